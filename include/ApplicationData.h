@@ -38,6 +38,9 @@
 #include "AssetDecoratedMap.h"
 #include "MultiplayerClient.hpp"
 
+class CAutoSave;
+class CAssetWatcher;
+
 typedef void (*TButtonCallbackFunction)(void *calldata);
 typedef bool (*TEditTextValidationCallbackFunction)(const std::string &text);
 
@@ -71,6 +74,10 @@ class CApplicationData : public std::enable_shared_from_this<CApplicationData>{
 	friend class CMapRenderer;
     friend class CAssetDecoratedMap;
     friend class CPlayerCapabilityCancel;
+    friend class CHeadlessRenderer;
+    friend class CStartupBenchmark;
+    friend class CSavedGame;
+    friend class CAssetWatcher;
 
     struct SPrivateApplicationType{};
     protected:
@@ -124,6 +131,21 @@ class CApplicationData : public std::enable_shared_from_this<CApplicationData>{
 
         static std::shared_ptr< CApplicationData > DApplicationDataPointer;
         bool DDeleted;
+        bool DHeadless;
+        bool DHeadlessSound;
+        int DHeadlessWidth;
+        int DHeadlessHeight;
+        std::string DSoundCachePath;
+        std::string DMapCachePath;
+        int DLoaderThreads;
+        bool DLockstepTextCommands;
+        int DLockstepInputDelay;
+        int DAutoSaveInterval;
+        std::shared_ptr< CAutoSave > DAutoSave;
+        bool DHotReload;
+        std::shared_ptr< CAssetWatcher > DAssetWatcher;
+        std::string DServerAddress;
+        std::string DServerPort;
         EGameSessionType DGameSessionType;
         EGameType DGameType;
         float DSoundVolume;
@@ -280,6 +302,7 @@ class CApplicationData : public std::enable_shared_from_this<CApplicationData>{
         static int TestLua();
 
         void Activate();
+        bool LoadGameData(std::shared_ptr< CDataContainer > datacontainer, std::shared_ptr< CDataContainer > imagedirectory);
         bool Timeout();
         bool MainWindowDeleteEvent(std::shared_ptr<CGUIWidget> widget);
         void MainWindowDestroy(std::shared_ptr<CGUIWidget> widget);
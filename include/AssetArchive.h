@@ -0,0 +1,133 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef ASSETARCHIVE_H
+#define ASSETARCHIVE_H
+#include "DataContainer.h"
+#include "DataSource.h"
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define ASSET_ARCHIVE_EXTENSION     ".pak"
+
+class CAssetArchive{
+    public:
+        using SEntry = struct ASSETARCHIVEENTRY_TAG{
+            const char *DName;
+            uint32_t DNameLength;
+            uint64_t DOffset;
+            uint64_t DSize;
+        };
+
+    protected:
+        struct SPrivateConstructorKey{};
+        int DFileHandle;
+        const char *DBase;
+        size_t DLength;
+        time_t DModificationTime;
+        std::vector< SEntry > DEntries;
+
+        bool Map(const std::string &filename);
+        static int CompareName(const SEntry &entry, const char *name, size_t length);
+
+    public:
+        explicit CAssetArchive(const SPrivateConstructorKey &key);
+        ~CAssetArchive();
+
+        static std::shared_ptr< CAssetArchive > Open(const std::string &filename);
+        static bool Build(const std::string &directory, const std::string &filename, size_t &entries, size_t &bytes);
+
+        size_t EntryCount() const{
+            return DEntries.size();
+        };
+        const SEntry &Entry(size_t index) const{
+            return DEntries[index];
+        };
+        const char *Data(const SEntry &entry) const{
+            return DBase + entry.DOffset;
+        };
+        time_t ModificationTime() const{
+            return DModificationTime;
+        };
+
+        const SEntry *Find(const std::string &name) const;
+        size_t LowerBound(const std::string &name) const;
+};
+
+class CAssetArchiveDataSource : public CDataSource{
+    protected:
+        std::shared_ptr< CAssetArchive > DArchive;
+        std::shared_ptr< CDataContainer > DContainer;
+        const char *DData;
+        size_t DSize;
+        size_t DOffset;
+
+    public:
+        CAssetArchiveDataSource(std::shared_ptr< CAssetArchive > archive, const CAssetArchive::SEntry &entry, std::shared_ptr< CDataContainer > container);
+
+        const char *Data() const{
+            return DData;
+        };
+        size_t Size() const{
+            return DSize;
+        };
+
+        int Read(void *data, int length);
+        bool ReadLine(std::string &line);
+        std::shared_ptr< CDataContainer > Container();
+        time_t ModificationTime();
+};
+
+class CAssetArchiveDataContainerIterator : public CDataContainerIterator{
+    friend class CAssetArchiveDataContainer;
+
+    protected:
+        struct SPrivateConstructorKey{};
+        std::vector< std::pair< std::string, bool > > DEntries;
+        size_t DIndex;
+
+    public:
+        explicit CAssetArchiveDataContainerIterator(const SPrivateConstructorKey &key);
+        std::string Name();
+        bool IsContainer();
+        bool IsValid();
+        void Next();
+};
+
+class CAssetArchiveDataContainer : public CDataContainer{
+    protected:
+        std::shared_ptr< CAssetArchive > DArchive;
+        std::string DRootPath;
+        std::string DFullPath;
+
+        bool ArchiveName(const std::string &fullpath, std::string &name) const;
+
+    public:
+        CAssetArchiveDataContainer(std::shared_ptr< CAssetArchive > archive, const std::string &rootpath, const std::string &path);
+
+        static std::shared_ptr< CDataContainer > OpenDataDirectory(const std::string &path);
+
+        std::shared_ptr< CDataContainerIterator > First() override;
+        std::shared_ptr< CDataSource > DataSource(const std::string &name) override;
+        std::shared_ptr< CDataSink > DataSink(const std::string &name) override;
+        std::shared_ptr< CDataContainer > Container() override;
+        std::shared_ptr< CDataContainer > DataContainer(const std::string &name) override;
+};
+
+#endif
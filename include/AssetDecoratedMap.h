@@ -19,10 +19,14 @@
 #include "TerrainMap.h"
 #include "PlayerAsset.h"
 #include "VisibilityMap.h"
+#include "DataContainer.h"
+#include "MemoryAccounting.h"
 #include <list>
 #include <map>
 #include <array>
 
+#define MAX_LOADED_MAPS     4
+
 class CAssetDecoratedMap : public CTerrainMap{
     public:
         typedef struct{
@@ -48,10 +52,34 @@ class CAssetDecoratedMap : public CTerrainMap{
         std::vector< std::vector< int > > DSearchMap;
         std::vector< std::vector< int > > DLumberAvailable;
         std::vector< std::vector< int > > DStoneAvailable;
+        CMemoryAccount DMemoryAccount;
+
+        using SMapEntry = struct MAPENTRY_TAG{
+            std::string DFileName;
+            std::string DMapName;
+            int DWidth;
+            int DHeight;
+            int DPlayerCount;
+            bool DReplaced;
+            unsigned int DLastUsed;
+            std::shared_ptr< CAssetDecoratedMap > DMap;
+        };
 
         static std::map< std::string, int > DMapNameTranslation;
-        static std::vector< std::shared_ptr< CAssetDecoratedMap > > DAllMaps;
-        static std::vector< std::shared_ptr< CAssetDecoratedMap > > DBackupMaps;
+        static std::vector< SMapEntry > DMapEntries;
+        static unsigned int DMapUseCount;
+        static std::shared_ptr< CDataContainer > DMapContainer;
+        static std::shared_ptr< CDataContainer > DMapCache;
+
+        static bool LoadMapHeader(std::shared_ptr< CDataSource > source, SMapEntry &entry);
+        static std::shared_ptr< CAssetDecoratedMap > LoadEntry(int index);
+        static void EvictMaps();
+
+        size_t MemoryUsage() const;
+        void AccountMemory();
+        void InitializeAvailableResources();
+        bool LoadCache(const std::string &data, uint64_t hash, std::string &triggers);
+        std::string StoreCache(uint64_t hash, const std::string &triggers) const;
 
     public:
         CAssetDecoratedMap();
@@ -62,7 +90,12 @@ class CAssetDecoratedMap : public CTerrainMap{
         CAssetDecoratedMap &operator=(const CAssetDecoratedMap &map);
 
         static bool LoadMaps(std::shared_ptr< CDataContainer > container);
+        static void MapCache(std::shared_ptr< CDataContainer > cache){
+            DMapCache = cache;
+        };
         static int FindMapIndex(const std::string &name);
+        static int MapCount();
+        static std::string GetMapName(int index);
         static std::shared_ptr< const CAssetDecoratedMap > GetMap(int index);
         static std::shared_ptr< CAssetDecoratedMap > DuplicateMap(int index, const std::array< EPlayerColor, to_underlying(EPlayerColor::Max)> &newcolors);
 
@@ -82,6 +115,7 @@ class CAssetDecoratedMap : public CTerrainMap{
         bool GrowTree(int x, int y);
 
         bool LoadMap(std::shared_ptr< CDataSource > source);
+        bool LoadMap(std::shared_ptr< CDataSource > source, std::string &triggers);
 
         const std::list< std::shared_ptr< CPlayerAsset > > &Assets() const;
         const std::list< SAssetInitialization > &AssetInitializationList() const;
@@ -95,6 +129,8 @@ class CAssetDecoratedMap : public CTerrainMap{
         CTilePosition FindNearestReachableTileType(const CTilePosition &pos, ETileType type);
 
         void SaveMap(std::ofstream& save) const;
+        std::vector< uint8_t > TerrainPartials() const;
+        void TerrainPartials(const std::vector< uint8_t > &partials);
         static void ReplaceMap(std::shared_ptr < CAssetDecoratedMap > NewMap, int index);
         static void ResetMap();
 };
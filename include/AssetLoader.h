@@ -18,14 +18,44 @@
 #define ASSETLOADER_H
 #include "ApplicationData.h"
 #include "Debug.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#define MAX_ASSET_LOADER_THREADS    4
 
 class CAssetLoader{
     protected:
+        using SPrefetch = struct PREFETCH_TAG{
+            std::string DName;
+            std::vector< char > DDescriptor;
+            std::shared_ptr< CGraphicSurface > DSurface;
+            bool DDone = false;
+            bool DTaken = false;
+        };
+
         std::shared_ptr< CApplicationData> AppData;
         std::shared_ptr< CDataContainer > TempDataContainer;
         std::shared_ptr< CDataContainer > ImageDirectory;
         std::shared_ptr< CDataContainerIterator > FileIterator;
         std::shared_ptr< CDataSource > TempDataSource;
+        std::shared_ptr< CGraphicSurface > TempSurface;
+
+        std::vector< SPrefetch > DPrefetches;
+        std::unordered_map< std::string, size_t > DPrefetchIndices;
+        std::vector< std::thread > DWorkers;
+        std::mutex DPrefetchMutex;
+        std::condition_variable DPrefetchCondition;
+        size_t DNextPrefetch;
+        bool DStopping;
+        double DWaitTime;
+
+        void StartPrefetch(const std::vector< std::string > &names, int threads);
+        void PrefetchWorker();
+        void StopPrefetch();
+        std::shared_ptr< CDataSource > Descriptor(const std::string &name, std::shared_ptr< CGraphicSurface > &surface);
+        void LoadStep(const std::string &name, void (CAssetLoader::*load)());
 
         void LoadFontColors();
         void LoadFont10();
@@ -70,6 +100,13 @@ class CAssetLoader{
         void LoadCannonTower();
     public:
         CAssetLoader(std::shared_ptr< CApplicationData> PassedAppData, std::shared_ptr< CDataContainer >, std::shared_ptr< CDataContainer >);
+        ~CAssetLoader();
+
+        static int ThreadCount(int requested);
+        double WaitTime() const{
+            return DWaitTime;
+        };
+
         void LoadAllAssets();
 };
 
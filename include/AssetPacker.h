@@ -0,0 +1,42 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef ASSETPACKER_H
+#define ASSETPACKER_H
+#include <string>
+
+class CAssetPacker{
+    public:
+        using SOptions = struct ASSETPACKEROPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DDataPath;
+            std::string DOutputPath;
+        };
+
+    protected:
+        SOptions DOptions;
+
+        bool Verify(const std::string &datapath, const std::string &outputpath);
+
+    public:
+        CAssetPacker(const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
@@ -24,10 +24,40 @@
 #include "GameModel.h"
 #include <vector>
 #include <list>
+#include <unordered_map>
+
+using SAssetRenderData = struct ASSETRENDERERDATA_TAG{
+    EAssetType DType;
+    int DX;
+    int DY;
+    int DBottomY;
+    int DTileIndex;
+    int DColorIndex;
+    uint32_t DPixelColor;
+    bool RangerInForest;
+};
 
 class CAssetRenderer{
     friend class CMapRenderer;
     protected:
+        using SAssetRenderItem = struct ASSETRENDERITEM_TAG{
+            std::shared_ptr< CPlayerAsset > DAsset;
+            EAssetType DType;
+            EAssetAction DAction;
+            EDirection DDirection;
+            EPlayerColor DColor;
+            EAssetCapabilityType DCapability;
+            int DStep;
+            int DPositionX;
+            int DPositionY;
+            int DHitPoints;
+            int DCarrying;
+            bool DInForest;
+            bool DValid;
+            int DGeneration;
+            SAssetRenderData DRenderData;
+        };
+        
         std::shared_ptr< CPlayerData > DPlayerData;
         std::shared_ptr< CAssetDecoratedMap > DPlayerMap;
         std::vector< std::shared_ptr< CGraphicMulticolorTileset > > DTilesets;
@@ -56,11 +86,29 @@ class CAssetRenderer{
         
         std::vector< uint32_t > DPixelColors;
         static int DAnimationDownsample;
+        static bool DRetainRenderItems;
+        
+        std::vector< SAssetRenderItem > DRenderItems;
+        std::vector< int > DRenderOrder;
+        std::vector< int > DFreeRenderItems;
+        std::unordered_map< CPlayerAsset *, int > DRenderItemLookup;
+        int DRenderGeneration;
+        int DRenderDownsample;
+        int DRenderCycle;
+        
+        bool RenderItemChanged(const SAssetRenderItem &item, const std::shared_ptr< CPlayerAsset > &asset) const;
+        void ComputeRenderData(SAssetRenderItem &item);
         
     public:
         CAssetRenderer(std::shared_ptr< CGraphicRecolorMap > colors, std::vector< std::shared_ptr< CGraphicMulticolorTileset > > tilesets, std::shared_ptr< CGraphicTileset > markertileset, std::shared_ptr< CGraphicTileset > corpsetileset, std::vector< std::shared_ptr< CGraphicTileset > > firetileset, std::shared_ptr< CGraphicTileset > buildingdeath, std::shared_ptr< CGraphicTileset > arrowtileset, std::shared_ptr< CPlayerData > player, std::shared_ptr< CAssetDecoratedMap > map);
         
         static int UpdateFrequency(int freq);
+        static bool RetainRenderItems(bool retain);
+        
+        void UpdateRenderItems();
+        int RenderItemCount() const{
+            return DRenderOrder.size();
+        }
         
         void DrawAssets(std::shared_ptr<CGraphicSurface> surface, std::shared_ptr<CGraphicSurface> typesurface, const SRectangle &rect);
         void DrawSelections(std::shared_ptr<CGraphicSurface> surface, const SRectangle &rect, const std::list< std::weak_ptr< CPlayerAsset > > &selectionlist, const SRectangle &selectrect, bool highlightbuilding);
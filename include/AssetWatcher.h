@@ -0,0 +1,71 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+#include "DataContainer.h"
+#include "GraphicTileset.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+#define ASSET_WATCHER_SCRIPT_PATH       "./scripts"
+#define ASSET_WATCHER_BUFFER_SIZE       4096
+
+class CApplicationData;
+
+class CAssetWatcher{
+    protected:
+        using STilesetEntry = struct TILESETENTRY_TAG{
+            std::string DDescriptor;
+            std::shared_ptr< CGraphicTileset > DTileset;
+        };
+
+        int DNotifyDescriptor;
+        int DImageWatch;
+        int DAssetWatch;
+        int DScriptWatch;
+        std::shared_ptr< CDataContainer > DImageDirectory;
+        std::shared_ptr< CDataContainer > DAssetDirectory;
+        std::string DScriptPath;
+        int DReloadCount;
+        int DFailedCount;
+
+        int AddWatch(const std::string &path);
+        std::vector< STilesetEntry > Tilesets(std::shared_ptr< CApplicationData > context);
+        std::string DescriptorImage(const std::string &descriptor);
+        bool ReloadTileset(const std::vector< STilesetEntry > &tilesets, const std::string &descriptor);
+        bool ReloadAssetType(std::shared_ptr< CApplicationData > context, const std::string &name);
+        bool ReloadScript(const std::string &name);
+
+    public:
+        CAssetWatcher(const std::string &datapath, const std::string &scriptpath);
+        ~CAssetWatcher();
+
+        bool Valid() const{
+            return 0 <= DNotifyDescriptor;
+        };
+        int ReloadCount() const{
+            return DReloadCount;
+        };
+        int FailedCount() const{
+            return DFailedCount;
+        };
+
+        int Poll(std::shared_ptr< CApplicationData > context);
+};
+
+#endif
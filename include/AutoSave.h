@@ -0,0 +1,84 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define AUTO_SAVE_FILENAME              "AutoSave.sav"
+#define DEFAULT_AUTO_SAVE_INTERVAL      0
+
+class CApplicationData;
+
+class CAutoSave{
+    protected:
+        std::string DFileName;
+        int DInterval;
+        std::chrono::steady_clock::time_point DLastSnapshot;
+
+        std::thread DThread;
+        std::mutex DMutex;
+        std::condition_variable DCondition;
+        std::string DPending;
+        bool DHasPending;
+        bool DWriting;
+        bool DTerminate;
+
+        int DSnapshotCount;
+        int DSkippedCount;
+        int DWriteCount;
+        int DFailedCount;
+        size_t DLastSize;
+        double DSnapshotTime;
+        double DMaxSnapshot;
+        double DWriteTime;
+        double DMaxWrite;
+
+        void WriterThread();
+
+    public:
+        CAutoSave(const std::string &filename, int interval);
+        ~CAutoSave();
+
+        int Interval() const{
+            return DInterval;
+        };
+        const std::string &FileName() const{
+            return DFileName;
+        };
+        int SnapshotCount() const{
+            return DSnapshotCount;
+        };
+        double MeanSnapshotTime() const{
+            return DSnapshotCount ? DSnapshotTime / DSnapshotCount : 0.0;
+        };
+        double MaxSnapshotTime() const{
+            return DMaxSnapshot;
+        };
+
+        void Reset();
+        bool Update(std::shared_ptr< CApplicationData > context);
+        bool Snapshot(std::shared_ptr< CApplicationData > context);
+        void Flush();
+        void PrintStatistics();
+};
+
+#endif
@@ -18,9 +18,11 @@
 #define BATTLEMODE_H
 
 #include "ApplicationMode.h"
+#include "LockstepScheduler.h"
 #include "PlayerCommand.h"
 #include "Position.h"
 #include "Rectangle.h"
+#include "RetainedPanel.h"
 #include <vector>
 #include <string>
 #include <iostream>
@@ -54,6 +56,10 @@ class CBattleMode : public CApplicationMode{
         std::vector< std::string > DEditText;
         std::shared_ptr< CDataSource > source;
         EAssetCapabilityType DPrevAction;
+        CRetainedPanel DUnitDescriptionPanel;
+        CLockstepScheduler DLockstep;
+
+        void UnitDescriptionKey(std::shared_ptr< CApplicationData > context, std::vector< int > &key);
 
     public:
         std::vector< CTilePosition > DWallPlacements;
@@ -0,0 +1,51 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef BUFFEREDDATASOURCE_H
+#define BUFFEREDDATASOURCE_H
+#include "DataSource.h"
+#include <vector>
+
+#define DEFAULT_DATA_SOURCE_BLOCK_SIZE  16384
+
+class CBufferedDataSource : public CDataSource{
+    protected:
+        std::vector< char > DBuffer;
+        size_t DBlockSize;
+        size_t DBufferOffset;
+        size_t DBufferLength;
+        size_t DBlockReads;
+
+        virtual int ReadBlock(void *data, int length) = 0;
+        bool Fill();
+
+    public:
+        CBufferedDataSource(size_t blocksize = DEFAULT_DATA_SOURCE_BLOCK_SIZE);
+        virtual ~CBufferedDataSource(){};
+
+        size_t BlockSize() const{
+            return DBlockSize;
+        };
+        void BlockSize(size_t blocksize);
+        size_t BlockReads() const{
+            return DBlockReads;
+        };
+
+        int Read(void *data, int length);
+        bool ReadLine(std::string &line);
+};
+
+#endif
@@ -19,6 +19,8 @@
 #include "Bevel.h"
 #include "FontTileset.h"
 #include "GameDataTypes.h"
+#include "RetainedPanel.h"
+#include <unordered_map>
 #include <vector>
 
 class CButtonRenderer{
@@ -47,6 +49,9 @@ class CButtonRenderer{
         int DWhiteIndex;
         int DGoldIndex;
         int DBlackIndex;
+        std::unordered_map< std::string, std::vector< CRetainedPanel > > DButtonPanels;
+        
+        void DrawButtonFace(std::shared_ptr<CGraphicSurface> surface, int x, int y, EButtonState state);
         
     public:        
         CButtonRenderer(std::shared_ptr< CGraphicRecolorMap > colors, std::shared_ptr< CBevel > innerbevel, std::shared_ptr< CBevel > outerbevel, std::shared_ptr< CFontTileset > font);
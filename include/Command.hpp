@@ -10,6 +10,7 @@
 #include <vector>
 #include <utility> // std::pair
 #include <stdexcept> //runtime_error
+#include <cstddef>
 
 class Command {
     // The entire str.
@@ -103,4 +104,73 @@ class Command {
     }
 };
 
+// A piece of a line, it only points into the line and does not own it.
+class CommandSpan {
+  public:
+    const char* data = nullptr;
+    std::size_t size = 0;
+
+    CommandSpan() { }
+    CommandSpan(const char* d,std::size_t s) : data(d), size(s) { }
+
+    bool empty() const { return 0 == size; }
+    bool equals(const char* s) const;
+    // The command part is compared ignoring case, like Command uppercases it
+    bool equalsNoCase(const char* s) const;
+    bool startsWith(const char* s) const;
+    std::string str() const { return std::string(data,size); }
+    void appendTo(std::string& s) const { s.append(data,size); }
+};
+
+// Parses a line like Command(everything,true) does, but in place: the
+// command, type and arguments are spans into the line, so nothing is
+// allocated. The line has to stay unchanged while the view is used.
+// Directive types (DD, D2) are not split and arguments with backslashes
+// are not unescaped, needsUnescape() tells when Command has to be used.
+// Lines with more than MAX_ARGS arguments or MAX_ROWS rows are rejected.
+class CommandView {
+  public:
+    static const std::size_t MAX_ARGS = 64;
+    static const std::size_t MAX_ROWS = 16;
+
+    // False if Command would throw, or the line does not fit the view.
+    bool parse(const char* line,std::size_t length);
+    bool parse(const std::string& line) {
+	return parse(line.data(),line.size());
+    }
+    // The first word of a line, without parsing the rest.
+    static CommandSpan verb(const std::string& line);
+
+    const CommandSpan& cmd() const { return _cmd; }
+    const CommandSpan& type() const { return _type; }
+    const CommandSpan& rest() const { return _rest; }
+    bool is(const char* command) const { return _cmd.equalsNoCase(command); }
+    bool needsUnescape() const { return directive || escaped; }
+
+    std::size_t rows() const { return _rows; }
+    std::size_t numArgsInRow(std::size_t row) const {
+	return rowStart[row+1] - rowStart[row];
+    }
+    const CommandSpan& get(std::size_t row,std::size_t i) const {
+	return args[rowStart[row]+i];
+    }
+    // Arguments of all rows, in order
+    std::size_t numArgs() const { return _numArgs; }
+    const CommandSpan& arg(std::size_t i) const { return args[i]; }
+
+  private:
+    CommandSpan _cmd;
+    CommandSpan _type;
+    CommandSpan _rest;
+    CommandSpan args[MAX_ARGS];
+    std::size_t rowStart[MAX_ROWS+1];
+    std::size_t _numArgs = 0;
+    std::size_t _rows = 0;
+    bool directive = false;
+    bool escaped = false;
+
+    bool split(const char* s,std::size_t length,char separator);
+    bool addRow();
+};
+
 #endif
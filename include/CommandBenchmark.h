@@ -0,0 +1,53 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef COMMANDBENCHMARK_H
+#define COMMANDBENCHMARK_H
+#include <random>
+#include <string>
+#include <vector>
+
+class CCommandBenchmark{
+    public:
+        using SOptions = struct COMMANDBENCHMARKOPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DCorpusPath;
+            int DLines = 10000;
+            int DPasses = 100;
+        };
+
+    protected:
+        SOptions DOptions;
+        std::mt19937 DRandom;
+        std::vector< std::string > DCorpus;
+
+        std::string RandomName();
+        void GenerateCorpus();
+        bool LoadCorpus();
+        bool CheckCorpus();
+        void RunReceive();
+        void RunParse();
+        static void PrintResult(const char *name, double legacySeconds, double viewSeconds, size_t lines);
+
+    public:
+        CCommandBenchmark(const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
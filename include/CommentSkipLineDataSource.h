@@ -22,6 +22,7 @@
 class CCommentSkipLineDataSource : public CLineDataSource{
     protected:
         char DCommentCharacter;
+        std::string DTempLine;
     public:
         CCommentSkipLineDataSource(std::shared_ptr< CDataSource > source, char commentchar);
         
@@ -19,14 +19,19 @@
 
 #include <string>
 #include <memory>
+#include <ctime>
 #include "DataContainer.h"
 
 class CDataSource{
     public:
         virtual int Read(void *data, int length) = 0;
+        virtual bool ReadLine(std::string &line);
         virtual std::shared_ptr< CDataContainer > Container(){
             return nullptr;
         };
+        virtual time_t ModificationTime(){
+            return 0;
+        };
 };
 
 #endif
@@ -30,6 +30,7 @@ class CFileDataSink : public CDataSink{
         ~CFileDataSink();                         
         
         int Write(const void *data, int length) override;
+        bool Sync();
         //int Append(const void *data, int length) override;
         std::shared_ptr< CDataContainer > Container() override;
 };
@@ -17,20 +17,24 @@
 #ifndef FILEDATASOURCE_H
 #define FILEDATASOURCE_H
 
-#include "DataSource.h"
+#include "BufferedDataSource.h"
 
-class CFileDataSource : public CDataSource{
+class CFileDataSource : public CBufferedDataSource{
     protected:
         int DFileHandle;
         std::string DFullPath;
         bool DCloseFile = false;
+        std::shared_ptr< CDataContainer > DContainer;
+
+        int ReadBlock(void *data, int length);
         
     public:
         CFileDataSource(const std::string &filename, int fd = -1);
         ~CFileDataSource();
         
-        int Read(void *data, int length);
         std::shared_ptr< CDataContainer > Container();
+        void Container(std::shared_ptr< CDataContainer > container);
+        time_t ModificationTime();
 };
 
 #endif
@@ -23,6 +23,14 @@
 
 class CFogRenderer{
     protected:
+        struct SFogTile{
+            CVisibilityMap::ETileVisibility DVisibility;
+            int DBaseIndex;
+            int DFogIndex;
+            int DBlackIndex;
+            bool DDirty;
+        };
+        
         std::shared_ptr< CGraphicTileset > DTileset;
         std::shared_ptr< CVisibilityMap > DMap;
         int DNoneIndex;
@@ -30,6 +38,14 @@ class CFogRenderer{
         int DPartialIndex;
         std::vector< int > DFogIndices;
         std::vector< int > DBlackIndices;
+        int DCacheWidth;
+        int DCacheHeight;
+        std::vector< SFogTile > DTileCache;
+        
+        void ComputeTile(int xindex, int yindex, SFogTile &tile) const;
+        void MarkDirty(int xindex, int yindex);
+        void MarkTransition(int xindex, int yindex);
+        void SyncCache(int minx, int miny, int maxx, int maxy);
         
     public:
         CFogRenderer(std::shared_ptr< CGraphicTileset > tileset, std::shared_ptr< CVisibilityMap > map);
@@ -38,7 +54,9 @@ class CFogRenderer{
         void DrawMiniMap(std::shared_ptr<CGraphicSurface> surface);
         void ReplaceVisibilityMap(std::shared_ptr< CVisibilityMap > map){
             DMap = map;
+            InvalidateCache();
         }
+        void InvalidateCache();
 };
 
 #endif
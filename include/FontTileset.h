@@ -17,6 +17,8 @@
 #ifndef FONTTILESET_H
 #define FONTTILESET_H
 #include "GraphicMulticolorTileset.h"
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 class CFontTileset : public CGraphicMulticolorTileset{
@@ -30,13 +32,32 @@ class CFontTileset : public CGraphicMulticolorTileset{
         int DTopOpaque;
         int DBottomOpaque;
         
+        using STextRun = struct TEXTRUN_TAG{
+            int DWidth;
+            int DTop;
+            int DBottom;
+            int DOffsetX;
+            int DSurfaceWidth;
+            std::vector< std::shared_ptr< CGraphicSurface > > DSurfaces;
+            std::list< std::string >::iterator DUsage;
+        };
+        
+        std::unordered_map< std::string, STextRun > DTextRuns;
+        std::list< std::string > DTextRunUsage;
+        size_t DTextRunCapacity;
+        
         static uint32_t TopBottomSearch(void *data, uint32_t pixel);
         
+        STextRun &FindTextRun(const std::string &str);
+        std::shared_ptr< CGraphicSurface > TextRunSurface(STextRun &run, const std::string &str, int colorindex);
+        void DrawTextRun(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int colorindex, const std::string &str);
+        
     public:
         CFontTileset();
         virtual ~CFontTileset();
         
-        bool LoadFont(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source); 
+        bool LoadFont(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface = nullptr); 
+        virtual bool ReloadTileset(std::shared_ptr< CDataSource > source) override;
         
         int CharacterBaseline() const{
             return DCharacterBaseline;  
@@ -47,6 +68,15 @@ class CFontTileset : public CGraphicMulticolorTileset{
         void DrawTextWithShadow(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int color, int shadowcol, int shadowwidth, const std::string &str);
         void MeasureText(const std::string &str, int &width, int &height);
         void MeasureTextDetailed(const std::string &str, int &width, int &height, int &top, int &bottom);
+        
+        size_t TextRunCapacity() const{
+            return DTextRunCapacity;
+        };
+        void TextRunCapacity(size_t capacity);
+        size_t TextRunCount() const{
+            return DTextRuns.size();
+        };
+        void ClearTextRuns();
 };
 
 #endif
@@ -25,6 +25,7 @@
 #include "TriggerHandler.h"
 #include "FileDataSource.h"
 #include "CommentSkipLineDataSource.h"
+#include "MemoryAccounting.h"
 
 extern int GAssetIDCount;
 extern std::map< int, std::shared_ptr< CPlayerAsset > > GAssetIDMap;
@@ -89,6 +90,7 @@ class CPlayerData{
 
     public:
         CPlayerData(std::shared_ptr< CAssetDecoratedMap > map, std::shared_ptr< CTriggerHandler > handler, EPlayerColor color);
+        ~CPlayerData();
 
         int HealStartTime() const{
             return DHealStartTime;
@@ -238,12 +240,15 @@ class CPlayerData{
             return DGameEvents;
         };
         void ClearGameEvents(){
+            CMemoryAccounting::Free(EMemorySubsystem::Events, DGameEvents.size() * sizeof(SGameEvent));
             DGameEvents.clear();
         };
         void AddGameEvent(const SGameEvent &event){
+            CMemoryAccounting::Allocate(EMemorySubsystem::Events, sizeof(SGameEvent));
             DGameEvents.push_back(event);
         };
         void AppendGameEvents(const std::vector< SGameEvent > &events){
+            CMemoryAccounting::Allocate(EMemorySubsystem::Events, events.size() * sizeof(SGameEvent), events.size());
             DGameEvents.insert(DGameEvents.end(), events.begin(), events.end());
         };
 
@@ -313,6 +318,19 @@ class CGameModel{
 
         std::shared_ptr< CAssetDecoratedMap > Map() { return DActualMap; }
 
+        uint64_t RandomState() const{
+            return DRandomNumberGenerator.State();
+        };
+        void RandomState(uint64_t state){
+            DRandomNumberGenerator.State(state);
+        };
+        const std::map< std::pair<int,int>, int> &GrowthMap() const{
+            return DGrowthMap;
+        };
+        void GrowthMap(const std::map< std::pair<int,int>, int> &growthmap){
+            DGrowthMap = growthmap;
+        };
+
         void SaveGrowthMap(std::ofstream& save);
         void LoadGrowthMap(std::shared_ptr< CDataSource > source);
 };
@@ -0,0 +1,103 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+#include <boost/asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DEFAULT_GAME_SERVER_PORT    55107
+
+class CGameServerSession;
+
+class CGameServer{
+    friend class CGameServerSession;
+    public:
+        using SOptions = struct GAMESERVEROPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DAddress = "0.0.0.0";
+            int DPort = DEFAULT_GAME_SERVER_PORT;
+            std::string DRecordPath;
+        };
+        using SStatistics = struct GAMESERVERSTATISTICS_TAG{
+            uint64_t DMessagesIn;
+            uint64_t DMessagesOut;
+            uint64_t DBytesIn;
+            uint64_t DBytesOut;
+            uint64_t DConnections;
+            uint64_t DPeakQueueDepth;
+        };
+
+    protected:
+        using SGame = struct GAME_TAG{
+            int DID;
+            std::string DName;
+            std::string DMap;
+            std::string DPassword;
+            int DMaxPlayers;
+            bool DPrivate;
+            bool DStarted;
+            std::vector< std::shared_ptr< CGameServerSession > > DPlayers;
+        };
+
+        boost::asio::io_service DIOService;
+        boost::asio::ip::tcp::acceptor DAcceptor;
+        std::thread DThread;
+        std::map< int, SGame > DGames;
+        std::set< std::string > DUsers;
+        int DNextGameID;
+        std::ofstream DRecord;
+
+        std::atomic< uint64_t > DMessagesIn;
+        std::atomic< uint64_t > DMessagesOut;
+        std::atomic< uint64_t > DBytesIn;
+        std::atomic< uint64_t > DBytesOut;
+        std::atomic< uint64_t > DConnections;
+        std::atomic< uint64_t > DPeakQueueDepth;
+
+        void Accept();
+        void Dispatch(std::shared_ptr< CGameServerSession > session, const std::string &line);
+        void Broadcast(SGame &game, const std::string &line, const CGameServerSession *except);
+        void Leave(std::shared_ptr< CGameServerSession > session);
+        void Disconnected(std::shared_ptr< CGameServerSession > session);
+        void Sent(size_t bytes, size_t depth);
+        std::string GameInfo(const SGame &game, const CGameServerSession *session) const;
+
+    public:
+        CGameServer(const std::string &address, int port);
+        ~CGameServer();
+
+        int Port() const;
+        void Start();
+        void Stop();
+        bool Record(const std::string &path);
+        SStatistics Statistics() const;
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
@@ -39,7 +39,9 @@ class CGraphicMulticolorTileset : public CGraphicTileset{
             return DColorMap->FindColor(colorname);
         };
         
-        virtual bool LoadTileset(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source); 
+        virtual bool LoadTileset(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface = nullptr); 
+        virtual bool ReloadTileset(std::shared_ptr< CDataSource > source) override;
+        virtual size_t MemoryUsage() const override;
         
         void DrawTile(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int tileindex, int colorindex, bool RangerInForest = false);
 };
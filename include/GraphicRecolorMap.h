@@ -50,7 +50,7 @@ class CGraphicRecolorMap{
         int FindColor(const std::string &colorname) const;
         uint32_t ColorValue(int gindex, int cindex) const;
         
-        bool Load(std::shared_ptr< CDataSource > source);
+        bool Load(std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface = nullptr);
         
         std::shared_ptr<CGraphicSurface> RecolorSurface(int index, std::shared_ptr<CGraphicSurface> srcsurface);
 };
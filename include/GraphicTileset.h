@@ -21,6 +21,7 @@
 #include <vector>
 #include "GraphicSurface.h"
 #include "DataSource.h"
+#include "MemoryAccounting.h"
 
 class CGraphicTileset{
     protected:
@@ -35,14 +36,19 @@ class CGraphicTileset{
         int DTileHeight;
         int DTileHalfWidth;
         int DTileHalfHeight;
+        CMemoryAccount DMemoryAccount;
         
         static bool ParseGroupName(const std::string &tilename, std::string &aniname, int &anistep);
+        static size_t SurfaceBytes(std::shared_ptr< CGraphicSurface > surface);
         void UpdateGroupNames();
+        void AccountMemory();
         
     public:
         CGraphicTileset();
         virtual ~CGraphicTileset();
 
+        virtual size_t MemoryUsage() const;
+
         int TileCount() const{
             return DTileCount;
         };
@@ -73,7 +79,8 @@ class CGraphicTileset{
         
         void CreateClippingMasks();
         
-        bool LoadTileset(std::shared_ptr< CDataSource > source);
+        bool LoadTileset(std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface = nullptr);
+        virtual bool ReloadTileset(std::shared_ptr< CDataSource > source);
         
         void DrawTile(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int tileindex);
         
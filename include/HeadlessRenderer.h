@@ -0,0 +1,81 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef HEADLESSRENDERER_H
+#define HEADLESSRENDERER_H
+#include "ApplicationData.h"
+#include <string>
+#include <vector>
+
+class CHeadlessRenderer{
+    public:
+        using SOptions = struct HEADLESSOPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DDataPath;
+            std::string DMapName;
+            std::string DSavedGame;
+            std::string DSaveGame;
+            std::string DCameraPath;
+            std::string DSnapshotPath;
+            std::string DTimingsPath;
+            int DSnapshotInterval = 1;
+            int DFrames = 300;
+            int DWidth = 800;
+            int DHeight = 600;
+            int DSaveRuns = 0;
+            int DMemoryReportInterval = 0;
+            int DUnits = 0;
+            bool DSimulate = false;
+            bool DCompareRetained = false;
+        };
+
+    protected:
+        using SFrameTiming = struct FRAMETIMING_TAG{
+            int DCameraX;
+            int DCameraY;
+            double DViewport;
+            double DMiniMap;
+            double DUserInterface;
+        };
+
+        std::shared_ptr< CApplicationData > DContext;
+        SOptions DOptions;
+        std::vector< CPixelPosition > DCameraPath;
+        std::vector< SFrameTiming > DTimings;
+
+        bool LoadGame();
+        bool LoadCameraPath();
+        bool AddUnits();
+        CPixelPosition CameraPosition(int frame) const;
+        void SelectAssets();
+        void RenderFrame(int frame);
+        bool StoreSnapshot(int frame);
+        void WriteTimings() const;
+        void PrintSummary() const;
+        static void PrintMemoryReport(const char *when);
+        bool StoreSavedGame();
+        bool BenchmarkSaves();
+
+    public:
+        CHeadlessRenderer(std::shared_ptr< CApplicationData > context, const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
+
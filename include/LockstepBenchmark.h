@@ -0,0 +1,57 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included
+    that were extracted from original Warcraft II by Blizzard Entertainment
+    were found freely available via internet sources and have been labeld as
+    abandonware. They have been included in this distribution for educational
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef LOCKSTEPBENCHMARK_H
+#define LOCKSTEPBENCHMARK_H
+#include "LockstepFrame.h"
+#include "LockstepScheduler.h"
+#include <random>
+#include <string>
+#include <vector>
+
+class CLockstepBenchmark{
+    public:
+        using SOptions = struct LOCKSTEPBENCHMARKOPTIONS_TAG{
+            bool DEnabled = false;
+            int DFrames = 100000;
+            int DCommands = 1;
+            int DActors = 9;
+            int DPeers = 2;
+            int DCycles = 2000;
+            int DDelay = DEFAULT_LOCKSTEP_INPUT_DELAY;
+            int DLatency = 4;
+        };
+
+    protected:
+        SOptions DOptions;
+        std::mt19937 DRandom;
+        std::vector< SLockstepFrame > DFrames;
+
+        SLockstepFrame RandomFrame(int cycle, int commands, int actors);
+        bool RoundTrip(const SLockstepFrame &frame, bool text);
+        bool RunRoundTrips();
+        void RunThroughput(bool text);
+        bool RunLoopback(int delay);
+
+    public:
+        CLockstepBenchmark(const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
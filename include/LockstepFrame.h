@@ -0,0 +1,68 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef LOCKSTEPFRAME_H
+#define LOCKSTEPFRAME_H
+
+#include "GameDataTypes.h"
+#include "PlayerCommand.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define LOCKSTEP_FRAME_VERSION      1
+#define LOCKSTEP_BINARY_MARKER      '~'
+
+using SLockstepCommand = struct LOCKSTEPCOMMAND_TAG{
+    EPlayerColor DPlayer;
+    EAssetCapabilityType DAction;
+    std::vector< int > DActorIDs;
+    EPlayerColor DTargetColor;
+    EAssetType DTargetType;
+    int DTargetX;
+    int DTargetY;
+};
+
+using SLockstepFrame = struct LOCKSTEPFRAME_TAG{
+    int DCycle;
+    std::vector< SLockstepCommand > DCommands;
+};
+
+class CLockstepFrame{
+    protected:
+        static void AppendVarint(std::string &data, uint32_t value);
+        static bool ReadVarint(const std::string &data, size_t &offset, uint32_t &value);
+        static uint32_t ZigZag(int value);
+        static int UnZigZag(uint32_t value);
+        static std::string ToText64(const std::string &data);
+        static bool FromText64(const std::string &text, std::string &data);
+
+    public:
+        static SLockstepCommand FromRequest(EPlayerColor player, const SPlayerCommandRequest &request);
+        static void ToRequest(const SLockstepCommand &command, SPlayerCommandRequest &request);
+
+        static std::string EncodeBinary(const SLockstepFrame &frame);
+        static bool DecodeBinary(const std::string &data, SLockstepFrame &frame);
+        static std::string EncodeText(const SLockstepFrame &frame);
+        static bool DecodeText(const std::string &text, SLockstepFrame &frame);
+
+        static std::string EncodeMessage(const SLockstepFrame &frame, bool text = false);
+        static bool DecodeMessage(const std::string &message, SLockstepFrame &frame);
+
+        static bool Equal(const SLockstepFrame &first, const SLockstepFrame &second);
+};
+
+#endif
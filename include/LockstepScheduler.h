@@ -0,0 +1,94 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef LOCKSTEPSCHEDULER_H
+#define LOCKSTEPSCHEDULER_H
+#include "LockstepFrame.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#define DEFAULT_LOCKSTEP_INPUT_DELAY    3
+#define MAX_LOCKSTEP_INPUT_DELAY        60
+#define MAX_LOCKSTEP_CYCLES_AHEAD       256
+
+class CLockstepScheduler{
+    protected:
+        using SCycleSlot = struct CYCLESLOT_TAG{
+            uint32_t DReceived = 0;
+            std::vector< SLockstepCommand > DCommands;
+        };
+
+        int DInputDelay;
+        int DStartCycle;
+        int DCurrentCycle;
+        int DIssuedCycle;
+        uint32_t DExpected;
+        std::map< int, SCycleSlot > DSlots;
+        bool DHasPending;
+        SLockstepCommand DPending;
+
+        bool DStalling;
+        double DStallStart;
+        int DStallCount;
+        int DStalledFrames;
+        int DCyclesAdvanced;
+        double DStallTime;
+        double DMaxStall;
+
+        static uint32_t PlayerBit(EPlayerColor player){
+            return uint32_t(1) << to_underlying(player);
+        };
+        bool Store(int cycle, EPlayerColor player, const std::vector< SLockstepCommand > &commands);
+
+    public:
+        CLockstepScheduler(int delay = DEFAULT_LOCKSTEP_INPUT_DELAY);
+
+        int InputDelay() const{
+            return DInputDelay;
+        };
+        int InputDelay(int delay);
+        void Reset(int cycle);
+
+        void Expect(EPlayerColor player, bool expected);
+        void Submit(const SLockstepCommand &command);
+        bool Issue(int cycle, EPlayerColor player, SLockstepFrame &frame);
+        bool Receive(const SLockstepFrame &frame);
+        bool Ready(int cycle) const;
+        bool Advance(int cycle, double now, std::vector< SLockstepCommand > &commands);
+
+        int BufferedCycles() const{
+            return DSlots.size();
+        };
+        int StallCount() const{
+            return DStallCount;
+        };
+        int StalledFrames() const{
+            return DStalledFrames;
+        };
+        int CyclesAdvanced() const{
+            return DCyclesAdvanced;
+        };
+        double StallTime() const{
+            return DStallTime;
+        };
+        double MaxStall() const{
+            return DMaxStall;
+        };
+        void PrintStatistics() const;
+};
+
+#endif
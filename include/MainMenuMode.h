@@ -38,6 +38,8 @@ class CMainMenuMode : public CButtonMenuMode{
         explicit CMainMenuMode(const SPrivateConstructorType &key);
 
         static std::shared_ptr< CApplicationMode > Instance();
+        static bool LoadSavedGame(std::shared_ptr< CApplicationData > context, std::shared_ptr< CDataSource > source);
+        static void CenterViewport(std::shared_ptr< CApplicationData > context);
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 #include "ApplicationMode.h"
 #include "Rectangle.h"
+#include "GraphicSurface.h"
 #include <vector>
 #include <string>
                                    
@@ -34,6 +35,7 @@ class CMapSelectionMode : public CApplicationMode{
         std::vector< SRectangle > DButtonLocations;
         bool DButtonHovered;
         int DMapOffset;
+        std::vector< std::shared_ptr< CGraphicSurface > > DPreviews;
         
         static void SelectMapButtonCallback(std::shared_ptr< CApplicationData > context);
         static void BackButtonCallback(std::shared_ptr< CApplicationData > context);
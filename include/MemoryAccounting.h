@@ -0,0 +1,87 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class EMemorySubsystem{
+    Maps = 0,
+    Visibility,
+    Assets,
+    Events,
+    Lua,
+    Tilesets,
+    Max
+};
+
+class CMemoryAccounting{
+    protected:
+        using SCounters = struct MEMORYCOUNTERS_TAG{
+            std::atomic< int64_t > DLiveBytes;
+            std::atomic< int64_t > DPeakBytes;
+            std::atomic< uint64_t > DAllocations;
+            std::atomic< uint64_t > DAllocatedBytes;
+            std::atomic< uint64_t > DReservedBytes;
+            uint64_t DReportedAllocations;
+            uint64_t DReportedBytes;
+        };
+
+        static SCounters DCounters[static_cast< int >(EMemorySubsystem::Max)];
+        static std::chrono::steady_clock::time_point DReportTime;
+
+    public:
+        static const char *Name(EMemorySubsystem subsystem);
+        static void Allocate(EMemorySubsystem subsystem, size_t bytes, size_t count = 1);
+        static void Free(EMemorySubsystem subsystem, size_t bytes);
+        static void Reserve(EMemorySubsystem subsystem, size_t bytes);
+
+        static int64_t LiveBytes(EMemorySubsystem subsystem){
+            return DCounters[static_cast< int >(subsystem)].DLiveBytes;
+        };
+        static uint64_t Allocations(EMemorySubsystem subsystem){
+            return DCounters[static_cast< int >(subsystem)].DAllocations;
+        };
+
+        static std::vector< std::string > Report();
+};
+
+class CMemoryAccount{
+    protected:
+        EMemorySubsystem DSubsystem;
+        size_t DBytes;
+
+    public:
+        CMemoryAccount(EMemorySubsystem subsystem);
+        CMemoryAccount(const CMemoryAccount &account);
+        ~CMemoryAccount();
+
+        CMemoryAccount &operator=(const CMemoryAccount &account){
+            Resize(account.DBytes);
+            return *this;
+        };
+
+        size_t Bytes() const{
+            return DBytes;
+        };
+        void Resize(size_t bytes);
+};
+
+#endif
@@ -27,6 +27,7 @@ class CMemoryDataSource : public CDataSource{
     public:
         CMemoryDataSource(const std::vector< char > &src);
         int Read(void *data, int length);
+        bool ReadLine(std::string &line);
 };
 
 #endif
@@ -0,0 +1,101 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef MEMORYPOOL_H
+#define MEMORYPOOL_H
+#include "MemoryAccounting.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#define MEMORY_POOL_CHUNK_BLOCKS    64
+
+class CMemoryPool{
+    protected:
+        EMemorySubsystem DSubsystem;
+        size_t DBlockSize;
+        std::mutex DMutex;
+        void *DFreeBlocks;
+        std::vector< char * > DChunks;
+        size_t DLiveBlocks;
+
+    public:
+        CMemoryPool(size_t blocksize, EMemorySubsystem subsystem);
+        ~CMemoryPool();
+
+        size_t BlockSize() const{
+            return DBlockSize;
+        };
+        size_t LiveBlocks() const{
+            return DLiveBlocks;
+        };
+
+        void *Allocate();
+        void Free(void *block);
+};
+
+template< typename T, EMemorySubsystem Subsystem > class CPoolAllocator{
+    public:
+        using value_type = T;
+
+        template< typename U > struct rebind{
+            using other = CPoolAllocator< U, Subsystem >;
+        };
+
+        CPoolAllocator(){};
+        template< typename U > CPoolAllocator(const CPoolAllocator< U, Subsystem > &allocator){};
+
+        static CMemoryPool &Pool(){
+            // Never destroyed, so objects released after main returns can
+            // still go back to their pool
+            static CMemoryPool *Pool = new CMemoryPool(sizeof(T), Subsystem);
+
+            return *Pool;
+        };
+
+        T *allocate(size_t count){
+            if(1 == count){
+                return static_cast< T * >(Pool().Allocate());
+            }
+            CMemoryAccounting::Allocate(Subsystem, count * sizeof(T));
+            return static_cast< T * >(::operator new(count * sizeof(T)));
+        };
+        void deallocate(T *pointer, size_t count){
+            if(1 == count){
+                Pool().Free(pointer);
+                return;
+            }
+            CMemoryAccounting::Free(Subsystem, count * sizeof(T));
+            ::operator delete(pointer);
+        };
+};
+
+template< typename T, typename U, EMemorySubsystem Subsystem > bool operator==(const CPoolAllocator< T, Subsystem > &first, const CPoolAllocator< U, Subsystem > &second){
+    return true;
+}
+
+template< typename T, typename U, EMemorySubsystem Subsystem > bool operator!=(const CPoolAllocator< T, Subsystem > &first, const CPoolAllocator< U, Subsystem > &second){
+    return false;
+}
+
+template< typename T, EMemorySubsystem Subsystem, typename... TArgs > std::shared_ptr< T > MakePooled(TArgs&&... args){
+    return std::allocate_shared< T >(CPoolAllocator< T, Subsystem >(), std::forward< TArgs >(args)...);
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included
+    that were extracted from original Warcraft II by Blizzard Entertainment
+    were found freely available via internet sources and have been labeld as
+    abandonware. They have been included in this distribution for educational
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef MIXERBENCHMARK_H
+#define MIXERBENCHMARK_H
+#include "SoundLibraryMixer.h"
+#include <string>
+#include <vector>
+
+class CMixerBenchmark{
+    public:
+        using SOptions = struct MIXERBENCHMARKOPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DDataPath;
+            std::string DScriptPath;
+            std::string DWavePath;
+            std::string DTimingsPath;
+            std::string DSongName;
+            std::string DCachePath;
+            int DSeconds = 30;
+            int DVoiceLimit = 0;
+        };
+
+    protected:
+        enum class EEventType{
+            Clip,
+            Tone,
+            Song,
+            Stop
+        };
+
+        using SScriptEvent = struct SCRIPTEVENT_TAG{
+            double DTime;
+            EEventType DType;
+            std::string DName;
+            float DFrequency;
+            int DCount;
+        };
+
+        using SBufferTiming = struct BUFFERTIMING_TAG{
+            double DMicroseconds;
+            int DClipVoices;
+            int DToneVoices;
+        };
+
+        std::shared_ptr< CSoundLibraryMixer > DMixer;
+        SOptions DOptions;
+        std::vector< SScriptEvent > DScript;
+        std::vector< SBufferTiming > DTimings;
+        int DClipRotation;
+
+        bool LoadScript();
+        void DefaultScript();
+        void TriggerEvent(const SScriptEvent &event);
+        void WriteTimings() const;
+        void PrintSummary() const;
+
+    public:
+        CMixerBenchmark(const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
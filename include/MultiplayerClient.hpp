@@ -1,9 +1,6 @@
 #ifndef CHAT_CLIENT_HPP
 #define CHAT_CLIENT_HPP
 
-#ifndef BOOST_ASIO_HPP
-#define BOOST_ASIO_HPP
-
 #if defined(_MSC_VER) && (_MSC_VER >= 1200)
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
@@ -12,15 +9,22 @@
 #include <deque>
 #include <iostream>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <boost/asio.hpp>
 #include "ApplicationData.h"
 #include "ApplicationMode.h"
 #include "MapSelectionMode.h"
+#include "SPSCQueue.h"
+#include "Command.hpp"
 
 
 using boost::asio::ip::tcp;
 #define HISTORY_SIZE 256
+#define MESSAGE_QUEUE_SIZE 1024
+#define MESSAGE_RETRY_INTERVAL 5
 
 class Handler
 {
@@ -38,10 +42,19 @@ class CMultiplayerClient
 		Handler handler;
 		boost::asio::io_service io_service_;
 		tcp::socket socket_;
+		boost::asio::deadline_timer retry_timer_;
+		// only touched on the io_service thread, write() posts to it
 		std::deque<std::string> outqueue;
 		std::thread service_thread;
 		boost::asio::streambuf inbuf, outbuf;
-		std::deque<std::string> inqueue;
+		// lines from the server, pushed by the io_service thread and
+		// popped by the game thread
+		CSPSCQueue<std::string, MESSAGE_QUEUE_SIZE> inqueue;
+		std::mutex inmutex;
+		std::condition_variable incondition;
+		std::atomic<bool> closed_;
+		// parses the front of inqueue on the game thread
+		CommandView view_;
 		std::deque<std::string> history;
 	public:
 		std::vector<std::string> games;
@@ -82,6 +95,9 @@ class CMultiplayerClient
 
 		void sendCommand(std::string command);
 
+		// sends a single token lockstep frame, see CLockstepFrame
+		void sendCommandFrame(const std::string &frame);
+
 		std::string getCommand();
 	
 		void sendMap(std::string command);
@@ -100,13 +116,27 @@ class CMultiplayerClient
 		
 		void close();
 
+		bool isClosed() const { return closed_; }
+
+		// lines received but not taken by the game yet
+		std::size_t queuedMessages() const { return inqueue.Size(); }
+
 	private:
+		// blocks until a line arrives, false if the connection closed first
+		bool wait_message(std::string &msg);
+
+		void notify_waiting();
+
+		void deliver(std::size_t length);
+
+		void mark_closed();
+
 		void do_connect(tcp::resolver::iterator endpoint_iterator);
 
 		void do_read();
 
 		//reads body of sent message, pushes to queue of actions to handle
-		void do_read_line();
+		void do_read_line(std::size_t length);
 
 		void write(const std::string msg);
 
@@ -0,0 +1,85 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef NETWORKLOADTEST_H
+#define NETWORKLOADTEST_H
+#include "GameServer.h"
+#include "LockstepScheduler.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class CNetworkLoadTest{
+    public:
+        using SOptions = struct NETWORKLOADTESTOPTIONS_TAG{
+            bool DEnabled = false;
+            int DClients = 8;
+            int DPlayers = 2;
+            int DCycles = 500;
+            int DTick = 10;
+            int DDelay = DEFAULT_LOCKSTEP_INPUT_DELAY;
+            int DChatPercent = 5;
+            int DTimeout = 30;
+            std::string DRecordPath;
+        };
+
+    protected:
+        using SMatch = struct MATCH_TAG{
+            std::mutex DMutex;
+            std::condition_variable DCondition;
+            bool DFailed = false;
+            int DJoined = 0;
+            int DReady = 0;
+            int DFinished = 0;
+            std::map< int64_t, double > DSendTimes;
+            std::map< int64_t, double > DChatTimes;
+        };
+
+        SOptions DOptions;
+        int DPort;
+        std::vector< std::unique_ptr< SMatch > > DMatches;
+        std::mutex DResultMutex;
+        std::vector< double > DCommandLatencies;
+        std::vector< double > DChatLatencies;
+        int DFailures;
+        int DStalls;
+        int DStalledFrames;
+        double DMaxStall;
+        size_t DPeakClientQueue;
+        double DClientQueueTotal;
+        int DClientQueueSamples;
+
+        static double Now();
+        static int64_t SendKey(int player, int cycle);
+        bool WaitFor(SMatch &match, std::function< bool() > condition);
+        bool RunClient(int matchIndex, int slot);
+        double Latency(SMatch &match, int64_t key, bool chat);
+        static void PrintLatencies(const char *name, std::vector< double > &latencies);
+
+    public:
+        CNetworkLoadTest(const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
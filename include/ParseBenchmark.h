@@ -0,0 +1,57 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef PARSEBENCHMARK_H
+#define PARSEBENCHMARK_H
+#include "DataContainer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class CParseBenchmark{
+    public:
+        using SOptions = struct PARSEBENCHMARKOPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DDataPath;
+            int DPasses = 20;
+            int DBlockSize = 0;
+        };
+
+    protected:
+        using SPassResult = struct PASSRESULT_TAG{
+            double DSeconds = 0.0;
+            size_t DLines = 0;
+            size_t DTokens = 0;
+            size_t DBlockReads = 0;
+            uint64_t DChecksum = 0;
+        };
+
+        SOptions DOptions;
+        std::shared_ptr< CDataContainer > DDataContainer;
+        std::vector< std::string > DFiles;
+
+        void FindDescriptors(const std::string &directory);
+        SPassResult ParseAll(size_t blocksize);
+
+    public:
+        CParseBenchmark(const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
@@ -30,6 +30,21 @@ class CPlayerAsset;
 class CPlayerAssetType;
 class CPlayerData;
 
+typedef struct{
+    std::string DType = "NULL";
+    int DActor = -1;
+    int DPlayerColor = -1;
+    int DTarget = -1;
+    std::string DOriginalType;
+    std::string DUpgradingType;
+    std::string DUpgradeName;
+    int DCurrentStep = 0;
+    int DTotalSteps = 0;
+    int DLumber = 0;
+    int DGold = 0;
+    int DStone = 0;
+} SSavedCapability, *SSavedCapabilityRef;
+
 class CActivatedPlayerCapability{
     protected:
         std::shared_ptr< CPlayerAsset > DActor;
@@ -44,6 +59,7 @@ class CActivatedPlayerCapability{
         virtual void Cancel() = 0;
         virtual void Step(int step) = 0;
         virtual void Save(std::ofstream& save) = 0;
+        virtual void Save(SSavedCapability &save) = 0;
 };
 
 class CPlayerCapability{
@@ -357,10 +373,12 @@ class CPlayerAssetType{
         static int MaxSight();
         static bool LoadTypes(std::shared_ptr< CDataContainer > container);
         static bool Load(std::shared_ptr< CDataSource > source);
+        static bool Load(std::shared_ptr< CDataSource > source, std::string &name);
         static std::shared_ptr< CPlayerAssetType > FindDefaultFromName(const std::string &name);
         static std::shared_ptr< CPlayerAssetType > FindDefaultFromType(EAssetType type);
         static std::shared_ptr< std::unordered_map< std::string, std::shared_ptr< CPlayerAssetType > > > DuplicateRegistry(EPlayerColor color);
 
+        void UpdateStats(std::shared_ptr< CPlayerAssetType > asset);
         std::shared_ptr< CPlayerAsset > Construct();
 };
 
@@ -371,6 +389,17 @@ typedef struct{
     std::shared_ptr< CActivatedPlayerCapability > DActivatedCapability;
 } SAssetCommand, *SAssetCommandRef;
 
+typedef struct{
+    int DPlayerColor = 0;
+    EAssetAction DAction = EAssetAction::None;
+    EAssetCapabilityType DCapability = EAssetCapabilityType::None;
+    bool DHasTarget = false;
+    int DTargetID = -1;
+    int DTargetX = 0;
+    int DTargetY = 0;
+    SSavedCapability DActivatedCapability;
+} SSavedAssetCommand, *SSavedAssetCommandRef;
+
 class CPlayerAsset{
     protected:
         int DAssetID;
@@ -409,6 +438,10 @@ class CPlayerAsset{
             return DPeasants.size();
         }
 
+        const std::vector< int > &Peasants() const{
+            return DPeasants;
+        };
+
         std::vector< SAssetCommand > GetCommands(){
             return DCommands;
         }
@@ -833,7 +866,9 @@ class CPlayerAsset{
 
         void SavePeasants(std::ofstream& save) const;
         void SaveCommands(std::ofstream& save, EPlayerColor PlayerColor) const;
+        void SaveCommands(std::vector< SSavedAssetCommand > &save, EPlayerColor PlayerColor) const;
         void LoadCommands(std::shared_ptr< CDataSource > source, std::array< std::shared_ptr< CPlayerData >, to_underlying(EPlayerColor::Max)> DPlayers);
+        void LoadCommands(const std::vector< SSavedAssetCommand > &commands, std::array< std::shared_ptr< CPlayerData >, to_underlying(EPlayerColor::Max)> DPlayers);
 
 };
 
@@ -40,6 +40,15 @@ class CRandomNumberGenerator{
             }
         };
         
+        uint64_t State() const{
+            return ((uint64_t)DRandomSeedHigh << 32) | DRandomSeedLow;
+        };
+
+        void State(uint64_t state){
+            DRandomSeedHigh = state >> 32;
+            DRandomSeedLow = state;
+        };
+
         uint32_t Random(){
             DRandomSeedHigh = 36969 * (DRandomSeedHigh & 65535) + (DRandomSeedHigh >> 16);
             DRandomSeedLow = 18000 * (DRandomSeedLow & 65535) + (DRandomSeedLow >> 16);
@@ -18,6 +18,7 @@
 #define RESOURCERENDERER_H
 #include "FontTileset.h"
 #include "GameModel.h"
+#include "RetainedPanel.h"
 #include <vector>
 
 class CResourceRenderer{
@@ -33,6 +34,9 @@ class CResourceRenderer{
         int DLastGoldDisplay;
         int DLastLumberDisplay;
         int DLastStoneDisplay;
+        CRetainedPanel DPanel;
+        
+        void DrawPanel(std::shared_ptr< CGraphicSurface > surface);
         
     public:        
         CResourceRenderer(std::shared_ptr< CGraphicTileset > icons, std::shared_ptr< CFontTileset > font, std::shared_ptr< CPlayerData > player);
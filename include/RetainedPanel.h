@@ -0,0 +1,48 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef RETAINEDPANEL_H
+#define RETAINEDPANEL_H
+#include "GraphicSurface.h"
+#include <memory>
+#include <vector>
+
+class CRetainedPanel{
+    protected:
+        std::shared_ptr< CGraphicSurface > DSurface;
+        std::vector< int > DKey;
+        bool DValid;
+        unsigned int DGeneration;
+        static unsigned int DCurrentGeneration;
+        
+    public:
+        CRetainedPanel();
+        
+        std::shared_ptr< CGraphicSurface > Surface() const{
+            return DSurface;
+        };
+        
+        bool Valid() const{
+            return DValid;
+        };
+        
+        bool Update(int width, int height, const std::vector< int > &key);
+        void Invalidate();
+        static void InvalidateAll();
+        void Draw(std::shared_ptr< CGraphicSurface > surface, int xpos, int ypos);
+};
+
+#endif
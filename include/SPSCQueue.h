@@ -0,0 +1,104 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+template < typename T, size_t N > class CSPSCQueue{
+    protected:
+        std::array< T, N > DBuffer;
+        std::atomic< size_t > DHead;
+        char DHeadPadding[64 - sizeof(std::atomic< size_t >)];
+        std::atomic< size_t > DTail;
+        char DTailPadding[64 - sizeof(std::atomic< size_t >)];
+        
+    public:
+        CSPSCQueue() : DHead(0), DTail(0){};
+        CSPSCQueue(const CSPSCQueue &) = delete;
+        const CSPSCQueue &operator =(const CSPSCQueue &) = delete;
+        
+        size_t Capacity() const{
+            return N - 1;
+        };
+        
+        size_t Size() const{
+            return (DTail.load(std::memory_order_acquire) + N - DHead.load(std::memory_order_acquire)) % N;
+        };
+        
+        bool Empty() const{
+            return DHead.load(std::memory_order_acquire) == DTail.load(std::memory_order_acquire);
+        };
+        
+        bool Push(const T &item){
+            size_t Tail = DTail.load(std::memory_order_relaxed);
+            size_t Next = (Tail + 1) % N;
+            
+            if(Next == DHead.load(std::memory_order_acquire)){
+                return false;
+            }
+            DBuffer[Tail] = item;
+            DTail.store(Next, std::memory_order_release);
+            return true;
+        };
+        
+        T *BeginPush(){
+            size_t Tail = DTail.load(std::memory_order_relaxed);
+            
+            if((Tail + 1) % N == DHead.load(std::memory_order_acquire)){
+                return nullptr;
+            }
+            return &DBuffer[Tail];
+        };
+        
+        void EndPush(){
+            DTail.store((DTail.load(std::memory_order_relaxed) + 1) % N, std::memory_order_release);
+        };
+        
+        bool Pop(T &item){
+            size_t Head = DHead.load(std::memory_order_relaxed);
+            
+            if(Head == DTail.load(std::memory_order_acquire)){
+                return false;
+            }
+            item = DBuffer[Head];
+            DHead.store((Head + 1) % N, std::memory_order_release);
+            return true;
+        };
+        
+        T *Front(){
+            size_t Head = DHead.load(std::memory_order_relaxed);
+            
+            if(Head == DTail.load(std::memory_order_acquire)){
+                return nullptr;
+            }
+            return &DBuffer[Head];
+        };
+        
+        bool Pop(){
+            size_t Head = DHead.load(std::memory_order_relaxed);
+            
+            if(Head == DTail.load(std::memory_order_acquire)){
+                return false;
+            }
+            DHead.store((Head + 1) % N, std::memory_order_release);
+            return true;
+        };
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef SAVEDGAME_H
+#define SAVEDGAME_H
+#include "DataSource.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define SAVED_GAME_FILENAME         "SavedGame.sav"
+#define SAVED_GAME_TEXT_FILENAME    "SavedGame.txt"
+#define SAVED_GAME_MAGIC            "ECSSAVE\x1A"
+#define SAVED_GAME_MAGIC_SIZE       8
+#define SAVED_GAME_VERSION          1
+
+class CApplicationData;
+
+class CSavedGame{
+    public:
+        static void SaveText(std::shared_ptr< CApplicationData > context, std::ofstream &save);
+        static std::string SaveText(std::shared_ptr< CApplicationData > context);
+        static std::string SaveBinary(std::shared_ptr< CApplicationData > context);
+        static bool Write(const std::string &data, const std::string &filename, bool sync = false);
+        static std::string NewestFile(const std::vector< std::string > &filenames);
+
+        static bool IsBinary(const std::string &data);
+        static bool Load(std::shared_ptr< CApplicationData > context, std::shared_ptr< CDataSource > source);
+        static bool LoadBinary(std::shared_ptr< CApplicationData > context, const std::string &data);
+};
+
+#endif
@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef SCRIPTCACHE_H
+#define SCRIPTCACHE_H
+#include <string>
+#include <unordered_map>
+
+struct lua_State;
+
+class CScriptCache{
+    protected:
+        static std::unordered_map< std::string, std::string > DChunks;
+        static int DCompileCount;
+
+        static std::string Key(const std::string &filename);
+        static int Compile(lua_State *L, const std::string &filename, std::string &chunk);
+        static int Searcher(lua_State *L);
+
+    public:
+        static lua_State *NewState();
+        static int Load(lua_State *L, const std::string &filename);
+        static int DoFile(lua_State *L, const std::string &filename);
+        static void InstallSearcher(lua_State *L);
+        static bool Reload(const std::string &filename);
+        static void Clear();
+
+        static int CompileCount(){
+            return DCompileCount;
+        };
+        static int ChunkCount(){
+            return DChunks.size();
+        };
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include "DataSource.h"
+#include "DataSink.h"
 
 class CSoundClip{
     protected:
@@ -36,6 +37,8 @@ class CSoundClip{
         
         static CLibraryInitializer &LibraryReference();
         
+        friend class CSoundStream;
+        
     public:
         CSoundClip();
         CSoundClip(const CSoundClip &clip);
@@ -56,10 +59,14 @@ class CSoundClip{
         };
         
         bool Load(std::shared_ptr< CDataSource > source, bool ismp3 = false);
+        bool LoadCache(std::shared_ptr< CDataSource > source, time_t modified);
+        bool StoreCache(std::shared_ptr< CDataSink > sink, time_t modified) const;
             
         void CopyStereoClip(float *data, int offset, int frames);
         void MixStereoClip(float *data, int offset, int frames, float volume = 1.0, float rightbias = 0.0, bool loop = false);
         
+        static void MixStereoBlock(float *data, const float *source, int frames, float leftgain, float rightgain);
+        
             
 };
 
@@ -47,6 +47,7 @@ class CSoundEventRenderer{
         std::vector< std::vector< int > > DMeleeHitIndices;
         
         static float RightBias(const SRectangle &viewportrect, const CPosition &position);
+        static float Distance(const SRectangle &viewportrect, const CPosition &position);
         static bool OnScreen(const SRectangle &viewportrect, const CPosition &position);
         
     public:
@@ -18,18 +18,31 @@
 #define SOUNDLIBRARYMIXER_H
 
 #include "SoundClip.h"
+#include "SoundStream.h"
 #include "DataSource.h"
+#include "DataSink.h"
+#include "SPSCQueue.h"
 #include <portaudio.h>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <list>
-#include <mutex>
+#include <atomic>
 
 using TSoundLibraryLoadingCalldata = void *;
 using TSoundLibraryLoadingCallback = void (*)(TSoundLibraryLoadingCalldata);
 
+#define MIXER_COMMAND_QUEUE_SIZE    256
+#define MIXER_COMPLETION_QUEUE_SIZE 512
+
+enum class ESoundPriority{
+    Ambient = 0,
+    Combat,
+    Voice,
+    Interface
+};
+
 class CSoundLibraryMixer{
     protected:
         typedef struct{
@@ -38,6 +51,8 @@ class CSoundLibraryMixer{
             int DOffset;
             float DVolume;
             float DRightBias;
+            ESoundPriority DPriority;
+            float DDistance;
         } SClipStatus, *SClipStatusRef;
         
         typedef struct{
@@ -51,27 +66,74 @@ class CSoundLibraryMixer{
             float DRightShift;
         } SToneStatus, *SToneStatusRef;
         
+        enum class EMixerCommandType{
+            PlayClip = 0,
+            PlayTone,
+            StopTone,
+            PlaySong,
+            StopSong,
+            SongVolume,
+            VoiceLimit
+        };
+        
+        typedef struct{
+            EMixerCommandType DType;
+            SClipStatus DClip;
+            SToneStatus DTone;
+            CSoundStream *DStream;
+        } SMixerCommand, *SMixerCommandRef;
+        
         std::shared_ptr< CDataContainer > DSoundDataContainer;
+        std::shared_ptr< CDataContainer > DPCMCache;
         std::vector< CSoundClip > DSoundClips;
         std::map< std::string, int > DMapping;
-        std::list< SClipStatus > DClipsInProgress;
-        std::list< SToneStatus > DTonesInProgress;
+        std::vector< SClipStatus > DClipVoices;
+        std::vector< SToneStatus > DToneVoices;
+        int DActiveClipVoices;
+        int DActiveToneVoices;
+        int DClipVoiceLimit;
+        int DRequestedClipVoiceLimit;
+        CSPSCQueue< SMixerCommand, MIXER_COMMAND_QUEUE_SIZE > DCommandQueue;
+        CSPSCQueue< int, MIXER_COMPLETION_QUEUE_SIZE > DCompletedClipQueue;
+        CSPSCQueue< int, MIXER_COMPLETION_QUEUE_SIZE > DCompletedToneQueue;
+        std::vector< int > DUnreportedClipIDs;
+        std::vector< int > DUnreportedToneIDs;
         std::list< int > DFreeClipIDs;
         std::list< int > DFreeToneIDs;
         std::vector< std::string > DMusicFilenames;
-        std::vector< CSoundClip > DMusicClips;
         std::map< std::string, int > DMusicMapping;
         SClipStatus DMusicStatus;
+        std::shared_ptr< CSoundStream > DMusicStream;
+        std::list< std::pair< int, std::shared_ptr< CSoundStream > > > DRetiredMusicStreams;
+        CSoundStream *DPlayingMusicStream;
+        int DMusicCommandsSent;
+        std::atomic< int > DMusicCommandsApplied;
         PaStream *DStream;
         bool DPortAudioInitialized;
-        std::mutex DMutex;
+        bool DOffline;
+        bool DCapturing;
+        std::vector< float > DCapture;
         std::vector< float > DSineWave;
         int DSampleRate;
         int DNextClipID;
         int DNextToneID;
         
+        bool SendCommand(const SMixerCommand &command);
+        void CollectCompleted();
+        bool SendMusicCommand(SMixerCommand &command, std::shared_ptr< CSoundStream > stream);
+        void CompleteClip(int identification);
+        void CompleteTone(int identification);
+        void ReportCompleted();
+        void ProcessCommands();
+        void StartClipVoice(const SClipStatus &clip);
+        bool MixTone(SToneStatus &tone, float *data, int frames);
+        static bool WeakerVoice(const SClipStatus &first, const SClipStatus &second);
+        bool OpenDevice();
+        bool LoadClip(int index, const std::string &path);
+        bool LoadClips(const std::vector< std::string > &paths, TSoundLibraryLoadingCallback callback, TSoundLibraryLoadingCalldata calldata);
+        
     public:
-        CSoundLibraryMixer(bool NO_AUDIOMIX);
+        CSoundLibraryMixer(bool NO_AUDIOMIX, bool offline = false);
         ~CSoundLibraryMixer();
         
         int ClipCount() const{
@@ -82,6 +144,24 @@ class CSoundLibraryMixer{
             return DSampleRate;  
         };
         
+        bool Offline() const{
+            return DOffline;
+        };
+        
+        int ActiveClipVoices() const{
+            return DActiveClipVoices;
+        };
+        
+        int ActiveToneVoices() const{
+            return DActiveToneVoices;
+        };
+        
+        int CapturedFrames() const{
+            return DCapture.size() / 2;
+        };
+        
+        static int FramesPerBuffer();
+        
         int FindClip(const std::string &clipname) const;
         int FindSong(const std::string &songname) const;
         int ClipDurationMS(int index);
@@ -89,15 +169,29 @@ class CSoundLibraryMixer{
         static int TimestepCallback(const void *in, void *out, unsigned long frames, const PaStreamCallbackTimeInfo* timeinfo, PaStreamCallbackFlags status, void *data);
         int Timestep(void *out, unsigned long frames, const PaStreamCallbackTimeInfo* timeinfo, PaStreamCallbackFlags status);
         
+        void PCMCache(std::shared_ptr< CDataContainer > cache){
+            DPCMCache = cache;
+        };
+        
         bool LoadLibrary(std::shared_ptr< CDataSource > source, TSoundLibraryLoadingCallback callback, TSoundLibraryLoadingCalldata calldata);
         
-        int PlayClip(int index, float volume, float rightbias);
+        int MaxClipVoices() const{
+            return DRequestedClipVoiceLimit;
+        };
+        int MaxClipVoices(int limit);
+        
+        int PlayClip(int index, float volume, float rightbias, ESoundPriority priority = ESoundPriority::Interface, float distance = 0.0);
         int PlayTone(float freq, float freqdecay, float volume, float volumedecay, float rightbias, float rightshift);
         void StopTone(int id);
         bool ClipCompleted(int id);
         void PlaySong(int index, float volume);
         void StopSong();
         void SongVolume(float volume);
+        
+        void SyncOffline(int frames);
+        void RenderOffline(float *data, int frames);
+        void CaptureOffline(bool capture);
+        bool WriteCapture(std::shared_ptr< CDataSink > sink) const;
 };
 
 #endif
@@ -0,0 +1,93 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef SOUNDSTREAM_H
+#define SOUNDSTREAM_H
+
+#include "DataContainer.h"
+#include "DataSource.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define DEFAULT_STREAM_BUFFER_FRAMES    32768
+#define STREAM_READ_CHUNK_SIZE          16384
+
+struct mpg123_handle_struct;
+
+class CSoundStream{
+    protected:
+        std::shared_ptr< CDataContainer > DContainer;
+        std::string DFilename;
+        std::shared_ptr< CDataSource > DSource;
+        struct mpg123_handle_struct *DDecoder;
+        int DFramesSinceOpen;
+        int DSourceChannels;
+        int DSampleRate;
+        bool DLoop;
+        std::vector< float > DRing;
+        std::vector< unsigned char > DReadBuffer;
+        std::vector< float > DDecodeBuffer;
+        std::atomic< size_t > DReadIndex;
+        std::atomic< size_t > DWriteIndex;
+        std::atomic< bool > DRunning;
+        std::atomic< bool > DFinished;
+        std::atomic< int > DUnderruns;
+        std::thread DThread;
+        std::mutex DWakeMutex;
+        std::condition_variable DWakeCondition;
+        
+        bool OpenDecoder();
+        void CloseDecoder();
+        bool FeedDecoder();
+        int DecodeFrames(float *data, int frames);
+        int FillRing(int frames);
+        void DecodeThread();
+        
+    public:
+        CSoundStream(int bufferframes = DEFAULT_STREAM_BUFFER_FRAMES);
+        CSoundStream(const CSoundStream &stream) = delete;
+        ~CSoundStream();
+        
+        CSoundStream &operator=(const CSoundStream &stream) = delete;
+        
+        int SampleRate() const{
+            return DSampleRate;  
+        };
+        
+        int BufferedFrames() const{
+            return (DWriteIndex.load() - DReadIndex.load()) / 2;
+        };
+        
+        int Underruns() const{
+            return DUnderruns.load();
+        };
+        
+        bool Finished() const{
+            return DFinished.load() && (DWriteIndex.load() == DReadIndex.load());
+        };
+        
+        bool Open(std::shared_ptr< CDataContainer > container, const std::string &filename, bool loop = true);
+        void Close();
+        
+        int MixStereoStream(float *data, int frames, float volume = 1.0, float rightbias = 0.0);
+};
+
+#endif
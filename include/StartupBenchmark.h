@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef STARTUPBENCHMARK_H
+#define STARTUPBENCHMARK_H
+#include "ApplicationData.h"
+#include <string>
+#include <vector>
+
+class CStartupBenchmark{
+    public:
+        using SOptions = struct STARTUPBENCHMARKOPTIONS_TAG{
+            bool DEnabled = false;
+            std::string DDataPath;
+            int DRuns = 5;
+            int DThreads = -1;
+        };
+
+    protected:
+        std::shared_ptr< CApplicationData > DContext;
+        SOptions DOptions;
+        std::shared_ptr< CDataContainer > DDataContainer;
+        std::shared_ptr< CDataContainer > DImageDirectory;
+
+        double LoadAssets(int threads, double &waittime);
+        static void PrintTimes(const char *name, std::vector< double > &times, double waittime);
+
+    public:
+        CStartupBenchmark(std::shared_ptr< CApplicationData > context, const SOptions &options);
+
+        static bool ParseArguments(int argc, char *argv[], SOptions &options);
+        static void PrintUsage(const char *program);
+        int Run();
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class CStartupTrace{
+    protected:
+        using SEvent = struct EVENT_TAG{
+            std::string DName;
+            int DThread;
+            int DDepth;
+            double DStart;
+            double DDuration;
+            uint64_t DBytes;
+            int DFiles;
+        };
+
+        using SThreadSummary = struct THREADSUMMARY_TAG{
+            int DSteps = 0;
+            double DBusy = 0.0;
+            uint64_t DBytes = 0;
+            int DFiles = 0;
+        };
+
+        static std::atomic< bool > DEnabled;
+        static std::atomic< bool > DRecording;
+        static std::string DFileName;
+        static std::chrono::steady_clock::time_point DStartTime;
+        static std::mutex DMutex;
+        static std::vector< SEvent > DEvents;
+
+        std::string DName;
+        std::chrono::steady_clock::time_point DStart;
+        uint64_t DStartBytes;
+        int DStartFiles;
+        int DDepth;
+        bool DRunning;
+
+        static int ThreadIndex();
+        static double Milliseconds(std::chrono::steady_clock::time_point time);
+        static std::string Escape(const std::string &str);
+
+    public:
+        CStartupTrace(const std::string &name);
+        ~CStartupTrace();
+
+        void End();
+        void Next(const std::string &name);
+
+        static bool Enabled(){
+            return DEnabled;
+        };
+        static void Enable(const std::string &filename);
+        static void Stop();
+        static void CountFile();
+        static void CountBytes(size_t bytes);
+        static bool Write(const std::string &filename);
+        static void PrintSummary();
+        static void Finish();
+};
+
+#endif
@@ -42,6 +42,7 @@
 #include "AIPlayer.h"
 #include "Debug.h"
 #include "ApplicationData.h"
+#include "ScriptCache.h"
 #include <cmath>
 
 //NN: Lua includes
@@ -1514,14 +1515,15 @@ void CAIPlayer::CalculateCommand(SPlayerCommandRequest &command){
 
         ClearAssignments();
         //Create a lua state unique to object
-        lua_State *AIL = luaL_newstate();
+        lua_State *AIL = CScriptCache::NewState();
         luaL_openlibs(AIL);
+        CScriptCache::InstallSearcher(AIL);
         //Register functions
         RegisterFunctions(AIL);
-        //Load the brain
+        //Load the brain, compiled once and reused from the script cache
         //luaL_dofile(AIL, DLuaFile);
 //        luaL_dofile(AIL, "./scripts/easy.lua");
-        luaL_dofile(AIL, DLuaFile);
+        CScriptCache::DoFile(AIL, DLuaFile);
         //Set AI Pointer
         lua_pushlightuserdata(AIL, this);
         lua_setglobal(AIL, "AIPointer");
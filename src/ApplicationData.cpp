@@ -39,8 +39,22 @@
 #include "ApplicationData.h"
 #include "ApplicationPath.h"
 #include "AssetLoader.h"
+#include "AssetWatcher.h"
+#include "AutoSave.h"
+#include "CommandBenchmark.h"
 #include "CommentSkipLineDataSource.h"
 #include "FileDataContainer.h"
+#include "GameServer.h"
+#include "HeadlessRenderer.h"
+#include "LockstepBenchmark.h"
+#include "LockstepScheduler.h"
+#include "MixerBenchmark.h"
+#include "NetworkLoadTest.h"
+#include "ParseBenchmark.h"
+#include "StartupBenchmark.h"
+#include "StartupTrace.h"
+#include "AssetPacker.h"
+#include "AssetArchive.h"
 #include "MemoryDataSource.h"
 #include "MainMenuMode.h"
 #include "PixelType.h"
@@ -51,8 +65,10 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <cstdlib>
 #include <map>
 #include <iostream>
+#include <sys/stat.h>
 
 extern "C" {
     #include "lua.h"
@@ -94,6 +110,17 @@ CApplicationData::CApplicationData(const std::string &appname, const SPrivateApp
     DPlayerColor = EPlayerColor::Red;
     DMiniMapViewportColor = 0xFFFFFF;
     DDeleted = false;
+    DHeadless = false;
+    DHeadlessSound = false;
+    DHeadlessWidth = INITIAL_MAP_WIDTH;
+    DHeadlessHeight = INITIAL_MAP_HEIGHT;
+    DLoaderThreads = -1;
+    DLockstepTextCommands = false;
+    DLockstepInputDelay = DEFAULT_LOCKSTEP_INPUT_DELAY;
+    DAutoSaveInterval = DEFAULT_AUTO_SAVE_INTERVAL;
+    DHotReload = false;
+    DServerAddress = "104.236.151.124";
+    DServerPort = std::to_string(DEFAULT_GAME_SERVER_PORT);
 
     DMapConfirmed = false;
 
@@ -379,18 +406,16 @@ bool CApplicationData::DrawingAreaMotionNotifyEventCallback(std::shared_ptr<CGUI
 */
 
 void CApplicationData::Activate(){
+    CStartupTrace Trace("Activate");
+    CStartupTrace Step("Window");
     // Sets up the environment (i.e application path and directory/filesystem so the
     // game can find files it needs.
     CPath AppPath = GetApplicationPath().Containing();
-    std::shared_ptr< CDataContainer > TempDataContainer = std::make_shared< CDirectoryDataContainer >(AppPath.ToString() + "/data");
+    std::shared_ptr< CDataContainer > TempDataContainer = CAssetArchiveDataContainer::OpenDataDirectory(AppPath.ToString() + "/data");
     std::shared_ptr< CDataContainer > ImageDirectory = TempDataContainer->DataContainer("img");
     std::shared_ptr< CDataContainerIterator > FileIterator;
     std::shared_ptr< CDataSource > TempDataSource;
 
-    // Instantiate AssetLoader with environment variables to load assets
-    std::shared_ptr< CApplicationData > AppData = shared_from_this();
-    CAssetLoader AssetLoader(AppData, TempDataContainer, ImageDirectory);
-
     // Create a new main window
     DMainWindow = DApplication->NewWindow();
 
@@ -464,12 +489,64 @@ void CApplicationData::Activate(){
     DefaultDisplay->Flush();
     DApplication->ProcessEvents(true);
     DefaultDisplay->Flush();
+    Step.End();
+
+    if(!LoadGameData(TempDataContainer, ImageDirectory)){
+        return;
+    }
+    if(DHotReload){
+        DAssetWatcher = std::make_shared< CAssetWatcher >(AppPath.ToString() + "/data", ASSET_WATCHER_SCRIPT_PATH);
+    }
+
+    PrintDebug(DEBUG_LOW, "Changing Mode to MainMenu\n");
+    DDoubleBufferSurface->Draw(DWorkingBufferSurface, 0, 0, -1, -1, 0, 0);
+    DDrawingArea->Invalidate();
+
+    // Set up game timer (how often to update 12/3/17
+    DApplicationMode = DNextApplicationMode = CMainMenuMode::Instance();
+
+    DApplication->SetTimer(TIMEOUT_INTERVAL, this, TimeoutCallback);
+
+    // Play background music
+    DSoundLibraryMixer->StopSong();
+    DSoundLibraryMixer->PlaySong(DSoundLibraryMixer->FindSong("menu"), DMusicVolume);
+    DLoadingResourceContext = nullptr;
+
+    // Start up ends here, the time spent in the menus is not part of it
+    Trace.End();
+    CStartupTrace::Stop();
+}
+
+/**
+* Loads everything the game needs that does not depend on the main window:
+* cursors, sounds, tilesets (through CAssetLoader), asset types, upgrades,
+* options and maps. Advances the splash screen as each step completes, and
+* times each step for the start up trace. Used by Activate and by the
+* headless renderer.
+*
+* @param[in] datacontainer The data directory of the game.
+* @param[in] imagedirectory The img directory within the data directory.
+*
+* @return True if everything loaded.
+*
+*/
+
+bool CApplicationData::LoadGameData(std::shared_ptr< CDataContainer > datacontainer, std::shared_ptr< CDataContainer > imagedirectory){
+    std::shared_ptr< CDataContainer > TempDataContainer = datacontainer;
+    std::shared_ptr< CDataContainer > ImageDirectory = imagedirectory;
+    std::shared_ptr< CDataSource > TempDataSource;
+    CStartupTrace Trace("LoadGameData");
+    CStartupTrace Step("Cursors");
+
+    // Instantiate AssetLoader with environment variables to load assets
+    std::shared_ptr< CApplicationData > AppData = shared_from_this();
+    CAssetLoader AssetLoader(AppData, TempDataContainer, ImageDirectory);
 
     TempDataSource = ImageDirectory->DataSource("Cursors.dat");
     DCursorSet = std::make_shared< CCursorSet >();
     if(!DCursorSet->LoadCursors(TempDataSource)){
         PrintError("Failed to load cursors.\n");
-        return;
+        return false;
     }
     DCursorIndices[ctPointer] = DCursorSet->FindCursor("pointer");
     DCursorIndices[ctInspect] = DCursorSet->FindCursor("magnifier");
@@ -482,45 +559,56 @@ void CApplicationData::Activate(){
 
     RenderSplashStep();
 
-    // Set up the audio sources/sound library.
+    // Set up the audio sources/sound library, headless it is only loaded for
+    // the start up benchmark and renders offline.
+    Step.Next("SoundLibrary");
     TempDataSource = TempDataContainer->DataSource("./snd/SoundClips.dat");
-    DSoundLibraryMixer = std::make_shared< CSoundLibraryMixer >(DISABLE_SOUNDLIBMIXER);
-    if(!DISABLE_SOUNDLIBMIXER && !DSoundLibraryMixer->LoadLibrary(TempDataSource, SoundLoadingCallback, this)){
+    DSoundLibraryMixer = std::make_shared< CSoundLibraryMixer >(DISABLE_SOUNDLIBMIXER || (DHeadless && !DHeadlessSound), DHeadless);
+    if(!DSoundCachePath.empty()){
+        mkdir(DSoundCachePath.c_str(), S_IRWXU);
+        DSoundLibraryMixer->PCMCache(std::make_shared< CDirectoryDataContainer >(DSoundCachePath));
+    }
+    if(!DISABLE_SOUNDLIBMIXER && (!DHeadless || DHeadlessSound) && !DSoundLibraryMixer->LoadLibrary(TempDataSource, SoundLoadingCallback, this)){
         PrintError("Failed to sound mixer.\n");
-        return;
+        return false;
     }
     RenderSplashStep();
     DSoundLibraryMixer->PlaySong(DSoundLibraryMixer->FindSong("load"), DMusicVolume);
 
     // Load the images and color them for various objects (buttons, markers, etc.)
+    Step.Next("ButtonColors");
     TempDataSource = ImageDirectory->DataSource("ButtonColors.dat");
     DButtonRecolorMap = std::make_shared< CGraphicRecolorMap >();
     if(!DButtonRecolorMap->Load(TempDataSource)){
         PrintError("Failed to load button colors.\n");
-        return;
+        return false;
     }
 
     RenderSplashStep();
+    Step.Next("Marker");
     TempDataSource = ImageDirectory->DataSource("Marker.dat");
     DMarkerTileset = std::make_shared< CGraphicTileset >();
     if(!DMarkerTileset->LoadTileset(TempDataSource)){
         PrintError("Failed to load markers.\n");
-        return;
+        return false;
     }
     DMarkerTileset->CreateClippingMasks();
 
     // Load the tilesets
     RenderSplashStep();
+    Step.Next("Texture");
     TempDataSource = ImageDirectory->DataSource("Texture.dat");
     DBackgroundTileset = std::make_shared< CGraphicTileset >();
     if(!DBackgroundTileset->LoadTileset(TempDataSource)){
         PrintError("Failed to load background tileset.\n");
-        return;
+        return false;
     }
 
     // Helper class function to load all the game assets
+    Step.Next("AssetLoader");
     AssetLoader.LoadAllAssets();
     RenderSplashStep();
+    Step.Next("ClippingMasks");
     for(auto AssetTileset : DAssetTilesets){
         if(AssetTileset != nullptr){
             AssetTileset->CreateClippingMasks();
@@ -529,39 +617,43 @@ void CApplicationData::Activate(){
     // Load tree growing pics
     PrintDebug(DEBUG_LOW, "Loading Tree Growth\n");
     RenderSplashStep();
+    Step.Next("TreeGrowth");
     TempDataSource = ImageDirectory->DataSource("TreeGrowth.dat");
     DTreeTileset = std::make_shared< CGraphicTileset >();
     if(!DTreeTileset->LoadTileset(TempDataSource)){
         PrintError("Failed to load tileset (TG).\n");
-        return;
+        return false;
     }
 
     PrintDebug(DEBUG_LOW, "Assets Loaded\n");
 
     PrintDebug(DEBUG_LOW, "Loading res directory\n");
     RenderSplashStep();
+    Step.Next("AssetTypes");
     std::shared_ptr< CDataContainer > AssetDirectory = TempDataContainer->DataContainer("res");
     if(!CPlayerAssetType::LoadTypes(AssetDirectory)){
         PrintError("Failed to load resources\n");
-        return;
+        return false;
     }
 
     PrintDebug(DEBUG_LOW, "Loading upg directory\n");
     RenderSplashStep();
+    Step.Next("Upgrades");
     std::shared_ptr< CDataContainer > UpgradeDirectory = TempDataContainer->DataContainer("upg");
     if(!CPlayerUpgrade::LoadUpgrades(UpgradeDirectory)){
         PrintError("Failed to load upgrades\n");
-        return;
+        return false;
     }
 
     PrintDebug(DEBUG_LOW, "Loading opt directory\n");
     RenderSplashStep();
+    Step.Next("Options");
     std::shared_ptr< CDataContainer > OptionsDirectory = TempDataContainer->DataContainer("opt");
 
     // load sound options
     if(!CApplicationData::LoadSoundOptions(OptionsDirectory)){
         PrintError("Failed to load Sound options\n");
-        return;
+        return false;
     }
 
     RenderSplashStep();
@@ -569,15 +661,20 @@ void CApplicationData::Activate(){
     // load network options
     if(!CApplicationData::LoadNetworkOptions(OptionsDirectory)){
         PrintError("Failed to load Network options\n");
-        return;
+        return false;
     }
 
     PrintDebug(DEBUG_LOW, "Loading Maps\n");
     RenderSplashStep();
+    Step.Next("Maps");
     std::shared_ptr< CDataContainer > MapDirectory = TempDataContainer->DataContainer("map");
+    if(!DMapCachePath.empty()){
+        mkdir(DMapCachePath.c_str(), S_IRWXU);
+        CAssetDecoratedMap::MapCache(std::make_shared< CDirectoryDataContainer >(DMapCachePath));
+    }
     if(!CAssetDecoratedMap::LoadMaps(MapDirectory)){
         PrintError("Failed to load maps\n");
-        return;
+        return false;
     }
 
     // Set update 12/3/17
@@ -585,6 +682,7 @@ void CApplicationData::Activate(){
     CAssetRenderer::UpdateFrequency(TIMEOUT_FREQUENCY);
 
     PrintDebug(DEBUG_LOW, "Loading Game Map 0\n");
+    Step.Next("GameMap0");
 
     std::shared_ptr< CDataSource > source = std::make_shared< CFileDataSource > ("");
     LoadGameMap(0, source);
@@ -592,36 +690,29 @@ void CApplicationData::Activate(){
     PrintDebug(DEBUG_LOW, "Game Map 0 Loaded\n");
 
     // Set up button, map, and options renderer
+    Step.Next("Renderers");
     DButtonRenderer = std::make_shared< CButtonRenderer > (DButtonRecolorMap, DInnerBevel, DOuterBevel, DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)]);
     DMapSelectListViewRenderer = std::make_shared< CListViewRenderer > (DListViewIconTileset, DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)]);
     DOptionsEditRenderer = std::make_shared< CEditRenderer > (DButtonRecolorMap, DInnerBevel, DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)]);
 
-    PrintDebug(DEBUG_LOW, "Changing Mode to MainMenu\n");
-    DDoubleBufferSurface->Draw(DWorkingBufferSurface, 0, 0, -1, -1, 0, 0);
-    DDrawingArea->Invalidate();
-
-    // Set up game timer (how often to update 12/3/17
-    DApplicationMode = DNextApplicationMode = CMainMenuMode::Instance();
-
-    DApplication->SetTimer(TIMEOUT_INTERVAL, this, TimeoutCallback);
-
-    // Play background music
-    DSoundLibraryMixer->StopSong();
-    DSoundLibraryMixer->PlaySong(DSoundLibraryMixer->FindSong("menu"), DMusicVolume);
-    DLoadingResourceContext = nullptr;
+    return true;
 }
 
 /**
 * Is called whenever the timer fires, is used to update 12/3/17
 * methods from the mode the game is currently in. Always calls the current
 * mode's Input, Calculate, and Render functions. Updates the current mode
-* with the next mode and draws the cursor.
+* with the next mode and draws the cursor. In hot reload mode the changed
+* data files are reloaded first.
 *
 * @return Nothing.
 *
 */
 
 bool CApplicationData::Timeout(){
+    if(DAssetWatcher){
+        DAssetWatcher->Poll(shared_from_this());
+    }
     DApplicationMode->Input(shared_from_this());
     DApplicationMode->Calculate(shared_from_this());
     DApplicationMode->Render(shared_from_this());
@@ -1080,6 +1171,10 @@ void CApplicationData::RenderMenuTitle(const std::string &title, int &titlebotto
 
 void CApplicationData::RenderSplashStep(){
     double RenderAlpha = (double)DCurrentLoadingStep / (double)DTotalLoadingSteps;
+    if(!DLoadingResourceContext){
+        DCurrentLoadingStep++;
+        return;
+    }
     DSplashTileset->DrawTile(DDoubleBufferSurface, 0, 0, 1);
     if(RenderAlpha > 0.0){
         DSplashTileset->DrawTile(DWorkingBufferSurface, 0, 0, 0);
@@ -1256,6 +1351,8 @@ bool CApplicationData::LoadNetworkOptions(std::shared_ptr< CDataContainer > cont
 * Loads the game map.
 *
 * @param[in] index Which map you want to load.
+* @param[in] source The saved visibility map of a loaded game, nullptr to
+*     leave it for the caller to restore.
 *
 * @return Nothing.
 *
@@ -1267,7 +1364,7 @@ void CApplicationData::LoadGameMap(int index, std::shared_ptr< CDataSource > sou
 
     DGameModel = std::make_shared< CGameModel >(index, 0x123456789ABCDEFULL, DLoadingPlayerColors);
 
-    if(DLoadedGame){
+    if(DLoadedGame && source){
         DGameModel->Player(DPlayerColor)->VisibilityMap()->LoadMap(source);
     }
 
@@ -1356,8 +1453,10 @@ void CApplicationData::LoadGameMap(int index, std::shared_ptr< CDataSource > sou
     DViewportYOffset = DBorderWidth;
 
     int MainWindowMinHeight = DUnitDescriptionYOffset + MinUnitDescrHeight + DUnitActionRenderer->MinimumHeight() + DOuterBevel->Width() * 5;
-    DMainWindow->SetMinSize(INITIAL_MAP_WIDTH, MainWindowMinHeight);
-    DMainWindow->SetMaxSize(DViewportXOffset + DetailedMapWidth + DBorderWidth, std::max(MainWindowMinHeight, DetailedMapHeight + DBorderWidth * 2));
+    if(DMainWindow){
+        DMainWindow->SetMinSize(INITIAL_MAP_WIDTH, MainWindowMinHeight);
+        DMainWindow->SetMaxSize(DViewportXOffset + DetailedMapWidth + DBorderWidth, std::max(MainWindowMinHeight, DetailedMapHeight + DBorderWidth * 2));
+    }
 
     // Resize window
     ResizeCanvases();
@@ -1400,14 +1499,18 @@ void CApplicationData::ResizeCanvases(){
     int DrawingAreaAllocationWidth, DrawingAreaAllocationHeight;
     int ViewportWidth, ViewportHeight;
     int UserDescrWidth, UserDescrHeight;
-    // Resize the canvas
-    if(!DDrawingArea){
+    // Resize the canvas, headless rendering has no drawing area and uses a fixed size
+    if(DDrawingArea){
+        DrawingAreaAllocationWidth = DDrawingArea->AllocatedWidth();
+        DrawingAreaAllocationHeight = DDrawingArea->AllocatedHeight();
+    }
+    else if(DHeadless){
+        DrawingAreaAllocationWidth = DHeadlessWidth;
+        DrawingAreaAllocationHeight = DHeadlessHeight;
+    }
+    else{
         return;
     }
-
-    // Get the new drawing dimensions
-    DrawingAreaAllocationWidth = DDrawingArea->AllocatedWidth();
-    DrawingAreaAllocationHeight = DDrawingArea->AllocatedHeight();
     PrintDebug(DEBUG_LOW, "Resizing %d x %d\n",DrawingAreaAllocationWidth, DrawingAreaAllocationHeight);
     ViewportWidth = DrawingAreaAllocationWidth - DViewportXOffset - DBorderWidth;
     ViewportHeight = DrawingAreaAllocationHeight - DViewportYOffset - DBorderWidth;
@@ -1577,7 +1680,46 @@ void CApplicationData::ResizeCanvases(){
 }
 
 /**
- * Runs the game.
+ * Removes every occurrence of a global option and its value from the command
+ * line, so the mode parsers and GTK, which rejects options it does not know,
+ * only see their own options. The last value given wins.
+ *
+ * @param[in,out] argc The number of command line arguments.
+ * @param[in,out] argv The command line arguments.
+ * @param[in] name The option to remove.
+ * @param[out] value The value of the option, nullptr for an option without a value.
+ *
+ * return true if the option was given.
+ *
+ */
+
+static bool ConsumeOption(int &argc, char *argv[], const std::string &name, std::string *value){
+    bool Found = false;
+    int Kept = 1;
+
+    for(int Index = 1; Index < argc; Index++){
+        if(name != argv[Index]){
+            argv[Kept++] = argv[Index];
+        }
+        else if(nullptr == value){
+            Found = true;
+        }
+        else if(Index + 1 < argc){
+            *value = argv[++Index];
+            Found = true;
+        }
+        else{
+            PrintError("Missing value for %s\n", name.c_str());
+        }
+    }
+    argc = Kept;
+    argv[argc] = nullptr;
+    return Found;
+}
+
+/**
+ * Runs the game. The global options are taken off the command line first,
+ * the rest is left to the mode parsers and the GUI application.
  *
  * @param[in] argc The number of command line arguments.
  * @param[in] argv The command line arguments.
@@ -1587,5 +1729,108 @@ void CApplicationData::ResizeCanvases(){
  */
 
 int CApplicationData::Run(int argc, char *argv[]){
+    CHeadlessRenderer::SOptions HeadlessOptions;
+    CMixerBenchmark::SOptions MixerBenchmarkOptions;
+    CLockstepBenchmark::SOptions LockstepBenchmarkOptions;
+    CGameServer::SOptions GameServerOptions;
+    CNetworkLoadTest::SOptions NetworkLoadTestOptions;
+    CCommandBenchmark::SOptions CommandBenchmarkOptions;
+    CParseBenchmark::SOptions ParseBenchmarkOptions;
+    CStartupBenchmark::SOptions StartupBenchmarkOptions;
+    CAssetPacker::SOptions AssetPackerOptions;
+    std::string Value;
+
+    if(ConsumeOption(argc, argv, "--sound-cache", &Value)){
+        DSoundCachePath = Value;
+    }
+    if(ConsumeOption(argc, argv, "--lockstep-text", nullptr)){
+        DLockstepTextCommands = true;
+    }
+    if(ConsumeOption(argc, argv, "--lockstep-delay", &Value)){
+        DLockstepInputDelay = std::atoi(Value.c_str());
+    }
+    if(ConsumeOption(argc, argv, "--server", &Value)){
+        size_t Colon = Value.rfind(':');
+
+        DServerAddress = Value.substr(0, Colon);
+        if(std::string::npos != Colon){
+            DServerPort = Value.substr(Colon + 1);
+        }
+    }
+    if(ConsumeOption(argc, argv, "--loader-threads", &Value)){
+        DLoaderThreads = std::atoi(Value.c_str());
+    }
+    if(ConsumeOption(argc, argv, "--autosave", &Value)){
+        DAutoSaveInterval = std::atoi(Value.c_str());
+    }
+    if(ConsumeOption(argc, argv, "--map-cache", &Value)){
+        DMapCachePath = Value;
+    }
+    if(ConsumeOption(argc, argv, "--hot-reload", nullptr)){
+        DHotReload = true;
+    }
+    if(ConsumeOption(argc, argv, "--startup-trace", &Value)){
+        CStartupTrace::Enable(Value);
+    }
+    if(0 < DAutoSaveInterval){
+        DAutoSave = std::make_shared< CAutoSave >(AUTO_SAVE_FILENAME, DAutoSaveInterval);
+    }
+    if(CHeadlessRenderer::ParseArguments(argc, argv, HeadlessOptions)){
+        CHeadlessRenderer HeadlessRenderer(shared_from_this(), HeadlessOptions);
+
+        return HeadlessRenderer.Run();
+    }
+    if(CMixerBenchmark::ParseArguments(argc, argv, MixerBenchmarkOptions)){
+        MixerBenchmarkOptions.DCachePath = DSoundCachePath;
+        CMixerBenchmark MixerBenchmark(MixerBenchmarkOptions);
+
+        return MixerBenchmark.Run();
+    }
+    if(CLockstepBenchmark::ParseArguments(argc, argv, LockstepBenchmarkOptions)){
+        CLockstepBenchmark LockstepBenchmark(LockstepBenchmarkOptions);
+
+        return LockstepBenchmark.Run();
+    }
+    if(CGameServer::ParseArguments(argc, argv, GameServerOptions)){
+        try{
+            CGameServer GameServer(GameServerOptions.DAddress, GameServerOptions.DPort);
+
+            if(!GameServerOptions.DRecordPath.empty() && !GameServer.Record(GameServerOptions.DRecordPath)){
+                PrintError("Could not open %s\n", GameServerOptions.DRecordPath.c_str());
+                return 1;
+            }
+            return GameServer.Run();
+        }
+        catch(std::exception &Exception){
+            PrintError("Could not start the game server: %s\n", Exception.what());
+            return 1;
+        }
+    }
+    if(CNetworkLoadTest::ParseArguments(argc, argv, NetworkLoadTestOptions)){
+        CNetworkLoadTest NetworkLoadTest(NetworkLoadTestOptions);
+
+        return NetworkLoadTest.Run();
+    }
+    if(CCommandBenchmark::ParseArguments(argc, argv, CommandBenchmarkOptions)){
+        CCommandBenchmark CommandBenchmark(CommandBenchmarkOptions);
+
+        return CommandBenchmark.Run();
+    }
+    if(CParseBenchmark::ParseArguments(argc, argv, ParseBenchmarkOptions)){
+        CParseBenchmark ParseBenchmark(ParseBenchmarkOptions);
+
+        return ParseBenchmark.Run();
+    }
+    if(CStartupBenchmark::ParseArguments(argc, argv, StartupBenchmarkOptions)){
+        StartupBenchmarkOptions.DThreads = DLoaderThreads;
+        CStartupBenchmark StartupBenchmark(shared_from_this(), StartupBenchmarkOptions);
+
+        return StartupBenchmark.Run();
+    }
+    if(CAssetPacker::ParseArguments(argc, argv, AssetPackerOptions)){
+        CAssetPacker AssetPacker(AssetPackerOptions);
+
+        return AssetPacker.Run();
+    }
     return DApplication->Run(argc, argv);
 }
@@ -0,0 +1,785 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CAssetArchive
+*
+* @brief A packed archive of the data directory that is memory mapped at
+*     start up, so loading reads one file front to back instead of opening
+*     hundreds of small ones. The layout is
+*
+*         header      "ECSPACK1", version, reserved (16 bytes)
+*         entries     the file contents, each aligned to 16 bytes
+*         contents    per entry: offset, size, name length, name
+*         trailer     contents offset and size, entry count, version,
+*                     "ECSPACK1" (32 bytes)
+*
+*     Names are paths relative to the data directory using '/', and the
+*     table of contents is sorted by name so lookups are a binary search on
+*     the mapped table. Numbers are in the byte order of the machine that
+*     built the archive, an archive is rebuilt rather than shared.
+*
+*     CAssetArchiveDataContainer serves the entries as CDataContainers and
+*     zero copy CDataSources, a loose file in the data directory overrides
+*     the archived one of the same name.
+*
+*/
+
+#include "AssetArchive.h"
+#include "FileDataContainer.h"
+#include "FileDataSink.h"
+#include "FileDataSource.h"
+#include "Path.h"
+#include "StartupTrace.h"
+#include "Debug.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ASSET_ARCHIVE_MAGIC         "ECSPACK1"
+#define ASSET_ARCHIVE_MAGIC_SIZE    8
+#define ASSET_ARCHIVE_VERSION       1
+#define ASSET_ARCHIVE_ALIGNMENT     16
+#define ASSET_ARCHIVE_HEADER_SIZE   16
+#define ASSET_ARCHIVE_TRAILER_SIZE  32
+#define ASSET_ARCHIVE_ENTRY_SIZE    20
+#define ASSET_ARCHIVE_READ_SIZE     65536
+
+/**
+* Reads a number out of the mapped archive, which may not be aligned.
+*
+* @param[in] data Where the number is stored
+*
+* @return The number
+*
+*/
+
+template< typename T > static T AssetArchiveNumber(const char *data){
+    T Value;
+
+    memcpy(&Value, data, sizeof(T));
+    return Value;
+}
+
+/**
+* Writes all of the data to the sink.
+*
+* @param[in] sink The archive being written
+* @param[in] data The data to write
+* @param[in] length The number of bytes to write
+* @param[in,out] offset The offset in the archive, advanced by length
+*
+* @return true if everything was written
+*
+*/
+
+static bool AssetArchiveWrite(CDataSink &sink, const void *data, size_t length, uint64_t &offset){
+    const char *Data = static_cast< const char * >(data);
+    size_t Written = 0;
+
+    while(Written < length){
+        int Length = sink.Write(Data + Written, std::min< size_t >(length - Written, ASSET_ARCHIVE_READ_SIZE));
+
+        if(0 >= Length){
+            return false;
+        }
+        Written += Length;
+    }
+    offset += length;
+    return true;
+}
+
+/**
+* Collects the names of all files under a container, skipping hidden files.
+*
+* @param[in] container The container to list
+* @param[in] prefix The name of the container relative to the archive root
+* @param[out] names The names found
+*
+* @return void
+*
+*/
+
+static void AssetArchiveCollect(std::shared_ptr< CDataContainer > container, const std::string &prefix, std::vector< std::string > &names){
+    auto Iterator = container->First();
+
+    while((nullptr != Iterator) && Iterator->IsValid()){
+        std::string Name = Iterator->Name();
+
+        if(Name.length() && ('.' != Name[0])){
+            if(Iterator->IsContainer()){
+                AssetArchiveCollect(container->DataContainer(Name), prefix + Name + "/", names);
+            }
+            else{
+                names.push_back(prefix + Name);
+            }
+        }
+        Iterator->Next();
+    }
+}
+
+/**
+* Constructor, only used by Open.
+*
+* @param[in] key Restricts construction to Open
+*
+*/
+
+CAssetArchive::CAssetArchive(const SPrivateConstructorKey &/*key*/){
+    DFileHandle = -1;
+    DBase = nullptr;
+    DLength = 0;
+    DModificationTime = 0;
+}
+
+/**
+* Destructor, unmaps the archive.
+*
+*/
+
+CAssetArchive::~CAssetArchive(){
+    if(nullptr != DBase){
+        munmap(const_cast< char * >(DBase), DLength);
+    }
+    if(0 <= DFileHandle){
+        close(DFileHandle);
+    }
+}
+
+/**
+* Opens and maps an archive.
+*
+* @param[in] filename The archive to open
+*
+* @return The archive, nullptr if it does not exist or is not valid
+*
+*/
+
+std::shared_ptr< CAssetArchive > CAssetArchive::Open(const std::string &filename){
+    auto Archive = std::make_shared< CAssetArchive >(SPrivateConstructorKey());
+
+    if(!Archive->Map(filename)){
+        return nullptr;
+    }
+    return Archive;
+}
+
+/**
+* Maps the archive and checks the table of contents. The whole archive is
+* read ahead since most of it is needed during start up.
+*
+* @param[in] filename The archive to map
+*
+* @return true if the archive is valid
+*
+*/
+
+bool CAssetArchive::Map(const std::string &filename){
+    struct stat FileStatus;
+    uint64_t ContentsOffset, ContentsSize;
+    uint32_t Count;
+    const char *Trailer;
+    const char *Contents;
+
+    DFileHandle = open(filename.c_str(), O_RDONLY);
+    if(0 > DFileHandle){
+        return false;
+    }
+    if((0 != fstat(DFileHandle, &FileStatus)) || (ASSET_ARCHIVE_HEADER_SIZE + ASSET_ARCHIVE_TRAILER_SIZE > FileStatus.st_size)){
+        PrintError("Asset archive %s is too short.\n", filename.c_str());
+        return false;
+    }
+    DModificationTime = FileStatus.st_mtime;
+    void *Base = mmap(nullptr, FileStatus.st_size, PROT_READ, MAP_PRIVATE, DFileHandle, 0);
+    if(MAP_FAILED == Base){
+        PrintError("Failed to map asset archive %s.\n", filename.c_str());
+        return false;
+    }
+    DBase = static_cast< const char * >(Base);
+    DLength = FileStatus.st_size;
+    madvise(Base, DLength, MADV_WILLNEED);
+
+    Trailer = DBase + DLength - ASSET_ARCHIVE_TRAILER_SIZE;
+    if(memcmp(DBase, ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_MAGIC_SIZE) || memcmp(Trailer + 24, ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_MAGIC_SIZE)){
+        PrintError("%s is not an asset archive.\n", filename.c_str());
+        return false;
+    }
+    if(ASSET_ARCHIVE_VERSION != AssetArchiveNumber< uint32_t >(Trailer + 20)){
+        PrintError("Asset archive %s has an unknown version.\n", filename.c_str());
+        return false;
+    }
+    ContentsOffset = AssetArchiveNumber< uint64_t >(Trailer);
+    ContentsSize = AssetArchiveNumber< uint64_t >(Trailer + 8);
+    Count = AssetArchiveNumber< uint32_t >(Trailer + 16);
+    // Contents must end at the trailer without wrapping, and every entry
+    // needs at least ASSET_ARCHIVE_ENTRY_SIZE bytes of it
+    if((ContentsOffset < ASSET_ARCHIVE_HEADER_SIZE) || (ContentsOffset > DLength - ASSET_ARCHIVE_TRAILER_SIZE) || (ContentsSize != DLength - ASSET_ARCHIVE_TRAILER_SIZE - ContentsOffset) || (Count > ContentsSize / ASSET_ARCHIVE_ENTRY_SIZE)){
+        PrintError("Asset archive %s is corrupt.\n", filename.c_str());
+        return false;
+    }
+
+    Contents = DBase + ContentsOffset;
+    DEntries.resize(Count);
+    for(auto &Entry : DEntries){
+        if((uint64_t)(Trailer - Contents) < ASSET_ARCHIVE_ENTRY_SIZE){
+            PrintError("Asset archive %s is corrupt.\n", filename.c_str());
+            DEntries.clear();
+            return false;
+        }
+        Entry.DOffset = AssetArchiveNumber< uint64_t >(Contents);
+        Entry.DSize = AssetArchiveNumber< uint64_t >(Contents + 8);
+        Entry.DNameLength = AssetArchiveNumber< uint32_t >(Contents + 16);
+        Entry.DName = Contents + ASSET_ARCHIVE_ENTRY_SIZE;
+        if(((uint64_t)(Trailer - Entry.DName) < Entry.DNameLength) || (Entry.DOffset < ASSET_ARCHIVE_HEADER_SIZE) || (Entry.DOffset > ContentsOffset) || (Entry.DSize > ContentsOffset - Entry.DOffset)){
+            PrintError("Asset archive %s is corrupt.\n", filename.c_str());
+            DEntries.clear();
+            return false;
+        }
+        Contents = Entry.DName + Entry.DNameLength;
+        if((&Entry != &DEntries.front()) && (0 <= CompareName(*(&Entry - 1), Entry.DName, Entry.DNameLength))){
+            PrintError("Asset archive %s is not sorted.\n", filename.c_str());
+            DEntries.clear();
+            return false;
+        }
+    }
+    if(Contents != Trailer){
+        PrintError("Asset archive %s is corrupt.\n", filename.c_str());
+        DEntries.clear();
+        return false;
+    }
+    PrintDebug(DEBUG_LOW, "Mapped asset archive %s, %d entries\n", filename.c_str(), (int)DEntries.size());
+    return true;
+}
+
+/**
+* Compares the name of an entry with a name, byte by byte.
+*
+* @param[in] entry The entry
+* @param[in] name The name to compare with
+* @param[in] length The length of name
+*
+* @return Less than, equal to or greater than 0 as the entry sorts before,
+*     the same as or after the name
+*
+*/
+
+int CAssetArchive::CompareName(const SEntry &entry, const char *name, size_t length){
+    int Result = memcmp(entry.DName, name, std::min< size_t >(entry.DNameLength, length));
+
+    if(Result){
+        return Result;
+    }
+    return entry.DNameLength < length ? -1 : (entry.DNameLength > length ? 1 : 0);
+}
+
+/**
+* Finds the first entry that does not sort before a name.
+*
+* @param[in] name The name to look for
+*
+* @return The index of the entry, EntryCount() if there is none
+*
+*/
+
+size_t CAssetArchive::LowerBound(const std::string &name) const{
+    size_t Low = 0, High = DEntries.size();
+
+    while(Low < High){
+        size_t Middle = (Low + High) / 2;
+
+        if(0 > CompareName(DEntries[Middle], name.data(), name.length())){
+            Low = Middle + 1;
+        }
+        else{
+            High = Middle;
+        }
+    }
+    return Low;
+}
+
+/**
+* Finds an entry by name.
+*
+* @param[in] name The name relative to the archive root
+*
+* @return The entry, nullptr if it is not in the archive
+*
+*/
+
+const CAssetArchive::SEntry *CAssetArchive::Find(const std::string &name) const{
+    size_t Index = LowerBound(name);
+
+    if((Index < DEntries.size()) && (0 == CompareName(DEntries[Index], name.data(), name.length()))){
+        return &DEntries[Index];
+    }
+    return nullptr;
+}
+
+/**
+* Packs every file under a directory into an archive. The archive is written
+* next to the destination and renamed over it when complete, so a running
+* game that has the old archive mapped is not disturbed.
+*
+* @param[in] directory The data directory to pack
+* @param[in] filename The archive to write
+* @param[out] entries The number of files packed
+* @param[out] bytes The size of the archive
+*
+* @return true if the archive was written
+*
+*/
+
+bool CAssetArchive::Build(const std::string &directory, const std::string &filename, size_t &entries, size_t &bytes){
+    std::string FullPath = CPath::CurrentPath().Simplify(filename).ToString();
+    std::string RootPath = CPath::CurrentPath().Simplify(directory).ToString();
+    std::string TempPath = FullPath + ".tmp";
+    std::vector< std::string > Names;
+    std::vector< SEntry > Entries;
+    std::vector< char > Buffer(ASSET_ARCHIVE_READ_SIZE);
+    char Header[ASSET_ARCHIVE_HEADER_SIZE] = {0};
+    char Trailer[ASSET_ARCHIVE_TRAILER_SIZE] = {0};
+    uint64_t Offset = 0, ContentsOffset;
+    uint32_t Version = ASSET_ARCHIVE_VERSION;
+    uint32_t Count;
+    bool Success = true;
+
+    AssetArchiveCollect(std::make_shared< CDirectoryDataContainer >(RootPath), "", Names);
+    Names.erase(std::remove_if(Names.begin(), Names.end(), [&](const std::string &name){
+        std::string Path = RootPath + "/" + name;
+
+        return (Path == FullPath) || (Path == TempPath);
+    }), Names.end());
+    std::sort(Names.begin(), Names.end());
+    if(Names.empty()){
+        PrintError("Found nothing to pack in %s.\n", RootPath.c_str());
+        return false;
+    }
+
+    unlink(TempPath.c_str());
+    {
+        CFileDataSink Sink(TempPath);
+
+        memcpy(Header, ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_MAGIC_SIZE);
+        memcpy(Header + 8, &Version, sizeof(Version));
+        Success = AssetArchiveWrite(Sink, Header, sizeof(Header), Offset);
+        for(size_t Index = 0; Success && (Index < Names.size()); Index++){
+            CFileDataSource Source(RootPath + "/" + Names[Index]);
+            SEntry Entry;
+            int Length;
+
+            Entry.DName = Names[Index].c_str();
+            Entry.DNameLength = Names[Index].length();
+            Entry.DOffset = Offset;
+            while(Success && (0 < (Length = Source.Read(Buffer.data(), Buffer.size())))){
+                Success = AssetArchiveWrite(Sink, Buffer.data(), Length, Offset);
+            }
+            Entry.DSize = Offset - Entry.DOffset;
+            Entries.push_back(Entry);
+            if(Success && (Offset % ASSET_ARCHIVE_ALIGNMENT)){
+                char Padding[ASSET_ARCHIVE_ALIGNMENT] = {0};
+
+                Success = AssetArchiveWrite(Sink, Padding, ASSET_ARCHIVE_ALIGNMENT - (Offset % ASSET_ARCHIVE_ALIGNMENT), Offset);
+            }
+        }
+        ContentsOffset = Offset;
+        for(size_t Index = 0; Success && (Index < Entries.size()); Index++){
+            char EntryHeader[ASSET_ARCHIVE_ENTRY_SIZE];
+
+            memcpy(EntryHeader, &Entries[Index].DOffset, 8);
+            memcpy(EntryHeader + 8, &Entries[Index].DSize, 8);
+            memcpy(EntryHeader + 16, &Entries[Index].DNameLength, 4);
+            Success = AssetArchiveWrite(Sink, EntryHeader, sizeof(EntryHeader), Offset) && AssetArchiveWrite(Sink, Entries[Index].DName, Entries[Index].DNameLength, Offset);
+        }
+        if(Success){
+            uint64_t ContentsSize = Offset - ContentsOffset;
+
+            Count = Entries.size();
+            memcpy(Trailer, &ContentsOffset, 8);
+            memcpy(Trailer + 8, &ContentsSize, 8);
+            memcpy(Trailer + 16, &Count, 4);
+            memcpy(Trailer + 20, &Version, 4);
+            memcpy(Trailer + 24, ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_MAGIC_SIZE);
+            Success = AssetArchiveWrite(Sink, Trailer, sizeof(Trailer), Offset);
+        }
+    }
+    if(!Success || (0 != rename(TempPath.c_str(), FullPath.c_str()))){
+        PrintError("Failed to write asset archive %s.\n", FullPath.c_str());
+        unlink(TempPath.c_str());
+        return false;
+    }
+    entries = Entries.size();
+    bytes = Offset;
+    return true;
+}
+
+/**
+* Constructor, serves an entry of an archive.
+*
+* @param[in] archive The archive, kept mapped while the source exists
+* @param[in] entry The entry to read
+* @param[in] container The container the entry is in
+*
+*/
+
+CAssetArchiveDataSource::CAssetArchiveDataSource(std::shared_ptr< CAssetArchive > archive, const CAssetArchive::SEntry &entry, std::shared_ptr< CDataContainer > container) : CDataSource(){
+    DArchive = archive;
+    DContainer = container;
+    DData = archive->Data(entry);
+    DSize = entry.DSize;
+    DOffset = 0;
+    CStartupTrace::CountFile();
+}
+
+/**
+* Copies the next bytes of the entry out of the mapping.
+*
+* @param[out] data The buffer to store the data read
+* @param[in] length The number of bytes to read
+*
+* @return Number of bytes read, -1 at the end of the entry
+*
+*/
+
+int CAssetArchiveDataSource::Read(void *data, int length){
+    size_t Length = std::min< size_t >(0 < length ? length : 0, DSize - DOffset);
+
+    if(!Length){
+        return -1;
+    }
+    memcpy(data, DData + DOffset, Length);
+    DOffset += Length;
+    CStartupTrace::CountBytes(Length);
+    return Length;
+}
+
+/**
+* Reads the next line straight out of the mapping, the new line is consumed
+* but not stored and carriage returns are dropped.
+*
+* @param[out] line The line read
+*
+* @return true if a line was read
+*
+*/
+
+bool CAssetArchiveDataSource::ReadLine(std::string &line){
+    size_t Available = DSize - DOffset;
+
+    line.clear();
+    if(!Available){
+        return false;
+    }
+    const char *Start = DData + DOffset;
+    const char *NewLine = static_cast< const char * >(memchr(Start, '\n', Available));
+    size_t Length = NewLine ? NewLine - Start : Available;
+
+    line.assign(Start, Length);
+    DOffset += NewLine ? Length + 1 : Length;
+    CStartupTrace::CountBytes(NewLine ? Length + 1 : Length);
+    if(std::string::npos != line.find('\r')){
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+    }
+    return true;
+}
+
+/**
+* Gets the container the entry is in.
+*
+* @return The container
+*
+*/
+
+std::shared_ptr< CDataContainer > CAssetArchiveDataSource::Container(){
+    return DContainer;
+}
+
+/**
+* Gets the modification time of the archive.
+*
+* @return The modification time
+*
+*/
+
+time_t CAssetArchiveDataSource::ModificationTime(){
+    return DArchive->ModificationTime();
+}
+
+/**
+* Constructor, the iterator is filled in by the container.
+*
+* @param[in] key Restricts construction to CAssetArchiveDataContainer
+*
+*/
+
+CAssetArchiveDataContainerIterator::CAssetArchiveDataContainerIterator(const SPrivateConstructorKey &/*key*/) : CDataContainerIterator(){
+    DIndex = 0;
+}
+
+/**
+* Gets the name of the current entry.
+*
+* @return The name
+*
+*/
+
+std::string CAssetArchiveDataContainerIterator::Name(){
+    return DIndex < DEntries.size() ? DEntries[DIndex].first : "";
+}
+
+/**
+* Checks if the current entry is a container.
+*
+* @return true if it is a container
+*
+*/
+
+bool CAssetArchiveDataContainerIterator::IsContainer(){
+    return (DIndex < DEntries.size()) && DEntries[DIndex].second;
+}
+
+/**
+* Checks if the iterator is at an entry.
+*
+* @return true if there is a current entry
+*
+*/
+
+bool CAssetArchiveDataContainerIterator::IsValid(){
+    return DIndex < DEntries.size();
+}
+
+/**
+* Moves to the next entry.
+*
+* @return void
+*
+*/
+
+void CAssetArchiveDataContainerIterator::Next(){
+    if(DIndex < DEntries.size()){
+        DIndex++;
+    }
+}
+
+/**
+* Constructor, serves a directory of the archive.
+*
+* @param[in] archive The archive
+* @param[in] rootpath The data directory the archive was packed from, loose
+*     files under it that are newer than the archive override it
+* @param[in] path The directory this container serves
+*
+*/
+
+CAssetArchiveDataContainer::CAssetArchiveDataContainer(std::shared_ptr< CAssetArchive > archive, const std::string &rootpath, const std::string &path) : CDataContainer(){
+    DArchive = archive;
+    DRootPath = CPath::CurrentPath().Simplify(rootpath).ToString();
+    DFullPath = CPath::CurrentPath().Simplify(path).ToString();
+}
+
+/**
+* Opens a data directory, through its archive if there is one next to it.
+*
+* @param[in] path The data directory, the archive is path plus ".pak"
+*
+* @return The container for the data directory
+*
+*/
+
+std::shared_ptr< CDataContainer > CAssetArchiveDataContainer::OpenDataDirectory(const std::string &path){
+    auto Archive = CAssetArchive::Open(path + ASSET_ARCHIVE_EXTENSION);
+
+    if(nullptr != Archive){
+        return std::make_shared< CAssetArchiveDataContainer >(Archive, path, path);
+    }
+    return std::make_shared< CDirectoryDataContainer >(path);
+}
+
+/**
+* Gets the name in the archive of a path under the data directory.
+*
+* @param[in] fullpath The simplified path
+* @param[out] name The name relative to the archive root
+*
+* @return false if the path is outside of the data directory
+*
+*/
+
+bool CAssetArchiveDataContainer::ArchiveName(const std::string &fullpath, std::string &name) const{
+    if(fullpath == DRootPath){
+        name.clear();
+        return true;
+    }
+    if((fullpath.length() > DRootPath.length()) && (0 == fullpath.compare(0, DRootPath.length(), DRootPath)) && ('/' == fullpath[DRootPath.length()])){
+        name = fullpath.substr(DRootPath.length() + 1);
+        return true;
+    }
+    return false;
+}
+
+/**
+* Lists the directory, the archived entries merged with any loose files.
+*
+* @return An iterator over the sorted names
+*
+*/
+
+std::shared_ptr< CDataContainerIterator > CAssetArchiveDataContainer::First(){
+    auto Iterator = std::make_shared< CAssetArchiveDataContainerIterator >(CAssetArchiveDataContainerIterator::SPrivateConstructorKey());
+    std::map< std::string, bool > Names;
+    std::string Prefix;
+
+    if(ArchiveName(DFullPath, Prefix)){
+        if(Prefix.length()){
+            Prefix += "/";
+        }
+        for(size_t Index = DArchive->LowerBound(Prefix); Index < DArchive->EntryCount(); Index++){
+            const CAssetArchive::SEntry &Entry = DArchive->Entry(Index);
+            std::string Name(Entry.DName, Entry.DNameLength);
+            size_t Slash;
+
+            if(0 != Name.compare(0, Prefix.length(), Prefix)){
+                break;
+            }
+            Slash = Name.find('/', Prefix.length());
+            if(std::string::npos == Slash){
+                Names[Name.substr(Prefix.length())] = false;
+            }
+            else{
+                Names[Name.substr(Prefix.length(), Slash - Prefix.length())] = true;
+            }
+        }
+    }
+    // The loose directory usually does not exist once the data is packed
+    if(0 == access(DFullPath.c_str(), F_OK)){
+        CDirectoryDataContainer Loose(DFullPath);
+
+        for(auto LooseIterator = Loose.First(); (nullptr != LooseIterator) && LooseIterator->IsValid(); LooseIterator->Next()){
+            std::string Name = LooseIterator->Name();
+
+            if(("." != Name) && (".." != Name)){
+                bool IsContainer = LooseIterator->IsContainer();
+
+                Names[Name] = Names[Name] || IsContainer;
+            }
+        }
+    }
+    Iterator->DEntries.assign(Names.begin(), Names.end());
+    return Iterator;
+}
+
+/**
+* Opens a file for reading, the archived entry unless a loose file of the
+* same name was modified after the archive was packed. Files missing from
+* the archive are read loose.
+*
+* @param[in] name The file name relative to this directory
+*
+* @return The data source, nullptr if the file does not exist
+*
+*/
+
+std::shared_ptr< CDataSource > CAssetArchiveDataContainer::DataSource(const std::string &name){
+    std::string FileName = CPath(DFullPath).Simplify(CPath(name)).ToString();
+    std::string Name;
+
+    if(!FileName.length()){
+        return nullptr;
+    }
+    if(!ArchiveName(FileName, Name)){
+        CDirectoryDataContainer Outside(DFullPath);
+
+        return Outside.DataSource(name);
+    }
+    auto Container = std::make_shared< CAssetArchiveDataContainer >(DArchive, DRootPath, CPath(FileName).Containing().ToString());
+    auto Entry = DArchive->Find(Name);
+    struct stat FileStatus;
+
+    if((0 == stat(FileName.c_str(), &FileStatus)) && ((nullptr == Entry) || (FileStatus.st_mtime > DArchive->ModificationTime()))){
+        auto Source = std::make_shared< CFileDataSource >(FileName);
+
+        // Files the loose one names are looked up in the archive as well
+        Source->Container(Container);
+        return Source;
+    }
+    if(nullptr != Entry){
+        return std::make_shared< CAssetArchiveDataSource >(DArchive, *Entry, Container);
+    }
+    return nullptr;
+}
+
+/**
+* Opens a file for writing, files are always written loose.
+*
+* @param[in] name The file name relative to this directory
+*
+* @return The data sink
+*
+*/
+
+std::shared_ptr< CDataSink > CAssetArchiveDataContainer::DataSink(const std::string &name){
+    CDirectoryDataContainer Loose(DFullPath);
+
+    return Loose.DataSink(name);
+}
+
+/**
+* Gets the containing directory, in the archive while it is under the data
+* directory.
+*
+* @return The containing directory
+*
+*/
+
+std::shared_ptr< CDataContainer > CAssetArchiveDataContainer::Container(){
+    std::string ContainerName = CPath(DFullPath).Containing().ToString();
+    std::string Name;
+
+    if(!ContainerName.length()){
+        return nullptr;
+    }
+    if((DFullPath != DRootPath) && ArchiveName(ContainerName, Name)){
+        return std::make_shared< CAssetArchiveDataContainer >(DArchive, DRootPath, ContainerName);
+    }
+    return std::make_shared< CDirectoryDataContainer >(ContainerName);
+}
+
+/**
+* Gets a directory relative to this one.
+*
+* @param[in] name The directory name relative to this directory
+*
+* @return The directory
+*
+*/
+
+std::shared_ptr< CDataContainer > CAssetArchiveDataContainer::DataContainer(const std::string &name){
+    std::string ContainerName = CPath(DFullPath).Simplify(CPath(name)).ToString();
+    std::string Name;
+
+    if(!ContainerName.length()){
+        return nullptr;
+    }
+    if(ArchiveName(ContainerName, Name)){
+        return std::make_shared< CAssetArchiveDataContainer >(DArchive, DRootPath, ContainerName);
+    }
+    return std::make_shared< CDirectoryDataContainer >(ContainerName);
+}
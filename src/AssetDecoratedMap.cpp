@@ -23,14 +23,23 @@
 #include <queue>
 #include <algorithm>
 #include "TriggerHandler.h"
+#include "MemoryDataSource.h"
+#include "StartupTrace.h"
 #include <iostream>
+#include <chrono>
+#include <cstring>
+
+#define MAP_CACHE_MAGIC         0x4350414D
+#define MAP_CACHE_VERSION       1
+#define MAP_CACHE_FNV_OFFSET    14695981039346656037ULL
+#define MAP_CACHE_FNV_PRIME     1099511628211ULL
 
 /**
 *
 * @class AssetDecoratedMap
 *
 * @brief This class maintains a players assets built on the map. It is derived from the class TerrainMap.
-* The class contains a static list of shared pointers to other AssetDecoratedMaps. It also contains
+* The class contains a static registry of the maps, which loads each map when it is first needed. It also contains
 * functions for loading maps, adding and removing player assets, and asset placement on the map.
 *
 * @author Jade
@@ -44,15 +53,130 @@
 */
 
 std::map< std::string, int > CAssetDecoratedMap::DMapNameTranslation;
-std::vector< std::shared_ptr< CAssetDecoratedMap > > CAssetDecoratedMap::DAllMaps;
-std::vector< std::shared_ptr< CAssetDecoratedMap > > CAssetDecoratedMap::DBackupMaps;
+std::vector< CAssetDecoratedMap::SMapEntry > CAssetDecoratedMap::DMapEntries;
+unsigned int CAssetDecoratedMap::DMapUseCount = 0;
+std::shared_ptr< CDataContainer > CAssetDecoratedMap::DMapContainer;
+std::shared_ptr< CDataContainer > CAssetDecoratedMap::DMapCache;
+
+/**
+* Reads a data source to its end
+*
+* @param[in] source The source to read
+*
+* @return The contents of the source, empty if there is no source
+*
+*/
+
+static std::string MapCacheReadAll(std::shared_ptr< CDataSource > source){
+    std::string Data;
+    char Buffer[4096];
+    int Length;
+
+    if(nullptr != source){
+        while(0 < (Length = source->Read(Buffer, sizeof(Buffer)))){
+            Data.append(Buffer, Length);
+        }
+    }
+    return Data;
+}
+
+/**
+* Hashes the contents of a map file with 64 bit FNV-1a, a cache entry is only
+* used if it was stored for a map file with the same hash
+*
+* @param[in] data The contents of the map file
+*
+* @return The hash
+*
+*/
+
+static uint64_t MapCacheHash(const std::string &data){
+    uint64_t Hash = MAP_CACHE_FNV_OFFSET;
+
+    for(auto Character : data){
+        Hash = (Hash ^ (uint8_t)Character) * MAP_CACHE_FNV_PRIME;
+    }
+    return Hash;
+}
+
+/**
+* Appends a value to a cache entry in the native byte order, the cache is
+* local to the machine that stored it
+*
+* @param[out] data The cache entry
+* @param[in] value The value to append
+*
+* @return void
+*
+*/
+
+template< typename TValue > static void MapCacheAppend(std::string &data, TValue value){
+    data.append((const char *)&value, sizeof(value));
+}
+
+/**
+* Reads a value appended with MapCacheAppend
+*
+* @param[in] data The cache entry
+* @param[in,out] offset The offset of the value, moved past it
+* @param[out] value The value read
+*
+* @return true if the entry held the whole value
+*
+*/
+
+template< typename TValue > static bool MapCacheRead(const std::string &data, size_t &offset, TValue &value){
+    if(sizeof(value) > data.size() - std::min(offset, data.size())){
+        return false;
+    }
+    memcpy(&value, data.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+
+/**
+* Appends a string to a cache entry as its length and its characters
+*
+* @param[out] data The cache entry
+* @param[in] value The string to append
+*
+* @return void
+*
+*/
+
+static void MapCacheAppendString(std::string &data, const std::string &value){
+    MapCacheAppend(data, (uint32_t)value.size());
+    data += value;
+}
+
+/**
+* Reads a string appended with MapCacheAppendString
+*
+* @param[in] data The cache entry
+* @param[in,out] offset The offset of the string, moved past it
+* @param[out] value The string read
+*
+* @return true if the entry held the whole string
+*
+*/
+
+static bool MapCacheReadString(const std::string &data, size_t &offset, std::string &value){
+    uint32_t Length;
+
+    if(!MapCacheRead(data, offset, Length) || (Length > data.size() - offset)){
+        return false;
+    }
+    value.assign(data, offset, Length);
+    offset += Length;
+    return true;
+}
 
 /**
 * Constructor
 *
 */
 
-CAssetDecoratedMap::CAssetDecoratedMap() : CTerrainMap(){
+CAssetDecoratedMap::CAssetDecoratedMap() : CTerrainMap(), DMemoryAccount(EMemorySubsystem::Maps){
 
 }
 
@@ -63,12 +187,13 @@ CAssetDecoratedMap::CAssetDecoratedMap() : CTerrainMap(){
 *
 */
 
-CAssetDecoratedMap::CAssetDecoratedMap(const CAssetDecoratedMap &map) : CTerrainMap(map){
+CAssetDecoratedMap::CAssetDecoratedMap(const CAssetDecoratedMap &map) : CTerrainMap(map), DMemoryAccount(map.DMemoryAccount){
     DAssets = map.DAssets;
     DLumberAvailable = map.DLumberAvailable;
     DStoneAvailable = map.DStoneAvailable;
     DAssetInitializationList = map.DAssetInitializationList;
     DResourceInitializationList = map.DResourceInitializationList;
+    AccountMemory();
 }
 
 /**
@@ -80,7 +205,7 @@ CAssetDecoratedMap::CAssetDecoratedMap(const CAssetDecoratedMap &map) : CTerrain
 *
 */
 
-CAssetDecoratedMap::CAssetDecoratedMap(const CAssetDecoratedMap &map, const std::array< EPlayerColor, to_underlying(EPlayerColor::Max)> &newcolors) : CTerrainMap(map){
+CAssetDecoratedMap::CAssetDecoratedMap(const CAssetDecoratedMap &map, const std::array< EPlayerColor, to_underlying(EPlayerColor::Max)> &newcolors) : CTerrainMap(map), DMemoryAccount(map.DMemoryAccount){
     DAssets = map.DAssets;
     DLumberAvailable = map.DLumberAvailable;
     DStoneAvailable = map.DStoneAvailable;
@@ -99,6 +224,7 @@ CAssetDecoratedMap::CAssetDecoratedMap(const CAssetDecoratedMap &map, const std:
         // }
         DResourceInitializationList.push_back(NewInitVal);
     }
+    AccountMemory();
 }
 
 /**
@@ -128,12 +254,15 @@ CAssetDecoratedMap &CAssetDecoratedMap::operator=(const CAssetDecoratedMap &map)
         DStoneAvailable = map.DStoneAvailable;
         DAssetInitializationList = map.DAssetInitializationList;
         DResourceInitializationList = map.DResourceInitializationList;
+        AccountMemory();
     }
     return *this;
 }
 
 /**
-* Load in the data for all the maps from .map files
+* Registers the maps of all .map files. Only the header of each map (name,
+* size and player count) and its triggers are read here, the terrain and
+* assets are loaded by GetMap the first time the map is needed
 *
 * @param[in] container Used to load in data from .map files
 *
@@ -142,33 +271,249 @@ CAssetDecoratedMap &CAssetDecoratedMap::operator=(const CAssetDecoratedMap &map)
 */
 
 bool CAssetDecoratedMap::LoadMaps(std::shared_ptr< CDataContainer > container){
+    auto LoadStart = std::chrono::steady_clock::now();
     auto FileIterator = container->First();
     if(FileIterator == nullptr){
         PrintError("FileIterator == nullptr\n");
         return false;
     }
+    DMapContainer = container;
     while((FileIterator != nullptr)&&(FileIterator->IsValid())){
         std::string Filename = FileIterator->Name();
         FileIterator->Next();
         if(Filename.rfind(".map") == (Filename.length() - 4)){
-            std::shared_ptr< CAssetDecoratedMap > TempMap = std::make_shared< CAssetDecoratedMap >();
+            std::shared_ptr< CDataSource > Source = container->DataSource(Filename);
+            SMapEntry Entry;
 
-            if(!TempMap->LoadMap(container->DataSource(Filename))){
+            Entry.DFileName = Filename;
+            Entry.DReplaced = false;
+            Entry.DLastUsed = 0;
+            if((nullptr == Source) || !LoadMapHeader(Source, Entry)){
                 PrintError("Failed to load map \"%s\".\n",Filename.c_str());
                 continue;
             }
-            else{
-                PrintDebug(DEBUG_LOW,"Loaded map \"%s\".\n",Filename.c_str());
+            // The triggers are registered by map index, so they are read with the header
+            CTriggerHandler::LoadTriggers(Source);
+            PrintDebug(DEBUG_LOW,"Registered map \"%s\".\n",Filename.c_str());
+            DMapNameTranslation[Entry.DMapName] = DMapEntries.size();
+            DMapEntries.push_back(Entry);
+        }
+    }
+    auto LoadEnd = std::chrono::steady_clock::now();
+    PrintDebug(DEBUG_LOW, "Maps registered, %d in %.1f ms\n", (int)DMapEntries.size(), std::chrono::duration< double, std::milli >(LoadEnd - LoadStart).count());
+    return true;
+}
+
+/**
+* Reads the header of a map: its name, size and player count. The terrain,
+* partials, resources and assets are skipped line by line, so the source is
+* left at the triggers. They are checked by LoadMap when the map is first
+* used, and LoadEntry reports a map that fails there
+*
+* @param[in] source The map file
+* @param[out] entry The registry entry to fill in
+*
+* @return true if the map has a complete header
+*
+*/
+
+bool CAssetDecoratedMap::LoadMapHeader(std::shared_ptr< CDataSource > source, SMapEntry &entry){
+    CCommentSkipLineDataSource LineSource(source, '#');
+    std::string TempString;
+    std::vector< std::string > Tokens;
+    int Count;
+
+    try{
+        if(!LineSource.Read(entry.DMapName) || !LineSource.Read(TempString)){
+            return false;
+        }
+        CTokenizer::Tokenize(Tokens, TempString);
+        if(2 != Tokens.size()){
+            return false;
+        }
+        entry.DWidth = std::stoi(Tokens[0]);
+        entry.DHeight = std::stoi(Tokens[1]);
+        if((8 > entry.DWidth)||(8 > entry.DHeight)){
+            return false;
+        }
+        // The terrain and then the partials, one line per row
+        for(int Index = 0; Index < (entry.DHeight + 1) * 2; Index++){
+            if(!LineSource.Read(TempString) || (entry.DWidth + 1 > (int)TempString.length())){
+                return false;
+            }
+        }
+        if(!LineSource.Read(TempString)){
+            return false;
+        }
+        Count = std::stoi(TempString);
+        entry.DPlayerCount = Count;
+        for(int Index = 0; Index <= Count; Index++){
+            if(!LineSource.Read(TempString)){
+                return false;
+            }
+        }
+        if(!LineSource.Read(TempString)){
+            return false;
+        }
+        Count = std::stoi(TempString);
+        for(int Index = 0; Index < Count; Index++){
+            if(!LineSource.Read(TempString)){
+                return false;
             }
-            TempMap->RenderTerrain();
-            DMapNameTranslation[TempMap->MapName()] = DAllMaps.size();
-            DAllMaps.push_back(TempMap);
         }
     }
-    PrintDebug(DEBUG_LOW, "Maps loaded\n");
+    catch(std::exception &E){
+        PrintError("%s\n",E.what());
+        return false;
+    }
     return true;
 }
 
+/**
+* Returns the loaded map of a registry entry, loading it from the map cache
+* or the map file if it is not loaded. Loading a map may evict the least
+* recently used other map.
+*
+* @param[in] index The index of the map
+*
+* @return The map, or an empty pointer if it failed to load
+*
+*/
+
+std::shared_ptr< CAssetDecoratedMap > CAssetDecoratedMap::LoadEntry(int index){
+    SMapEntry &Entry = DMapEntries[index];
+    std::shared_ptr< CAssetDecoratedMap > TempMap = std::make_shared< CAssetDecoratedMap >();
+    std::string CacheName, Triggers;
+    bool Cached = false;
+
+    Entry.DLastUsed = ++DMapUseCount;
+    if(nullptr != Entry.DMap){
+        return Entry.DMap;
+    }
+    CStartupTrace Trace("Map " + Entry.DFileName);
+    auto LoadStart = std::chrono::steady_clock::now();
+    std::string MapData = MapCacheReadAll(DMapContainer->DataSource(Entry.DFileName));
+    uint64_t Hash = MapCacheHash(MapData);
+
+    if(nullptr != DMapCache){
+        for(auto Character : Entry.DFileName){
+            CacheName += isalnum(Character) ? Character : '_';
+        }
+        CacheName += ".mapc";
+        Cached = TempMap->LoadCache(MapCacheReadAll(DMapCache->DataSource(CacheName)), Hash, Triggers);
+        if(!Cached){
+            TempMap = std::make_shared< CAssetDecoratedMap >();
+        }
+    }
+    if(!Cached){
+        if(!TempMap->LoadMap(std::make_shared< CMemoryDataSource >(std::vector< char >(MapData.begin(), MapData.end())), Triggers)){
+            PrintError("Failed to load map \"%s\".\n",Entry.DFileName.c_str());
+            return nullptr;
+        }
+        TempMap->RenderTerrain();
+        if(!CacheName.empty()){
+            std::string CacheData = TempMap->StoreCache(Hash, Triggers);
+            auto Sink = DMapCache->DataSink(CacheName);
+
+            if((nullptr == Sink) || ((int)CacheData.size() != Sink->Write(CacheData.data(), CacheData.size()))){
+                PrintDebug(DEBUG_LOW, "Failed to cache map %s\n", Entry.DFileName.c_str());
+            }
+        }
+    }
+    Entry.DMap = TempMap;
+    TempMap->AccountMemory();
+    auto LoadEnd = std::chrono::steady_clock::now();
+    PrintDebug(DEBUG_LOW, "Loaded map \"%s\"%s in %.1f ms, %d KiB\n", Entry.DFileName.c_str(), Cached ? " from the cache" : "", std::chrono::duration< double, std::milli >(LoadEnd - LoadStart).count(), (int)(TempMap->MemoryUsage() / 1024));
+    EvictMaps();
+    return TempMap;
+}
+
+/**
+* Unloads the least recently used maps until at most MAX_LOADED_MAPS are
+* loaded, and reports the memory the loaded maps use. Maps replaced by a
+* loaded game stay loaded until ResetMap. Copies of an evicted map made by
+* DuplicateMap are not affected.
+*
+* @return void
+*
+*/
+
+void CAssetDecoratedMap::EvictMaps(){
+    int LoadedCount = 0;
+    size_t LoadedSize = 0;
+
+    for(auto &Entry : DMapEntries){
+        LoadedCount += nullptr != Entry.DMap ? 1 : 0;
+    }
+    while(MAX_LOADED_MAPS < LoadedCount){
+        SMapEntry *Oldest = nullptr;
+
+        for(auto &Entry : DMapEntries){
+            if((nullptr != Entry.DMap) && !Entry.DReplaced && ((nullptr == Oldest) || (Entry.DLastUsed < Oldest->DLastUsed))){
+                Oldest = &Entry;
+            }
+        }
+        if(nullptr == Oldest){
+            break;
+        }
+        PrintDebug(DEBUG_LOW, "Evicted map \"%s\"\n", Oldest->DFileName.c_str());
+        Oldest->DMap = nullptr;
+        LoadedCount--;
+    }
+    for(auto &Entry : DMapEntries){
+        if(nullptr != Entry.DMap){
+            LoadedSize += Entry.DMap->MemoryUsage();
+        }
+    }
+    PrintDebug(DEBUG_LOW, "Maps: %d of %d loaded, %d KiB\n", LoadedCount, (int)DMapEntries.size(), (int)(LoadedSize / 1024));
+}
+
+/**
+* Estimates the memory a loaded map uses for its terrain, tiles, resources
+* and initialization lists
+*
+* @return The size in bytes
+*
+*/
+
+size_t CAssetDecoratedMap::MemoryUsage() const{
+    size_t Size = sizeof(*this);
+
+    for(auto &Row : DTerrainMap){
+        Size += Row.capacity() * sizeof(Row[0]);
+    }
+    for(auto &Row : DPartials){
+        Size += Row.capacity() * sizeof(Row[0]);
+    }
+    for(auto &Row : DMap){
+        Size += Row.capacity() * sizeof(Row[0]);
+    }
+    for(auto &Row : DMapIndices){
+        Size += Row.capacity() * sizeof(Row[0]);
+    }
+    for(auto &Row : DLumberAvailable){
+        Size += Row.capacity() * sizeof(Row[0]);
+    }
+    for(auto &Row : DStoneAvailable){
+        Size += Row.capacity() * sizeof(Row[0]);
+    }
+    Size += DResourceInitializationList.size() * sizeof(SResourceInitialization);
+    Size += DAssetInitializationList.size() * sizeof(SAssetInitialization);
+    return Size;
+}
+
+/**
+* Updates the size of the map counted against the maps in the memory
+* accounting, called when the map was loaded, copied or resized
+*
+* @return void
+*
+*/
+
+void CAssetDecoratedMap::AccountMemory(){
+    DMemoryAccount.Resize(MemoryUsage());
+}
+
 /**
 * Find the index of a map based on a map name
 *
@@ -188,25 +533,53 @@ int CAssetDecoratedMap::FindMapIndex(const std::string &name){
 }
 
 /**
-* Given an index, return a pointer to the corresponding map in DAllMaps
+* Returns the number of registered maps
+*
+* @return The number of maps
+*
+*/
+
+int CAssetDecoratedMap::MapCount(){
+    return DMapEntries.size();
+}
+
+/**
+* Given an index, return the name of the map without loading it
+*
+* @param[in] index The index of the map
+*
+* @return The name of the map or an empty string if index is out of bounds
+*
+*/
+
+std::string CAssetDecoratedMap::GetMapName(int index){
+    if((0 > index)||(DMapEntries.size() <= index)){
+        return "";
+    }
+    return DMapEntries[index].DMapName;
+}
+
+/**
+* Given an index, return a pointer to the corresponding map, loading it if
+* it is not loaded
 *
-* @param[in] index The index of the map in DAllMaps
+* @param[in] index The index of the map
 *
 * @return a pointer to a map or an empty pointer if index is out of bounds
 *
 */
 
 std::shared_ptr< const CAssetDecoratedMap > CAssetDecoratedMap::GetMap(int index){
-    if((0 > index)||(DAllMaps.size() <= index)){
+    if((0 > index)||(DMapEntries.size() <= index)){
         return std::shared_ptr< const CAssetDecoratedMap >();
     }
-    return std::const_pointer_cast< const CAssetDecoratedMap >(DAllMaps[index]);
+    return std::const_pointer_cast< const CAssetDecoratedMap >(LoadEntry(index));
 }
 
 /**
 * Duplicate a map at given index
 *
-* @param[in] index The index of the map in DAllMaps to duplicate
+* @param[in] index The index of the map to duplicate
 * @param[in] newcolors Array of player colors
 *
 * @return pointer to the duplicated map
@@ -214,10 +587,14 @@ std::shared_ptr< const CAssetDecoratedMap > CAssetDecoratedMap::GetMap(int index
 */
 
 std::shared_ptr< CAssetDecoratedMap > CAssetDecoratedMap::DuplicateMap(int index, const std::array< EPlayerColor, to_underlying(EPlayerColor::Max)> &newcolors){
-    if((0 > index)||(DAllMaps.size() <= index)){
+    if((0 > index)||(DMapEntries.size() <= index)){
         return std::shared_ptr< CAssetDecoratedMap >();
     }
-    return std::make_shared< CAssetDecoratedMap >( *DAllMaps[index], newcolors );
+    auto Map = LoadEntry(index);
+    if(nullptr == Map){
+        return std::shared_ptr< CAssetDecoratedMap >();
+    }
+    return std::make_shared< CAssetDecoratedMap >( *Map, newcolors );
 }
 
 /**
@@ -674,7 +1051,8 @@ void CAssetDecoratedMap::CreateRubble(CTilePosition pos) {
 
 /**
 * Fills the asset and resource initialization lists and the available
-* lumber vector based on the data provided by source
+* lumber vector based on the data provided by source, and registers the
+* triggers of the map
 *
 * @param[in] source Initialization info is loaded from file and stored in source
 *
@@ -683,13 +1061,34 @@ void CAssetDecoratedMap::CreateRubble(CTilePosition pos) {
 */
 
 bool CAssetDecoratedMap::LoadMap(std::shared_ptr< CDataSource > source){
+    std::string Triggers;
+
+    if(!LoadMap(source, Triggers)){
+        return false;
+    }
+    return CTriggerHandler::LoadTriggers(std::make_shared< CMemoryDataSource >(std::vector< char >(Triggers.begin(), Triggers.end())));
+}
+
+/**
+* Fills the asset and resource initialization lists and the available
+* lumber vector based on the data provided by source, and returns the
+* trigger section of the map without registering it, the map registry
+* registers the triggers when it reads the map header
+*
+* @param[in] source Initialization info is loaded from file and stored in source
+* @param[out] triggers The rest of the map file after the assets
+*
+* @return true if loaded successfully or not
+*
+*/
+
+bool CAssetDecoratedMap::LoadMap(std::shared_ptr< CDataSource > source, std::string &triggers){
     CCommentSkipLineDataSource LineSource(source, '#');
     std::string TempString;
     std::vector< std::string > Tokens;
     SResourceInitialization TempResourceInit;
     SAssetInitialization TempAssetInit;
-    int ResourceCount, AssetCount, InitialLumber = 400;
-    int InitialStone = 400;
+    int ResourceCount, AssetCount;
     bool ReturnStatus = false;
 
     if(!CTerrainMap::LoadMap(source)){
@@ -720,10 +1119,6 @@ bool CAssetDecoratedMap::LoadMap(std::shared_ptr< CDataSource > source){
             TempResourceInit.DGold = std::stoi(Tokens[1]);
             TempResourceInit.DLumber = std::stoi(Tokens[2]);
             TempResourceInit.DStone = std::stoi(Tokens[3]);
-            if(EPlayerColor::None == TempResourceInit.DColor){
-                InitialLumber = TempResourceInit.DLumber;
-                InitialStone = TempResourceInit.DStone;
-            }
 
             DResourceInitializationList.push_back(TempResourceInit);
         }
@@ -761,33 +1156,9 @@ bool CAssetDecoratedMap::LoadMap(std::shared_ptr< CDataSource > source){
             DAssetInitializationList.push_back(TempAssetInit);
         }
 
-        DLumberAvailable.resize(DTerrainMap.size());
-        for(int RowIndex = 0; RowIndex < DLumberAvailable.size(); RowIndex++){
-            DLumberAvailable[RowIndex].resize(DTerrainMap[RowIndex].size());
-            for(int ColIndex = 0; ColIndex < DTerrainMap[RowIndex].size(); ColIndex++){
-                if(ETerrainTileType::Forest == DTerrainMap[RowIndex][ColIndex]){
-                    DLumberAvailable[RowIndex][ColIndex] =  DPartials[RowIndex][ColIndex] ? InitialLumber : 0;
-                }
-                else{
-                    DLumberAvailable[RowIndex][ColIndex] =  0;
-                }
-            }
-        }
+        InitializeAvailableResources();
 
-        CTriggerHandler::LoadTriggers(source);
-
-        DStoneAvailable.resize(DTerrainMap.size());
-        for(int RowIndex = 0; RowIndex < DStoneAvailable.size(); RowIndex++){
-            DStoneAvailable[RowIndex].resize(DTerrainMap[RowIndex].size());
-            for(int ColIndex = 0; ColIndex < DTerrainMap[RowIndex].size(); ColIndex++){
-                if(ETerrainTileType::Rock == DTerrainMap[RowIndex][ColIndex]){
-                    DStoneAvailable[RowIndex][ColIndex] = DPartials[RowIndex][ColIndex] ? InitialStone : 0;
-                }
-                else{
-                    DStoneAvailable[RowIndex][ColIndex] =  0;
-                }
-            }
-        }
+        triggers = MapCacheReadAll(source);
 
         ReturnStatus = true;
     }
@@ -800,6 +1171,196 @@ LoadMapExit:
 
 }
 
+/**
+* Fills the available lumber and stone from the terrain, every full forest
+* and rock tile starts with the lumber and stone of the None resource
+*
+* @return void
+*
+*/
+
+void CAssetDecoratedMap::InitializeAvailableResources(){
+    int InitialLumber = 400;
+    int InitialStone = 400;
+
+    for(auto &Resource : DResourceInitializationList){
+        if(EPlayerColor::None == Resource.DColor){
+            InitialLumber = Resource.DLumber;
+            InitialStone = Resource.DStone;
+        }
+    }
+    DLumberAvailable.resize(DTerrainMap.size());
+    for(int RowIndex = 0; RowIndex < DLumberAvailable.size(); RowIndex++){
+        DLumberAvailable[RowIndex].resize(DTerrainMap[RowIndex].size());
+        for(int ColIndex = 0; ColIndex < DTerrainMap[RowIndex].size(); ColIndex++){
+            if(ETerrainTileType::Forest == DTerrainMap[RowIndex][ColIndex]){
+                DLumberAvailable[RowIndex][ColIndex] =  DPartials[RowIndex][ColIndex] ? InitialLumber : 0;
+            }
+            else{
+                DLumberAvailable[RowIndex][ColIndex] =  0;
+            }
+        }
+    }
+
+    DStoneAvailable.resize(DTerrainMap.size());
+    for(int RowIndex = 0; RowIndex < DStoneAvailable.size(); RowIndex++){
+        DStoneAvailable[RowIndex].resize(DTerrainMap[RowIndex].size());
+        for(int ColIndex = 0; ColIndex < DTerrainMap[RowIndex].size(); ColIndex++){
+            if(ETerrainTileType::Rock == DTerrainMap[RowIndex][ColIndex]){
+                DStoneAvailable[RowIndex][ColIndex] = DPartials[RowIndex][ColIndex] ? InitialStone : 0;
+            }
+            else{
+                DStoneAvailable[RowIndex][ColIndex] =  0;
+            }
+        }
+    }
+}
+
+/**
+* Encodes the loaded and rendered map for the map cache: the terrain types,
+* partials, tile types and indices, the resources and assets, and the
+* trigger section of the map file
+*
+* @param[in] hash The hash of the map file
+* @param[in] triggers The trigger section of the map file
+*
+* @return The cache entry
+*
+*/
+
+std::string CAssetDecoratedMap::StoreCache(uint64_t hash, const std::string &triggers) const{
+    std::string Data;
+
+    MapCacheAppend(Data, (uint32_t)MAP_CACHE_MAGIC);
+    MapCacheAppend(Data, (uint32_t)MAP_CACHE_VERSION);
+    MapCacheAppend(Data, hash);
+    MapCacheAppendString(Data, DMapName);
+    MapCacheAppend(Data, (int32_t)Width());
+    MapCacheAppend(Data, (int32_t)Height());
+    for(int Row = 0; Row < DTerrainMap.size(); Row++){
+        for(int Column = 0; Column < DTerrainMap[Row].size(); Column++){
+            MapCacheAppend(Data, (uint8_t)to_underlying(DTerrainMap[Row][Column]));
+            MapCacheAppend(Data, (uint8_t)DPartials[Row][Column]);
+        }
+    }
+    for(int Row = 0; Row < DMap.size(); Row++){
+        for(int Column = 0; Column < DMap[Row].size(); Column++){
+            MapCacheAppend(Data, (uint8_t)to_underlying(DMap[Row][Column]));
+            MapCacheAppend(Data, (int32_t)DMapIndices[Row][Column]);
+        }
+    }
+    MapCacheAppend(Data, (uint32_t)DResourceInitializationList.size());
+    for(auto &Resource : DResourceInitializationList){
+        MapCacheAppend(Data, (int32_t)to_underlying(Resource.DColor));
+        MapCacheAppend(Data, (int32_t)Resource.DGold);
+        MapCacheAppend(Data, (int32_t)Resource.DLumber);
+        MapCacheAppend(Data, (int32_t)Resource.DStone);
+    }
+    MapCacheAppend(Data, (uint32_t)DAssetInitializationList.size());
+    for(auto &Asset : DAssetInitializationList){
+        MapCacheAppendString(Data, Asset.DType);
+        MapCacheAppend(Data, (int32_t)to_underlying(Asset.DColor));
+        MapCacheAppend(Data, (int32_t)Asset.DTilePosition.X());
+        MapCacheAppend(Data, (int32_t)Asset.DTilePosition.Y());
+    }
+    MapCacheAppendString(Data, triggers);
+    return Data;
+}
+
+/**
+* Restores a map from a cache entry written by StoreCache, in place of
+* LoadMap and RenderTerrain
+*
+* @param[in] data The cache entry
+* @param[in] hash The hash of the current map file
+* @param[out] triggers The trigger section of the map file
+*
+* @return true if the entry is complete and was stored for the same map file
+*
+*/
+
+bool CAssetDecoratedMap::LoadCache(const std::string &data, uint64_t hash, std::string &triggers){
+    size_t Offset = 0;
+    uint32_t Magic, Version, Count;
+    uint64_t Hash;
+    int32_t MapWidth, MapHeight;
+    uint8_t Type, Partial;
+    int32_t Index, Color, Value[3];
+
+    if(!MapCacheRead(data, Offset, Magic) || !MapCacheRead(data, Offset, Version) || !MapCacheRead(data, Offset, Hash)){
+        return false;
+    }
+    if((MAP_CACHE_MAGIC != Magic) || (MAP_CACHE_VERSION != Version) || (hash != Hash)){
+        return false;
+    }
+    if(!MapCacheReadString(data, Offset, DMapName) || !MapCacheRead(data, Offset, MapWidth) || !MapCacheRead(data, Offset, MapHeight)){
+        return false;
+    }
+    if((8 > MapWidth) || (8 > MapHeight) || ((size_t)(MapWidth + 1) * (MapHeight + 1) * 2 + (size_t)(MapWidth + 2) * (MapHeight + 2) * 5 > data.size() - Offset)){
+        return false;
+    }
+    DTerrainMap.assign(MapHeight + 1, decltype(DTerrainMap)::value_type(MapWidth + 1));
+    DPartials.assign(MapHeight + 1, decltype(DPartials)::value_type(MapWidth + 1));
+    for(int Row = 0; Row < DTerrainMap.size(); Row++){
+        for(int Column = 0; Column < DTerrainMap[Row].size(); Column++){
+            if(!MapCacheRead(data, Offset, Type) || !MapCacheRead(data, Offset, Partial) || (to_underlying(ETerrainTileType::Max) <= Type)){
+                return false;
+            }
+            DTerrainMap[Row][Column] = static_cast< ETerrainTileType >(Type);
+            DPartials[Row][Column] = Partial;
+        }
+    }
+    DMap.assign(MapHeight + 2, decltype(DMap)::value_type(MapWidth + 2));
+    DMapIndices.assign(MapHeight + 2, decltype(DMapIndices)::value_type(MapWidth + 2));
+    for(int Row = 0; Row < DMap.size(); Row++){
+        for(int Column = 0; Column < DMap[Row].size(); Column++){
+            if(!MapCacheRead(data, Offset, Type) || !MapCacheRead(data, Offset, Index) || (to_underlying(ETileType::Max) <= Type)){
+                return false;
+            }
+            DMap[Row][Column] = static_cast< ETileType >(Type);
+            DMapIndices[Row][Column] = Index;
+        }
+    }
+    DRendered = true;
+
+    DResourceInitializationList.clear();
+    if(!MapCacheRead(data, Offset, Count)){
+        return false;
+    }
+    for(; Count; Count--){
+        SResourceInitialization TempResourceInit;
+
+        if(!MapCacheRead(data, Offset, Color) || !MapCacheRead(data, Offset, Value)){
+            return false;
+        }
+        TempResourceInit.DColor = static_cast< EPlayerColor >(Color);
+        TempResourceInit.DGold = Value[0];
+        TempResourceInit.DLumber = Value[1];
+        TempResourceInit.DStone = Value[2];
+        DResourceInitializationList.push_back(TempResourceInit);
+    }
+    DAssetInitializationList.clear();
+    if(!MapCacheRead(data, Offset, Count)){
+        return false;
+    }
+    for(; Count; Count--){
+        SAssetInitialization TempAssetInit;
+
+        if(!MapCacheReadString(data, Offset, TempAssetInit.DType) || !MapCacheRead(data, Offset, Color) || !MapCacheRead(data, Offset, Value[0]) || !MapCacheRead(data, Offset, Value[1])){
+            return false;
+        }
+        TempAssetInit.DColor = static_cast< EPlayerColor >(Color);
+        TempAssetInit.DTilePosition.X(Value[0]);
+        TempAssetInit.DTilePosition.Y(Value[1]);
+        DAssetInitializationList.push_back(TempAssetInit);
+    }
+    if(!MapCacheReadString(data, Offset, triggers)){
+        return false;
+    }
+    InitializeAvailableResources();
+    return true;
+}
+
 /**
 * Initialize the growth map 
 *
@@ -887,6 +1448,7 @@ std::shared_ptr< CAssetDecoratedMap > CAssetDecoratedMap::CreateInitializeMap()
                 Cell = 0;
             }
         }
+        ReturnMap->AccountMemory();
     }
     return ReturnMap;
 }
@@ -1124,7 +1686,48 @@ void CAssetDecoratedMap::SaveMap(std::ofstream& save) const{
 }
 
 /**
-* Replace an old map with a new map while backing up the old map
+* Gets the terrain partials row by row, used by the binary saved games
+*
+* @return The (Width() + 1) x (Height() + 1) partials
+*
+*/
+
+std::vector< uint8_t > CAssetDecoratedMap::TerrainPartials() const{
+    std::vector< uint8_t > Partials;
+
+    for(auto &Row : DPartials){
+        Partials.insert(Partials.end(), Row.begin(), Row.end());
+    }
+    return Partials;
+}
+
+/**
+* Replaces the terrain partials and renders the tile types and indices again
+*
+* @param[in] partials The partials row by row, as returned by TerrainPartials
+*
+* @return void
+*
+*/
+
+void CAssetDecoratedMap::TerrainPartials(const std::vector< uint8_t > &partials){
+    size_t Offset = 0;
+
+    for(auto &Row : DPartials){
+        for(auto &Partial : Row){
+            if(Offset < partials.size()){
+                Partial = partials[Offset++];
+            }
+        }
+    }
+    DMap.clear();
+    DMapIndices.clear();
+    RenderTerrain();
+}
+
+/**
+* Replace the terrain of a map with the terrain of a loaded game. The map
+* stays loaded until ResetMap, the map file still holds the original
 *
 * @param[in] NewMap new map to replace the old map
 * @param[in] Index index of the map to be replaced
@@ -1134,37 +1737,35 @@ void CAssetDecoratedMap::SaveMap(std::ofstream& save) const{
 */
 
 void CAssetDecoratedMap::ReplaceMap(std::shared_ptr < CAssetDecoratedMap > NewMap, int index){
-    auto OldMap = CAssetDecoratedMap::GetMap(index);
-
-    // make a copy of the old map
-    auto CopyMap = std::make_shared<CAssetDecoratedMap>(*OldMap);
-
-    // push old map to backup maps
-    DBackupMaps.push_back(CopyMap);
+    if((0 > index)||(DMapEntries.size() <= index)){
+        return;
+    }
+    auto OldMap = LoadEntry(index);
+    if(nullptr == OldMap){
+        return;
+    }
 
     // change old map with new map
-    DAllMaps[index]->DPartials = NewMap->DPartials;
-    DAllMaps[index]->DMap = NewMap->DMap;
-    DAllMaps[index]->DMapIndices = NewMap->DMapIndices;
+    OldMap->DPartials = NewMap->DPartials;
+    OldMap->DMap = NewMap->DMap;
+    OldMap->DMapIndices = NewMap->DMapIndices;
+    DMapEntries[index].DReplaced = true;
 }
 
 /**
-* Restore map from backup
+* Restore the maps replaced by loaded games, they are unloaded so the next
+* GetMap loads them from their files again
 *
 * @return void
 *
 */
 
 void CAssetDecoratedMap::ResetMap(){
-    auto OldMap = DBackupMaps.back();
-
-    // find index of the map to be replaces
-    int index = CAssetDecoratedMap::FindMapIndex(OldMap->MapName());
-
-    DAllMaps[index]->DPartials = OldMap->DPartials;
-    DAllMaps[index]->DMap = OldMap->DMap;
-    DAllMaps[index]->DMapIndices = OldMap->DMapIndices;
-
-    // clear backup
-    DBackupMaps.pop_back();
+    for(auto &Entry : DMapEntries){
+        if(Entry.DReplaced){
+            Entry.DMap = nullptr;
+            Entry.DReplaced = false;
+        }
+    }
+    EvictMaps();
 }
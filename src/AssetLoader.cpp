@@ -32,6 +32,11 @@
 */
 
 #include "AssetLoader.h"
+#include "CommentSkipLineDataSource.h"
+#include "MemoryDataSource.h"
+#include "StartupTrace.h"
+#include <algorithm>
+#include <chrono>
 
 /**
 * Constructor initializes protected data members with parameter values of the map
@@ -45,6 +50,204 @@ CAssetLoader::CAssetLoader(std::shared_ptr< CApplicationData> PassedAppData, std
     AppData = PassedAppData;
     TempDataContainer = PassedDataContainer;
     ImageDirectory = PassedImageDirectory;
+    DNextPrefetch = 0;
+    DStopping = false;
+    DWaitTime = 0.0;
+}
+
+/**
+* Destructor, stops the workers if loading was cut short
+*
+*/
+
+CAssetLoader::~CAssetLoader(){
+    StopPrefetch();
+}
+
+/**
+* Resolves the number of loader threads, a negative request picks one per
+* core up to MAX_ASSET_LOADER_THREADS, 0 loads everything on the calling
+* thread
+*
+* @param[in] requested The number of threads asked for
+*
+* @return The number of worker threads to start
+*
+*/
+
+int CAssetLoader::ThreadCount(int requested){
+    if(0 <= requested){
+        return requested;
+    }
+    return std::max(1, std::min((int)std::thread::hardware_concurrency(), MAX_ASSET_LOADER_THREADS));
+}
+
+/**
+* Starts worker threads that read the descriptors and decode their PNGs in
+* the order given, so the main thread finds the next tileset ready while it
+* recolors and registers the previous one
+*
+* @param[in] names The descriptors in the order they will be asked for
+* @param[in] threads The number of workers, 0 to not prefetch
+*
+* @return void
+*
+*/
+
+void CAssetLoader::StartPrefetch(const std::vector< std::string > &names, int threads){
+    StopPrefetch();
+    DPrefetches.clear();
+    DPrefetchIndices.clear();
+    DNextPrefetch = 0;
+    DStopping = false;
+    if(0 >= threads){
+        return;
+    }
+    for(auto &Name : names){
+        if(DPrefetchIndices.find(Name) == DPrefetchIndices.end()){
+            SPrefetch Prefetch;
+
+            Prefetch.DName = Name;
+            DPrefetchIndices[Name] = DPrefetches.size();
+            DPrefetches.push_back(Prefetch);
+        }
+    }
+    threads = std::min(threads, (int)DPrefetches.size());
+    PrintDebug(DEBUG_LOW, "Prefetching %d tilesets on %d threads\n", (int)DPrefetches.size(), threads);
+    for(int Index = 0; Index < threads; Index++){
+        DWorkers.push_back(std::thread(&CAssetLoader::PrefetchWorker, this));
+    }
+}
+
+/**
+* Worker thread, takes the next descriptor, reads it into memory and decodes
+* the PNG it names. Nothing shared is touched until the result is stored.
+*
+* @return void
+*
+*/
+
+void CAssetLoader::PrefetchWorker(){
+    while(true){
+        std::vector< char > Data;
+        std::shared_ptr< CGraphicSurface > Surface;
+        size_t Index;
+
+        {
+            std::lock_guard< std::mutex > Lock(DPrefetchMutex);
+
+            if(DStopping || (DNextPrefetch >= DPrefetches.size())){
+                return;
+            }
+            Index = DNextPrefetch++;
+        }
+        CStartupTrace Trace("Prefetch " + DPrefetches[Index].DName);
+        auto Source = ImageDirectory->DataSource(DPrefetches[Index].DName);
+        if(nullptr != Source){
+            std::string PNGPath;
+            char Buffer[4096];
+            int Length;
+
+            while(0 < (Length = Source->Read(Buffer, sizeof(Buffer)))){
+                Data.insert(Data.end(), Buffer, Buffer + Length);
+            }
+            CCommentSkipLineDataSource LineSource(std::make_shared< CMemoryDataSource >(Data), '#');
+            auto Container = Source->Container();
+
+            if(LineSource.Read(PNGPath) && (nullptr != Container)){
+                auto PNGSource = Container->DataSource(PNGPath);
+
+                if(nullptr != PNGSource){
+                    Surface = CGraphicFactory::LoadSurface(PNGSource);
+                }
+            }
+        }
+        Trace.End();
+        {
+            std::lock_guard< std::mutex > Lock(DPrefetchMutex);
+
+            DPrefetches[Index].DDescriptor.swap(Data);
+            DPrefetches[Index].DSurface = Surface;
+            DPrefetches[Index].DDone = true;
+        }
+        DPrefetchCondition.notify_all();
+    }
+}
+
+/**
+* Stops the workers once their current descriptor is done and waits for them
+*
+* @return void
+*
+*/
+
+void CAssetLoader::StopPrefetch(){
+    {
+        std::lock_guard< std::mutex > Lock(DPrefetchMutex);
+
+        DStopping = true;
+    }
+    for(auto &Worker : DWorkers){
+        Worker.join();
+    }
+    DWorkers.clear();
+}
+
+/**
+* Gets the data source of a descriptor. If it was prefetched this waits for
+* the worker and returns the descriptor from memory along with the decoded
+* PNG, otherwise, or if the worker failed, the file is opened as usual and
+* surface is nullptr so the tileset loads and reports errors itself.
+*
+* @param[in] name The name of the descriptor in the img directory
+* @param[out] surface The decoded PNG or nullptr
+*
+* @return The data source of the descriptor
+*
+*/
+
+std::shared_ptr< CDataSource > CAssetLoader::Descriptor(const std::string &name, std::shared_ptr< CGraphicSurface > &surface){
+    auto Search = DPrefetchIndices.find(name);
+
+    surface = nullptr;
+    if(Search != DPrefetchIndices.end()){
+        SPrefetch &Prefetch = DPrefetches[Search->second];
+        std::unique_lock< std::mutex > Lock(DPrefetchMutex);
+
+        // A surface is handed out once, a second tileset from the same
+        // descriptor decodes its own copy
+        if(!Prefetch.DTaken){
+            auto WaitStart = std::chrono::steady_clock::now();
+            CStartupTrace Trace("Wait " + name);
+
+            DPrefetchCondition.wait(Lock, [&Prefetch]{ return Prefetch.DDone; });
+            Trace.End();
+            DWaitTime += std::chrono::duration< double >(std::chrono::steady_clock::now() - WaitStart).count();
+            Prefetch.DTaken = true;
+            if(nullptr != Prefetch.DSurface){
+                surface = Prefetch.DSurface;
+                Prefetch.DSurface = nullptr;
+                return std::make_shared< CMemoryDataSource >(Prefetch.DDescriptor);
+            }
+        }
+    }
+    return ImageDirectory->DataSource(name);
+}
+
+/**
+* Runs one of the load functions below as a step of the start up trace
+*
+* @param[in] name The name of the step
+* @param[in] load The load function
+*
+* @return void
+*
+*/
+
+void CAssetLoader::LoadStep(const std::string &name, void (CAssetLoader::*load)()){
+    CStartupTrace Trace(name);
+
+    (this->*load)();
 }
 
 /**
@@ -56,48 +259,93 @@ CAssetLoader::CAssetLoader(std::shared_ptr< CApplicationData> PassedAppData, std
 *
 */
 void CAssetLoader::LoadAllAssets(){
-    LoadFontColors();
-    LoadFont10();
-    LoadFont12();
-    LoadFont16();
-    LoadFont24();
-    LoadMiniBevel();
-    LoadInnerBevel();
-    LoadOuterBevel();
-    LoadListViewIcons();
-    LoadRangerTrackingIcon();
-    LoadPeasantShelterIcon();
-    LoadRenderingConfiguration();
-    LoadTerrain();
-    LoadFog();
-    LoadPlayerColors();
+    // The workers decode in this order, the same order the steps below use
+    StartPrefetch({
+        "FontColors.dat",
+        "FontKingthings10.dat",
+        "FontKingthings12.dat",
+        "FontKingthings16.dat",
+        "FontKingthings24.dat",
+        "MiniBevel.dat",
+        "InnerBevel.dat",
+        "OuterBevel.dat",
+        "ListViewIcons.dat",
+        "RangerTrackingIcon.dat",
+        "PeasantShelterIcon.dat",
+        "Terrain.dat",
+        "Fog.dat",
+        "Colors.dat",
+        "Icons.dat",
+        "MiniIcons.dat",
+        "Corpse.dat",
+        "FireSmall.dat",
+        "FireLarge.dat",
+        "BuildingDeath.dat",
+        "Arrow.dat",
+        "AssetColor.dat",
+        "Peasant.dat",
+        "Footman.dat",
+        "Archer.dat",
+        "Ranger.dat",
+        "Knight.dat",
+        "GoldMine.dat",
+        "TownHall.dat",
+        "Keep.dat",
+        "Castle.dat",
+        "Farm.dat",
+        "Wall.dat",
+        "Barracks.dat",
+        "Blacksmith.dat",
+        "LumberMill.dat",
+        "ScoutTower.dat",
+        "GuardTower.dat",
+        "CannonTower.dat"
+    }, ThreadCount(AppData->DLoaderThreads));
+    AppData->DFireTilesets.clear();
+    AppData->DMapRendererConfigurationData.clear();
+    LoadStep("FontColors", &CAssetLoader::LoadFontColors);
+    LoadStep("Font10", &CAssetLoader::LoadFont10);
+    LoadStep("Font12", &CAssetLoader::LoadFont12);
+    LoadStep("Font16", &CAssetLoader::LoadFont16);
+    LoadStep("Font24", &CAssetLoader::LoadFont24);
+    LoadStep("MiniBevel", &CAssetLoader::LoadMiniBevel);
+    LoadStep("InnerBevel", &CAssetLoader::LoadInnerBevel);
+    LoadStep("OuterBevel", &CAssetLoader::LoadOuterBevel);
+    LoadStep("ListViewIcons", &CAssetLoader::LoadListViewIcons);
+    LoadStep("RangerTrackingIcon", &CAssetLoader::LoadRangerTrackingIcon);
+    LoadStep("PeasantShelterIcon", &CAssetLoader::LoadPeasantShelterIcon);
+    LoadStep("RenderingConfiguration", &CAssetLoader::LoadRenderingConfiguration);
+    LoadStep("Terrain", &CAssetLoader::LoadTerrain);
+    LoadStep("Fog", &CAssetLoader::LoadFog);
+    LoadStep("PlayerColors", &CAssetLoader::LoadPlayerColors);
     AppData->DAssetTilesets.resize(to_underlying(EAssetType::Max));
-    LoadIconAsset();
-    LoadMiniIcons();
-    LoadCorpse();
-    LoadFireSmall();
-    LoadFireLarge();
-    LoadBuildingDeath();
-    LoadArrow();
-    LoadAssetColor();
-    LoadPeasant();
-    LoadFootman();
-    LoadArcher();
-    LoadRanger();
-    LoadKnight();
-    LoadGoldMine();
-    LoadGoldVein();
-    LoadTownHall();
-    LoadKeep();
-    LoadCastle();
-    LoadFarm();
-    LoadWall();
-    LoadBarracks();
-    LoadBlacksmith();
-    LoadLumberMill();
-    LoadScoutTower();
-    LoadGuardTower();
-    LoadCannonTower();
+    LoadStep("IconAsset", &CAssetLoader::LoadIconAsset);
+    LoadStep("MiniIcons", &CAssetLoader::LoadMiniIcons);
+    LoadStep("Corpse", &CAssetLoader::LoadCorpse);
+    LoadStep("FireSmall", &CAssetLoader::LoadFireSmall);
+    LoadStep("FireLarge", &CAssetLoader::LoadFireLarge);
+    LoadStep("BuildingDeath", &CAssetLoader::LoadBuildingDeath);
+    LoadStep("Arrow", &CAssetLoader::LoadArrow);
+    LoadStep("AssetColor", &CAssetLoader::LoadAssetColor);
+    LoadStep("Peasant", &CAssetLoader::LoadPeasant);
+    LoadStep("Footman", &CAssetLoader::LoadFootman);
+    LoadStep("Archer", &CAssetLoader::LoadArcher);
+    LoadStep("Ranger", &CAssetLoader::LoadRanger);
+    LoadStep("Knight", &CAssetLoader::LoadKnight);
+    LoadStep("GoldMine", &CAssetLoader::LoadGoldMine);
+    LoadStep("GoldVein", &CAssetLoader::LoadGoldVein);
+    LoadStep("TownHall", &CAssetLoader::LoadTownHall);
+    LoadStep("Keep", &CAssetLoader::LoadKeep);
+    LoadStep("Castle", &CAssetLoader::LoadCastle);
+    LoadStep("Farm", &CAssetLoader::LoadFarm);
+    LoadStep("Wall", &CAssetLoader::LoadWall);
+    LoadStep("Barracks", &CAssetLoader::LoadBarracks);
+    LoadStep("Blacksmith", &CAssetLoader::LoadBlacksmith);
+    LoadStep("LumberMill", &CAssetLoader::LoadLumberMill);
+    LoadStep("ScoutTower", &CAssetLoader::LoadScoutTower);
+    LoadStep("GuardTower", &CAssetLoader::LoadGuardTower);
+    LoadStep("CannonTower", &CAssetLoader::LoadCannonTower);
+    StopPrefetch();
 }
 
 /**
@@ -112,9 +360,9 @@ void CAssetLoader::LoadAllAssets(){
 void CAssetLoader::LoadFontColors(){
     PrintDebug(DEBUG_LOW, "Loading FontColors\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FontColors.dat");
+    TempDataSource = Descriptor("FontColors.dat", TempSurface);
     AppData->DFontRecolorMap = std::make_shared< CGraphicRecolorMap >();
-    if(!AppData->DFontRecolorMap->Load(TempDataSource)){
+    if(!AppData->DFontRecolorMap->Load(TempDataSource, TempSurface)){
         PrintError("Failed to load font colors.\n");
         return;
     }
@@ -132,9 +380,9 @@ void CAssetLoader::LoadFontColors(){
 void CAssetLoader::LoadFont10(){
     PrintDebug(DEBUG_LOW, "Loading Font10\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FontKingthings10.dat");
+    TempDataSource = Descriptor("FontKingthings10.dat", TempSurface);
     AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Small)] = std::make_shared< CFontTileset >();
-    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Small)]->LoadFont(AppData->DFontRecolorMap, TempDataSource)){
+    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Small)]->LoadFont(AppData->DFontRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load font tileset.\n");
         return;
     }
@@ -152,9 +400,9 @@ void CAssetLoader::LoadFont10(){
 void CAssetLoader::LoadFont12(){
     PrintDebug(DEBUG_LOW, "Loading Font12\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FontKingthings12.dat");
+    TempDataSource = Descriptor("FontKingthings12.dat", TempSurface);
     AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Medium)] = std::make_shared< CFontTileset >();
-    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Medium)]->LoadFont(AppData->DFontRecolorMap, TempDataSource)){
+    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Medium)]->LoadFont(AppData->DFontRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load font tileset.\n");
         return;
     }
@@ -172,9 +420,9 @@ void CAssetLoader::LoadFont12(){
 void CAssetLoader::LoadFont16(){
     PrintDebug(DEBUG_LOW, "Loading Font16\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FontKingthings16.dat");
+    TempDataSource = Descriptor("FontKingthings16.dat", TempSurface);
     AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)] = std::make_shared< CFontTileset >();
-    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)]->LoadFont(AppData->DFontRecolorMap, TempDataSource)){
+    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)]->LoadFont(AppData->DFontRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load font tileset.\n");
         return;
     }
@@ -192,9 +440,9 @@ void CAssetLoader::LoadFont16(){
 void CAssetLoader::LoadFont24(){
     PrintDebug(DEBUG_LOW, "Loading Font24\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FontKingthings24.dat");
+    TempDataSource = Descriptor("FontKingthings24.dat", TempSurface);
     AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Giant)] = std::make_shared< CFontTileset >();
-    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Giant)]->LoadFont(AppData->DFontRecolorMap, TempDataSource)){
+    if(!AppData->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Giant)]->LoadFont(AppData->DFontRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load font tileset.\n");
         return;
     }
@@ -213,9 +461,9 @@ void CAssetLoader::LoadMiniBevel(){
     // Load the boaders for buttons and boxes
     PrintDebug(DEBUG_LOW, "Loading MiniBevel\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("MiniBevel.dat");
+    TempDataSource = Descriptor("MiniBevel.dat", TempSurface);
     AppData->DMiniBevelTileset = std::make_shared< CGraphicTileset >();
-    if(!AppData->DMiniBevelTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DMiniBevelTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load bevel tileset.\n");
         return;
     }
@@ -234,9 +482,9 @@ void CAssetLoader::LoadMiniBevel(){
 void CAssetLoader::LoadInnerBevel(){
     PrintDebug(DEBUG_LOW, "Loading InnerBevel\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("InnerBevel.dat");
+    TempDataSource = Descriptor("InnerBevel.dat", TempSurface);
     AppData->DInnerBevelTileset = std::make_shared< CGraphicTileset >();
-    if(!AppData->DInnerBevelTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DInnerBevelTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load bevel tileset.\n");
         return;
     }
@@ -255,9 +503,9 @@ void CAssetLoader::LoadInnerBevel(){
 void CAssetLoader::LoadOuterBevel(){
     PrintDebug(DEBUG_LOW, "Loading OuterBevel\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("OuterBevel.dat");
+    TempDataSource = Descriptor("OuterBevel.dat", TempSurface);
     AppData->DOuterBevelTileset = std::make_shared< CGraphicTileset >();
-    if(!AppData->DOuterBevelTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DOuterBevelTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load bevel tileset.\n");
         return;
     }
@@ -276,9 +524,9 @@ void CAssetLoader::LoadOuterBevel(){
 void CAssetLoader::LoadListViewIcons(){
     PrintDebug(DEBUG_LOW, "Loading ListViewIcons\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("ListViewIcons.dat");
+    TempDataSource = Descriptor("ListViewIcons.dat", TempSurface);
     AppData->DListViewIconTileset = std::make_shared< CGraphicTileset >();
-    if(!AppData->DListViewIconTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DListViewIconTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load list view tileset.\n");
         return;
     }
@@ -296,9 +544,9 @@ void CAssetLoader::LoadListViewIcons(){
 void CAssetLoader::LoadRangerTrackingIcon(){
     PrintDebug(DEBUG_LOW, "Loading RangerTrackingIcon\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("RangerTrackingIcon.dat");
+    TempDataSource = Descriptor("RangerTrackingIcon.dat", TempSurface);
     AppData->DRangerTrackingIcon = std::make_shared< CGraphicTileset >();
-    if(!AppData->DRangerTrackingIcon->LoadTileset(TempDataSource)){
+    if(!AppData->DRangerTrackingIcon->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load list view tileset.\n");
         return;
     }
@@ -316,9 +564,9 @@ void CAssetLoader::LoadRangerTrackingIcon(){
 void CAssetLoader::LoadPeasantShelterIcon(){
     PrintDebug(DEBUG_LOW, "Loading PeasantShelterIcon\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("PeasantShelterIcon.dat");
+    TempDataSource = Descriptor("PeasantShelterIcon.dat", TempSurface);
     AppData->DPeasantShelterIcon = std::make_shared< CGraphicTileset >();
-    if(!AppData->DPeasantShelterIcon->LoadTileset(TempDataSource)){
+    if(!AppData->DPeasantShelterIcon->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load list view tileset.\n");
         return;
     }
@@ -355,9 +603,9 @@ void CAssetLoader::LoadRenderingConfiguration(){
 void CAssetLoader::LoadTerrain(){
     PrintDebug(DEBUG_LOW, "Loading Terrain\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Terrain.dat");
+    TempDataSource = Descriptor("Terrain.dat", TempSurface);
     AppData->DTerrainTileset = std::make_shared< CGraphicTileset >();
-    if(!AppData->DTerrainTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DTerrainTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load tileset.\n");
         return;
     }
@@ -377,9 +625,9 @@ void CAssetLoader::LoadTerrain(){
 void CAssetLoader::LoadFog(){
     PrintDebug(DEBUG_LOW, "Loading Fog\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Fog.dat");
+    TempDataSource = Descriptor("Fog.dat", TempSurface);
     AppData->DFogTileset = std::make_shared< CGraphicTileset >();
-    if(!AppData->DFogTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DFogTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load tileset.\n");
         return;
     }
@@ -398,9 +646,9 @@ void CAssetLoader::LoadPlayerColors(){
     // Load icons and play colors/icons etc.
     PrintDebug(DEBUG_LOW, "Loading Player Colors\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Colors.dat");
+    TempDataSource = Descriptor("Colors.dat", TempSurface);
     AppData->DPlayerRecolorMap = std::make_shared< CGraphicRecolorMap > ();
-    if(!AppData->DPlayerRecolorMap->Load(TempDataSource)){
+    if(!AppData->DPlayerRecolorMap->Load(TempDataSource, TempSurface)){
         PrintError("Failed to load recolor map.\n");
         return;
     }
@@ -418,9 +666,9 @@ void CAssetLoader::LoadPlayerColors(){
 void CAssetLoader::LoadIconAsset(){
     PrintDebug(DEBUG_LOW, "Loading Icons\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Icons.dat");
+    TempDataSource = Descriptor("Icons.dat", TempSurface);
     AppData->DIconTileset = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DIconTileset->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DIconTileset->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load icons.\n");
         return;
     }
@@ -438,9 +686,9 @@ void CAssetLoader::LoadIconAsset(){
 void CAssetLoader::LoadMiniIcons(){
     PrintDebug(DEBUG_LOW, "Loading Mini Icons\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("MiniIcons.dat");
+    TempDataSource = Descriptor("MiniIcons.dat", TempSurface);
     AppData->DMiniIconTileset = std::make_shared< CGraphicTileset > ();
-    if(!AppData->DMiniIconTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DMiniIconTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load mini icons.\n");
         return;
     }
@@ -459,9 +707,9 @@ void CAssetLoader::LoadMiniIcons(){
 void CAssetLoader::LoadCorpse(){
     PrintDebug(DEBUG_LOW, "Loading Corpse\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Corpse.dat");
+    TempDataSource = Descriptor("Corpse.dat", TempSurface);
     AppData->DCorpseTileset = std::make_shared< CGraphicTileset > ();
-    if(!AppData->DCorpseTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DCorpseTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load corpse tileset.\n");
         return;
     }
@@ -480,9 +728,9 @@ void CAssetLoader::LoadCorpse(){
 void CAssetLoader::LoadFireSmall(){
     PrintDebug(DEBUG_LOW, "Loading FireSmall\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FireSmall.dat");
+    TempDataSource = Descriptor("FireSmall.dat", TempSurface);
     auto FireTileset = std::make_shared< CGraphicTileset > ();
-    if(!FireTileset->LoadTileset(TempDataSource)){
+    if(!FireTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load fire small tileset.\n");
         return;
     }
@@ -502,9 +750,9 @@ void CAssetLoader::LoadFireSmall(){
 void CAssetLoader::LoadFireLarge(){
     PrintDebug(DEBUG_LOW, "Loading FireLarge\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("FireLarge.dat");
+    TempDataSource = Descriptor("FireLarge.dat", TempSurface);
     auto FireTileset = std::make_shared< CGraphicTileset > ();
-    if(!FireTileset->LoadTileset(TempDataSource)){
+    if(!FireTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load fire large tileset.\n");
         return;
     }
@@ -524,9 +772,9 @@ void CAssetLoader::LoadFireLarge(){
 void CAssetLoader::LoadBuildingDeath(){
     PrintDebug(DEBUG_LOW, "Loading BuildingDeath\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("BuildingDeath.dat");
+    TempDataSource = Descriptor("BuildingDeath.dat", TempSurface);
     AppData->DBuildingDeathTileset = std::make_shared< CGraphicTileset > ();
-    if(!AppData->DBuildingDeathTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DBuildingDeathTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load building death tileset.\n");
         return;
     }
@@ -544,9 +792,9 @@ void CAssetLoader::LoadBuildingDeath(){
 
 void CAssetLoader::LoadArrow(){
     PrintDebug(DEBUG_LOW, "Loading Arrow\n");
-    TempDataSource = ImageDirectory->DataSource("Arrow.dat");
+    TempDataSource = Descriptor("Arrow.dat", TempSurface);
     AppData->DArrowTileset = std::make_shared< CGraphicTileset > ();
-    if(!AppData->DArrowTileset->LoadTileset(TempDataSource)){
+    if(!AppData->DArrowTileset->LoadTileset(TempDataSource, TempSurface)){
         PrintError("Failed to load arrow tileset.\n");
         return;
     }
@@ -565,9 +813,9 @@ void CAssetLoader::LoadArrow(){
 void CAssetLoader::LoadAssetColor(){
     PrintDebug(DEBUG_LOW, "Loading AssetColor\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("AssetColor.dat");
+    TempDataSource = Descriptor("AssetColor.dat", TempSurface);
     AppData->DAssetRecolorMap = std::make_shared< CGraphicRecolorMap > ();
-    if(!AppData->DAssetRecolorMap->Load(TempDataSource)){
+    if(!AppData->DAssetRecolorMap->Load(TempDataSource, TempSurface)){
         PrintError("Failed to load asset color map.\n");
         return;
     }
@@ -586,9 +834,9 @@ void CAssetLoader::LoadAssetColor(){
 void CAssetLoader::LoadPeasant(){
     PrintDebug(DEBUG_LOW, "Loading Peasant\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Peasant.dat");
+    TempDataSource = Descriptor("Peasant.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Peasant)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Peasant)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Peasant)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load peasant tileset.\n");
         return;
     }
@@ -606,9 +854,9 @@ void CAssetLoader::LoadPeasant(){
 void CAssetLoader::LoadFootman(){
     PrintDebug(DEBUG_LOW, "Loading Footman\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Footman.dat");
+    TempDataSource = Descriptor("Footman.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Footman)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Footman)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Footman)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load footman tileset.\n");
         return;
     }
@@ -626,9 +874,9 @@ void CAssetLoader::LoadFootman(){
 void CAssetLoader::LoadArcher(){
     PrintDebug(DEBUG_LOW, "Loading Archer\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Archer.dat");
+    TempDataSource = Descriptor("Archer.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Archer)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Archer)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Archer)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load archer tileset.\n");
         return;
     }
@@ -646,9 +894,9 @@ void CAssetLoader::LoadArcher(){
 void CAssetLoader::LoadRanger(){
     PrintDebug(DEBUG_LOW, "Loading Ranger\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Ranger.dat");
+    TempDataSource = Descriptor("Ranger.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Ranger)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Ranger)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Ranger)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load archer tileset.\n");
         return;
     }
@@ -666,9 +914,9 @@ void CAssetLoader::LoadRanger(){
 void CAssetLoader::LoadKnight(){
     PrintDebug(DEBUG_LOW, "Loading Knight\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Knight.dat");
+    TempDataSource = Descriptor("Knight.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Knight)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Knight)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Knight)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load Knight tileset.\n");
         return;
     }
@@ -687,9 +935,9 @@ void CAssetLoader::LoadKnight(){
 void CAssetLoader::LoadGoldMine(){
     PrintDebug(DEBUG_LOW, "Loading GoldMine\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("GoldMine.dat");
+    TempDataSource = Descriptor("GoldMine.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::GoldMine)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::GoldMine)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::GoldMine)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load gold mine tileset.\n");
         return;
     }
@@ -707,9 +955,9 @@ void CAssetLoader::LoadGoldMine(){
 void CAssetLoader::LoadGoldVein(){
     PrintDebug(DEBUG_LOW, "Loading GoldVein\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("GoldMine.dat");
+    TempDataSource = Descriptor("GoldMine.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::GoldVein)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::GoldVein)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::GoldVein)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load gold vein tileset.\n");
         return;
     }
@@ -727,9 +975,9 @@ void CAssetLoader::LoadGoldVein(){
 void CAssetLoader::LoadTownHall(){
     PrintDebug(DEBUG_LOW, "Loading TownHall\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("TownHall.dat");
+    TempDataSource = Descriptor("TownHall.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::TownHall)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::TownHall)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::TownHall)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load town hall tileset.\n");
         return;
     }
@@ -747,9 +995,9 @@ void CAssetLoader::LoadTownHall(){
 void CAssetLoader::LoadKeep(){
     PrintDebug(DEBUG_LOW, "Loading Keep\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Keep.dat");
+    TempDataSource = Descriptor("Keep.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Keep)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Keep)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Keep)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load keep tileset.\n");
         return;
     }
@@ -767,9 +1015,9 @@ void CAssetLoader::LoadKeep(){
 void CAssetLoader::LoadCastle(){
     PrintDebug(DEBUG_LOW, "Loading Castle\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Castle.dat");
+    TempDataSource = Descriptor("Castle.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Castle)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Castle)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Castle)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load castle tileset.\n");
         return;
     }
@@ -787,9 +1035,9 @@ void CAssetLoader::LoadCastle(){
 void CAssetLoader::LoadFarm(){
     PrintDebug(DEBUG_LOW, "Loading Farm\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Farm.dat");
+    TempDataSource = Descriptor("Farm.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Farm)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Farm)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Farm)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load farm tileset.\n");
         return;
     }
@@ -807,9 +1055,9 @@ void CAssetLoader::LoadFarm(){
 void CAssetLoader::LoadWall(){
     PrintDebug(DEBUG_LOW, "Loading Wall\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Wall.dat");
+    TempDataSource = Descriptor("Wall.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Wall)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Wall)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Wall)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load wall tileset.\n");
         return;
     }
@@ -827,9 +1075,9 @@ void CAssetLoader::LoadWall(){
 void CAssetLoader::LoadBarracks(){
     PrintDebug(DEBUG_LOW, "Loading Barracks\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Barracks.dat");
+    TempDataSource = Descriptor("Barracks.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Barracks)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Barracks)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Barracks)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load barracks tileset.\n");
         return;
     }
@@ -847,9 +1095,9 @@ void CAssetLoader::LoadBarracks(){
 void CAssetLoader::LoadBlacksmith(){
     PrintDebug(DEBUG_LOW, "Loading Blacksmith\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("Blacksmith.dat");
+    TempDataSource = Descriptor("Blacksmith.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::Blacksmith)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Blacksmith)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::Blacksmith)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load blacksmith tileset.\n");
         return;
     }
@@ -867,9 +1115,9 @@ void CAssetLoader::LoadBlacksmith(){
 void CAssetLoader::LoadLumberMill(){
     PrintDebug(DEBUG_LOW, "Loading LumberMill\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("LumberMill.dat");
+    TempDataSource = Descriptor("LumberMill.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::LumberMill)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::LumberMill)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::LumberMill)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load lumber mill tileset.\n");
         return;
     }
@@ -887,9 +1135,9 @@ void CAssetLoader::LoadLumberMill(){
 void CAssetLoader::LoadScoutTower(){
     PrintDebug(DEBUG_LOW, "Loading ScoutTower\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("ScoutTower.dat");
+    TempDataSource = Descriptor("ScoutTower.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::ScoutTower)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::ScoutTower)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::ScoutTower)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load scout tower tileset.\n");
         return;
     }
@@ -908,9 +1156,9 @@ void CAssetLoader::LoadScoutTower(){
 void CAssetLoader::LoadGuardTower(){
     PrintDebug(DEBUG_LOW, "Loading GuardTower\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("GuardTower.dat");
+    TempDataSource = Descriptor("GuardTower.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::GuardTower)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::GuardTower)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::GuardTower)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load guard tower tileset.\n");
         return;
     }
@@ -928,9 +1176,9 @@ void CAssetLoader::LoadGuardTower(){
 void CAssetLoader::LoadCannonTower(){
     PrintDebug(DEBUG_LOW, "Loading CannonTower\n");
     AppData->RenderSplashStep();
-    TempDataSource = ImageDirectory->DataSource("CannonTower.dat");
+    TempDataSource = Descriptor("CannonTower.dat", TempSurface);
     AppData->DAssetTilesets[to_underlying(EAssetType::CannonTower)] = std::make_shared< CGraphicMulticolorTileset > ();
-    if(!AppData->DAssetTilesets[to_underlying(EAssetType::CannonTower)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource)){
+    if(!AppData->DAssetTilesets[to_underlying(EAssetType::CannonTower)]->LoadTileset(AppData->DPlayerRecolorMap, TempDataSource, TempSurface)){
         PrintError("Failed to load cannon tower tileset.\n");
         return;
     }
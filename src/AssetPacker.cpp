@@ -0,0 +1,180 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CAssetPacker
+*
+* @brief Packs the data directory into a CAssetArchive. The archive is
+*     written next to the data directory by default, where the game picks it
+*     up in place of the loose files. Every entry is read back and compared
+*     with the file it was packed from before the packer reports success.
+*
+*     Started with "--pack-assets", see PrintUsage for the other options.
+*
+*/
+
+#include "AssetPacker.h"
+#include "AssetArchive.h"
+#include "ApplicationPath.h"
+#include "FileDataSource.h"
+#include "Debug.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/**
+* Constructor, stores the options.
+*
+* @param[in] options The parsed packer options
+*
+*/
+
+CAssetPacker::CAssetPacker(const SOptions &options){
+    DOptions = options;
+}
+
+/**
+* Parses the command line for the packer options. The packer is only
+* enabled if "--pack-assets" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if packing was requested
+*
+*/
+
+bool CAssetPacker::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--pack-assets" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--data" == Argument){
+            options.DDataPath = Value;
+        }
+        else if("--output" == Argument){
+            options.DOutputPath = Value;
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown pack assets option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the packer options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CAssetPacker::PrintUsage(const char *program){
+    PrintError("Usage: %s --pack-assets [options]\n", program);
+    PrintError("  --data DIR        data directory (default: data next to the executable)\n");
+    PrintError("  --output FILE     archive to write (default: the data directory plus %s)\n", ASSET_ARCHIVE_EXTENSION);
+}
+
+/**
+* Reads every entry of the archive back and compares it with the file it was
+* packed from.
+*
+* @param[in] datapath The data directory that was packed
+* @param[in] outputpath The archive that was written
+*
+* @return true if every entry matches
+*
+*/
+
+bool CAssetPacker::Verify(const std::string &datapath, const std::string &outputpath){
+    auto Archive = CAssetArchive::Open(outputpath);
+    std::vector< char > Buffer;
+
+    if(nullptr == Archive){
+        return false;
+    }
+    for(size_t Index = 0; Index < Archive->EntryCount(); Index++){
+        const CAssetArchive::SEntry &Entry = Archive->Entry(Index);
+        std::string Name(Entry.DName, Entry.DNameLength);
+        CFileDataSource Source(datapath + "/" + Name);
+        size_t Offset = 0;
+        int Length;
+
+        Buffer.resize(DEFAULT_DATA_SOURCE_BLOCK_SIZE);
+        while(0 < (Length = Source.Read(Buffer.data(), Buffer.size()))){
+            if((Offset + Length > Entry.DSize) || memcmp(Archive->Data(Entry) + Offset, Buffer.data(), Length)){
+                break;
+            }
+            Offset += Length;
+        }
+        if((0 < Length) || (Offset != Entry.DSize)){
+            PrintError("Archived %s differs from the file.\n", Name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* Packs the data directory and verifies the archive.
+*
+* @return 0 on success, 1 if the archive could not be written or differs
+*
+*/
+
+int CAssetPacker::Run(){
+    std::string DataPath = DOptions.DDataPath;
+    std::string OutputPath = DOptions.DOutputPath;
+    size_t Entries = 0, Bytes = 0;
+
+    if(DataPath.empty()){
+        DataPath = GetApplicationPath().Containing().ToString() + "/data";
+    }
+    while((1 < DataPath.length()) && ('/' == DataPath.back())){
+        DataPath.pop_back();
+    }
+    if(OutputPath.empty()){
+        OutputPath = DataPath + ASSET_ARCHIVE_EXTENSION;
+    }
+
+    auto Start = std::chrono::steady_clock::now();
+    if(!CAssetArchive::Build(DataPath, OutputPath, Entries, Bytes)){
+        return 1;
+    }
+    double Seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - Start).count();
+    if(!Verify(DataPath, OutputPath)){
+        PrintError("Failed to verify asset archive %s.\n", OutputPath.c_str());
+        return 1;
+    }
+    printf("Packed %d files from %s into %s, %d bytes in %.1f ms\n", (int)Entries, DataPath.c_str(), OutputPath.c_str(), (int)Bytes, Seconds * 1000.0);
+    return 0;
+}
@@ -43,6 +43,7 @@
 
 #define TARGET_FREQUENCY        10
 int CAssetRenderer::DAnimationDownsample = 1;
+bool CAssetRenderer::DRetainRenderItems = true;
 
 /**
  * Constructor to initialize the default settings for the game
@@ -70,6 +71,9 @@ CAssetRenderer::CAssetRenderer(std::shared_ptr< CGraphicRecolorMap > colors, std
     DPlayerData = player;
     DPlayerMap = map;
     DActualMap = DPlayerData ? DPlayerData->ActualMap() : nullptr;
+    DRenderGeneration = 0;
+    DRenderDownsample = DAnimationDownsample;
+    DRenderCycle = -1;
 
     DPixelColors.resize(to_underlying(EPlayerColor::Max) + 3);
     DPixelColors[to_underlying(EPlayerColor::None)] = colors->ColorValue(colors->FindColor("none"), 0);
@@ -397,16 +401,21 @@ int CAssetRenderer::UpdateFrequency(int freq){
     return freq;
 }
 
-using SAssetRenderData = struct ASSETRENDERERDATA_TAG{
-    EAssetType DType;
-    int DX;
-    int DY;
-    int DBottomY;
-    int DTileIndex;
-    int DColorIndex;
-    uint32_t DPixelColor;
-    bool RangerInForest;
-};
+/**
+ * Turns the retained render items on or off. With retention off every item
+ * is recomputed and fully sorted on each draw call, the way the assets were
+ * rendered before the items were retained. Used to benchmark the two.
+ *
+ * @param[in] retain true to keep the render items between frames
+ *
+ * @return The previous setting
+ */
+bool CAssetRenderer::RetainRenderItems(bool retain){
+    bool Previous = DRetainRenderItems;
+
+    DRetainRenderItems = retain;
+    return Previous;
+}
 
 /**
  * Used to determine the order in which assets should be rendered by
@@ -415,7 +424,7 @@ using SAssetRenderData = struct ASSETRENDERERDATA_TAG{
  * @param[in] first Data from first asset to be compared
  * @param[in[ second Data from second asset to be compared
  *
- * @return True if first is rendered first, false otherwise
+ * @return True if first must be rendered before second, false otherwise
  */
 bool CompareRenderData(const SAssetRenderData &first, const SAssetRenderData &second){
     if(first.DBottomY < second.DBottomY){
@@ -425,12 +434,324 @@ bool CompareRenderData(const SAssetRenderData &first, const SAssetRenderData &se
         return false;
     }
 
-    return first.DX <= second.DX;
+    return first.DX < second.DX;
+}
+
+/**
+ * Determines if any of the asset state that the rendered tile depends on has
+ * changed since the render item was last computed. Walls are always
+ * recomputed since their tile depends on the neighboring walls.
+ *
+ * @param[in] item The retained render item for the asset
+ * @param[in] asset The asset being rendered
+ *
+ * @return True if the render data must be recomputed
+ */
+bool CAssetRenderer::RenderItemChanged(const SAssetRenderItem &item, const std::shared_ptr< CPlayerAsset > &asset) const{
+    if(!item.DValid){
+        return true;
+    }
+    if((item.DType != asset->Type())||(EAssetType::Wall == item.DType)){
+        return true;
+    }
+    if((item.DAction != asset->Action())||(item.DStep != asset->Step())||(item.DDirection != asset->Direction())){
+        return true;
+    }
+    if((item.DPositionX != asset->PositionX())||(item.DPositionY != asset->PositionY())){
+        return true;
+    }
+    if((item.DColor != asset->Color())||(item.DHitPoints != asset->HitPoints())||(item.DInForest != asset->DInForest)){
+        return true;
+    }
+    if(item.DCarrying != (asset->Lumber() ? 1 : asset->Gold() ? 2 : asset->Stone() ? 3 : 0)){
+        return true;
+    }
+    if(EAssetAction::Capability == item.DAction){
+        return item.DCapability != asset->CurrentCommand().DCapability;
+    }
+    return false;
+}
+
+/**
+ * Computes the tile index, color and map position (in map pixels) of an
+ * asset and records the state it was computed from in the render item.
+ *
+ * @param[in,out] item The retained render item to update
+ *
+ * @return None
+ */
+void CAssetRenderer::ComputeRenderData(SAssetRenderItem &item){
+    auto AssetIterator = item.DAsset;
+    SAssetRenderData &TempRenderData = item.DRenderData;
+
+    item.DType = AssetIterator->Type();
+    item.DAction = AssetIterator->Action();
+    item.DStep = AssetIterator->Step();
+    item.DDirection = AssetIterator->Direction();
+    item.DPositionX = AssetIterator->PositionX();
+    item.DPositionY = AssetIterator->PositionY();
+    item.DColor = AssetIterator->Color();
+    item.DHitPoints = AssetIterator->HitPoints();
+    item.DInForest = AssetIterator->DInForest;
+    item.DCarrying = AssetIterator->Lumber() ? 1 : AssetIterator->Gold() ? 2 : AssetIterator->Stone() ? 3 : 0;
+    item.DCapability = EAssetAction::Capability == item.DAction ? AssetIterator->CurrentCommand().DCapability : EAssetCapabilityType::None;
+    item.DValid = true;
+
+    TempRenderData.DType = item.DType;
+    TempRenderData.RangerInForest = item.DInForest;
+    TempRenderData.DTileIndex = -1;
+    TempRenderData.DX = item.DPositionX;
+    TempRenderData.DY = item.DPositionY;
+    TempRenderData.DBottomY = item.DPositionY;
+    if(EAssetType::None == TempRenderData.DType){
+        return;
+    }
+    if(EAssetType::Wall == TempRenderData.DType){
+        PrintDebug(DEBUG_LOW, "Wall action = %d\n", (int)AssetIterator->Action());
+    }
+    if((0 <= to_underlying(TempRenderData.DType))&&(to_underlying(TempRenderData.DType) < static_cast<int>(DTilesets.size()))){
+        CPixelType PixelType(*AssetIterator);
+        TempRenderData.DX = AssetIterator->PositionX() + (AssetIterator->Size() - 1) * CPosition::HalfTileWidth() - DTilesets[to_underlying(TempRenderData.DType)]->TileHalfWidth();
+        TempRenderData.DY = AssetIterator->PositionY() + (AssetIterator->Size() - 1) * CPosition::HalfTileHeight() - DTilesets[to_underlying(TempRenderData.DType)]->TileHalfHeight();
+        TempRenderData.DPixelColor = PixelType.ToPixelColor();
+
+        TempRenderData.DBottomY = TempRenderData.DY + DTilesets[to_underlying(TempRenderData.DType)]->TileHeight() - 1;
+        TempRenderData.DColorIndex = to_underlying(AssetIterator->Color()) ? to_underlying(AssetIterator->Color()) - 1 : to_underlying(AssetIterator->Color());
+        int ActionSteps, CurrentStep, TileIndex;
+        switch(AssetIterator->Action()){
+            case EAssetAction::Build:           ActionSteps = DBuildIndices[to_underlying(TempRenderData.DType)].size();
+                                                ActionSteps /= to_underlying(EDirection::Max);
+                                                if(ActionSteps){
+                                                    TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                    TempRenderData.DTileIndex = DBuildIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                }
+                                                break;
+            case EAssetAction::Construct:       ActionSteps = DConstructIndices[to_underlying(TempRenderData.DType)].size();
+                                                if(ActionSteps){
+                                                    int TotalSteps = AssetIterator->BuildTime() * CPlayerAsset::UpdateFrequency();
+                                                    int CurrentStep = AssetIterator->Step() * ActionSteps / TotalSteps;
+                                                    if(CurrentStep == DConstructIndices[to_underlying(TempRenderData.DType)].size()){
+                                                        CurrentStep--;
+                                                    }
+                                                    TempRenderData.DTileIndex = DConstructIndices[to_underlying(TempRenderData.DType)][CurrentStep];
+                                                }
+                                                break;
+            case EAssetAction::Walk:            if(AssetIterator->Lumber()){
+                                                    ActionSteps = DCarryLumberIndices[to_underlying(TempRenderData.DType)].size();
+                                                    ActionSteps /= to_underlying(EDirection::Max);
+                                                    TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                    TempRenderData.DTileIndex = DCarryLumberIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                }
+                                                else if(AssetIterator->Gold()){
+                                                    ActionSteps = DCarryGoldIndices[to_underlying(TempRenderData.DType)].size();
+                                                    ActionSteps /= to_underlying(EDirection::Max);
+                                                    TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                    TempRenderData.DTileIndex = DCarryGoldIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                }
+                                                else if(AssetIterator->Stone()){
+                                                    ActionSteps = DCarryStoneIndices[to_underlying(TempRenderData.DType)].size();
+                                                    ActionSteps /= to_underlying(EDirection::Max);
+                                                    TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                    TempRenderData.DTileIndex = DCarryStoneIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                }
+                                                else{
+                                                    ActionSteps = DWalkIndices[to_underlying(TempRenderData.DType)].size();
+                                                    ActionSteps /= to_underlying(EDirection::Max);
+                                                    TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                    TempRenderData.DTileIndex = DWalkIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                }
+                                                break;
+            case EAssetAction::Attack:          CurrentStep = AssetIterator->Step() % (AssetIterator->AttackSteps() + AssetIterator->ReloadSteps());
+                                                if(CurrentStep < AssetIterator->AttackSteps()){
+                                                    ActionSteps = DAttackIndices[to_underlying(TempRenderData.DType)].size();
+                                                    ActionSteps /= to_underlying(EDirection::Max);
+                                                    TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + (CurrentStep * ActionSteps / AssetIterator->AttackSteps());
+                                                    TempRenderData.DTileIndex = DAttackIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                }
+                                                else{
+                                                    TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
+                                                }
+                                                break;
+            case EAssetAction::Repair:
+            case EAssetAction::HarvestLumber:   ActionSteps = DAttackIndices[to_underlying(TempRenderData.DType)].size();
+                                                ActionSteps /= to_underlying(EDirection::Max);
+                                                TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                TempRenderData.DTileIndex = DAttackIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                break;
+            case EAssetAction::QuarryStone:     ActionSteps = DAttackIndices[to_underlying(TempRenderData.DType)].size();
+                                                ActionSteps /= to_underlying(EDirection::Max);
+                                                TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
+                                                TempRenderData.DTileIndex = DAttackIndices[to_underlying(TempRenderData.DType)][TileIndex];
+                                                break;
+            case EAssetAction::MineGold:        break;
+            case EAssetAction::StandGround:
+            case EAssetAction::None:            TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
+                                                if(AssetIterator->Speed()){
+                                                    if(AssetIterator->Lumber()){
+                                                        ActionSteps = DCarryLumberIndices[to_underlying(TempRenderData.DType)].size();
+                                                        ActionSteps /= to_underlying(EDirection::Max);
+                                                        TempRenderData.DTileIndex = DCarryLumberIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps];
+                                                    }
+                                                    else if(AssetIterator->Gold()){
+                                                        ActionSteps = DCarryGoldIndices[to_underlying(TempRenderData.DType)].size();
+                                                        ActionSteps /= to_underlying(EDirection::Max);
+                                                        TempRenderData.DTileIndex = DCarryGoldIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps];
+                                                    }
+                                                    else if(AssetIterator->Stone()){
+                                                        ActionSteps = DCarryStoneIndices[to_underlying(TempRenderData.DType)].size();
+                                                        ActionSteps /= to_underlying(EDirection::Max);
+                                                        TempRenderData.DTileIndex = DCarryStoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps];
+                                                    }
+                                                }
+                                                else if(EAssetType::GoldVein == AssetIterator->Type()){
+                                                    TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][0];
+                                                    PrintDebug(DEBUG_LOW, "Vein Tile Index = %d\n", TempRenderData.DTileIndex);
+                                                }
+                                                else if(EAssetType::Wall == TempRenderData.DType) {
+                                                    if((float)(AssetIterator->HitPoints())/(float)(AssetIterator->MaxHitPoints()) < 0.5){
+                                                        TempRenderData.DTileIndex = DWallIndices[to_underlying(EWallStatus::Damaged)][DActualMap->DWallIndices[AssetIterator->TilePositionY()][AssetIterator->TilePositionX()]][0];
+                                                    }
+                                                    else{
+                                                        TempRenderData.DTileIndex = DWallIndices[to_underlying(EWallStatus::None)][DActualMap->DWallIndices[AssetIterator->TilePositionY()][AssetIterator->TilePositionX()]][0];
+                                                    }
+                                                }
+                                                break;
+            case EAssetAction::Capability:      if(AssetIterator->Speed()){
+                                                    if((EAssetCapabilityType::Patrol == AssetIterator->CurrentCommand().DCapability)||(EAssetCapabilityType::StandGround == AssetIterator->CurrentCommand().DCapability)){
+                                                        TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
+                                                    }
+                                                }
+                                                else{
+                                                    // Buildings
+                                                    TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
+                                                }
+                                                break;
+            case EAssetAction::Death:           ActionSteps = DDeathIndices[to_underlying(TempRenderData.DType)].size();
+                                                if(AssetIterator->Speed()){
+                                                    ActionSteps /= to_underlying(EDirection::Max);
+                                                    if(ActionSteps){
+                                                        CurrentStep = AssetIterator->Step() / DAnimationDownsample;
+                                                        if(CurrentStep >= ActionSteps){
+                                                            CurrentStep = ActionSteps - 1;
+                                                        }
+                                                        TempRenderData.DTileIndex = DDeathIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps + CurrentStep];
+                                                    }
+                                                }
+                                                else{
+                                                    if(AssetIterator->Step() < DBuildingDeathTileset->TileCount()){
+                                                        TempRenderData.DTileIndex = DTilesets[to_underlying(TempRenderData.DType)]->TileCount() + AssetIterator->Step();
+                                                        TempRenderData.DX += DTilesets[to_underlying(TempRenderData.DType)]->TileHalfWidth() - DBuildingDeathTileset->TileHalfWidth();
+                                                        TempRenderData.DY += DTilesets[to_underlying(TempRenderData.DType)]->TileHalfHeight() - DBuildingDeathTileset->TileHalfHeight();
+                                                    }
+                                                }
+            default:                            break;
+        }
+    }
+}
+
+/**
+ * Brings the retained render items up to date with the assets on the player
+ * map. Items are only recomputed when the asset's action, step, direction,
+ * position (or other state the tile depends on) changes. Assets that are new
+ * are appended and assets that are gone are dropped, then the draw order is
+ * re-sorted with an insertion sort since it is nearly sorted from the prior
+ * frame. The items are shared by all of the asset render passes, so the
+ * update is skipped if it was already done for the current game cycle. With
+ * retention turned off the items are rebuilt and sorted on every call.
+ *
+ * @return None
+ */
+void CAssetRenderer::UpdateRenderItems(){
+    bool Removed = false;
+
+    if(!DRetainRenderItems){
+        DRenderItems.clear();
+        DRenderOrder.clear();
+        DFreeRenderItems.clear();
+        DRenderItemLookup.clear();
+    }
+    // Assets only change when the game model advances a cycle
+    else if(DPlayerData && (DPlayerData->GameCycle() == DRenderCycle) && (DRenderItemLookup.size() == DPlayerMap->Assets().size()) && (DRenderDownsample == DAnimationDownsample)){
+        return;
+    }
+    DRenderCycle = DPlayerData ? DPlayerData->GameCycle() : -1;
+
+    if(DRenderDownsample != DAnimationDownsample){
+        DRenderDownsample = DAnimationDownsample;
+        for(auto &Item : DRenderItems){
+            Item.DValid = false;
+        }
+    }
+    DRenderGeneration++;
+    for(auto &Asset : DPlayerMap->Assets()){
+        auto Search = DRenderItemLookup.find(Asset.get());
+        int ItemIndex;
+
+        if(DRenderItemLookup.end() == Search){
+            if(DFreeRenderItems.size()){
+                ItemIndex = DFreeRenderItems.back();
+                DFreeRenderItems.pop_back();
+            }
+            else{
+                ItemIndex = DRenderItems.size();
+                DRenderItems.resize(ItemIndex + 1);
+            }
+            DRenderItems[ItemIndex].DAsset = Asset;
+            DRenderItems[ItemIndex].DValid = false;
+            DRenderItemLookup[Asset.get()] = ItemIndex;
+            DRenderOrder.push_back(ItemIndex);
+        }
+        else{
+            ItemIndex = Search->second;
+        }
+        SAssetRenderItem &Item = DRenderItems[ItemIndex];
+        Item.DGeneration = DRenderGeneration;
+        if(RenderItemChanged(Item, Asset)){
+            ComputeRenderData(Item);
+        }
+    }
+    if(DRenderItemLookup.size() != DPlayerMap->Assets().size()){
+        for(auto Search = DRenderItemLookup.begin(); Search != DRenderItemLookup.end();){
+            SAssetRenderItem &Item = DRenderItems[Search->second];
+            if(Item.DGeneration != DRenderGeneration){
+                Item.DAsset.reset();
+                Item.DValid = false;
+                DFreeRenderItems.push_back(Search->second);
+                Search = DRenderItemLookup.erase(Search);
+                Removed = true;
+            }
+            else{
+                Search++;
+            }
+        }
+    }
+    if(Removed){
+        DRenderOrder.erase(std::remove_if(DRenderOrder.begin(), DRenderOrder.end(), [this](int index){
+            return DRenderItems[index].DGeneration != DRenderGeneration;
+        }), DRenderOrder.end());
+    }
+    if(!DRetainRenderItems){
+        std::sort(DRenderOrder.begin(), DRenderOrder.end(), [this](int first, int second){
+            return CompareRenderData(DRenderItems[first].DRenderData, DRenderItems[second].DRenderData);
+        });
+        return;
+    }
+    for(size_t Index = 1; Index < DRenderOrder.size(); Index++){
+        int Current = DRenderOrder[Index];
+        size_t Position = Index;
+
+        while(Position && CompareRenderData(DRenderItems[Current].DRenderData, DRenderItems[DRenderOrder[Position - 1]].DRenderData)){
+            DRenderOrder[Position] = DRenderOrder[Position - 1];
+            Position--;
+        }
+        DRenderOrder[Position] = Current;
+    }
 }
 
 /**
  * Used to render assets on the map after establishing the order
- * in which they should be rendered.
+ * in which they should be rendered. The retained render items are
+ * updated first, then the already sorted items are culled and drawn.
  *
  * @param[in] surface The ground tileset, new assets are rendered on top of this
  * @param[in] typesurface For use with GraphicFactoryCairo surface creation function
@@ -442,187 +763,34 @@ bool CompareRenderData(const SAssetRenderData &first, const SAssetRenderData &se
 void CAssetRenderer::DrawAssets(std::shared_ptr<CGraphicSurface> surface, std::shared_ptr<CGraphicSurface> typesurface, const SRectangle &rect){
     int ScreenRightX = rect.DXPosition + rect.DWidth - 1;
     int ScreenBottomY = rect.DYPosition + rect.DHeight - 1;
-    std::list< SAssetRenderData > FinalRenderList;
 
-    for(auto &AssetIterator : DPlayerMap->Assets()){
-        SAssetRenderData TempRenderData;
-        TempRenderData.DType = AssetIterator->Type();
-        if(AssetIterator->DInForest){
-            TempRenderData.RangerInForest = true;
-        }
-        else{
-            TempRenderData.RangerInForest = false;
-        }
-        if(EAssetType::None == TempRenderData.DType){
+    UpdateRenderItems();
+    for(auto ItemIndex : DRenderOrder){
+        SAssetRenderItem &Item = DRenderItems[ItemIndex];
+        SAssetRenderData RenderData = Item.DRenderData;
+
+        if(0 > RenderData.DTileIndex){
             continue;
         }
-        if(EAssetType::Wall == TempRenderData.DType){
-            PrintDebug(DEBUG_LOW, "Wall action = %d\n", (int)AssetIterator->Action());
+        // Cull against the asset tile extents, not the death tile
+        int TileX = Item.DAsset->PositionX() + (Item.DAsset->Size() - 1) * CPosition::HalfTileWidth() - DTilesets[to_underlying(RenderData.DType)]->TileHalfWidth();
+        int TileY = Item.DAsset->PositionY() + (Item.DAsset->Size() - 1) * CPosition::HalfTileHeight() - DTilesets[to_underlying(RenderData.DType)]->TileHalfHeight();
+        int RightX = TileX + DTilesets[to_underlying(RenderData.DType)]->TileWidth() - 1;
+
+        if((RightX < rect.DXPosition)||(TileX > ScreenRightX)){
+            continue;
         }
-        if((0 <= to_underlying(TempRenderData.DType))&&(to_underlying(TempRenderData.DType) < static_cast<int>(DTilesets.size()))){
-            CPixelType PixelType(*AssetIterator);
-            int RightX;
-            TempRenderData.DX = AssetIterator->PositionX() + (AssetIterator->Size() - 1) * CPosition::HalfTileWidth() - DTilesets[to_underlying(TempRenderData.DType)]->TileHalfWidth();
-            TempRenderData.DY = AssetIterator->PositionY() + (AssetIterator->Size() - 1) * CPosition::HalfTileHeight() - DTilesets[to_underlying(TempRenderData.DType)]->TileHalfHeight();
-            TempRenderData.DPixelColor = PixelType.ToPixelColor();
-
-            RightX = TempRenderData.DX + DTilesets[to_underlying(TempRenderData.DType)]->TileWidth() - 1;
-            TempRenderData.DBottomY = TempRenderData.DY + DTilesets[to_underlying(TempRenderData.DType)]->TileHeight() - 1;
-            bool OnScreen = true;
-            if((RightX < rect.DXPosition)||(TempRenderData.DX > ScreenRightX)){
-                OnScreen = false;
-            }
-            else if((TempRenderData.DBottomY < rect.DYPosition)||(TempRenderData.DY > ScreenBottomY)){
-                OnScreen = false;
-            }
-            TempRenderData.DX -= rect.DXPosition;
-            TempRenderData.DY -= rect.DYPosition;
-            TempRenderData.DColorIndex = to_underlying(AssetIterator->Color()) ? to_underlying(AssetIterator->Color()) - 1 : to_underlying(AssetIterator->Color());
-            TempRenderData.DTileIndex = -1;
-            if(OnScreen){
-                int ActionSteps, CurrentStep, TileIndex;
-                switch(AssetIterator->Action()){
-                    case EAssetAction::Build:           ActionSteps = DBuildIndices[to_underlying(TempRenderData.DType)].size();
-                                                        ActionSteps /= to_underlying(EDirection::Max);
-                                                        if(ActionSteps){
-                                                            TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                            TempRenderData.DTileIndex = DBuildIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        }
-                                                        break;
-                    case EAssetAction::Construct:       ActionSteps = DConstructIndices[to_underlying(TempRenderData.DType)].size();
-                                                        if(ActionSteps){
-                                                            int TotalSteps = AssetIterator->BuildTime() * CPlayerAsset::UpdateFrequency();
-                                                            int CurrentStep = AssetIterator->Step() * ActionSteps / TotalSteps;
-                                                            if(CurrentStep == DConstructIndices[to_underlying(TempRenderData.DType)].size()){
-                                                                CurrentStep--;
-                                                            }
-                                                            TempRenderData.DTileIndex = DConstructIndices[to_underlying(TempRenderData.DType)][CurrentStep];
-                                                        }
-                                                        break;
-                    case EAssetAction::Walk:            if(AssetIterator->Lumber()){
-                                                            ActionSteps = DCarryLumberIndices[to_underlying(TempRenderData.DType)].size();
-                                                            ActionSteps /= to_underlying(EDirection::Max);
-                                                            TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                            TempRenderData.DTileIndex = DCarryLumberIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        }
-                                                        else if(AssetIterator->Gold()){
-                                                            ActionSteps = DCarryGoldIndices[to_underlying(TempRenderData.DType)].size();
-                                                            ActionSteps /= to_underlying(EDirection::Max);
-                                                            TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                            TempRenderData.DTileIndex = DCarryGoldIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        }
-                                                        else if(AssetIterator->Stone()){
-                                                            ActionSteps = DCarryStoneIndices[to_underlying(TempRenderData.DType)].size();
-                                                            ActionSteps /= to_underlying(EDirection::Max);
-                                                            TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                            TempRenderData.DTileIndex = DCarryStoneIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        }
-                                                        else{
-                                                            ActionSteps = DWalkIndices[to_underlying(TempRenderData.DType)].size();
-                                                            ActionSteps /= to_underlying(EDirection::Max);
-                                                            TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                            TempRenderData.DTileIndex = DWalkIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        }
-                                                        break;
-                    case EAssetAction::Attack:          CurrentStep = AssetIterator->Step() % (AssetIterator->AttackSteps() + AssetIterator->ReloadSteps());
-                                                        if(CurrentStep < AssetIterator->AttackSteps()){
-                                                            ActionSteps = DAttackIndices[to_underlying(TempRenderData.DType)].size();
-                                                            ActionSteps /= to_underlying(EDirection::Max);
-                                                            TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + (CurrentStep * ActionSteps / AssetIterator->AttackSteps());
-                                                            TempRenderData.DTileIndex = DAttackIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        }
-                                                        else{
-                                                            TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
-                                                        }
-                                                        break;
-                    case EAssetAction::Repair:
-                    case EAssetAction::HarvestLumber:   ActionSteps = DAttackIndices[to_underlying(TempRenderData.DType)].size();
-                                                        ActionSteps /= to_underlying(EDirection::Max);
-                                                        TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                        TempRenderData.DTileIndex = DAttackIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        break;
-                    case EAssetAction::QuarryStone:     ActionSteps = DAttackIndices[to_underlying(TempRenderData.DType)].size();
-                                                        ActionSteps /= to_underlying(EDirection::Max);
-                                                        TileIndex = to_underlying(AssetIterator->Direction()) * ActionSteps + ((AssetIterator->Step() / DAnimationDownsample)% ActionSteps);
-                                                        TempRenderData.DTileIndex = DAttackIndices[to_underlying(TempRenderData.DType)][TileIndex];
-                                                        break;
-                    case EAssetAction::MineGold:        break;
-                    case EAssetAction::StandGround:
-                    case EAssetAction::None:            TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
-                                                        if(AssetIterator->Speed()){
-                                                            if(AssetIterator->Lumber()){
-                                                                ActionSteps = DCarryLumberIndices[to_underlying(TempRenderData.DType)].size();
-                                                                ActionSteps /= to_underlying(EDirection::Max);
-                                                                TempRenderData.DTileIndex = DCarryLumberIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps];
-                                                            }
-                                                            else if(AssetIterator->Gold()){
-                                                                ActionSteps = DCarryGoldIndices[to_underlying(TempRenderData.DType)].size();
-                                                                ActionSteps /= to_underlying(EDirection::Max);
-                                                                TempRenderData.DTileIndex = DCarryGoldIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps];
-                                                            }
-                                                            else if(AssetIterator->Stone()){
-                                                                ActionSteps = DCarryStoneIndices[to_underlying(TempRenderData.DType)].size();
-                                                                ActionSteps /= to_underlying(EDirection::Max);
-                                                                TempRenderData.DTileIndex = DCarryStoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps];
-                                                            }
-                                                        }
-                                                        else if(EAssetType::GoldVein == AssetIterator->Type()){
-                                                            TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][0];
-                                                            PrintDebug(DEBUG_LOW, "Vein Tile Index = %d\n", TempRenderData.DTileIndex);
-                                                        }
-                                                        else if(EAssetType::Wall == TempRenderData.DType) {
-                                                            if((float)(AssetIterator->HitPoints())/(float)(AssetIterator->MaxHitPoints()) < 0.5){
-                                                                TempRenderData.DTileIndex = DWallIndices[to_underlying(EWallStatus::Damaged)][DActualMap->DWallIndices[AssetIterator->TilePositionY()][AssetIterator->TilePositionX()]][0];
-                                                            }
-                                                            else{
-                                                                TempRenderData.DTileIndex = DWallIndices[to_underlying(EWallStatus::None)][DActualMap->DWallIndices[AssetIterator->TilePositionY()][AssetIterator->TilePositionX()]][0];
-                                                            }
-                                                        }
-                                                        break;
-                    case EAssetAction::Capability:      if(AssetIterator->Speed()){
-                                                            if((EAssetCapabilityType::Patrol == AssetIterator->CurrentCommand().DCapability)||(EAssetCapabilityType::StandGround == AssetIterator->CurrentCommand().DCapability)){
-                                                                TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
-                                                            }
-                                                        }
-                                                        else{
-                                                            // Buildings
-                                                            TempRenderData.DTileIndex = DNoneIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction())];
-                                                        }
-                                                        break;
-                    case EAssetAction::Death:           ActionSteps = DDeathIndices[to_underlying(TempRenderData.DType)].size();
-                                                        if(AssetIterator->Speed()){
-                                                            ActionSteps /= to_underlying(EDirection::Max);
-                                                            if(ActionSteps){
-                                                                CurrentStep = AssetIterator->Step() / DAnimationDownsample;
-                                                                if(CurrentStep >= ActionSteps){
-                                                                    CurrentStep = ActionSteps - 1;
-                                                                }
-                                                                TempRenderData.DTileIndex = DDeathIndices[to_underlying(TempRenderData.DType)][to_underlying(AssetIterator->Direction()) * ActionSteps + CurrentStep];
-                                                            }
-                                                        }
-                                                        else{
-                                                            if(AssetIterator->Step() < DBuildingDeathTileset->TileCount()){
-                                                                TempRenderData.DTileIndex = DTilesets[to_underlying(TempRenderData.DType)]->TileCount() + AssetIterator->Step();
-                                                                TempRenderData.DX += DTilesets[to_underlying(TempRenderData.DType)]->TileHalfWidth() - DBuildingDeathTileset->TileHalfWidth();
-                                                                TempRenderData.DY += DTilesets[to_underlying(TempRenderData.DType)]->TileHalfHeight() - DBuildingDeathTileset->TileHalfHeight();
-                                                            }
-                                                        }
-                    default:                            break;
-                }
-                if(0 <= TempRenderData.DTileIndex){
-                    FinalRenderList.push_back(TempRenderData);
-                }
-            }
+        if((RenderData.DBottomY < rect.DYPosition)||(TileY > ScreenBottomY)){
+            continue;
         }
-    }
-    FinalRenderList.sort(CompareRenderData);
-    for(auto &RenderIterator : FinalRenderList){
-        if(RenderIterator.DTileIndex < DTilesets[to_underlying(RenderIterator.DType)]->TileCount()){
-            DTilesets[to_underlying(RenderIterator.DType)]->DrawTile(surface, RenderIterator.DX, RenderIterator.DY, RenderIterator.DTileIndex, RenderIterator.DColorIndex, RenderIterator.RangerInForest);
-            DTilesets[to_underlying(RenderIterator.DType)]->DrawClipped(typesurface, RenderIterator.DX, RenderIterator.DY, RenderIterator.DTileIndex, RenderIterator.DPixelColor);
+        RenderData.DX -= rect.DXPosition;
+        RenderData.DY -= rect.DYPosition;
+        if(RenderData.DTileIndex < DTilesets[to_underlying(RenderData.DType)]->TileCount()){
+            DTilesets[to_underlying(RenderData.DType)]->DrawTile(surface, RenderData.DX, RenderData.DY, RenderData.DTileIndex, RenderData.DColorIndex, RenderData.RangerInForest);
+            DTilesets[to_underlying(RenderData.DType)]->DrawClipped(typesurface, RenderData.DX, RenderData.DY, RenderData.DTileIndex, RenderData.DPixelColor);
         }
         else{
-            DBuildingDeathTileset->DrawTile(surface, RenderIterator.DX, RenderIterator.DY, RenderIterator.DTileIndex);
+            DBuildingDeathTileset->DrawTile(surface, RenderData.DX, RenderData.DY, RenderData.DTileIndex);
         }
     }
 }
@@ -651,7 +819,9 @@ void CAssetRenderer::DrawSelections(std::shared_ptr<CGraphicSurface> surface, co
         RectangleColor = DPixelColors[to_underlying(EPlayerColor::Max) + 2];
 
         ResourceContext->SetSourceRGB(RectangleColor);
-        for(auto &AssetIterator : DPlayerMap->Assets()){
+        UpdateRenderItems();
+        for(auto ItemIndex : DRenderOrder){
+            auto &AssetIterator = DRenderItems[ItemIndex].DAsset;
             SAssetRenderData TempRenderData;
             TempRenderData.DType = AssetIterator->Type();
             if(EAssetType::None == TempRenderData.DType){
@@ -817,7 +987,9 @@ void CAssetRenderer::DrawOverlays(std::shared_ptr<CGraphicSurface> surface, cons
     int ScreenRightX = rect.DXPosition + rect.DWidth - 1;
     int ScreenBottomY = rect.DYPosition + rect.DHeight - 1;
 
-    for(auto &AssetIterator : DPlayerMap->Assets()){
+    UpdateRenderItems();
+    for(auto ItemIndex : DRenderOrder){
+        auto &AssetIterator = DRenderItems[ItemIndex].DAsset;
         SAssetRenderData TempRenderData;
         TempRenderData.DType = AssetIterator->Type();
         if(EAssetType::None == TempRenderData.DType){
@@ -1018,7 +1190,7 @@ void CAssetRenderer::DrawPlacement(std::shared_ptr<CGraphicSurface> surface, con
 
 /**
  * Used to render assets on the mini map corresponding to assets rendered
- * on the actual map
+ * on the actual map, walks the retained render items shared with DrawAssets
  *
  * @param[in] surface The surface on which minimap assets are rendered
  *
@@ -1028,7 +1200,9 @@ void CAssetRenderer::DrawPlacement(std::shared_ptr<CGraphicSurface> surface, con
 void CAssetRenderer::DrawMiniAssets(std::shared_ptr<CGraphicSurface> surface){
     auto ResourceContext = surface->CreateResourceContext();
     if(nullptr != DPlayerData){
-        for(auto &AssetIterator : DPlayerMap->Assets()){
+        UpdateRenderItems();
+        for(auto ItemIndex : DRenderOrder){
+            auto &AssetIterator = DRenderItems[ItemIndex].DAsset;
             EPlayerColor AssetColor = AssetIterator->Color();
             int Size = AssetIterator->Size();
             if(AssetColor == DPlayerData->Color()){
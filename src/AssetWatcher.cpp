@@ -0,0 +1,358 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CAssetWatcher
+*
+* @brief Development mode that reloads game data while the game runs. The
+*     img and res directories of the data directory and the scripts
+*     directory are watched with inotify, and Poll reloads only what changed:
+*     - A tileset descriptor or its PNG is decoded again and replaces the
+*       tileset in place, recolored for the players if it is a multicolor
+*       tileset, so every renderer holding it draws the new tiles.
+*     - A res .dat file is parsed again into the CPlayerAssetType registry
+*       and copied into each player's duplicated registry, which also
+*       updates the units already on the map.
+*     - A Lua script is recompiled into the script cache, the AI and event
+*       handlers pick it up on their next call.
+*     Tilesets whose tile names or sizes change, the recolor maps and the
+*     cursors still need a restart.
+*
+*/
+
+#include "AssetWatcher.h"
+#include "ApplicationData.h"
+#include "CommentSkipLineDataSource.h"
+#include "FileDataContainer.h"
+#include "RetainedPanel.h"
+#include "ScriptCache.h"
+#include "Debug.h"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <chrono>
+#include <set>
+
+/**
+* Constructor, starts watching the directories. If inotify is not available
+* the watcher stays invalid and Poll does nothing.
+*
+* @param[in] datapath The data directory containing img and res
+* @param[in] scriptpath The directory of the Lua scripts
+*
+*/
+
+CAssetWatcher::CAssetWatcher(const std::string &datapath, const std::string &scriptpath){
+    DImageWatch = -1;
+    DAssetWatch = -1;
+    DScriptWatch = -1;
+    DScriptPath = scriptpath;
+    DReloadCount = 0;
+    DFailedCount = 0;
+    DImageDirectory = std::make_shared< CDirectoryDataContainer >(datapath + "/img");
+    DAssetDirectory = std::make_shared< CDirectoryDataContainer >(datapath + "/res");
+    DNotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(0 > DNotifyDescriptor){
+        PrintError("Hot reload: failed to initialize inotify.\n");
+        return;
+    }
+    DImageWatch = AddWatch(datapath + "/img");
+    DAssetWatch = AddWatch(datapath + "/res");
+    DScriptWatch = AddWatch(scriptpath);
+}
+
+/**
+* Destructor, stops watching and closes the inotify descriptor
+*
+*/
+
+CAssetWatcher::~CAssetWatcher(){
+    if(0 <= DNotifyDescriptor){
+        close(DNotifyDescriptor);
+    }
+}
+
+/**
+* Watches a directory for files that are written or moved into it, editors
+* that save through a temporary file rename it over the original
+*
+* @param[in] path The directory to watch
+*
+* @return The watch descriptor, or -1 if the directory cannot be watched
+*
+*/
+
+int CAssetWatcher::AddWatch(const std::string &path){
+    int Watch = inotify_add_watch(DNotifyDescriptor, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if(0 > Watch){
+        PrintError("Hot reload: cannot watch %s.\n", path.c_str());
+    }
+    else{
+        PrintDebug(DEBUG_LOW, "Hot reload: watching %s\n", path.c_str());
+    }
+    return Watch;
+}
+
+/**
+* Lists the tilesets that can be reloaded with the descriptor each was loaded
+* from. Several tilesets can share a descriptor.
+*
+* @param[in] context The application the tilesets are held by
+*
+* @return The tilesets and their descriptors
+*
+*/
+
+std::vector< CAssetWatcher::STilesetEntry > CAssetWatcher::Tilesets(std::shared_ptr< CApplicationData > context){
+    std::vector< STilesetEntry > Entries = {
+        {"Marker.dat", context->DMarkerTileset},
+        {"Texture.dat", context->DBackgroundTileset},
+        {"MiniBevel.dat", context->DMiniBevelTileset},
+        {"InnerBevel.dat", context->DInnerBevelTileset},
+        {"OuterBevel.dat", context->DOuterBevelTileset},
+        {"ListViewIcons.dat", context->DListViewIconTileset},
+        {"RangerTrackingIcon.dat", context->DRangerTrackingIcon},
+        {"PeasantShelterIcon.dat", context->DPeasantShelterIcon},
+        {"Terrain.dat", context->DTerrainTileset},
+        {"TreeGrowth.dat", context->DTreeTileset},
+        {"Fog.dat", context->DFogTileset},
+        {"Icons.dat", context->DIconTileset},
+        {"MiniIcons.dat", context->DMiniIconTileset},
+        {"Corpse.dat", context->DCorpseTileset},
+        {"BuildingDeath.dat", context->DBuildingDeathTileset},
+        {"Arrow.dat", context->DArrowTileset},
+        {"FontKingthings10.dat", context->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Small)]},
+        {"FontKingthings12.dat", context->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Medium)]},
+        {"FontKingthings16.dat", context->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Large)]},
+        {"FontKingthings24.dat", context->DFonts[to_underlying(CUnitDescriptionRenderer::EFontSize::Giant)]}
+    };
+
+    if(2 <= context->DFireTilesets.size()){
+        Entries.push_back({"FireSmall.dat", context->DFireTilesets[0]});
+        Entries.push_back({"FireLarge.dat", context->DFireTilesets[1]});
+    }
+    for(int Index = 0; Index < context->DAssetTilesets.size(); Index++){
+        EAssetType Type = static_cast< EAssetType >(Index);
+
+        if(nullptr != context->DAssetTilesets[Index]){
+            // The gold vein is drawn with the gold mine tiles
+            std::string Name = EAssetType::GoldVein == Type ? "GoldMine" : CPlayerAssetType::TypeToName(Type);
+
+            Entries.push_back({Name + ".dat", context->DAssetTilesets[Index]});
+        }
+    }
+    return Entries;
+}
+
+/**
+* Reads the name of the PNG a descriptor loads
+*
+* @param[in] descriptor The name of the descriptor in the img directory
+*
+* @return The file name of the PNG, empty if the descriptor cannot be read
+*
+*/
+
+std::string CAssetWatcher::DescriptorImage(const std::string &descriptor){
+    auto Source = DImageDirectory->DataSource(descriptor);
+    std::string PNGPath;
+
+    if(nullptr != Source){
+        CCommentSkipLineDataSource LineSource(Source, '#');
+
+        if(LineSource.Read(PNGPath)){
+            size_t Slash = PNGPath.rfind('/');
+
+            if(std::string::npos != Slash){
+                PNGPath = PNGPath.substr(Slash + 1);
+            }
+            return PNGPath;
+        }
+    }
+    return std::string();
+}
+
+/**
+* Reloads every tileset loaded from a descriptor
+*
+* @param[in] tilesets The reloadable tilesets
+* @param[in] descriptor The name of the descriptor in the img directory
+*
+* @return true if the tilesets were reloaded
+*
+*/
+
+bool CAssetWatcher::ReloadTileset(const std::vector< STilesetEntry > &tilesets, const std::string &descriptor){
+    auto StartTime = std::chrono::steady_clock::now();
+    int Count = 0;
+
+    for(auto &Entry : tilesets){
+        if((Entry.DDescriptor == descriptor) && (nullptr != Entry.DTileset)){
+            if(!Entry.DTileset->ReloadTileset(DImageDirectory->DataSource(descriptor))){
+                PrintError("Hot reload: failed to reload tileset %s.\n", descriptor.c_str());
+                return false;
+            }
+            Count++;
+        }
+    }
+    if(0 == Count){
+        PrintDebug(DEBUG_LOW, "Hot reload: %s is not a reloadable tileset, restart to apply it\n", descriptor.c_str());
+        return true;
+    }
+    CRetainedPanel::InvalidateAll();
+    PrintDebug(DEBUG_LOW, "Hot reload: reloaded %s (%d tilesets) in %.3f ms\n", descriptor.c_str(), Count, std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - StartTime).count());
+    return true;
+}
+
+/**
+* Parses an asset type again and updates the copy of it in the registry of
+* each player
+*
+* @param[in] context The application holding the game model
+* @param[in] name The name of the .dat file in the res directory
+*
+* @return true if the asset type was reloaded
+*
+*/
+
+bool CAssetWatcher::ReloadAssetType(std::shared_ptr< CApplicationData > context, const std::string &name){
+    std::string TypeName;
+    int PlayerCount = 0;
+
+    if(!CPlayerAssetType::Load(DAssetDirectory->DataSource(name), TypeName)){
+        PrintError("Hot reload: failed to reload asset type %s.\n", name.c_str());
+        return false;
+    }
+    auto AssetType = CPlayerAssetType::FindDefaultFromName(TypeName);
+
+    if(nullptr != context->DGameModel){
+        for(int Index = 0; Index < to_underlying(EPlayerColor::Max); Index++){
+            auto Player = context->DGameModel->Player(static_cast< EPlayerColor >(Index));
+
+            if((nullptr != Player) && (nullptr != Player->AssetTypes())){
+                auto Search = Player->AssetTypes()->find(TypeName);
+
+                if(Search != Player->AssetTypes()->end()){
+                    Search->second->UpdateStats(AssetType);
+                    PlayerCount++;
+                }
+            }
+        }
+    }
+    PrintDebug(DEBUG_LOW, "Hot reload: reloaded asset type %s for %d players\n", TypeName.c_str(), PlayerCount);
+    return true;
+}
+
+/**
+* Recompiles a Lua script into the script cache
+*
+* @param[in] name The file name in the scripts directory
+*
+* @return true if the script compiled
+*
+*/
+
+bool CAssetWatcher::ReloadScript(const std::string &name){
+    return CScriptCache::Reload(DScriptPath + "/" + name);
+}
+
+/**
+* Reloads the files that changed since the last call, called once per frame.
+* Changes are collected first so a file written several times, or a
+* descriptor and its PNG written together, is only reloaded once.
+*
+* @param[in] context The application holding the game data
+*
+* @return The number of items reloaded
+*
+*/
+
+int CAssetWatcher::Poll(std::shared_ptr< CApplicationData > context){
+    alignas(struct inotify_event) char Buffer[ASSET_WATCHER_BUFFER_SIZE];
+    std::set< std::string > Descriptors;
+    std::set< std::string > AssetFiles;
+    std::set< std::string > Scripts;
+    std::set< std::string > Images;
+    ssize_t Length;
+    int Reloaded = 0;
+
+    if(0 > DNotifyDescriptor){
+        return 0;
+    }
+    while(0 < (Length = read(DNotifyDescriptor, Buffer, sizeof(Buffer)))){
+        for(ssize_t Offset = 0; Offset < Length;){
+            auto Event = reinterpret_cast< struct inotify_event * >(Buffer + Offset);
+            std::string Name = Event->len ? Event->name : "";
+            size_t Dot = Name.rfind('.');
+            std::string Extension = std::string::npos == Dot ? "" : Name.substr(Dot);
+
+            Offset += sizeof(struct inotify_event) + Event->len;
+            if(Name.empty() || (Event->mask & IN_ISDIR)){
+                continue;
+            }
+            if(Event->wd == DImageWatch){
+                if(".dat" == Extension){
+                    Descriptors.insert(Name);
+                }
+                else if(".png" == Extension){
+                    Images.insert(Name);
+                }
+            }
+            else if((Event->wd == DAssetWatch) && (".dat" == Extension)){
+                AssetFiles.insert(Name);
+            }
+            else if((Event->wd == DScriptWatch) && (".lua" == Extension)){
+                Scripts.insert(Name);
+            }
+        }
+    }
+    if(!Descriptors.empty() || !Images.empty()){
+        auto Entries = Tilesets(context);
+
+        for(auto &Entry : Entries){
+            if(Images.count(DescriptorImage(Entry.DDescriptor))){
+                Descriptors.insert(Entry.DDescriptor);
+            }
+        }
+        for(auto &Descriptor : Descriptors){
+            if(ReloadTileset(Entries, Descriptor)){
+                Reloaded++;
+            }
+            else{
+                DFailedCount++;
+            }
+        }
+    }
+    for(auto &Name : AssetFiles){
+        if(ReloadAssetType(context, Name)){
+            Reloaded++;
+        }
+        else{
+            DFailedCount++;
+        }
+    }
+    for(auto &Name : Scripts){
+        if(ReloadScript(Name)){
+            Reloaded++;
+        }
+        else{
+            DFailedCount++;
+        }
+    }
+    DReloadCount += Reloaded;
+    return Reloaded;
+}
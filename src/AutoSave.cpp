@@ -0,0 +1,212 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CAutoSave
+*
+* @brief Saves the game in the background every Interval() seconds. Between
+*     two game cycles Update takes a snapshot of the game by serializing it
+*     into the binary saved game format in memory, which is the only part
+*     that pauses the simulation. A writer thread then writes the snapshot
+*     to disk and syncs it, so the disk never stalls the game. If the
+*     previous snapshot is still being written when the next is due, the
+*     new one replaces it in the queue, so at most one snapshot waits.
+*
+*/
+
+#include "AutoSave.h"
+#include "ApplicationData.h"
+#include "SavedGame.h"
+#include "Debug.h"
+#include <algorithm>
+
+/**
+* Constructor, starts the writer thread.
+*
+* @param[in] filename The file the snapshots are written to
+* @param[in] interval The seconds between snapshots, 0 disables the autosave
+*
+*/
+
+CAutoSave::CAutoSave(const std::string &filename, int interval){
+    DFileName = filename;
+    DInterval = std::max(0, interval);
+    DHasPending = false;
+    DWriting = false;
+    DTerminate = false;
+    DSnapshotCount = 0;
+    DSkippedCount = 0;
+    DWriteCount = 0;
+    DFailedCount = 0;
+    DLastSize = 0;
+    DSnapshotTime = 0.0;
+    DMaxSnapshot = 0.0;
+    DWriteTime = 0.0;
+    DMaxWrite = 0.0;
+    Reset();
+    DThread = std::thread(&CAutoSave::WriterThread, this);
+}
+
+/**
+* Destructor, writes the last pending snapshot and stops the writer thread.
+*
+*/
+
+CAutoSave::~CAutoSave(){
+    {
+        std::lock_guard< std::mutex > Lock(DMutex);
+
+        DTerminate = true;
+    }
+    DCondition.notify_all();
+    if(DThread.joinable()){
+        DThread.join();
+    }
+}
+
+/**
+* Restarts the interval, called when a battle starts or is loaded so the
+* first snapshot is not taken right away.
+*
+* @return void
+*
+*/
+
+void CAutoSave::Reset(){
+    DLastSnapshot = std::chrono::steady_clock::now();
+}
+
+/**
+* Takes a snapshot if the interval has passed since the last one. Must be
+* called between game cycles.
+*
+* @param[in] context The game to save
+*
+* @return true if a snapshot was taken
+*
+*/
+
+bool CAutoSave::Update(std::shared_ptr< CApplicationData > context){
+    auto Now = std::chrono::steady_clock::now();
+
+    if(!DInterval || (std::chrono::seconds(DInterval) > Now - DLastSnapshot)){
+        return false;
+    }
+    DLastSnapshot = Now;
+    return Snapshot(context);
+}
+
+/**
+* Serializes the game into memory and hands it to the writer thread. The
+* time taken is the pause the autosave adds to the game and is reported.
+*
+* @param[in] context The game to save
+*
+* @return true if the snapshot was queued
+*
+*/
+
+bool CAutoSave::Snapshot(std::shared_ptr< CApplicationData > context){
+    auto SnapshotStart = std::chrono::steady_clock::now();
+    std::string Data = CSavedGame::SaveBinary(context);
+    auto SnapshotEnd = std::chrono::steady_clock::now();
+    double Duration = std::chrono::duration< double, std::milli >(SnapshotEnd - SnapshotStart).count();
+
+    {
+        std::lock_guard< std::mutex > Lock(DMutex);
+
+        if(DHasPending){
+            DSkippedCount++;
+        }
+        DPending.swap(Data);
+        DHasPending = true;
+        DSnapshotCount++;
+        DLastSize = DPending.size();
+        DSnapshotTime += Duration;
+        DMaxSnapshot = std::max(DMaxSnapshot, Duration);
+    }
+    DCondition.notify_all();
+    PrintDebug(DEBUG_LOW, "Autosave: cycle %d snapshot of %d bytes took %.3f ms\n", context->DGameModel->GameCycle(), (int)DLastSize, Duration);
+    return true;
+}
+
+/**
+* Waits until every queued snapshot has been written.
+*
+* @return void
+*
+*/
+
+void CAutoSave::Flush(){
+    std::unique_lock< std::mutex > Lock(DMutex);
+
+    DCondition.wait(Lock, [this](){
+        return !DHasPending && !DWriting;
+    });
+}
+
+/**
+* Prints how long the snapshots and writes took.
+*
+* @return void
+*
+*/
+
+void CAutoSave::PrintStatistics(){
+    std::lock_guard< std::mutex > Lock(DMutex);
+
+    PrintDebug(DEBUG_LOW, "Autosave: %d snapshots, the last %d bytes, %.3f ms mean (max %.3f ms) in game, %d writes %.3f ms mean (max %.3f ms) in background, %d replaced, %d failed\n", DSnapshotCount, (int)DLastSize, DSnapshotCount ? DSnapshotTime / DSnapshotCount : 0.0, DMaxSnapshot, DWriteCount, DWriteCount ? DWriteTime / DWriteCount : 0.0, DMaxWrite, DSkippedCount, DFailedCount);
+}
+
+/**
+* Writes the queued snapshots until the autosave is destroyed. Each file is
+* synced to disk before it replaces the previous autosave.
+*
+* @return void
+*
+*/
+
+void CAutoSave::WriterThread(){
+    std::unique_lock< std::mutex > Lock(DMutex);
+
+    while(true){
+        DCondition.wait(Lock, [this](){
+            return DHasPending || DTerminate;
+        });
+        if(!DHasPending){
+            break;
+        }
+        std::string Data;
+
+        Data.swap(DPending);
+        DHasPending = false;
+        DWriting = true;
+        Lock.unlock();
+
+        auto WriteStart = std::chrono::steady_clock::now();
+        bool Success = CSavedGame::Write(Data, DFileName, true);
+        auto WriteEnd = std::chrono::steady_clock::now();
+        double Duration = std::chrono::duration< double, std::milli >(WriteEnd - WriteStart).count();
+
+        Lock.lock();
+        DWriting = false;
+        DWriteCount++;
+        DFailedCount += Success ? 0 : 1;
+        DWriteTime += Duration;
+        DMaxWrite = std::max(DMaxWrite, Duration);
+        DCondition.notify_all();
+    }
+}
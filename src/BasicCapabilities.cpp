@@ -18,6 +18,7 @@
 #include "ApplicationData.h"
 #include "GameModel.h"
 #include "Debug.h"
+#include "MemoryPool.h"
 #include "TerrainMap.h"
 
 /**
@@ -97,6 +98,7 @@ class CPlayerCapabilityMove : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save){};
+                void Save(SSavedCapability &save){};
                 void Step(int step){};
         };
         CPlayerCapabilityMove();
@@ -166,7 +168,7 @@ bool CPlayerCapabilityMove::ApplyCapability(std::shared_ptr< CPlayerAsset > acto
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
         actor->ClearCommand();
         actor->PushCommand(NewCommand);
         return true;
@@ -309,6 +311,7 @@ class CPlayerCapabilityMineHarvestQuarry : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save){};
+                void Save(SSavedCapability &save){};
                 void Step(int step){};
         };
         CPlayerCapabilityMineHarvestQuarry();
@@ -401,7 +404,7 @@ bool CPlayerCapabilityMineHarvestQuarry::ApplyCapability(std::shared_ptr< CPlaye
     NewCommand.DAction = EAssetAction::Capability;
     NewCommand.DCapability = AssetCapabilityType();
     NewCommand.DAssetTarget = target;
-    NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+    NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
     actor->ClearCommand();
     actor->PushCommand(NewCommand);
 
@@ -560,6 +563,7 @@ class CPlayerCapabilityStandGround : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save){};
+                void Save(SSavedCapability &save){};
                 void Step(int step){};
         };
         CPlayerCapabilityStandGround();
@@ -629,7 +633,7 @@ bool CPlayerCapabilityStandGround::ApplyCapability(std::shared_ptr< CPlayerAsset
     NewCommand.DAction = EAssetAction::Capability;
     NewCommand.DCapability = AssetCapabilityType();
     NewCommand.DAssetTarget = target;
-    NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+    NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
     actor->ClearCommand();
     actor->PushCommand(NewCommand);
 
@@ -778,6 +782,7 @@ class CPlayerCapabilityCancel : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save){};
+                void Save(SSavedCapability &save){};
                 void Step(int step){};
         };
         CPlayerCapabilityCancel();
@@ -845,7 +850,7 @@ bool CPlayerCapabilityCancel::ApplyCapability(std::shared_ptr< CPlayerAsset > ac
     NewCommand.DAction = EAssetAction::Capability;
     NewCommand.DCapability = AssetCapabilityType();
     NewCommand.DAssetTarget = target;
-    NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+    NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
     actor->PushCommand(NewCommand);
 
     return true;
@@ -1011,6 +1016,7 @@ class CPlayerCapabilityConvey : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step){};
         };
         CPlayerCapabilityConvey();
@@ -1101,7 +1107,7 @@ bool CPlayerCapabilityConvey::ApplyCapability(std::shared_ptr< CPlayerAsset > ac
     NewCommand.DAction = EAssetAction::Capability;
     NewCommand.DCapability = AssetCapabilityType();
     NewCommand.DAssetTarget = target;
-    NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+    NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
     actor->ClearCommand();
     actor->PushCommand(NewCommand);
     return true;
@@ -1145,6 +1151,22 @@ void CPlayerCapabilityConvey::CActivatedCapability::Save(std::ofstream& save){
 
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityConvey::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "BASIC";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+}
+
 /**
 * Show the percentage completion of the capability.
 *
@@ -1294,6 +1316,7 @@ class CPlayerCapabilityPatrol : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save){};
+                void Save(SSavedCapability &save){};
                 void Step(int step){};
         };
         CPlayerCapabilityPatrol();
@@ -1363,7 +1386,7 @@ bool CPlayerCapabilityPatrol::ApplyCapability(std::shared_ptr< CPlayerAsset > ac
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
         actor->ClearCommand();
         actor->PushCommand(NewCommand);
         return true;
@@ -1411,7 +1434,7 @@ bool CPlayerCapabilityPatrol::CActivatedCapability::IncrementStep(){
     PatrolCommand.DAction = EAssetAction::Capability;
     PatrolCommand.DCapability = EAssetCapabilityType::Patrol;
     PatrolCommand.DAssetTarget = DPlayerData->CreateMarker(DActor->Position(), false);
-    PatrolCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(DActor, DPlayerData, PatrolCommand.DAssetTarget);
+    PatrolCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(DActor, DPlayerData, PatrolCommand.DAssetTarget);
     DActor->ClearCommand();
     DActor->PushCommand(PatrolCommand);
 
@@ -1513,6 +1536,7 @@ class CPlayerCapabilityAttack : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step){};
         };
         CPlayerCapabilityAttack();
@@ -1595,7 +1619,7 @@ bool CPlayerCapabilityAttack::ApplyCapability(std::shared_ptr< CPlayerAsset > ac
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
         actor->ClearCommand();
         actor->PushCommand(NewCommand);
         return true;
@@ -1642,6 +1666,22 @@ void CPlayerCapabilityAttack::CActivatedCapability::Save(std::ofstream& save){
 
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityAttack::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "BASIC";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+}
+
 /**
 * Show the percentage completion of the capability.
 *
@@ -1773,6 +1813,7 @@ class CPlayerCapabilityRepair : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step){};
         };
         CPlayerCapabilityRepair();
@@ -1859,7 +1900,7 @@ bool CPlayerCapabilityRepair::ApplyCapability(std::shared_ptr< CPlayerAsset > ac
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
         actor->ClearCommand();
         actor->PushCommand(NewCommand);
         return true;
@@ -1906,6 +1947,22 @@ void CPlayerCapabilityRepair::CActivatedCapability::Save(std::ofstream& save){
 
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityRepair::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "BASIC";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+}
+
 /**
 * Show the percentage completion of the capability.
 *
@@ -2019,6 +2076,7 @@ class CPlayerCapabilityShelter : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save){};
+                void Save(SSavedCapability &save){};
                 void Step(int step){};
         };
         CPlayerCapabilityShelter();
@@ -2097,7 +2155,7 @@ bool CPlayerCapabilityShelter::ApplyCapability(std::shared_ptr< CPlayerAsset > a
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target);
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target);
         actor->ClearCommand();
         actor->PushCommand(NewCommand);
         return true;
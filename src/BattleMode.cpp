@@ -38,13 +38,16 @@
 #include "BattleMode.h"
 #include "EndOfBattleMode.h"
 #include "ApplicationData.h"
+#include "AutoSave.h"
 #include "InGameMenuMode.h"
+#include "LockstepFrame.h"
 #include "PixelType.h"
 #include "Debug.h"
 #include <sstream>
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 #define PAN_SPEED_MAX           0x100
 #define PAN_SPEED_SHIFT         1
@@ -110,6 +113,11 @@ CBattleMode::CBattleMode(const SPrivateConstructorType & key){
 void CBattleMode::InitializeChange(std::shared_ptr< CApplicationData > context){
     std::shared_ptr< CDataSource > source = std::make_shared< CFileDataSource > ("");
     context->LoadGameMap(context->DSelectedMapIndex, source);
+    DLockstep.InputDelay(context->DLockstepInputDelay);
+    DLockstep.Reset(context->DGameModel->GameCycle());
+    if(context->DAutoSave){
+        context->DAutoSave->Reset();
+    }
     context->DSoundLibraryMixer->PlaySong(context->DSoundLibraryMixer->FindSong("game1"), context->DMusicVolume);
 }
 
@@ -920,10 +928,10 @@ void CBattleMode::Calculate(std::shared_ptr< CApplicationData > context){
     bool AIAlive = false;
     int PlayerLeft = 0;
 
-    //Command is full command sent over network
-    std::string Value,Command;
-    Command = std::string("");
-    Value = std::string("");
+    //Frame is the full command frame sent over network
+    SLockstepFrame Frame;
+    std::vector< SLockstepCommand > FrameCommands;
+    std::string Message;
 
     PrintDebug(DEBUG_LOW, "Started 1st for loop\n");
 
@@ -947,24 +955,16 @@ void CBattleMode::Calculate(std::shared_ptr< CApplicationData > context){
         if(context->DGameModel->Player(static_cast<EPlayerColor>(Index))->IsAlive() && context->DGameModel->Player(static_cast<EPlayerColor>(Index))->IsAI()){
 
             if(context->DGameSessionType != CApplicationData::gstSinglePlayer){
-                while(Value.empty()){
-                    Command = context->DMultiplayerClient->getCommand();
-                    popLine(Command,Value);//Pop Game Cycle
-                }
-
-                while(std::stoi(Value) != context->DGameModel->GameCycle()){
-                    Command = context->DMultiplayerClient->getCommand();
-                    popLine(Command,Value);//Pop Game Cycle
-                }
-                context->DAIPlayers[Index]->LoadCommand(context->DPlayerCommands[Index], Command);
-
-                Command.erase();
-                Value.erase();
+                // The remote players' commands arrive through the lockstep scheduler
+                DLockstep.Expect(static_cast<EPlayerColor>(Index), true);
             }
             else{
                 context->DAIPlayers[Index]->CalculateCommand(context->DPlayerCommands[Index]);
             }
         }
+        else{
+            DLockstep.Expect(static_cast<EPlayerColor>(Index), Index == to_underlying(context->DPlayerColor));
+        }
     }
   //}
 
@@ -973,11 +973,36 @@ void CBattleMode::Calculate(std::shared_ptr< CApplicationData > context){
     if ((context->DGameSessionType != CApplicationData::gstSinglePlayer && PlayerLeft == 1) || (context->DGameSessionType == CApplicationData::gstSinglePlayer && DBattleOver)){
         DBattleOver = false;
         if(context->DGameSessionType != CApplicationData::gstSinglePlayer){
+            DLockstep.PrintStatistics();
             context->DMultiplayerClient->close();
             context->ChangeApplicationMode(CEndOfBattleMode::Instance());
         }
-        else if ((!DForcedEnd && !AIAlive) || DForcedEnd)
+        else if ((!DForcedEnd && !AIAlive) || DForcedEnd){
+            if(context->DAutoSave){
+                context->DAutoSave->PrintStatistics();
+            }
             context->ChangeApplicationMode(CEndOfBattleMode::Instance());
+        }
+    }
+
+    if(context->DGameSessionType != CApplicationData::gstSinglePlayer){
+        while(!(Message = context->DMultiplayerClient->getCommand()).empty()){
+            if(CLockstepFrame::DecodeMessage(Message, Frame)){
+                DLockstep.Receive(Frame);
+            }
+            else{
+                PrintDebug(DEBUG_LOW, "Invalid lockstep frame %s\n", Message.c_str());
+            }
+        }
+        // Without every player's commands for this cycle the simulation waits, Render still runs
+        double Now = std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        if(!DLockstep.Advance(context->DGameModel->GameCycle(), Now, FrameCommands)){
+            return;
+        }
+        for(auto &Command : FrameCommands){
+            CLockstepFrame::ToRequest(Command, context->DPlayerCommands[to_underlying(Command.DPlayer)]);
+        }
     }
 
     for(std::vector< SPlayerCommandRequest >::reverse_iterator rit = DBufferedWallCommands.rbegin(); rit != DBufferedWallCommands.rend(); rit++){
@@ -1054,6 +1079,10 @@ void CBattleMode::Calculate(std::shared_ptr< CApplicationData > context){
 
     PrintDebug(DEBUG_LOW,"Finished 2nd for loop(nested)\n");
     context->DGameModel->Timestep();
+    // Between two cycles the game is consistent, the autosave only pauses it for the snapshot
+    if(context->DAutoSave && (context->DGameSessionType == CApplicationData::gstSinglePlayer)){
+        context->DAutoSave->Update(context);
+    }
     auto WeakAsset = context->DSelectedPlayerAssets.begin();
     PrintDebug(DEBUG_LOW,"Started 1st while (4th loop)\n");
     while(WeakAsset != context->DSelectedPlayerAssets.end()){
@@ -1097,6 +1126,65 @@ void CBattleMode::Calculate(std::shared_ptr< CApplicationData > context){
     }
 }
 
+/**
+* Builds the key of everything the unit description panel shows for the
+* current selection, the panel is only redrawn when the key changes.
+*
+* @param[in] context shared pointer to Application Data
+* @param[out] key the values the unit description depends on
+*
+* @return void
+*
+*/
+
+void CBattleMode::UnitDescriptionKey(std::shared_ptr< CApplicationData > context, std::vector< int > &key){
+    key.clear();
+    key.push_back(to_underlying(context->DPlayerColor));
+    key.push_back(context->DSelectedPlayerAssets.size());
+    for(auto &Item : context->DSelectedPlayerAssets){
+        if(auto Asset = Item.lock()){
+            key.push_back(to_underlying(Asset->Type()));
+            key.push_back(to_underlying(Asset->Color()));
+            key.push_back(Asset->HitPoints());
+            key.push_back(Asset->MaxHitPoints());
+            if(1 == context->DSelectedPlayerAssets.size()){
+                auto Command = Asset->CurrentCommand();
+
+                key.push_back(Asset->Armor());
+                key.push_back(Asset->ArmorUpgrade());
+                key.push_back(Asset->BasicDamage());
+                key.push_back(Asset->BasicDamageUpgrade());
+                key.push_back(Asset->PiercingDamage());
+                key.push_back(Asset->PiercingDamageUpgrade());
+                key.push_back(Asset->Range());
+                key.push_back(Asset->RangeUpgrade());
+                key.push_back(Asset->Sight());
+                key.push_back(Asset->SightUpgrade());
+                key.push_back(Asset->Speed());
+                key.push_back(Asset->SpeedUpgrade());
+                key.push_back(Asset->Gold());
+                key.push_back(to_underlying(Asset->Action()));
+                key.push_back(to_underlying(Command.DCapability));
+                if(Command.DAssetTarget){
+                    key.push_back(to_underlying(Command.DAssetTarget->Type()));
+                    key.push_back(to_underlying(Command.DAssetTarget->Color()));
+                    key.push_back(Command.DAssetTarget->HitPoints());
+                    key.push_back(Command.DAssetTarget->MaxHitPoints());
+                    if(Command.DAssetTarget->CurrentCommand().DActivatedCapability){
+                        key.push_back(Command.DAssetTarget->CurrentCommand().DActivatedCapability->PercentComplete(100));
+                    }
+                }
+                if(Command.DActivatedCapability){
+                    key.push_back(Command.DActivatedCapability->PercentComplete(100));
+                }
+            }
+        }
+        else{
+            key.push_back(-1);
+        }
+    }
+}
+
 /**
 * Render Battle Mode graphics
 *
@@ -1120,6 +1208,7 @@ void CBattleMode::Render(std::shared_ptr< CApplicationData > context){
     int IconDescriptionW, IconDescriptionH;
     int NotificationW, NotificationH;
     std::list< std::weak_ptr< CPlayerAsset > > SelectedAndMarkerAssets = context->DSelectedPlayerAssets;
+    std::vector< int > UnitDescriptionPanelKey;
 
     std::list<std::string> chats;
     int tmp = 1;
@@ -1217,7 +1306,11 @@ void CBattleMode::Render(std::shared_ptr< CApplicationData > context){
     context->DOuterBevel->DrawBevel(context->DWorkingBufferSurface, context->DUnitDescriptionXOffset, context->DUnitDescriptionYOffset, DescriptionWidth, DescriptionHeight);
 
     context->DUnitDescriptionSurface->Draw(context->DWorkingBufferSurface, 0, 0, DescriptionWidth, DescriptionHeight, context->DUnitDescriptionXOffset, context->DUnitDescriptionYOffset);
-    context->DUnitDescriptionRenderer->DrawUnitDescription(context->DUnitDescriptionSurface, context->DSelectedPlayerAssets);
+    UnitDescriptionKey(context, UnitDescriptionPanelKey);
+    if(DUnitDescriptionPanel.Update(DescriptionWidth, DescriptionHeight, UnitDescriptionPanelKey)){
+        context->DUnitDescriptionRenderer->DrawUnitDescription(DUnitDescriptionPanel.Surface(), context->DSelectedPlayerAssets);
+    }
+    DUnitDescriptionPanel.Draw(context->DUnitDescriptionSurface, 0, 0);
     context->DWorkingBufferSurface->Draw(context->DUnitDescriptionSurface, context->DUnitDescriptionXOffset, context->DUnitDescriptionYOffset, -1, -1, 0, 0);
 
     context->DOuterBevel->DrawBevel(context->DWorkingBufferSurface, context->DUnitActionXOffset, context->DUnitActionYOffset, ActionWidth, ActionHeight);
@@ -1320,30 +1413,36 @@ std::shared_ptr< CApplicationMode > CBattleMode::Instance(){
 }
 
 
-void CBattleMode::SaveCommand(std::shared_ptr< CApplicationData > context){
-    std::stringstream output;
-    output << "#Game Cycle\n" << context->DGameModel->GameCycle() << "\n";
-    output << "#PlayerColor\n" << to_underlying(context->DPlayerColor) << "\n";
-    output << "#Action\n" << to_underlying(context->DPlayerCommands[to_underlying(context->DPlayerColor)].DAction) << "\n";
-    output << "#Actors Count\n" << context->DPlayerCommands[to_underlying(context->DPlayerColor)].DActors.size() << "\n";
-    output << "#AssetID\n";
-    for(auto Actor : context->DPlayerCommands[to_underlying(context->DPlayerColor)].DActors){
-        output << Actor.lock()->AssetID() << "\n";
-    }
-
-    // context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetColor = EPlayerColor::None;
-    output << "#TargetColor\n" << to_underlying(context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetColor) << "\n";
-
-    // context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetType = EAssetType::None;
-    output << "#TargetType\n" << to_underlying(context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetType) << "\n";
+/**
+* Submits the local player's command to the lockstep scheduler and sends
+* the frames of the cycles that are due to the other players, binary unless
+* the text form was requested for debugging
+*
+* @param[in] context shared pointer to Application Data
+*
+* @return void
+*
+*/
 
-    // context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetLocation = ActorTarget->Position();
-    // this is a CPixelPosition object
-    output << "#TargetLocation\n" << context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetLocation.X() << "\n";
-    output << context->DPlayerCommands[to_underlying(context->DPlayerColor)].DTargetLocation.Y() << "\n";
+void CBattleMode::SaveCommand(std::shared_ptr< CApplicationData > context){
+    SLockstepFrame Frame;
+    SPlayerCommandRequest &Request = context->DPlayerCommands[to_underlying(context->DPlayerColor)];
 
-    if(context->DGameSessionType != CApplicationData::gstSinglePlayer){
-        context->DMultiplayerClient->sendCommand(output.str());
+    if(context->DGameSessionType == CApplicationData::gstSinglePlayer){
+        return;
+    }
+    // The command is applied InputDelay() cycles later together with everyone else's
+    if(EAssetCapabilityType::None != Request.DAction){
+        DLockstep.Submit(CLockstepFrame::FromRequest(context->DPlayerColor, Request));
+        Request.DAction = EAssetCapabilityType::None;
+    }
+    while(DLockstep.Issue(context->DGameModel->GameCycle(), context->DPlayerColor, Frame)){
+        if(context->DLockstepTextCommands){
+            context->DMultiplayerClient->sendCommand(CLockstepFrame::EncodeMessage(Frame, true));
+        }
+        else{
+            context->DMultiplayerClient->sendCommandFrame(CLockstepFrame::EncodeMessage(Frame));
+        }
     }
 }
 
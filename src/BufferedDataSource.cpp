@@ -0,0 +1,174 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CBufferedDataSource
+*
+* @brief Base of the data sources that read their data in blocks. Small reads
+*     are served from an internal block buffer so that reading a descriptor
+*     a byte or a line at a time costs one ReadBlock call per block instead
+*     of one per byte, reads larger than a block go straight to ReadBlock.
+*     ReadLine scans the buffer for the end of the line and appends whole
+*     runs of characters at once.
+*
+*     Several line sources may read from the same data source one after the
+*     other (a map is read by the terrain map then by the asset map), they
+*     all share the buffer, so none of them sees data go missing.
+*
+*/
+
+#include "BufferedDataSource.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+* Constructor, the buffer is allocated on the first read.
+*
+* @param[in] blocksize The size of the blocks to read, 0 for no buffering
+*
+*/
+
+CBufferedDataSource::CBufferedDataSource(size_t blocksize) : CDataSource(){
+    DBlockSize = blocksize;
+    DBufferOffset = 0;
+    DBufferLength = 0;
+    DBlockReads = 0;
+}
+
+/**
+* Sets the size of the blocks to read. Data that is already buffered is
+* still returned first.
+*
+* @param[in] blocksize The size of the blocks to read, 0 for no buffering
+*
+* @return void
+*
+*/
+
+void CBufferedDataSource::BlockSize(size_t blocksize){
+    DBlockSize = blocksize;
+}
+
+/**
+* Refills the buffer with the next block, the buffer must be empty.
+*
+* @return true if any data was read
+*
+*/
+
+bool CBufferedDataSource::Fill(){
+    int BytesRead;
+
+    DBufferOffset = 0;
+    DBufferLength = 0;
+    if(!DBlockSize){
+        return false;
+    }
+    if(DBuffer.size() != DBlockSize){
+        DBuffer.resize(DBlockSize);
+    }
+    DBlockReads++;
+    BytesRead = ReadBlock(DBuffer.data(), DBlockSize);
+    if(0 < BytesRead){
+        DBufferLength = BytesRead;
+        return true;
+    }
+    return false;
+}
+
+/**
+* Reads up to length bytes, first from the buffer then with at most one
+* ReadBlock call, so a read is only short at the end of the data just as a
+* read of the underlying source would be.
+*
+* @param[out] data   The buffer to store the data read
+* @param[in] length The number of bytes to read
+*
+* @return Number of bytes read, -1 if at the end of the data
+*
+*/
+
+int CBufferedDataSource::Read(void *data, int length){
+    char *Data = static_cast< char * >(data);
+    size_t Remaining = 0 < length ? length : 0;
+    size_t Copied = 0;
+
+    if(DBufferOffset < DBufferLength){
+        Copied = std::min(Remaining, DBufferLength - DBufferOffset);
+        memcpy(Data, DBuffer.data() + DBufferOffset, Copied);
+        DBufferOffset += Copied;
+        Remaining -= Copied;
+    }
+    if(Remaining){
+        if(!DBlockSize || (Remaining >= DBlockSize)){
+            int BytesRead;
+
+            DBlockReads++;
+            BytesRead = ReadBlock(Data + Copied, Remaining);
+            if(0 < BytesRead){
+                Copied += BytesRead;
+            }
+        }
+        else if(Fill()){
+            size_t Length = std::min(Remaining, DBufferLength);
+
+            memcpy(Data + Copied, DBuffer.data(), Length);
+            DBufferOffset = Length;
+            Copied += Length;
+        }
+    }
+    return Copied ? Copied : -1;
+}
+
+/**
+* Reads the next line straight out of the buffer. The new line is consumed
+* but not stored and carriage returns are dropped, as CDataSource::ReadLine
+* does.
+*
+* @param[out] line The line read
+*
+* @return true if a line was read
+*
+*/
+
+bool CBufferedDataSource::ReadLine(std::string &line){
+    bool FoundNewLine = false;
+
+    if(!DBlockSize){
+        return CDataSource::ReadLine(line);
+    }
+    line.clear();
+    while(!FoundNewLine){
+        if((DBufferOffset >= DBufferLength) && !Fill()){
+            break;
+        }
+        const char *Start = DBuffer.data() + DBufferOffset;
+        size_t Available = DBufferLength - DBufferOffset;
+        const char *NewLine = static_cast< const char * >(memchr(Start, '\n', Available));
+        size_t Length = NewLine ? NewLine - Start : Available;
+
+        line.append(Start, Length);
+        DBufferOffset += Length;
+        if(NewLine){
+            DBufferOffset++;
+            FoundNewLine = true;
+        }
+    }
+    if(std::string::npos != line.find('\r')){
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+    }
+    return FoundNewLine || line.length();
+}
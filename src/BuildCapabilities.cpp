@@ -17,6 +17,7 @@
 #include "GameModel.h"
 #include "ApplicationData.h"
 #include "Debug.h"
+#include "MemoryPool.h"
 
 // Build normal buildings capability
 
@@ -103,6 +104,7 @@ class CPlayerCapabilityBuildNormal : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step);
         };
         std::string DBuildingName;
@@ -276,7 +278,7 @@ bool CPlayerCapabilityBuildNormal::ApplyCapability(std::shared_ptr< CPlayerAsset
             NewCommand.DAction = EAssetAction::Capability;
             NewCommand.DCapability = AssetCapabilityType();
             NewCommand.DAssetTarget = NewAsset;
-            NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, NewAsset, nullptr, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
+            NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, NewAsset, nullptr, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
             actor->PushCommand(NewCommand);
         }
         else if("GoldMine" == DBuildingName) {
@@ -309,7 +311,7 @@ bool CPlayerCapabilityBuildNormal::ApplyCapability(std::shared_ptr< CPlayerAsset
             NewCommand.DAction = EAssetAction::Capability; // Pretend active
             NewCommand.DCapability = AssetCapabilityType();
             NewCommand.DAssetTarget = NewAsset;
-            NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, NewAsset, target, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
+            NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, NewAsset, target, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
       
              actor->PushCommand(NewCommand);
       
@@ -409,6 +411,27 @@ void CPlayerCapabilityBuildNormal::CActivatedCapability::Save(std::ofstream& sav
     save << DStone << std::endl;
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityBuildNormal::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "BUILD";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+    save.DCurrentStep = DCurrentStep;
+    save.DTotalSteps = DTotalSteps;
+    save.DLumber = DLumber;
+    save.DGold = DGold;
+    save.DStone = DStone;
+}
+
 void CPlayerCapabilityBuildNormal::CActivatedCapability::Step(int step){
     DCurrentStep = step;
 }
@@ -38,6 +38,7 @@
 
 #include "GameModel.h"
 #include "Debug.h"
+#include "MemoryPool.h"
 
 class CPlayerCapabilityBuildingUpgrade : public CPlayerCapability{
     protected:
@@ -66,6 +67,7 @@ class CPlayerCapabilityBuildingUpgrade : public CPlayerCapability{
                 void Cancel();
                 void Step(int step);
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
         };
         std::string DBuildingName;
         CPlayerCapabilityBuildingUpgrade(const std::string &buildingname);
@@ -189,7 +191,7 @@ bool CPlayerCapabilityBuildingUpgrade::ApplyCapability(std::shared_ptr< CPlayerA
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target, actor->AssetType(), AssetType, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target, actor->AssetType(), AssetType, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
         actor->PushCommand(NewCommand);
 
         return true;
@@ -280,6 +282,29 @@ void CPlayerCapabilityBuildingUpgrade::CActivatedCapability::Save(std::ofstream&
     save << DStone << std::endl;
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityBuildingUpgrade::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "BUILDINGUPGRADE";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+    save.DOriginalType = DOriginalType->Name();
+    save.DUpgradingType = DUpgradeType->Name();
+    save.DCurrentStep = DCurrentStep;
+    save.DTotalSteps = DTotalSteps;
+    save.DLumber = DLumber;
+    save.DGold = DGold;
+    save.DStone = DStone;
+}
+
 void CPlayerCapabilityBuildingUpgrade::CActivatedCapability::Step(int step){
     DCurrentStep = step;
 }
@@ -37,6 +37,7 @@
 #include "ButtonRenderer.h"
 #include "Debug.h"
 
+#define MAX_BUTTON_PANELS   64
 
 /**
  * CButtonRenderer constructor is passed the parameters for a new button object
@@ -156,7 +157,8 @@ int CButtonRenderer::Height(int height){
 /**
  * Uses the parameters of the button object to render the button on the screen. This
  * also re-renders a button depending on player input, rendering the button in a
- * depressed state when the player clicks it, for example
+ * depressed state when the player clicks it, for example. Each text and state is
+ * kept as a retained panel, so an unchanged button is a single copy
  *
  * @param[in] surface The surface over which the button object is rendered
  * @param[in] x The X coordinate for where to begin rendering the button on the screen
@@ -166,6 +168,33 @@ int CButtonRenderer::Height(int height){
  * @return None
  */
 void CButtonRenderer::DrawButton(std::shared_ptr<CGraphicSurface> surface, int x, int y, EButtonState state){
+    if((MAX_BUTTON_PANELS <= DButtonPanels.size()) && (DButtonPanels.end() == DButtonPanels.find(DText))){
+        DButtonPanels.clear();
+    }
+    std::vector< CRetainedPanel > &Panels = DButtonPanels[DText];
+    
+    if(Panels.empty()){
+        Panels.resize(to_underlying(EButtonState::Max));
+    }
+    CRetainedPanel &Panel = Panels[to_underlying(state)];
+    
+    if(Panel.Update(DWidth, DHeight, {to_underlying(DButtonColor), DTextOffsetX, DTextOffsetY})){
+        DrawButtonFace(Panel.Surface(), 0, 0, state);
+    }
+    Panel.Draw(surface, x, y);
+}
+
+/**
+ * Renders the fill, text and bevel of the button for a state
+ *
+ * @param[in] surface The surface over which the button face is rendered
+ * @param[in] x The X coordinate for where to begin rendering the button
+ * @param[in] y The Y coordinate for where to begin rendering the button
+ * @param[in] state The state of the button to render
+ *
+ * @return None
+ */
+void CButtonRenderer::DrawButtonFace(std::shared_ptr<CGraphicSurface> surface, int x, int y, EButtonState state){
     auto ResourceContext = surface->CreateResourceContext();
     if(EButtonState::Pressed == state){
         int BevelWidth = DInnerBevel->Width();
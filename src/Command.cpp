@@ -1,6 +1,7 @@
 #include "Command.hpp"
 #include <cctype> // For toUpper
 #include <algorithm> // For transform
+#include <cstring> // For memchr, strlen
 // Should parse everything, more or less.
 Command::Command(std::string everything,bool)
     : str(everything) {
@@ -46,7 +47,6 @@ void Command::setCommandAndType() {
        "|S" != type &&
        "DD" != type &&
        "D2" != type) {
-	std::cout << "Auto deriving type, SS" << std::endl;
 	type = "SS";
     } else  {
 	_cmd = _cmd.substr(0,_cmd.size()-2);
@@ -175,7 +175,7 @@ std::vector<std::string> Command::directiveSplit(std::string directive,
 	    toPut = unescape(toPut);
 	    ret.push_back(toPut);
 	    x = y+1;
-	} catch (std::exception e) {
+	} catch (const std::exception &) {
 	    throw error("Incorrect Directive, bad numbers");
 	}
     }
@@ -477,3 +477,118 @@ void Command::toUpper(std::string& s) {
     std::transform(s.begin(),s.end(),s.begin(),
 		   [](unsigned char c){ return std::toupper(c);});
 }
+
+bool CommandSpan::equals(const char* s) const {
+    std::size_t length = std::strlen(s);
+    return length == size && 0 == std::memcmp(data,s,length);
+}
+bool CommandSpan::equalsNoCase(const char* s) const {
+    std::size_t length = std::strlen(s);
+    if(length != size) {
+	return false;
+    }
+    for(std::size_t i = 0;i < size;++i) {
+	if(std::toupper((unsigned char)data[i]) !=
+	   std::toupper((unsigned char)s[i])) {
+	    return false;
+	}
+    }
+    return true;
+}
+bool CommandSpan::startsWith(const char* s) const {
+    std::size_t length = std::strlen(s);
+    return length <= size && 0 == std::memcmp(data,s,length);
+}
+
+CommandSpan CommandView::verb(const std::string& line) {
+    auto foundAt = line.find(' ');
+    if(foundAt == std::string::npos) {
+	foundAt = line.size();
+    }
+    return CommandSpan(line.data(),foundAt);
+}
+// Same rules as setCommandAndType and the process functions of Command,
+// only the spans are stored instead of copies.
+bool CommandView::parse(const char* line,std::size_t length) {
+    _numArgs = 0;
+    _rows = 0;
+    rowStart[0] = 0;
+    directive = false;
+    escaped = false;
+    _rest = CommandSpan(line+length,0);
+    if(length < 3) {
+	return false;
+    }
+    const char* space = (const char*)std::memchr(line,' ',length);
+    std::size_t verbLength = space ? space-line : length;
+    bool commandOnly = nullptr == space;
+
+    if(!commandOnly) {
+	_rest = CommandSpan(space+1,length-verbLength-1);
+	// Command::get unescapes every argument
+	escaped = nullptr != std::memchr(_rest.data,'\\',_rest.size);
+    }
+    if(verbLength < 3) {
+	return false;
+    }
+    _type = CommandSpan(line+verbLength-2,2);
+    if(_type.equals("SS") || _type.equals("||") || _type.equals("|S") ||
+       _type.equals("DD") || _type.equals("D2")) {
+	_cmd = CommandSpan(line,verbLength-2);
+    } else {
+	_type = CommandSpan("SS",2);
+	_cmd = CommandSpan(line,verbLength);
+    }
+    if(_type.equals("DD") || _type.equals("D2")) {
+	// Arguments are escaped, Command has to unescape them
+	directive = true;
+	return !commandOnly;
+    }
+    if(commandOnly) {
+	return _type.equals("SS");
+    }
+    if(_type.equals("SS")) {
+	return split(_rest.data,_rest.size,' ') && addRow();
+    }
+    if(_type.equals("||")) {
+	return split(_rest.data,_rest.size,'|') && addRow();
+    }
+    // "|S", rows separated by pipes, arguments by spaces
+    std::size_t x = 0;
+    for(std::size_t y = 0;y < _rest.size;++y) {
+	if('|' == _rest.data[y]) {
+	    if(!split(_rest.data+x,y-x,' ') || !addRow()) {
+		return false;
+	    }
+	    x = y+1;
+	}
+    }
+    if(x < _rest.size) {
+	return split(_rest.data+x,_rest.size-x,' ') && addRow();
+    }
+    return true;
+}
+// Like Command::split, the last piece is dropped if it is empty
+bool CommandView::split(const char* s,std::size_t length,char separator) {
+    std::size_t x = 0;
+    for(std::size_t y = 0;y <= length;++y) {
+	if(y == length && x == length) {
+	    break;
+	}
+	if(y == length || separator == s[y]) {
+	    if(MAX_ARGS == _numArgs) {
+		return false;
+	    }
+	    args[_numArgs++] = CommandSpan(s+x,y-x);
+	    x = y+1;
+	}
+    }
+    return true;
+}
+bool CommandView::addRow() {
+    if(MAX_ROWS == _rows) {
+	return false;
+    }
+    rowStart[++_rows] = _numArgs;
+    return true;
+}
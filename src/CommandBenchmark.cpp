@@ -0,0 +1,478 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CCommandBenchmark
+*
+* @brief Compares the copying Command parser with the in place CommandView
+*     on a corpus of server messages. The corpus is either a file recorded
+*     with "--game-server --record FILE" or "--network-load-test --record
+*     FILE", or generated with the mix a lockstep match produces: mostly
+*     binary command frames, some text frames, chat and lobby messages.
+*
+*     First every line is parsed both ways and the results compared. Then
+*     two stages are timed: receiving, where the line is taken out of the
+*     socket's streambuf into the message queue, and parsing, where the game
+*     thread looks at the verb and extracts the command frame, chat text or
+*     player name like CMultiplayerClient does.
+*
+*     Started with "--command-benchmark", see PrintUsage for the other
+*     options.
+*
+*/
+
+#include "CommandBenchmark.h"
+#include "Command.hpp"
+#include "LockstepFrame.h"
+#include "Debug.h"
+#include <boost/asio/streambuf.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+#define COMMAND_BENCHMARK_SEED      40
+#define COMMAND_BENCHMARK_QUEUE     1024
+
+/**
+* Constructor, stores the options.
+*
+* @param[in] options The parsed benchmark options
+*
+*/
+
+CCommandBenchmark::CCommandBenchmark(const SOptions &options) : DRandom(COMMAND_BENCHMARK_SEED){
+    DOptions = options;
+}
+
+/**
+* Parses the command line for the command benchmark options. The benchmark
+* is only enabled if "--command-benchmark" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the command benchmark was requested
+*
+*/
+
+bool CCommandBenchmark::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--command-benchmark" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--corpus" == Argument){
+            options.DCorpusPath = Value;
+        }
+        else if("--lines" == Argument){
+            options.DLines = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--passes" == Argument){
+            options.DPasses = std::max(1, std::atoi(Value.c_str()));
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown command benchmark option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the command benchmark options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CCommandBenchmark::PrintUsage(const char *program){
+    PrintError("Usage: %s --command-benchmark [options]\n", program);
+    PrintError("  --corpus FILE     recorded server messages, one per line (default: generated)\n");
+    PrintError("  --lines N         lines of the generated corpus (default: 10000)\n");
+    PrintError("  --passes N        passes over the corpus per measurement (default: 100)\n");
+}
+
+/**
+* Loads or generates the corpus, checks it and runs the measurements.
+*
+* @return 0 on success, 1 if the corpus could not be loaded or the parsers
+*     disagree
+*
+*/
+
+int CCommandBenchmark::Run(){
+    if(DOptions.DCorpusPath.empty()){
+        GenerateCorpus();
+    }
+    else if(!LoadCorpus()){
+        return 1;
+    }
+    size_t Bytes = 0;
+
+    for(auto &Line : DCorpus){
+        Bytes += Line.size();
+    }
+    printf("Corpus: %d lines, %.1f bytes/line (%s)\n", (int)DCorpus.size(), (double)Bytes / std::max< size_t >(DCorpus.size(), 1), DOptions.DCorpusPath.empty() ? "generated" : DOptions.DCorpusPath.c_str());
+    if(!CheckCorpus()){
+        return 1;
+    }
+    RunReceive();
+    RunParse();
+    return 0;
+}
+
+/**
+* Returns a random player name.
+*
+* @return The name
+*
+*/
+
+std::string CCommandBenchmark::RandomName(){
+    return "player" + std::to_string(DRandom() % 100);
+}
+
+/**
+* Generates a corpus with the message mix of a lockstep match.
+*
+* @return void
+*
+*/
+
+void CCommandBenchmark::GenerateCorpus(){
+    for(int Index = 0; Index < DOptions.DLines; Index++){
+        int Kind = DRandom() % 100;
+
+        if(75 > Kind){
+            SLockstepFrame Frame;
+            SLockstepCommand FrameCommand;
+
+            Frame.DCycle = Index;
+            FrameCommand.DPlayer = static_cast< EPlayerColor >(1 + DRandom() % (to_underlying(EPlayerColor::Max) - 1));
+            FrameCommand.DAction = 50 > Kind ? EAssetCapabilityType::None : static_cast< EAssetCapabilityType >(DRandom() % to_underlying(EAssetCapabilityType::Max));
+            if(EAssetCapabilityType::None != FrameCommand.DAction){
+                for(int Actor = 1 + DRandom() % 9; Actor; Actor--){
+                    FrameCommand.DActorIDs.push_back(DRandom() % 2000);
+                }
+            }
+            FrameCommand.DTargetColor = EPlayerColor::None;
+            FrameCommand.DTargetType = EAssetType::None;
+            FrameCommand.DTargetX = DRandom() % 4096;
+            FrameCommand.DTargetY = DRandom() % 4096;
+            Frame.DCommands.push_back(FrameCommand);
+            if(70 > Kind){
+                DCorpus.push_back("COMMAND " + CLockstepFrame::EncodeMessage(Frame));
+            }
+            else{
+                // The text form is sent line by line, like sendCommand does
+                Command Text(std::string("COMMAND"));
+                std::string Input = CLockstepFrame::EncodeMessage(Frame, true);
+                size_t Start = 0;
+                size_t End;
+
+                while(std::string::npos != (End = Input.find('\n', Start))){
+                    Text.add(Input.substr(Start, End + 1 - Start));
+                    Start = End + 1;
+                }
+                DCorpus.push_back(Text.toString());
+            }
+        }
+        else if(90 > Kind){
+            DCorpus.push_back("CHAT " + RandomName() + ": attack the gold mine at " + std::to_string(DRandom() % 100));
+        }
+        else{
+            switch(DRandom() % 7){
+                case 0:     DCorpus.push_back("ISRDY " + RandomName());
+                            break;
+                case 1:     DCorpus.push_back("UNRDY " + RandomName());
+                            break;
+                case 2:     DCorpus.push_back("PLYINF " + RandomName());
+                            break;
+                case 3:     DCorpus.push_back("GSTART");
+                            break;
+                case 4:     DCorpus.push_back("LEAVE " + RandomName());
+                            break;
+                case 5:     DCorpus.push_back("RGAMESS 3 2 2player match3 " + RandomName() + " 1 1 " + RandomName() + " 0 2");
+                            break;
+                default:    DCorpus.push_back("RGAMEP|S match1 1|match2 2|match3 3");
+                            break;
+            }
+        }
+    }
+}
+
+/**
+* Loads the corpus file, empty lines are skipped.
+*
+* @return true if the file could be read and was not empty
+*
+*/
+
+bool CCommandBenchmark::LoadCorpus(){
+    std::ifstream Input(DOptions.DCorpusPath.c_str());
+    std::string Line;
+
+    if(!Input.is_open()){
+        PrintError("Could not open corpus %s\n", DOptions.DCorpusPath.c_str());
+        return false;
+    }
+    while(std::getline(Input, Line)){
+        if(!Line.empty() && ('\r' == Line.back())){
+            Line.pop_back();
+        }
+        if(!Line.empty()){
+            DCorpus.push_back(Line);
+        }
+    }
+    if(DCorpus.empty()){
+        PrintError("Corpus %s is empty\n", DOptions.DCorpusPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+* Parses every line with both parsers and compares the command and all
+* arguments.
+*
+* @return true if the parsers agree on every line
+*
+*/
+
+bool CCommandBenchmark::CheckCorpus(){
+    CommandView View;
+    int InPlace = 0;
+    int Fallback = 0;
+    int Mismatches = 0;
+
+    for(auto &Line : DCorpus){
+        if(!View.parse(Line) || View.needsUnescape()){
+            Fallback++;
+            continue;
+        }
+        InPlace++;
+        try{
+            Command Parsed(Line, true);
+            bool Same = View.is(Parsed.cmd.c_str()) && (Parsed.rows() == View.rows());
+
+            for(size_t Row = 0; Same && (Row < View.rows()); Row++){
+                Same = Parsed.numArgsInRow(Row) == View.numArgsInRow(Row);
+                for(size_t Index = 0; Same && (Index < View.numArgsInRow(Row)); Index++){
+                    Same = Parsed.get(Row, Index) == View.get(Row, Index).str();
+                }
+            }
+            if(!Same){
+                PrintError("Parsers disagree on: %s\n", Line.c_str());
+                Mismatches++;
+            }
+        }
+        catch(std::exception &Exception){
+            PrintError("Command rejected a line the view accepted: %s\n", Line.c_str());
+            Mismatches++;
+        }
+    }
+    printf("Check: %d parsed in place, %d left to Command, %d mismatches\n", InPlace, Fallback, Mismatches);
+    return 0 == Mismatches;
+}
+
+/**
+* Times taking the lines out of a streambuf into a queue of strings, once
+* through an istream and a temporary like do_read_line used to, and once
+* straight into the queue slot.
+*
+* @return void
+*
+*/
+
+void CCommandBenchmark::RunReceive(){
+    std::string Text;
+    std::vector< std::string > Queue(COMMAND_BENCHMARK_QUEUE);
+    double LegacySeconds = 0.0;
+    double ViewSeconds = 0.0;
+    size_t Checksum[2] = {0, 0};
+
+    for(auto &Line : DCorpus){
+        Text += Line + "\n";
+    }
+    for(int Pass = 0; Pass < DOptions.DPasses; Pass++){
+        for(int Method = 0; Method < 2; Method++){
+            boost::asio::streambuf Buffer;
+            std::ostream Output(&Buffer);
+            size_t Slot = 0;
+
+            Output.write(Text.data(), Text.size());
+            auto Start = std::chrono::steady_clock::now();
+            if(0 == Method){
+                std::istream Input(&Buffer);
+
+                for(size_t Index = 0; Index < DCorpus.size(); Index++){
+                    std::string Line;
+
+                    std::getline(Input, Line);
+                    Queue[Slot] = Line;
+                    Checksum[0] += Queue[Slot].size();
+                    Slot = (Slot + 1) % Queue.size();
+                }
+            }
+            else{
+                for(size_t Index = 0; Index < DCorpus.size(); Index++){
+                    const char *Data = boost::asio::buffer_cast< const char * >(Buffer.data());
+                    size_t Length = (const char *)std::memchr(Data, '\n', Buffer.size()) - Data + 1;
+
+                    Queue[Slot].assign(Data, Length - 1);
+                    Buffer.consume(Length);
+                    Checksum[1] += Queue[Slot].size();
+                    Slot = (Slot + 1) % Queue.size();
+                }
+            }
+            double Seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - Start).count();
+
+            (0 == Method ? LegacySeconds : ViewSeconds) += Seconds;
+        }
+    }
+    if(Checksum[0] != Checksum[1]){
+        PrintError("Received lines differ\n");
+    }
+    PrintResult("receive", LegacySeconds, ViewSeconds, DCorpus.size() * DOptions.DPasses);
+}
+
+/**
+* Times what the game thread does with the front of the queue: find the
+* verb, then join the arguments of a COMMAND, take the text of a CHAT or
+* the name of a PLYINF.
+*
+* @return void
+*
+*/
+
+void CCommandBenchmark::RunParse(){
+    CommandView View;
+    std::string Output;
+    double LegacySeconds = 0.0;
+    double ViewSeconds = 0.0;
+    size_t Checksum[2] = {0, 0};
+
+    for(int Pass = 0; Pass < DOptions.DPasses; Pass++){
+        auto Start = std::chrono::steady_clock::now();
+
+        for(auto &Front : DCorpus){
+            std::string Line = Front;
+            std::string Code = Line.substr(0, Line.find(' '));
+
+            try{
+                if(0 == Code.compare(0, 7, "COMMAND")){
+                    Command Parsed(Line, true);
+
+                    Output = Parsed.arg();
+                    while(Parsed.next()){
+                        Output += Parsed.arg();
+                    }
+                }
+                else if("CHAT" == Code){
+                    Output = Line.substr(Line.find(' '));
+                }
+                else if("PLYINF" == Code){
+                    Output = Command(Line, true).arg();
+                }
+                else{
+                    Output.clear();
+                }
+            }
+            catch(std::exception &Exception){
+                Output.clear();
+            }
+            Checksum[0] += Output.size();
+        }
+        auto Middle = std::chrono::steady_clock::now();
+
+        for(auto &Front : DCorpus){
+            CommandSpan Code = CommandView::verb(Front);
+
+            Output.clear();
+            if(Code.startsWith("COMMAND")){
+                if(View.parse(Front) && !View.needsUnescape()){
+                    for(size_t Index = 0; Index < View.numArgs(); Index++){
+                        View.arg(Index).appendTo(Output);
+                    }
+                }
+                else{
+                    try{
+                        Command Parsed(Front, true);
+
+                        Output = Parsed.arg();
+                        while(Parsed.next()){
+                            Output += Parsed.arg();
+                        }
+                    }
+                    catch(std::exception &Exception){
+                        Output.clear();
+                    }
+                }
+            }
+            else if(Code.equals("CHAT")){
+                Output.assign(Front, Code.size, std::string::npos);
+            }
+            else if(Code.equals("PLYINF")){
+                if(View.parse(Front) && View.numArgs()){
+                    View.arg(0).appendTo(Output);
+                }
+            }
+            Checksum[1] += Output.size();
+        }
+        auto End = std::chrono::steady_clock::now();
+
+        LegacySeconds += std::chrono::duration< double >(Middle - Start).count();
+        ViewSeconds += std::chrono::duration< double >(End - Middle).count();
+    }
+    if(Checksum[0] != Checksum[1]){
+        PrintError("Parsed messages differ\n");
+    }
+    PrintResult("parse", LegacySeconds, ViewSeconds, DCorpus.size() * DOptions.DPasses);
+}
+
+/**
+* Prints the time per line of both methods.
+*
+* @param[in] name The name of the stage
+* @param[in] legacySeconds The time of the copying method
+* @param[in] viewSeconds The time of the in place method
+* @param[in] lines The number of lines handled by each method
+*
+* @return void
+*
+*/
+
+void CCommandBenchmark::PrintResult(const char *name, double legacySeconds, double viewSeconds, size_t lines){
+    printf("%-8s Command %8.1f ns/line, CommandView %8.1f ns/line, %5.2fx\n", name, legacySeconds * 1e9 / lines, viewSeconds * 1e9 / lines, legacySeconds / std::max(viewSeconds, 1e-12));
+}
@@ -54,21 +54,20 @@ CCommentSkipLineDataSource::CCommentSkipLineDataSource(std::shared_ptr< CDataSou
  * @return bool true if reached a comment character
 */
 bool CCommentSkipLineDataSource::Read(std::string &line){
-    std::string TempLine;
-    
     while(true){
-        if(!CLineDataSource::Read(TempLine)){
+        if(!CLineDataSource::Read(DTempLine)){
             return false;
         }
-        if(!TempLine.length() || TempLine[0] != DCommentCharacter){
-            line = TempLine;
+        if(!DTempLine.length() || DTempLine[0] != DCommentCharacter){
             break;
         }
-        if((2 <= TempLine.length())&&(TempLine[1] == DCommentCharacter)){
-            line = TempLine.substr(1);
+        if((2 <= DTempLine.length())&&(DTempLine[1] == DCommentCharacter)){
+            DTempLine.erase(0, 1);
             break;
         }
     }
+    // Swap rather than copy, the old buffer of line is reused for the next read
+    line.swap(DTempLine);
     return true;
 }
 
@@ -0,0 +1,57 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CDataSource
+*
+* @brief Interface of the sources of data. ReadLine is implemented on top of
+*     Read one character at a time, sources that can find the end of a line
+*     in their own data override it.
+*
+*/
+
+#include "DataSource.h"
+
+/**
+* Reads the next line of text. The new line is consumed but not stored, and
+* carriage returns are skipped.
+*
+* @param[out] line The line read
+*
+* @return true if a new line was reached or anything was read
+*
+*/
+
+bool CDataSource::ReadLine(std::string &line){
+    char TempChar;
+
+    line.clear();
+    while(true){
+        if(0 < Read(&TempChar, 1)){
+            // Check until reach a new line character
+            if('\n' == TempChar){
+                return true;
+            }
+            // Skip carriage returns
+            else if('\r' != TempChar){
+                line += TempChar;
+            }
+        }
+        else{
+            return 0 < line.length();
+        }
+    }
+}
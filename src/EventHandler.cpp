@@ -3,6 +3,7 @@
 #include "BattleMode.h"
 #include "GameModel.h"
 #include "StringAndTypeConversion.h"
+#include "ScriptCache.h"
 
 extern "C" {
     #include "lua.h"
@@ -28,10 +29,11 @@ void CEventHandler::SetEventScript (std::string scriptName){
 void CEventHandler::DoEvent (int offenderID, std::string event, std::vector< std::string > params, EPlayerColor color){
 	//printf("DoEvent\n");
 
-    lua_State *L = luaL_newstate();
+    lua_State *L = CScriptCache::NewState();
     luaL_openlibs(L);
+    CScriptCache::InstallSearcher(L);
     RegisterFunctions(L);
-    luaL_dofile(L, DEventScript.c_str());
+    CScriptCache::DoFile(L, DEventScript);
 
     lua_pushnumber(L, (int)color);
     lua_setglobal(L, "PlayerColor");
@@ -94,6 +94,17 @@ int CFileDataSink::Write(const void *data, int length){
     return -1;
 }
 
+/**
+ * Flushes the written data of the current open file to the disk.
+ * 
+ * @return True if the data reached the disk, false otherwise.
+ * 
+ */ 
+
+bool CFileDataSink::Sync(){
+    return (0 <= DFileHandle) && (0 == fsync(DFileHandle));
+}
+
 /**
  * Creates a directory data container for I/O for the current path.
  * 
@@ -34,8 +34,10 @@
 #include "FileDataSource.h"
 #include "FileDataContainer.h"
 #include "Path.h"
+#include "StartupTrace.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <cstdio>
 #include "Debug.h"
 
@@ -51,13 +53,16 @@
  * 
  */
 
-CFileDataSource::CFileDataSource(const std::string &filename, int fd) : CDataSource(){
+CFileDataSource::CFileDataSource(const std::string &filename, int fd) : CBufferedDataSource(){
     DFullPath = CPath::CurrentPath().Simplify(filename).ToString();
 
     DFileHandle = fd;
     if(DFullPath.length() && (0 > fd)){
         DFileHandle = open(DFullPath.c_str(), O_RDONLY);
         DCloseFile = true;
+        if(0 <= DFileHandle){
+            CStartupTrace::CountFile();
+        }
     } else{
     	PrintDebug(DEBUG_LOW, "Failed to open file source for %s\n", filename.c_str());
     }
@@ -77,7 +82,8 @@ CFileDataSource::~CFileDataSource(){
 }
 
 /**
- * Reads from the current open file.
+ * Reads the next block from the current open file, CBufferedDataSource
+ * calls this once per block rather than once per Read.
  * 
  * @param[in] data   The buffer to store data read from the file.
  * @param[in] length The number of bytes to read.
@@ -86,11 +92,12 @@ CFileDataSource::~CFileDataSource(){
  * 
  */ 
 
-int CFileDataSource::Read(void *data, int length){
+int CFileDataSource::ReadBlock(void *data, int length){
     if(0 <= DFileHandle){
         int BytesRead = read(DFileHandle, data, length);
 
         if(0 < BytesRead){
+            CStartupTrace::CountBytes(BytesRead);
             return BytesRead;
         }
     }
@@ -98,13 +105,17 @@ int CFileDataSource::Read(void *data, int length){
 }
 
 /**
- * Creates a directory data container for I/O for the current path.
+ * Creates a directory data container for I/O for the current path, unless
+ * one was set with Container(container).
  * 
  * @return A new directory data container.
  * 
  */
 
 std::shared_ptr< CDataContainer > CFileDataSource::Container(){
+    if(nullptr != DContainer){
+        return DContainer;
+    }
     std::string ContainerName = CPath(DFullPath).Containing().ToString();
 
     if(ContainerName.length()){
@@ -113,3 +124,33 @@ std::shared_ptr< CDataContainer > CFileDataSource::Container(){
     }
     return nullptr;
 }
+
+/**
+ * Sets the container returned by Container(), used when the file is served
+ * by a container other than its directory.
+ * 
+ * @param[in] container The container the file is in.
+ * 
+ * @return Nothing.
+ * 
+ */
+
+void CFileDataSource::Container(std::shared_ptr< CDataContainer > container){
+    DContainer = container;
+}
+
+/**
+ * Gets the time the open file was last modified.
+ * 
+ * @return The modification time, or 0 if the file is not open.
+ * 
+ */
+
+time_t CFileDataSource::ModificationTime(){
+    struct stat FileStatus;
+
+    if((0 <= DFileHandle) && (0 == fstat(DFileHandle, &FileStatus))){
+        return FileStatus.st_mtime;
+    }
+    return 0;
+}
@@ -42,6 +42,7 @@
 #include <fstream>
 #include "FileDataSource.h"
 #include "CommentSkipLineDataSource.h"
+#include <algorithm>
 
 /**
 * Constructor initializes protected data members with parameter values of the map
@@ -66,10 +67,189 @@ CFogRenderer::CFogRenderer(std::shared_ptr< CGraphicTileset > tileset, std::shar
     }
     DSeenIndex = DFogIndices[0x00];
     DNoneIndex = DBlackIndices[0x00];
+    DCacheWidth = 0;
+    DCacheHeight = 0;
 }
 
 /**
-* Draws the map to include the fog of war based on unit coordinates.
+* Drops every cached fog tile, forcing the indices to be recomputed the next
+* time they are drawn. Called when the visibility map is replaced.
+*
+* @return void
+*
+*/
+
+void CFogRenderer::InvalidateCache(){
+    DCacheWidth = 0;
+    DCacheHeight = 0;
+    DTileCache.clear();
+}
+
+/**
+* Marks a tile whose visibility transitioned so that it and its neighbours
+* are recomputed, the fog and black edge tiles depend on all 8 neighbours.
+*
+* @param[in] xindex X tile index that changed
+* @param[in] yindex Y tile index that changed
+*
+* @return void
+*
+*/
+
+void CFogRenderer::MarkTransition(int xindex, int yindex){
+    for(int YOff = -1; YOff < 2; YOff++){
+        for(int XOff = -1; XOff < 2; XOff++){
+            MarkDirty(xindex + XOff, yindex + YOff);
+        }
+    }
+}
+
+/**
+* Flags a cached tile for recomputation, ignoring tiles outside of the map.
+*
+* @param[in] xindex X tile index
+* @param[in] yindex Y tile index
+*
+* @return void
+*
+*/
+
+void CFogRenderer::MarkDirty(int xindex, int yindex){
+    if((0 <= xindex)&&(0 <= yindex)&&(xindex < DCacheWidth)&&(yindex < DCacheHeight)){
+        DTileCache[yindex * DCacheWidth + xindex].DDirty = true;
+    }
+}
+
+/**
+* Calculates which base, fog and black edge tiles are needed for a tile by
+* inspecting its 8 neighbours in the visibility map. A negative index means
+* nothing is drawn for that layer.
+*
+* @param[in] xindex X tile index
+* @param[in] yindex Y tile index
+* @param[out] tile Cache entry to fill in
+*
+* @return void
+*
+*/
+
+void CFogRenderer::ComputeTile(int xindex, int yindex, SFogTile &tile) const{
+    CVisibilityMap::ETileVisibility TileType = DMap->TileType(xindex, yindex);
+
+    tile.DVisibility = TileType;
+    tile.DBaseIndex = -1;
+    tile.DFogIndex = -1;
+    tile.DBlackIndex = -1;
+    tile.DDirty = false;
+
+    if(CVisibilityMap::ETileVisibility::None == TileType){
+        tile.DBaseIndex = DNoneIndex;
+        return;
+    }
+    else if(CVisibilityMap::ETileVisibility::Visible == TileType){
+        return;
+    }
+    if((CVisibilityMap::ETileVisibility::Seen == TileType)||(CVisibilityMap::ETileVisibility::SeenPartial == TileType)){
+        tile.DBaseIndex = DSeenIndex;
+    }
+    if((CVisibilityMap::ETileVisibility::PartialPartial == TileType)||(CVisibilityMap::ETileVisibility::Partial == TileType)){
+        int VisibilityIndex = 0, VisibilityMask = 0x1;
+
+        for(int YOff = -1; YOff < 2; YOff++){
+            for(int XOff = -1; XOff < 2; XOff++){
+                if(YOff || XOff){
+                    CVisibilityMap::ETileVisibility VisTile = DMap->TileType(xindex + XOff, yindex + YOff);
+
+                    if(CVisibilityMap::ETileVisibility::Visible == VisTile){
+                        VisibilityIndex |= VisibilityMask;
+                    }
+                    VisibilityMask <<= 1;
+                }
+            }
+        }
+        tile.DFogIndex = DFogIndices[VisibilityIndex];
+    }
+
+    if((CVisibilityMap::ETileVisibility::PartialPartial == TileType)||(CVisibilityMap::ETileVisibility::SeenPartial == TileType)){
+        int VisibilityIndex = 0, VisibilityMask = 0x1;
+
+        for(int YOff = -1; YOff < 2; YOff++){
+            for(int XOff = -1; XOff < 2; XOff++){
+                if(YOff || XOff){
+                    CVisibilityMap::ETileVisibility VisTile = DMap->TileType(xindex + XOff, yindex + YOff);
+
+                    if((CVisibilityMap::ETileVisibility::Visible == VisTile)||(CVisibilityMap::ETileVisibility::Partial == VisTile)||(CVisibilityMap::ETileVisibility::Seen == VisTile)){
+                        VisibilityIndex |= VisibilityMask;
+                    }
+                    VisibilityMask <<= 1;
+                }
+            }
+        }
+        tile.DBlackIndex = DBlackIndices[VisibilityIndex];
+    }
+}
+
+/**
+* Compares the visibility of the tiles in the given range (inclusive) against
+* the values seen on the previous draw. Any tile that transitioned marks itself
+* and its neighbours dirty, dirty tiles are then recomputed. Tiles outside of
+* the range keep their dirty flag until they are synced. The visibility map
+* rewrites every cell on each update, so comparing the in view tiles against
+* the cache is how transitions are found.
+*
+* @param[in] minx Minimum X tile index
+* @param[in] miny Minimum Y tile index
+* @param[in] maxx Maximum X tile index
+* @param[in] maxy Maximum Y tile index
+*
+* @return void
+*
+*/
+
+void CFogRenderer::SyncCache(int minx, int miny, int maxx, int maxy){
+    if((DCacheWidth != DMap->Width())||(DCacheHeight != DMap->Height())){
+        DCacheWidth = DMap->Width();
+        DCacheHeight = DMap->Height();
+        DTileCache.resize(DCacheWidth * DCacheHeight);
+        for(int YIndex = 0; YIndex < DCacheHeight; YIndex++){
+            for(int XIndex = 0; XIndex < DCacheWidth; XIndex++){
+                ComputeTile(XIndex, YIndex, DTileCache[YIndex * DCacheWidth + XIndex]);
+            }
+        }
+        return;
+    }
+    minx = std::max(minx, 0);
+    miny = std::max(miny, 0);
+    maxx = std::min(maxx, DCacheWidth - 1);
+    maxy = std::min(maxy, DCacheHeight - 1);
+
+    // Detect visibility transitions, a change affects the tile and its neighbours
+    for(int YIndex = miny; YIndex <= maxy; YIndex++){
+        for(int XIndex = minx; XIndex <= maxx; XIndex++){
+            SFogTile &Tile = DTileCache[YIndex * DCacheWidth + XIndex];
+            CVisibilityMap::ETileVisibility TileType = DMap->TileType(XIndex, YIndex);
+
+            if(Tile.DVisibility != TileType){
+                Tile.DVisibility = TileType;
+                MarkTransition(XIndex, YIndex);
+            }
+        }
+    }
+    for(int YIndex = miny; YIndex <= maxy; YIndex++){
+        for(int XIndex = minx; XIndex <= maxx; XIndex++){
+            SFogTile &Tile = DTileCache[YIndex * DCacheWidth + XIndex];
+
+            if(Tile.DDirty){
+                ComputeTile(XIndex, YIndex, Tile);
+            }
+        }
+    }
+}
+
+/**
+* Draws the map to include the fog of war based on unit coordinates. The fog
+* indices come from the tile cache, only tiles whose visibility (or their
+* neighbours' visibility) changed since the last draw are recomputed.
 *
 * @param[in] surface Shared pointer of CGraphicSurface
 * @param[in] rect Constant reference to a SRectangle object
@@ -84,58 +264,35 @@ void CFogRenderer::DrawMap(std::shared_ptr<CGraphicSurface> surface, const SRect
     TileWidth = DTileset->TileWidth();
     TileHeight = DTileset->TileHeight();
 
-    // Draw the visible map based on the coordinates in the parameters
-    for(int YIndex = rect.DYPosition / TileHeight, YPos = -(rect.DYPosition % TileHeight); YPos < rect.DHeight; YIndex++, YPos += TileHeight){
-        for(int XIndex = rect.DXPosition / TileWidth, XPos = -(rect.DXPosition % TileWidth); XPos < rect.DWidth; XIndex++, XPos += TileWidth){
-            CVisibilityMap::ETileVisibility TileType = DMap->TileType(XIndex, YIndex);
+    int MinXIndex = rect.DXPosition / TileWidth;
+    int MinYIndex = rect.DYPosition / TileHeight;
+    int MaxXIndex = (rect.DXPosition + rect.DWidth) / TileWidth;
+    int MaxYIndex = (rect.DYPosition + rect.DHeight) / TileHeight;
+
+    // Sync one tile beyond the view so neighbour transitions are caught
+    SyncCache(MinXIndex - 1, MinYIndex - 1, MaxXIndex + 1, MaxYIndex + 1);
 
-            //NN: I demand all tiles be considered visible >:V
-            //TileType = CVisibilityMap::ETileVisibility::Visible;
+    // Draw the visible map based on the coordinates in the parameters
+    for(int YIndex = MinYIndex, YPos = -(rect.DYPosition % TileHeight); YPos < rect.DHeight; YIndex++, YPos += TileHeight){
+        for(int XIndex = MinXIndex, XPos = -(rect.DXPosition % TileWidth); XPos < rect.DWidth; XIndex++, XPos += TileWidth){
+            SFogTile TempTile;
+            const SFogTile *Tile;
 
-            if(CVisibilityMap::ETileVisibility::None == TileType){
-                DTileset->DrawTile(surface, XPos, YPos, DNoneIndex);
-                continue;
+            if((0 <= XIndex)&&(0 <= YIndex)&&(XIndex < DCacheWidth)&&(YIndex < DCacheHeight)){
+                Tile = &DTileCache[YIndex * DCacheWidth + XIndex];
             }
-            else if(CVisibilityMap::ETileVisibility::Visible == TileType){
-                continue;
+            else{
+                ComputeTile(XIndex, YIndex, TempTile);
+                Tile = &TempTile;
             }
-            if((CVisibilityMap::ETileVisibility::Seen == TileType)||(CVisibilityMap::ETileVisibility::SeenPartial == TileType)){
-                DTileset->DrawTile(surface, XPos, YPos, DSeenIndex);
+            if(0 <= Tile->DBaseIndex){
+                DTileset->DrawTile(surface, XPos, YPos, Tile->DBaseIndex);
             }
-            if((CVisibilityMap::ETileVisibility::PartialPartial == TileType)||(CVisibilityMap::ETileVisibility::Partial == TileType)){
-                int VisibilityIndex = 0, VisibilityMask = 0x1;
-
-                for(int YOff = -1; YOff < 2; YOff++){
-                    for(int XOff = -1; XOff < 2; XOff++){
-                        if(YOff || XOff){
-                            CVisibilityMap::ETileVisibility VisTile = DMap->TileType(XIndex + XOff, YIndex + YOff);
-
-                            if(CVisibilityMap::ETileVisibility::Visible == VisTile){
-                                VisibilityIndex |= VisibilityMask;
-                            }
-                            VisibilityMask <<= 1;
-                        }
-                    }
-                }
-                DTileset->DrawTile(surface, XPos, YPos, DFogIndices[VisibilityIndex]);
+            if(0 <= Tile->DFogIndex){
+                DTileset->DrawTile(surface, XPos, YPos, Tile->DFogIndex);
             }
-
-            if((CVisibilityMap::ETileVisibility::PartialPartial == TileType)||(CVisibilityMap::ETileVisibility::SeenPartial == TileType)){
-                int VisibilityIndex = 0, VisibilityMask = 0x1;
-
-                for(int YOff = -1; YOff < 2; YOff++){
-                    for(int XOff = -1; XOff < 2; XOff++){
-                        if(YOff || XOff){
-                            CVisibilityMap::ETileVisibility VisTile = DMap->TileType(XIndex + XOff, YIndex + YOff);
-
-                            if((CVisibilityMap::ETileVisibility::Visible == VisTile)||(CVisibilityMap::ETileVisibility::Partial == VisTile)||(CVisibilityMap::ETileVisibility::Seen == VisTile)){
-                                VisibilityIndex |= VisibilityMask;
-                            }
-                            VisibilityMask <<= 1;
-                        }
-                    }
-                }
-                DTileset->DrawTile(surface, XPos, YPos, DBlackIndices[VisibilityIndex]);
+            if(0 <= Tile->DBlackIndex){
+                DTileset->DrawTile(surface, XPos, YPos, Tile->DBlackIndex);
             }
         }
     }
@@ -31,18 +31,23 @@
 */
 
 #include "FontTileset.h"
+#include "GraphicFactory.h"
 #include "LineDataSource.h"
 #include "Tokenizer.h"
 #include "Debug.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
+
+#define DEFAULT_TEXT_RUN_CAPACITY   256
 
 /**
-* Empty Constructor to instantiate CFontTileset object
+* Constructor to instantiate CFontTileset object with the default text run
+* cache capacity
 *
 */
 CFontTileset::CFontTileset(){
-    
+    DTextRunCapacity = DEFAULT_TEXT_RUN_CAPACITY;
 }
 
 /**
@@ -83,12 +88,14 @@ uint32_t CFontTileset::TopBottomSearch(void *data, uint32_t pixel){
 *
 * @param[in] colormap shared pointer of CGraphicRecolorMap
 * @param[in] source shared pointer of CDataSource
+* @param[in] surface the already decoded PNG of the font, or nullptr to load
+*   the PNG named in the source
 *
 * @return True if this function was able to load the font
 *
 */
 
-bool CFontTileset::LoadFont(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source){
+bool CFontTileset::LoadFont(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface){
     // Instantiate local variables to load font
     CLineDataSource LineSource(source);
     std::string TempString;
@@ -96,7 +103,8 @@ bool CFontTileset::LoadFont(std::shared_ptr< CGraphicRecolorMap > colormap, std:
     std::vector< int > BottomOccurence;
     int BestLine = 0;
     
-    if(!CGraphicMulticolorTileset::LoadTileset(colormap, source)){
+    ClearTextRuns();
+    if(!CGraphicMulticolorTileset::LoadTileset(colormap, source, surface)){
         return false;    
     }    
     
@@ -159,28 +167,162 @@ LoadFontExit:
 }
 
 /**
-* Draws the font into the application instance
+* Loads the font again in place with the color map it was loaded with. The
+* font is only replaced once the new one loaded, the run cache starts out
+* empty and keeps its capacity.
 *
-* @param[in] surface shared pointer of CGraphicSurface
-* @param[in] xpos integer of x coordinate
-* @param[in] ypos integer of y coordinate
-* @param[in] str constant reference to the text that this function will draw
+* @param[in] source shared pointer of CDataSource
 *
-* @return void
+* @return True if the font was reloaded
 *
 */
 
-void CFontTileset::DrawText(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, const std::string &str){
+bool CFontTileset::ReloadTileset(std::shared_ptr< CDataSource > source){
+    CFontTileset Reloaded;
+    size_t Capacity = DTextRunCapacity;
+
+    if(!Reloaded.LoadFont(DColorMap, source)){
+        return false;
+    }
+    *this = Reloaded;
+    DTextRunCapacity = Capacity;
+    AccountMemory();
+    return true;
+}
+
+/**
+* Finds the cached run for a string, measuring it and adding it to the cache
+* if it is not present. The least recently used run is evicted when the cache
+* is full. Only the metrics are computed here, surfaces are rendered on demand
+* by TextRunSurface.
+*
+* @param[in] str constant reference to the text of the run
+*
+* @return reference to the cached run
+*
+*/
+
+CFontTileset::STextRun &CFontTileset::FindTextRun(const std::string &str){
+    auto Search = DTextRuns.find(str);
+    
+    if(DTextRuns.end() != Search){
+        DTextRunUsage.splice(DTextRunUsage.begin(), DTextRunUsage, Search->second.DUsage);
+        return Search->second;
+    }
+    while(DTextRuns.size() && (DTextRuns.size() >= DTextRunCapacity)){
+        DTextRuns.erase(DTextRunUsage.back());
+        DTextRunUsage.pop_back();
+    }
+    
+    STextRun &Run = DTextRuns[str];
     int LastChar, NextChar;
+    int XPos = 0, MinX = 0, MaxX = 0;
+    
+    Run.DWidth = 0;
+    Run.DTop = DTileHeight;
+    Run.DBottom = 0;
     for(int Index = 0; Index < str.length(); Index++){
         NextChar = str[Index] - ' ';
         
         if(Index){
-            xpos += DCharacterWidths[LastChar] + DDeltaWidths[LastChar][NextChar]; 
+            XPos += DCharacterWidths[LastChar] + DDeltaWidths[LastChar][NextChar];
+            Run.DWidth += DDeltaWidths[LastChar][NextChar]; 
+        }
+        MinX = std::min(MinX, XPos);
+        MaxX = std::max(MaxX, XPos);
+        Run.DWidth += DCharacterWidths[NextChar]; 
+        if(DCharacterTops[NextChar] < Run.DTop){
+            Run.DTop = DCharacterTops[NextChar];   
+        }
+        if(DCharacterBottoms[NextChar] > Run.DBottom){
+            Run.DBottom = DCharacterBottoms[NextChar];   
         }
-        CGraphicTileset::DrawTile(surface, xpos, ypos, NextChar);
         LastChar = NextChar;
     }
+    Run.DOffsetX = MinX;
+    Run.DSurfaceWidth = MaxX - MinX + DTileWidth;
+    Run.DSurfaces.resize(DColoredTilesets.size() + 1);
+    DTextRunUsage.push_front(str);
+    Run.DUsage = DTextRunUsage.begin();
+    
+    return Run;
+}
+
+/**
+* Returns the surface of a run in a color, rendering the glyphs once with
+* kerning applied if the run has not been drawn in that color yet
+*
+* @param[in] run reference to the cached run
+* @param[in] str constant reference to the text of the run
+* @param[in] colorindex integer of the color index, -1 for the uncolored font
+*
+* @return shared pointer of the rendered run surface
+*
+*/
+
+std::shared_ptr< CGraphicSurface > CFontTileset::TextRunSurface(STextRun &run, const std::string &str, int colorindex){
+    std::shared_ptr< CGraphicSurface > &RunSurface = run.DSurfaces[colorindex + 1];
+    
+    if(!RunSurface){
+        int LastChar, NextChar;
+        int XPos = -run.DOffsetX;
+        
+        RunSurface = CGraphicFactory::CreateSurface(run.DSurfaceWidth, DTileHeight, CGraphicSurface::ESurfaceFormat::ARGB32);
+        RunSurface->Clear();
+        for(int Index = 0; Index < str.length(); Index++){
+            NextChar = str[Index] - ' ';
+            
+            if(Index){
+                XPos += DCharacterWidths[LastChar] + DDeltaWidths[LastChar][NextChar]; 
+            }
+            if(0 > colorindex){
+                CGraphicTileset::DrawTile(RunSurface, XPos, 0, NextChar);
+            }
+            else{
+                CGraphicMulticolorTileset::DrawTile(RunSurface, XPos, 0, NextChar, colorindex);
+            }
+            LastChar = NextChar;
+        }
+    }
+    return RunSurface;
+}
+
+/**
+* Draws a string through the run cache
+*
+* @param[in] surface shared pointer of CGraphicSurface
+* @param[in] xpos integer of x coordinate
+* @param[in] ypos integer of y coordinate
+* @param[in] colorindex integer of the color index, -1 for the uncolored font
+* @param[in] str constant reference to the text that this function will draw
+*
+* @return void
+*
+*/
+
+void CFontTileset::DrawTextRun(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int colorindex, const std::string &str){
+    if(str.empty()){
+        return;
+    }
+    STextRun &Run = FindTextRun(str);
+    
+    surface->Draw(TextRunSurface(Run, str, colorindex), xpos + Run.DOffsetX, ypos, Run.DSurfaceWidth, DTileHeight, 0, 0);
+}
+
+/**
+* Draws the font into the application instance
+*
+* @param[in] surface shared pointer of CGraphicSurface
+* @param[in] xpos integer of x coordinate
+* @param[in] ypos integer of y coordinate
+* @param[in] str constant reference to the text that this function will draw
+*
+* @return void
+*
+*/
+
+void CFontTileset::DrawText(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, const std::string &str){
+    DrawTextRun(surface, xpos, ypos, -1, str);
 }
 
 /**
@@ -197,22 +339,10 @@ void CFontTileset::DrawText(std::shared_ptr<CGraphicSurface> surface, int xpos,
 */
 
 void CFontTileset::DrawTextColor(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int colorindex, const std::string &str){
-    int LastChar, NextChar;
-    
     if((0 > colorindex)||(colorindex >= DColoredTilesets.size())){
         return;    
     }
-    for(int Index = 0; Index < str.length(); Index++){
-        NextChar = str[Index] - ' ';
-        
-        if(Index){
-            xpos += DCharacterWidths[LastChar] + DDeltaWidths[LastChar][NextChar]; 
-        }
-        
-        CGraphicMulticolorTileset::DrawTile(surface, xpos, ypos, NextChar, colorindex);
-        
-        LastChar = NextChar;
-    }
+    DrawTextRun(surface, xpos, ypos, colorindex, str);
 }
 
 /**
@@ -260,7 +390,8 @@ void CFontTileset::MeasureText(const std::string &str, int &width, int &height){
 }
 
 /**
-* Measures the text based on the details provided in MesaureText
+* Measures the text based on the details provided in MesaureText, the metrics
+* come from the same run cache used for drawing
 *
 * @param[in] str constant reference to the text that this function will measure
 * @param[in] width integer reference to width of text
@@ -273,25 +404,46 @@ void CFontTileset::MeasureText(const std::string &str, int &width, int &height){
 */
 
 void CFontTileset::MeasureTextDetailed(const std::string &str, int &width, int &height, int &top, int &bottom){
-    int LastChar, NextChar;
-    width = 0;
-    top = DTileHeight;
-    bottom = 0;
-    for(int Index = 0; Index < str.length(); Index++){
-        NextChar = str[Index] - ' ';
-        
-        if(Index){
-            width += DDeltaWidths[LastChar][NextChar]; 
-        }
-        width += DCharacterWidths[NextChar]; 
-        if(DCharacterTops[NextChar] < top){
-            top = DCharacterTops[NextChar];   
-        }
-        if(DCharacterBottoms[NextChar] > bottom){
-            bottom = DCharacterBottoms[NextChar];   
-        }
-        LastChar = NextChar;
-    }
     height = DTileHeight;
+    if(str.empty()){
+        width = 0;
+        top = DTileHeight;
+        bottom = 0;
+        return;
+    }
+    STextRun &Run = FindTextRun(str);
+    
+    width = Run.DWidth;
+    top = Run.DTop;
+    bottom = Run.DBottom;
+}
+
+/**
+* Sets the maximum number of runs kept in the cache, evicting the least
+* recently used runs if there are too many
+*
+* @param[in] capacity maximum number of cached runs, at least one
+*
+* @return void
+*
+*/
+
+void CFontTileset::TextRunCapacity(size_t capacity){
+    DTextRunCapacity = std::max(capacity, (size_t)1);
+    while(DTextRuns.size() > DTextRunCapacity){
+        DTextRuns.erase(DTextRunUsage.back());
+        DTextRunUsage.pop_back();
+    }
 }
 
+/**
+* Empties the run cache, called when the font is (re)loaded
+*
+* @return void
+*
+*/
+
+void CFontTileset::ClearTextRuns(){
+    DTextRuns.clear();
+    DTextRunUsage.clear();
+}
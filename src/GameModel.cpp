@@ -186,6 +186,15 @@ CPlayerData::CPlayerData(std::shared_ptr< CAssetDecoratedMap > map, std::shared_
     }
 }
 
+/**
+*  Destructor, the events still pending are no longer counted
+*
+*/
+
+CPlayerData::~CPlayerData(){
+    ClearGameEvents();
+}
+
 /**
 *  Calculates food cost of an asset
 *
@@ -0,0 +1,610 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CGameServer
+*
+* @brief A small game server that speaks the protocol of CMultiplayerClient,
+*     so multiplayer games and the network code can be run without the
+*     external server. It keeps the logged in users and the hosted games in
+*     memory and answers LOGIN, MYINFO, LGAMES, HGAMEP, JGAME, GETINF,
+*     READY, START, QUIT and LOGOUT. COMMAND, CHAT and SENDMAP lines are
+*     relayed unchanged to the other players of the sender's game.
+*
+*     All sessions and games are handled on one io_service thread, so the
+*     game tables need no locking. Only the statistics are read from other
+*     threads.
+*
+*     Started with "--game-server", CNetworkLoadTest also runs one on the
+*     loopback interface.
+*
+*/
+
+#include "GameServer.h"
+#include "Command.hpp"
+#include "Debug.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+
+using boost::asio::ip::tcp;
+
+class CGameServerSession : public std::enable_shared_from_this< CGameServerSession >{
+    public:
+        CGameServer *DServer;
+        tcp::socket DSocket;
+        boost::asio::streambuf DInput;
+        std::deque< std::string > DOutput;
+        std::string DUser;
+        int DGameID;
+        int DSlot;
+        bool DReady;
+        bool DClosed;
+
+        CGameServerSession(CGameServer *server) : DServer(server), DSocket(server->DIOService), DGameID(-1), DSlot(0), DReady(false), DClosed(false){};
+
+        void Read();
+        void Send(const std::string &line);
+        void Write();
+        void Close();
+};
+
+/**
+* Reads the next line from the client and dispatches it.
+*
+* @return void
+*
+*/
+
+void CGameServerSession::Read(){
+    auto Self = shared_from_this();
+
+    boost::asio::async_read_until(DSocket, DInput, '\n', [Self](boost::system::error_code error, std::size_t length){
+        if(error){
+            Self->Close();
+            return;
+        }
+        std::string Line;
+        std::istream Input(&Self->DInput);
+
+        std::getline(Input, Line);
+        if(!Line.empty() && ('\r' == Line.back())){
+            Line.pop_back();
+        }
+        Self->DServer->DMessagesIn++;
+        Self->DServer->DBytesIn += length;
+        Self->DServer->Dispatch(Self, Line);
+        if(!Self->DClosed){
+            Self->Read();
+        }
+    });
+}
+
+/**
+* Queues a line for the client, lines are written one after the other.
+*
+* @param[in] line The line without the newline
+*
+* @return void
+*
+*/
+
+void CGameServerSession::Send(const std::string &line){
+    if(DClosed){
+        return;
+    }
+    DOutput.push_back(line + "\n");
+    if(DServer->DRecord.is_open()){
+        DServer->DRecord << DOutput.back();
+    }
+    DServer->DMessagesOut++;
+    DServer->Sent(0, DOutput.size());
+    if(1 == DOutput.size()){
+        Write();
+    }
+}
+
+/**
+* Writes the front of the output queue. The completion does nothing once the
+* session is closed.
+*
+* @return void
+*
+*/
+
+void CGameServerSession::Write(){
+    auto Self = shared_from_this();
+
+    boost::asio::async_write(DSocket, boost::asio::buffer(DOutput.front()), [Self](boost::system::error_code error, std::size_t length){
+        // Close empties the output, a completion queued before it has nothing to pop
+        if(Self->DClosed){
+            return;
+        }
+        if(error){
+            Self->Close();
+            return;
+        }
+        Self->DServer->Sent(length, 0);
+        Self->DOutput.pop_front();
+        if(!Self->DOutput.empty()){
+            Self->Write();
+        }
+    });
+}
+
+/**
+* Closes the connection and removes the user from its game.
+*
+* @return void
+*
+*/
+
+void CGameServerSession::Close(){
+    boost::system::error_code Ignored;
+
+    if(DClosed){
+        return;
+    }
+    DClosed = true;
+    DOutput.clear();
+    DSocket.close(Ignored);
+    DServer->Disconnected(shared_from_this());
+}
+
+/**
+* Constructor, binds and listens on the address and port. Throws
+* boost::system::system_error if the port can not be bound.
+*
+* @param[in] address The address to listen on
+* @param[in] port The port to listen on, 0 picks a free one
+*
+*/
+
+CGameServer::CGameServer(const std::string &address, int port) : DAcceptor(DIOService){
+    tcp::endpoint Endpoint(boost::asio::ip::address::from_string(address), port);
+
+    DNextGameID = 1;
+    DMessagesIn = 0;
+    DMessagesOut = 0;
+    DBytesIn = 0;
+    DBytesOut = 0;
+    DConnections = 0;
+    DPeakQueueDepth = 0;
+    DAcceptor.open(Endpoint.protocol());
+    DAcceptor.set_option(tcp::acceptor::reuse_address(true));
+    DAcceptor.bind(Endpoint);
+    DAcceptor.listen();
+    Accept();
+}
+
+/**
+* Destructor, stops the server thread if it was started.
+*
+*/
+
+CGameServer::~CGameServer(){
+    Stop();
+}
+
+/**
+* Returns the port the server listens on.
+*
+* @return The port
+*
+*/
+
+int CGameServer::Port() const{
+    boost::system::error_code Ignored;
+
+    return DAcceptor.local_endpoint(Ignored).port();
+}
+
+/**
+* Runs the server on its own thread.
+*
+* @return void
+*
+*/
+
+void CGameServer::Start(){
+    DThread = std::thread([this](){
+        DIOService.run();
+    });
+}
+
+/**
+* Stops the server and waits for its thread.
+*
+* @return void
+*
+*/
+
+void CGameServer::Stop(){
+    DIOService.stop();
+    if(DThread.joinable()){
+        DThread.join();
+    }
+}
+
+/**
+* Records every line sent to the clients to a file, one per line, for use
+* as a message corpus. Call before the server is started.
+*
+* @param[in] path The file to write
+*
+* @return true if the file could be opened
+*
+*/
+
+bool CGameServer::Record(const std::string &path){
+    DRecord.open(path.c_str(), std::ios::out | std::ios::trunc);
+    return DRecord.is_open();
+}
+
+/**
+* Runs the server on the calling thread until it is stopped.
+*
+* @return 0
+*
+*/
+
+int CGameServer::Run(){
+    printf("Game server listening on port %d\n", Port());
+    fflush(stdout);
+    DIOService.run();
+    return 0;
+}
+
+/**
+* Returns a snapshot of the message statistics.
+*
+* @return The statistics
+*
+*/
+
+CGameServer::SStatistics CGameServer::Statistics() const{
+    SStatistics Statistics;
+
+    Statistics.DMessagesIn = DMessagesIn;
+    Statistics.DMessagesOut = DMessagesOut;
+    Statistics.DBytesIn = DBytesIn;
+    Statistics.DBytesOut = DBytesOut;
+    Statistics.DConnections = DConnections;
+    Statistics.DPeakQueueDepth = DPeakQueueDepth;
+    return Statistics;
+}
+
+/**
+* Parses the command line for the game server options. The server is only
+* enabled if "--game-server" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the game server was requested
+*
+*/
+
+bool CGameServer::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--game-server" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--address" == Argument){
+            options.DAddress = Value;
+        }
+        else if("--port" == Argument){
+            options.DPort = std::max(0, std::atoi(Value.c_str()));
+        }
+        else if("--record" == Argument){
+            options.DRecordPath = Value;
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown game server option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the game server options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CGameServer::PrintUsage(const char *program){
+    PrintError("Usage: %s --game-server [options]\n", program);
+    PrintError("  --address ADDR    address to listen on (default: 0.0.0.0)\n");
+    PrintError("  --port N          port to listen on (default: %d)\n", DEFAULT_GAME_SERVER_PORT);
+    PrintError("  --record FILE     write every line sent to the clients to FILE\n");
+}
+
+/**
+* Accepts the next connection.
+*
+* @return void
+*
+*/
+
+void CGameServer::Accept(){
+    auto Session = std::make_shared< CGameServerSession >(this);
+
+    DAcceptor.async_accept(Session->DSocket, [this, Session](boost::system::error_code error){
+        if(!error){
+            boost::system::error_code Ignored;
+
+            DConnections++;
+            Session->DSocket.set_option(tcp::no_delay(true), Ignored);
+            Session->Read();
+        }
+        if(DAcceptor.is_open()){
+            Accept();
+        }
+    });
+}
+
+/**
+* Handles a line from a client. The frequent COMMAND and CHAT lines are
+* recognized by their first word and relayed without splitting the line.
+*
+* @param[in] session The session the line came from
+* @param[in] line The line without the newline
+*
+* @return void
+*
+*/
+
+void CGameServer::Dispatch(std::shared_ptr< CGameServerSession > session, const std::string &line){
+    CommandSpan Verb = CommandView::verb(line);
+    auto Game = DGames.find(session->DGameID);
+
+    if(Verb.startsWith("COMMAND") || Verb.equals("CHAT") || Verb.startsWith("SENDMAP")){
+        if(DGames.end() != Game){
+            Broadcast(Game->second, line, session.get());
+        }
+        return;
+    }
+    std::string Code = Verb.str();
+    std::string Rest = Code.size() < line.size() ? line.substr(Code.size() + 1) : "";
+    std::vector< std::string > Arguments = Command::split(Rest);
+
+    if("LOGIN" == Code){
+        if(Arguments.empty() || DUsers.count(Arguments[0])){
+            session->Send("BADATH");
+        }
+        else{
+            if(!session->DUser.empty()){
+                DUsers.erase(session->DUser);
+            }
+            session->DUser = Arguments[0];
+            DUsers.insert(session->DUser);
+            session->Send("WELCOM " + session->DUser);
+        }
+    }
+    else if("MYINFO" == Code){
+        session->Send("YRINFO " + session->DUser + " Wins:0 Losses:0");
+    }
+    else if("LGAMES" == Code){
+        std::string Reply;
+
+        for(auto &Entry : DGames){
+            if(!Entry.second.DStarted && !Entry.second.DPrivate && ((int)Entry.second.DPlayers.size() < Entry.second.DMaxPlayers)){
+                Reply += (Reply.empty() ? "RGAMEP|S " : "|") + Entry.second.DName + " " + std::to_string(Entry.first);
+            }
+        }
+        session->Send(Reply.empty() ? "NOHOST" : Reply);
+    }
+    else if(0 == Code.compare(0, 6, "HGAMEP")){
+        try{
+            Command Request(line, true);
+
+            if(session->DUser.empty() || (DGames.end() != Game) || (5 > Request.numArgsInRow(0))){
+                session->Send("NOHOST");
+                return;
+            }
+            SGame &NewGame = DGames[DNextGameID];
+
+            NewGame.DID = DNextGameID++;
+            NewGame.DMap = Request.arg(0);
+            NewGame.DMaxPlayers = std::max(1, std::atoi(Request.arg(1).c_str()));
+            NewGame.DPassword = Request.arg(2);
+            NewGame.DPrivate = 0 != std::atoi(Request.arg(3).c_str());
+            NewGame.DName = Request.arg(4);
+            NewGame.DStarted = false;
+            NewGame.DPlayers.push_back(session);
+            session->DGameID = NewGame.DID;
+            session->DSlot = 1;
+            session->DReady = false;
+            session->Send("INHOST " + std::to_string(NewGame.DID));
+        }
+        catch(std::exception &Exception){
+            PrintDebug(DEBUG_LOW, "Bad host request %s: %s\n", line.c_str(), Exception.what());
+            session->Send("NOHOST");
+        }
+    }
+    else if("JGAME" == Code){
+        auto Joined = Arguments.empty() ? DGames.end() : DGames.find(std::atoi(Arguments[0].c_str()));
+        std::string Password = 1 < Arguments.size() ? Arguments[1] : "";
+
+        if(session->DUser.empty() || (DGames.end() != Game) || (DGames.end() == Joined) || Joined->second.DStarted){
+            session->Send("NOEXIS");
+        }
+        else if(Joined->second.DPassword != Password){
+            session->Send("BADPAS");
+        }
+        else if((int)Joined->second.DPlayers.size() >= Joined->second.DMaxPlayers){
+            session->Send("FULL");
+        }
+        else{
+            // Take the lowest free slot, the slot is the player's color
+            int Slot = 1;
+
+            while(std::any_of(Joined->second.DPlayers.begin(), Joined->second.DPlayers.end(), [Slot](const std::shared_ptr< CGameServerSession > &player){ return player->DSlot == Slot; })){
+                Slot++;
+            }
+            Joined->second.DPlayers.push_back(session);
+            session->DGameID = Joined->first;
+            session->DSlot = Slot;
+            session->DReady = false;
+            session->Send("INGAME " + std::to_string(Joined->first));
+            Broadcast(Joined->second, "PLYINF " + session->DUser, session.get());
+        }
+    }
+    else if("GETINF" == Code){
+        session->Send(DGames.end() != Game ? GameInfo(Game->second, session.get()) : "NOHOST");
+    }
+    else if("READY" == Code){
+        if(DGames.end() != Game){
+            session->DReady = !Arguments.empty() && ("1" == Arguments[0]);
+            Broadcast(Game->second, (session->DReady ? "ISRDY " : "UNRDY ") + session->DUser, session.get());
+        }
+    }
+    else if("START" == Code){
+        if((DGames.end() != Game) && (Game->second.DPlayers.front() == session)){
+            Game->second.DStarted = true;
+            Broadcast(Game->second, "GSTART", nullptr);
+        }
+    }
+    else if("QUIT" == Code){
+        Leave(session);
+    }
+    else if("LOGOUT" == Code){
+        Leave(session);
+        DUsers.erase(session->DUser);
+        session->DUser.clear();
+    }
+    else{
+        PrintDebug(DEBUG_LOW, "Unknown request %s\n", line.c_str());
+    }
+}
+
+/**
+* Sends a line to the players of a game.
+*
+* @param[in] game The game
+* @param[in] line The line to send
+* @param[in] except The session that is skipped, nullptr to send to all
+*
+* @return void
+*
+*/
+
+void CGameServer::Broadcast(SGame &game, const std::string &line, const CGameServerSession *except){
+    for(auto &Player : game.DPlayers){
+        if(Player.get() != except){
+            Player->Send(line);
+        }
+    }
+}
+
+/**
+* Removes a session from its game and tells the other players. A game
+* without players is removed.
+*
+* @param[in] session The session that leaves
+*
+* @return void
+*
+*/
+
+void CGameServer::Leave(std::shared_ptr< CGameServerSession > session){
+    auto Game = DGames.find(session->DGameID);
+
+    session->DGameID = -1;
+    session->DSlot = 0;
+    session->DReady = false;
+    if(DGames.end() == Game){
+        return;
+    }
+    auto &Players = Game->second.DPlayers;
+
+    Players.erase(std::remove(Players.begin(), Players.end(), session), Players.end());
+    if(Players.empty()){
+        DGames.erase(Game);
+        return;
+    }
+    Broadcast(Game->second, "LEAVE " + session->DUser, nullptr);
+}
+
+/**
+* Cleans up after a closed connection.
+*
+* @param[in] session The closed session
+*
+* @return void
+*
+*/
+
+void CGameServer::Disconnected(std::shared_ptr< CGameServerSession > session){
+    Leave(session);
+    if(!session->DUser.empty()){
+        DUsers.erase(session->DUser);
+    }
+}
+
+/**
+* Updates the output statistics.
+*
+* @param[in] bytes The bytes that were written
+* @param[in] depth The depth of the output queue a line was added to
+*
+* @return void
+*
+*/
+
+void CGameServer::Sent(size_t bytes, size_t depth){
+    DBytesOut += bytes;
+    if(depth > DPeakQueueDepth){
+        DPeakQueueDepth = depth;
+    }
+}
+
+/**
+* Builds the GETINF reply: game ID, the player's slot, map, game name and
+* then the name, ready state and slot of every player.
+*
+* @param[in] game The game
+* @param[in] session The session that asked
+*
+* @return The reply line
+*
+*/
+
+std::string CGameServer::GameInfo(const SGame &game, const CGameServerSession *session) const{
+    std::string Reply = "RGAMESS " + std::to_string(game.DID) + " " + std::to_string(session->DSlot) + " " + game.DMap + " " + game.DName;
+
+    for(auto &Player : game.DPlayers){
+        Reply += " " + Player->DUser + " " + (Player->DReady ? "1" : "0") + " " + std::to_string(Player->DSlot);
+    }
+    return Reply;
+}
@@ -45,9 +45,9 @@ CGraphicMulticolorTileset::~CGraphicMulticolorTileset(){
 
 }
 
-bool CGraphicMulticolorTileset::LoadTileset(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source){
+bool CGraphicMulticolorTileset::LoadTileset(std::shared_ptr< CGraphicRecolorMap > colormap, std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface){
     DColorMap = colormap;
-    if(!CGraphicTileset::LoadTileset(source)){
+    if(!CGraphicTileset::LoadTileset(source, surface)){
         return false;
     }
     
@@ -56,10 +56,52 @@ bool CGraphicMulticolorTileset::LoadTileset(std::shared_ptr< CGraphicRecolorMap
     for(int ColIndex = 1; ColIndex < colormap->GroupCount(); ColIndex++){
         DColoredTilesets.push_back(colormap->RecolorSurface(ColIndex, DSurfaceTileset));
     }
+    AccountMemory();
     
     return true;
 }
 
+/**
+* Loads the tileset again in place and recolors it with the color map it was
+* loaded with. The tileset is only replaced once the new one loaded.
+*
+* @param[in] source The dat file of the tileset
+*
+* @return true if the tileset was reloaded
+*
+*/
+
+bool CGraphicMulticolorTileset::ReloadTileset(std::shared_ptr< CDataSource > source){
+    CGraphicMulticolorTileset Reloaded;
+
+    if(!Reloaded.LoadTileset(DColorMap, source)){
+        return false;
+    }
+    if(!DClippingMasks.empty()){
+        Reloaded.CreateClippingMasks();
+    }
+    *this = Reloaded;
+    AccountMemory();
+    return true;
+}
+
+/**
+* Gets the size of the surfaces of the tileset, its clipping masks and its
+* recolored copies
+*
+* @return The size in bytes
+*
+*/
+
+size_t CGraphicMulticolorTileset::MemoryUsage() const{
+    size_t Size = CGraphicTileset::MemoryUsage();
+
+    for(size_t Index = 1; Index < DColoredTilesets.size(); Index++){
+        Size += SurfaceBytes(DColoredTilesets[Index]);
+    }
+    return Size;
+}
+
 void CGraphicMulticolorTileset::DrawTile(std::shared_ptr<CGraphicSurface> surface, int xpos, int ypos, int tileindex, int colorindex, bool RangerInForest){
     if((0 > tileindex)||(tileindex >= DTileCount)){
         return;
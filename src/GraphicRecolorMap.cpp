@@ -92,7 +92,7 @@ uint32_t CGraphicRecolorMap::ColorValue(int gindex, int cindex) const{
     return DOriginalColors[gindex][cindex];
 }
 
-bool CGraphicRecolorMap::Load(std::shared_ptr< CDataSource > source){
+bool CGraphicRecolorMap::Load(std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface){
     CCommentSkipLineDataSource LineSource(source, '#');
     std::string PNGPath, TempString;
     std::vector< std::string > Tokens;
@@ -103,7 +103,7 @@ bool CGraphicRecolorMap::Load(std::shared_ptr< CDataSource > source){
     if(!LineSource.Read(PNGPath)){
         return false;
     }
-    auto ColorSurface = CGraphicFactory::LoadSurface(source->Container()->DataSource(PNGPath));
+    auto ColorSurface = surface ? surface : CGraphicFactory::LoadSurface(source->Container()->DataSource(PNGPath));
     if(nullptr == ColorSurface){
         return false;
     }
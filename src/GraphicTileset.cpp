@@ -46,7 +46,7 @@
 #include <cctype>
 #include <iostream>
 
-CGraphicTileset::CGraphicTileset(){
+CGraphicTileset::CGraphicTileset() : DMemoryAccount(EMemorySubsystem::Tilesets){
     DSurfaceTileset = nullptr;
     DTileCount = 0;
     DTileWidth = 0;
@@ -59,6 +59,46 @@ CGraphicTileset::~CGraphicTileset(){
 
 }
 
+/**
+*   /brief Gets the size of the pixels of a surface
+*   @param[in] surface: The surface, or nullptr
+*   @return size_t The size in bytes
+*/
+size_t CGraphicTileset::SurfaceBytes(std::shared_ptr< CGraphicSurface > surface){
+    if(nullptr == surface){
+        return 0;
+    }
+    switch(surface->Format()){
+        case CGraphicSurface::ESurfaceFormat::A8:
+            return (size_t)surface->Width() * surface->Height();
+        case CGraphicSurface::ESurfaceFormat::A1:
+            return (size_t)(surface->Width() + 31) / 32 * 4 * surface->Height();
+        default:
+            return (size_t)surface->Width() * surface->Height() * 4;
+    }
+}
+
+/**
+*   /brief Gets the size of the surfaces of the tileset and its clipping masks
+*   @return size_t The size in bytes
+*/
+size_t CGraphicTileset::MemoryUsage() const{
+    size_t Size = SurfaceBytes(DSurfaceTileset);
+
+    for(auto &Mask : DClippingMasks){
+        Size += SurfaceBytes(Mask);
+    }
+    return Size;
+}
+
+/**
+*   /brief Updates the size of the tileset counted against the tilesets in
+*       the memory accounting, called whenever a surface is replaced
+*/
+void CGraphicTileset::AccountMemory(){
+    DMemoryAccount.Resize(MemoryUsage());
+}
+
 bool CGraphicTileset::ParseGroupName(const std::string &tilename, std::string &aniname, int &anistep){
     size_t LastIndex = tilename.length();
     
@@ -136,6 +176,7 @@ int CGraphicTileset::TileCount(int count){
     TempSurface->Copy(DSurfaceTileset, 0, 0, -1, -1, 0, 0);
     DSurfaceTileset = TempSurface;
     DTileCount = count;
+    AccountMemory();
     return DTileCount;
 }
 
@@ -193,6 +234,7 @@ bool CGraphicTileset::DuplicateClippedTile(int destindex, const std::string &til
     }
     DClippingMasks[destindex] = CGraphicFactory::CreateSurface(DTileWidth, DTileHeight, CGraphicSurface::ESurfaceFormat::A1);
     DClippingMasks[destindex]->Copy(DSurfaceTileset, 0, 0, DTileWidth, DTileHeight, 0, destindex * DTileHeight);
+    AccountMemory();
 
     return true;
 }
@@ -244,15 +286,18 @@ void CGraphicTileset::CreateClippingMasks(){
             DClippingMasks[Index] = CGraphicFactory::CreateSurface(DTileWidth, DTileHeight, CGraphicSurface::ESurfaceFormat::A1);
             DClippingMasks[Index]->Copy(DSurfaceTileset, 0, 0, DTileWidth, DTileHeight, 0, Index * DTileHeight);
         }
+        AccountMemory();
     }
 }
 
 /**
 *   /brief Loads the Tileset from the associated datasource
 *   @param[in] source: The dat file associated with a particular tileset
+*   @param[in] surface: The already decoded PNG of the tileset, or nullptr to
+*       load the PNG named in the dat file
 *   @return bool If Parsing of file was succesful
 */
-bool CGraphicTileset::LoadTileset(std::shared_ptr< CDataSource > source){
+bool CGraphicTileset::LoadTileset(std::shared_ptr< CDataSource > source, std::shared_ptr< CGraphicSurface > surface){
     CCommentSkipLineDataSource LineSource(source, '#');
     std::string PNGPath, TempString;
     std::vector< std::string > Tokens;
@@ -265,7 +310,7 @@ bool CGraphicTileset::LoadTileset(std::shared_ptr< CDataSource > source){
         PrintError("Failed to get path.\n");
         goto LoadTilesetExit;
     }
-    DSurfaceTileset = CGraphicFactory::LoadSurface(source->Container()->DataSource(PNGPath));
+    DSurfaceTileset = surface ? surface : CGraphicFactory::LoadSurface(source->Container()->DataSource(PNGPath));
     if(nullptr == DSurfaceTileset){
         PrintError("Failed to load file %s.\n", PNGPath.c_str());
         goto LoadTilesetExit;        
@@ -292,9 +337,31 @@ bool CGraphicTileset::LoadTileset(std::shared_ptr< CDataSource > source){
 
     ReturnStatus = true;
 LoadTilesetExit:
+    AccountMemory();
     return ReturnStatus;
 }
 
+/**
+*   /brief Loads the Tileset again in place, so everything holding on to it
+*       draws the new tiles. The tileset is only replaced once the new one
+*       loaded, and the clipping masks are recreated if it had them.
+*   @param[in] source: The dat file associated with the tileset
+*   @return bool If the tileset was reloaded
+*/
+bool CGraphicTileset::ReloadTileset(std::shared_ptr< CDataSource > source){
+    CGraphicTileset Reloaded;
+
+    if(!Reloaded.LoadTileset(source)){
+        return false;
+    }
+    if(!DClippingMasks.empty()){
+        Reloaded.CreateClippingMasks();
+    }
+    *this = Reloaded;
+    AccountMemory();
+    return true;
+}
+
 /**
 *   /brief Draws a particular tile on the source surface
 *   @param[in] surface: The source surface on which to draw tile
@@ -0,0 +1,729 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included
+    that were extracted from original Warcraft II by Blizzard Entertainment
+    were found freely available via internet sources and have been labeld as
+    abandonware. They have been included in this distribution for educational
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CHeadlessRenderer
+*
+* @brief Renders the game without a window or display. Loads everything through
+*     CApplicationData::LoadGameData (and so CAssetLoader) into image surfaces,
+*     loads a map or saved game, then drives the viewport, minimap and UI
+*     renderers along a scripted camera path. Per frame timings are reported
+*     and optional PNG snapshots are written so renderer changes can be
+*     benchmarked and pixel diffed on machines without a display or GPU.
+*     The memory report of CMemoryAccounting can be printed along the way.
+*
+*     Started with "--headless", see PrintUsage for the other options.
+*
+*/
+
+#include "HeadlessRenderer.h"
+#include "ApplicationPath.h"
+#include "AssetArchive.h"
+#include "AssetRenderer.h"
+#include "AutoSave.h"
+#include "BattleMode.h"
+#include "CommentSkipLineDataSource.h"
+#include "FileDataContainer.h"
+#include "FileDataSink.h"
+#include "MainMenuMode.h"
+#include "MemoryAccounting.h"
+#include "MemoryDataSource.h"
+#include "SavedGame.h"
+#include "StartupTrace.h"
+#include "Tokenizer.h"
+#include "Debug.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+/**
+* Constructor, stores the context to render with and the options.
+*
+* @param[in] context The application data that will be loaded and rendered
+* @param[in] options The parsed headless options
+*
+*/
+
+CHeadlessRenderer::CHeadlessRenderer(std::shared_ptr< CApplicationData > context, const SOptions &options){
+    DContext = context;
+    DOptions = options;
+}
+
+/**
+* Parses the command line for the headless options. Headless rendering is only
+* enabled if "--headless" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if headless rendering was requested
+*
+*/
+
+bool CHeadlessRenderer::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--headless" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--simulate" == Argument){
+            options.DSimulate = true;
+            HasValue = false;
+        }
+        else if("--compare-retained" == Argument){
+            options.DCompareRetained = true;
+            HasValue = false;
+        }
+        else if("--data" == Argument){
+            options.DDataPath = Value;
+        }
+        else if("--map" == Argument){
+            options.DMapName = Value;
+        }
+        else if("--load" == Argument){
+            options.DSavedGame = Value;
+        }
+        else if("--camera" == Argument){
+            options.DCameraPath = Value;
+        }
+        else if("--png" == Argument){
+            options.DSnapshotPath = Value;
+        }
+        else if("--png-every" == Argument){
+            options.DSnapshotInterval = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--timings" == Argument){
+            options.DTimingsPath = Value;
+        }
+        else if("--save" == Argument){
+            options.DSaveGame = Value;
+        }
+        else if("--save-benchmark" == Argument){
+            options.DSaveRuns = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--memory-report" == Argument){
+            options.DMemoryReportInterval = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--units" == Argument){
+            options.DUnits = std::max(0, std::atoi(Value.c_str()));
+        }
+        else if("--frames" == Argument){
+            options.DFrames = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--size" == Argument){
+            std::vector< std::string > Tokens;
+
+            CTokenizer::Tokenize(Tokens, Value, "x");
+            if(2 == Tokens.size()){
+                options.DWidth = std::max(1, std::atoi(Tokens[0].c_str()));
+                options.DHeight = std::max(1, std::atoi(Tokens[1].c_str()));
+            }
+        }
+        else{
+            // Skip the value of an unknown option so it is not read as one
+            HasValue = !Value.empty() && (0 != Value.compare(0, 2, "--"));
+            if(options.DEnabled){
+                PrintError("Unknown headless option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    if(options.DEnabled){
+        PrintDebug(DEBUG_LOW, "Headless rendering %d frames at %dx%d\n", options.DFrames, options.DWidth, options.DHeight);
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the headless options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CHeadlessRenderer::PrintUsage(const char *program){
+    PrintError("Usage: %s --headless [options]\n", program);
+    PrintError("  --data DIR        data directory (default: data next to the executable)\n");
+    PrintError("  --map NAME        map to render (default: first map)\n");
+    PrintError("  --load FILE       saved game to render instead of a new map\n");
+    PrintError("  --camera FILE     camera path, one \"X Y\" tile position per line\n");
+    PrintError("  --frames N        number of frames to render (default: 300)\n");
+    PrintError("  --size WxH        size of the offscreen surface (default: 800x600)\n");
+    PrintError("  --simulate        advance the game one cycle per frame\n");
+    PrintError("  --units N         add footmen next to each player's assets until the map holds N assets\n");
+    PrintError("  --compare-retained  render the frames without and then with retained asset render items\n");
+    PrintError("  --png DIR         write PNG snapshots of the full screen to DIR\n");
+    PrintError("  --png-every N     only snapshot every Nth frame (default: 1)\n");
+    PrintError("  --timings FILE    write per frame timings as CSV\n");
+    PrintError("  --save FILE       save the game after the last frame, as text if FILE ends in .txt\n");
+    PrintError("  --save-benchmark N  time N text and binary saves and loads, and check they round trip\n");
+    PrintError("  --memory-report N  print the memory of each subsystem after loading, every N frames and at the end\n");
+}
+
+/**
+* Loads all resources into offscreen surfaces, then renders the requested
+* number of frames and reports the timings.
+*
+* @return 0 on success, 1 on failure
+*
+*/
+
+int CHeadlessRenderer::Run(){
+    std::string DataPath = DOptions.DDataPath;
+
+    if(DataPath.empty()){
+        DataPath = GetApplicationPath().Containing().ToString() + "/data";
+    }
+    std::shared_ptr< CDataContainer > DataContainer = CAssetArchiveDataContainer::OpenDataDirectory(DataPath);
+    std::shared_ptr< CDataContainer > ImageDirectory = DataContainer->DataContainer("img");
+
+    if(!ImageDirectory){
+        PrintError("Failed to find img directory in %s.\n", DataPath.c_str());
+        return 1;
+    }
+    DContext->DHeadless = true;
+    DContext->DHeadlessWidth = DOptions.DWidth;
+    DContext->DHeadlessHeight = DOptions.DHeight;
+    DContext->DGameSessionType = CApplicationData::gstSinglePlayer;
+    DContext->DTotalLoadingSteps = 128;
+    DContext->DCurrentLoadingStep = 0;
+    DContext->DDoubleBufferSurface = CGraphicFactory::CreateSurface(DOptions.DWidth, DOptions.DHeight, CGraphicSurface::ESurfaceFormat::ARGB32);
+    DContext->DWorkingBufferSurface = CGraphicFactory::CreateSurface(DOptions.DWidth, DOptions.DHeight, CGraphicSurface::ESurfaceFormat::ARGB32);
+
+    auto LoadStart = std::chrono::steady_clock::now();
+    if(!DContext->LoadGameData(DataContainer, ImageDirectory)){
+        PrintError("Failed to load game data.\n");
+        return 1;
+    }
+    if(!LoadGame() || !AddUnits()){
+        return 1;
+    }
+    auto LoadEnd = std::chrono::steady_clock::now();
+    CStartupTrace::Stop();
+    printf("Loaded in %.1f ms\n", std::chrono::duration< double, std::milli >(LoadEnd - LoadStart).count());
+    if(DOptions.DMemoryReportInterval){
+        PrintMemoryReport("after loading");
+    }
+
+    if(!LoadCameraPath()){
+        return 1;
+    }
+    SelectAssets();
+
+    DTimings.reserve(DOptions.DFrames);
+    if(DOptions.DCompareRetained){
+        bool Retain = CAssetRenderer::RetainRenderItems(false);
+
+        for(int Frame = 0; Frame < DOptions.DFrames; Frame++){
+            RenderFrame(Frame);
+        }
+        printf("Without retained render items, %d assets\n", (int)DContext->DGameModel->Player(DContext->DPlayerColor)->PlayerMap()->Assets().size());
+        PrintSummary();
+        DTimings.clear();
+        CAssetRenderer::RetainRenderItems(Retain);
+        printf("With retained render items, %d assets\n", (int)DContext->DGameModel->Player(DContext->DPlayerColor)->PlayerMap()->Assets().size());
+    }
+    for(int Frame = 0; Frame < DOptions.DFrames; Frame++){
+        RenderFrame(Frame);
+        if(!DOptions.DSnapshotPath.empty() && (0 == (Frame % DOptions.DSnapshotInterval))){
+            if(!StoreSnapshot(Frame)){
+                PrintError("Failed to store snapshot for frame %d.\n", Frame);
+                return 1;
+            }
+        }
+        if(DOptions.DMemoryReportInterval && (0 == ((Frame + 1) % DOptions.DMemoryReportInterval)) && (Frame + 1 < DOptions.DFrames)){
+            char When[32];
+
+            snprintf(When, sizeof(When), "at frame %d", Frame + 1);
+            PrintMemoryReport(When);
+        }
+    }
+    WriteTimings();
+    PrintSummary();
+    if(DOptions.DMemoryReportInterval){
+        PrintMemoryReport("at the end");
+    }
+    if(DContext->DAutoSave){
+        DContext->DAutoSave->Flush();
+        DContext->DAutoSave->PrintStatistics();
+        printf("%d autosaves to %s, %.3f ms mean (max %.3f ms) paused\n", DContext->DAutoSave->SnapshotCount(), DContext->DAutoSave->FileName().c_str(), DContext->DAutoSave->MeanSnapshotTime(), DContext->DAutoSave->MaxSnapshotTime());
+    }
+    if(!StoreSavedGame()){
+        return 1;
+    }
+    if(DOptions.DSaveRuns && !BenchmarkSaves()){
+        return 1;
+    }
+    return 0;
+}
+
+/**
+* Loads the saved game if one was requested, otherwise starts a new game on
+* the requested map the same way the map selection mode does.
+*
+* @return true if the game was loaded
+*
+*/
+
+bool CHeadlessRenderer::LoadGame(){
+    if(!DOptions.DSavedGame.empty()){
+        std::shared_ptr< CDirectoryDataContainer > CurrDir = std::make_shared< CDirectoryDataContainer > (".");
+        std::shared_ptr< CDataSource > Source = CurrDir->DataSource(DOptions.DSavedGame);
+
+        if(!CSavedGame::Load(DContext, Source)){
+            PrintError("Failed to load saved game %s.\n", DOptions.DSavedGame.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    int MapIndex = DOptions.DMapName.empty() ? 0 : CAssetDecoratedMap::FindMapIndex(DOptions.DMapName);
+    if(0 > MapIndex){
+        PrintError("Failed to find map %s.\n", DOptions.DMapName.c_str());
+        return false;
+    }
+    DContext->DSelectedMapIndex = MapIndex;
+    DContext->DSelectedMap = CAssetDecoratedMap::DuplicateMap(MapIndex, DContext->DLoadingPlayerColors);
+    if(nullptr == DContext->DSelectedMap){
+        PrintError("Failed to load map %s.\n", CAssetDecoratedMap::GetMapName(MapIndex).c_str());
+        return false;
+    }
+    for(int Index = 0; Index < to_underlying(EPlayerColor::Max); Index++){
+        DContext->DLoadingPlayerTypes[Index] = CApplicationData::ptNone;
+        if(1 == Index){
+            DContext->DLoadingPlayerTypes[Index] = CApplicationData::ptHuman;
+        }
+        else if(Index && (Index <= DContext->DSelectedMap->PlayerCount())){
+            DContext->DLoadingPlayerTypes[Index] = CApplicationData::ptAIEasy;
+        }
+    }
+    DContext->DPlayerColor = DContext->DLoadingPlayerColors[1];
+    DContext->LoadGameMap(MapIndex, std::make_shared< CFileDataSource >(""));
+    return true;
+}
+
+/**
+* Loads the camera path. Each non comment line holds an "X Y" tile position,
+* the camera moves linearly between them over the frames. Without a path file
+* the camera tours the corners of the map.
+*
+* @return true if the path was loaded, false if it could not be opened or
+* holds an invalid position
+*
+*/
+
+bool CHeadlessRenderer::LoadCameraPath(){
+    std::vector< CTilePosition > TilePath;
+
+    if(!DOptions.DCameraPath.empty()){
+        std::shared_ptr< CDirectoryDataContainer > CurrDir = std::make_shared< CDirectoryDataContainer > (".");
+        std::shared_ptr< CDataSource > Source = CurrDir->DataSource(DOptions.DCameraPath);
+        std::string TempString;
+        std::vector< std::string > Tokens;
+
+        if(nullptr == Source){
+            PrintError("Failed to open camera path %s.\n", DOptions.DCameraPath.c_str());
+            return false;
+        }
+        CCommentSkipLineDataSource LineSource(Source, '#');
+        while(LineSource.Read(TempString)){
+            CTokenizer::Tokenize(Tokens, TempString);
+            if(2 != Tokens.size()){
+                continue;
+            }
+            try{
+                TilePath.push_back(CTilePosition(std::stoi(Tokens[0]), std::stoi(Tokens[1])));
+            }
+            catch(std::exception &E){
+                PrintError("Invalid camera position \"%s\" in %s.\n", TempString.c_str(), DOptions.DCameraPath.c_str());
+                return false;
+            }
+        }
+    }
+    if(TilePath.empty()){
+        int Width = DContext->DGameModel->Map()->Width();
+        int Height = DContext->DGameModel->Map()->Height();
+
+        TilePath.push_back(CTilePosition(0, 0));
+        TilePath.push_back(CTilePosition(Width - 1, 0));
+        TilePath.push_back(CTilePosition(Width - 1, Height - 1));
+        TilePath.push_back(CTilePosition(0, Height - 1));
+        TilePath.push_back(CTilePosition(0, 0));
+    }
+    for(auto &Tile : TilePath){
+        CPixelPosition Pixel;
+
+        Pixel.SetFromTile(Tile);
+        DCameraPath.push_back(Pixel);
+    }
+    return true;
+}
+
+/**
+* Adds footmen to the players that have assets, placing them next to the
+* players' assets in turn until the actual map holds the requested number of
+* assets. Used to benchmark the asset renderer with hundreds of units.
+*
+* @return true if the units were added, or none were requested
+*
+*/
+
+bool CHeadlessRenderer::AddUnits(){
+    std::vector< std::shared_ptr< CPlayerData > > Players;
+    std::shared_ptr< CAssetDecoratedMap > ActualMap = DContext->DGameModel->Map();
+    size_t Turn = 0;
+
+    if(0 >= DOptions.DUnits){
+        return true;
+    }
+    for(int Index = 1; Index < to_underlying(EPlayerColor::Max); Index++){
+        auto Player = DContext->DGameModel->Player(static_cast< EPlayerColor >(Index));
+
+        if(Player && Player->IsAlive()){
+            Players.push_back(Player);
+        }
+    }
+    while(Players.size() && ((int)ActualMap->Assets().size() < DOptions.DUnits)){
+        std::shared_ptr< CPlayerData > Player = Players[Turn % Players.size()];
+        std::list< std::weak_ptr< CPlayerAsset > > Assets = Player->Assets();
+        std::shared_ptr< CPlayerAsset > FromAsset;
+        size_t Skip = (Turn / Players.size()) % Assets.size();
+
+        for(auto &WeakAsset : Assets){
+            if(auto Asset = WeakAsset.lock()){
+                FromAsset = Asset;
+                if(0 == Skip--){
+                    break;
+                }
+            }
+        }
+        auto NewUnit = Player->CreateAsset("Footman");
+        CTilePosition Placement = ActualMap->FindAssetPlacement(NewUnit, FromAsset, CTilePosition(ActualMap->Width() / 2, ActualMap->Height() / 2));
+
+        if(0 > Placement.X()){
+            Player->DeleteAsset(NewUnit);
+            PrintError("Only room for %d assets on the map.\n", (int)ActualMap->Assets().size());
+            return false;
+        }
+        NewUnit->TilePosition(Placement);
+        Turn++;
+    }
+    for(auto &Player : Players){
+        Player->UpdateVisibility();
+    }
+    printf("Added %d units, %d assets on the map\n", (int)Turn, (int)ActualMap->Assets().size());
+    return true;
+}
+
+/**
+* Calculates where the camera is centered for a frame.
+*
+* @param[in] frame The frame number
+*
+* @return The pixel position to center the viewport on
+*
+*/
+
+CPixelPosition CHeadlessRenderer::CameraPosition(int frame) const{
+    if((1 == DCameraPath.size())||(1 >= DOptions.DFrames)){
+        return DCameraPath.front();
+    }
+    double Progress = (double)frame * (DCameraPath.size() - 1) / (DOptions.DFrames - 1);
+    int Segment = std::min((int)Progress, (int)DCameraPath.size() - 2);
+    double Fraction = Progress - Segment;
+    const CPixelPosition &From = DCameraPath[Segment];
+    const CPixelPosition &To = DCameraPath[Segment + 1];
+
+    return CPixelPosition(From.X() + (int)((To.X() - From.X()) * Fraction), From.Y() + (int)((To.Y() - From.Y()) * Fraction));
+}
+
+/**
+* Selects up to nine of the player's units (or a building if there are no
+* units) so the unit description and action renderers have something to draw.
+*
+* @return void
+*
+*/
+
+void CHeadlessRenderer::SelectAssets(){
+    DContext->DSelectedPlayerAssets.clear();
+    for(auto WeakAsset : DContext->DGameModel->Player(DContext->DPlayerColor)->Assets()){
+        if(auto Asset = WeakAsset.lock()){
+            if(Asset->Speed() && (9 > DContext->DSelectedPlayerAssets.size())){
+                DContext->DSelectedPlayerAssets.push_back(Asset);
+            }
+        }
+    }
+    if(DContext->DSelectedPlayerAssets.empty()){
+        for(auto WeakAsset : DContext->DGameModel->Player(DContext->DPlayerColor)->Assets()){
+            if(!WeakAsset.expired()){
+                DContext->DSelectedPlayerAssets.push_back(WeakAsset);
+                break;
+            }
+        }
+    }
+}
+
+/**
+* Renders a single frame: moves the camera, optionally advances the game, and
+* then times the viewport, minimap and UI renderers separately.
+*
+* @param[in] frame The frame number
+*
+* @return void
+*
+*/
+
+void CHeadlessRenderer::RenderFrame(int frame){
+    SFrameTiming Timing;
+    std::vector< CTilePosition > WallPlacements;
+    std::list< std::weak_ptr< CPlayerAsset > > SelectedAndMarkerAssets = DContext->DSelectedPlayerAssets;
+    CPixelPosition Camera = CameraPosition(frame);
+
+    DContext->DViewportRenderer->CenterViewport(Camera);
+    Timing.DCameraX = DContext->DViewportRenderer->ViewportX();
+    Timing.DCameraY = DContext->DViewportRenderer->ViewportY();
+    if(DOptions.DSimulate){
+        CBattleMode::Instance()->Calculate(DContext);
+    }
+    for(auto Asset : DContext->DGameModel->Player(DContext->DPlayerColor)->PlayerMap()->Assets()){
+        if(EAssetType::None == Asset->Type()){
+            SelectedAndMarkerAssets.push_back(Asset);
+        }
+    }
+
+    auto ViewportStart = std::chrono::steady_clock::now();
+    DContext->DViewportRenderer->DrawViewport(WallPlacements, DContext->DViewportSurface, DContext->DViewportTypeSurface, SelectedAndMarkerAssets, SRectangle({0, 0, 0, 0}), EAssetCapabilityType::None);
+    auto MiniMapStart = std::chrono::steady_clock::now();
+    DContext->DMiniMapRenderer->DrawMiniMap(DContext->DMiniMapSurface);
+    auto UserInterfaceStart = std::chrono::steady_clock::now();
+    DContext->DResourceRenderer->DrawResources(DContext->DResourceSurface);
+    DContext->DUnitDescriptionRenderer->DrawUnitDescription(DContext->DUnitDescriptionSurface, DContext->DSelectedPlayerAssets);
+    DContext->DUnitActionRenderer->DrawUnitAction(DContext->DUnitActionSurface, DContext->DSelectedPlayerAssets, DContext->DCurrentAssetCapability);
+    auto FrameEnd = std::chrono::steady_clock::now();
+
+    Timing.DViewport = std::chrono::duration< double, std::milli >(MiniMapStart - ViewportStart).count();
+    Timing.DMiniMap = std::chrono::duration< double, std::milli >(UserInterfaceStart - MiniMapStart).count();
+    Timing.DUserInterface = std::chrono::duration< double, std::milli >(FrameEnd - UserInterfaceStart).count();
+    DTimings.push_back(Timing);
+}
+
+/**
+* Composes the full battle screen into the working buffer and writes it as a
+* PNG. Composition is not included in the frame timings.
+*
+* @param[in] frame The frame number, used for the file name
+*
+* @return true if the snapshot was written
+*
+*/
+
+bool CHeadlessRenderer::StoreSnapshot(int frame){
+    std::ostringstream FileName;
+
+    CBattleMode::Instance()->Render(DContext);
+    FileName<<DOptions.DSnapshotPath<<"/frame-"<<std::setfill('0')<<std::setw(5)<<frame<<".png";
+    std::remove(FileName.str().c_str());
+    return CGraphicFactory::StoreSurface(std::make_shared< CFileDataSink >(FileName.str()), DContext->DWorkingBufferSurface);
+}
+
+/**
+* Writes the per frame timings as CSV if a timings file was requested.
+*
+* @return void
+*
+*/
+
+void CHeadlessRenderer::WriteTimings() const{
+    if(DOptions.DTimingsPath.empty()){
+        return;
+    }
+    std::ofstream Output(DOptions.DTimingsPath);
+
+    Output<<"frame,camera_x,camera_y,viewport_ms,minimap_ms,ui_ms,total_ms"<<std::endl;
+    for(size_t Index = 0; Index < DTimings.size(); Index++){
+        const SFrameTiming &Timing = DTimings[Index];
+
+        Output<<Index<<","<<Timing.DCameraX<<","<<Timing.DCameraY<<","<<Timing.DViewport<<","<<Timing.DMiniMap<<","<<Timing.DUserInterface<<","<<(Timing.DViewport + Timing.DMiniMap + Timing.DUserInterface)<<std::endl;
+    }
+}
+
+/**
+* Prints the mean, median, 95th percentile and worst frame time of each
+* renderer.
+*
+* @return void
+*
+*/
+
+void CHeadlessRenderer::PrintSummary() const{
+    std::vector< std::vector< double > > Samples(4);
+    const char *Names[] = {"viewport", "minimap", "ui", "total"};
+
+    for(auto &Timing : DTimings){
+        Samples[0].push_back(Timing.DViewport);
+        Samples[1].push_back(Timing.DMiniMap);
+        Samples[2].push_back(Timing.DUserInterface);
+        Samples[3].push_back(Timing.DViewport + Timing.DMiniMap + Timing.DUserInterface);
+    }
+    printf("%d frames at %dx%d\n", (int)DTimings.size(), DOptions.DWidth, DOptions.DHeight);
+    printf("%-10s %10s %10s %10s %10s\n", "(ms)", "mean", "p50", "p95", "max");
+    for(size_t Index = 0; Index < Samples.size(); Index++){
+        std::vector< double > &Sorted = Samples[Index];
+        double Total = 0.0;
+
+        if(Sorted.empty()){
+            continue;
+        }
+        std::sort(Sorted.begin(), Sorted.end());
+        for(auto Sample : Sorted){
+            Total += Sample;
+        }
+        printf("%-10s %10.3f %10.3f %10.3f %10.3f\n", Names[Index], Total / Sorted.size(), Sorted[Sorted.size() / 2], Sorted[(Sorted.size() * 95) / 100], Sorted.back());
+    }
+}
+
+/**
+* Prints the memory report, the rates are since the previous report.
+*
+* @param[in] when When in the run the report is taken
+*
+* @return void
+*
+*/
+
+void CHeadlessRenderer::PrintMemoryReport(const char *when){
+    printf("Memory %s\n", when);
+    for(auto &Line : CMemoryAccounting::Report()){
+        printf("%s\n", Line.c_str());
+    }
+}
+
+/**
+* Saves the game after the last frame if requested, in the binary format
+* unless the file name ends in .txt.
+*
+* @return true if nothing was requested or the game was saved
+*
+*/
+
+bool CHeadlessRenderer::StoreSavedGame(){
+    std::string Suffix = ".txt";
+    std::string Data;
+
+    if(DOptions.DSaveGame.empty()){
+        return true;
+    }
+    if((DOptions.DSaveGame.length() >= Suffix.length()) && (0 == DOptions.DSaveGame.compare(DOptions.DSaveGame.length() - Suffix.length(), Suffix.length(), Suffix))){
+        Data = CSavedGame::SaveText(DContext);
+    }
+    else{
+        Data = CSavedGame::SaveBinary(DContext);
+    }
+    if(!CSavedGame::Write(Data, DOptions.DSaveGame)){
+        PrintError("Failed to save game to %s.\n", DOptions.DSaveGame.c_str());
+        return false;
+    }
+    printf("Saved %d bytes to %s\n", (int)Data.size(), DOptions.DSaveGame.c_str());
+    return true;
+}
+
+/**
+* Times saving and loading the current game in both formats, and checks that
+* each format loads back into a game that saves the same text as the
+* original. The first differing line is printed on a mismatch.
+*
+* @return true if both formats round trip
+*
+*/
+
+bool CHeadlessRenderer::BenchmarkSaves(){
+    std::string Text = CSavedGame::SaveText(DContext);
+    std::string Binary = CSavedGame::SaveBinary(DContext);
+    std::vector< std::pair< std::string, std::string > > Formats = {{"text", Text}, {"binary", Binary}};
+    std::vector< double > SaveTimes(Formats.size());
+    std::vector< double > LoadTimes(Formats.size());
+    bool Success = true;
+
+    for(size_t Index = 0; Index < Formats.size(); Index++){
+        const std::string &Data = Formats[Index].second;
+        std::string Check;
+
+        auto SaveStart = std::chrono::steady_clock::now();
+        for(int Run = 0; Run < DOptions.DSaveRuns; Run++){
+            Check = Formats[Index].first == "text" ? CSavedGame::SaveText(DContext) : CSavedGame::SaveBinary(DContext);
+        }
+        auto SaveEnd = std::chrono::steady_clock::now();
+        SaveTimes[Index] = std::chrono::duration< double, std::milli >(SaveEnd - SaveStart).count() / DOptions.DSaveRuns;
+
+        auto LoadStart = std::chrono::steady_clock::now();
+        for(int Run = 0; Run < DOptions.DSaveRuns; Run++){
+            if(!CSavedGame::Load(DContext, std::make_shared< CMemoryDataSource >(std::vector< char >(Data.begin(), Data.end())))){
+                PrintError("Failed to load the %s saved game.\n", Formats[Index].first.c_str());
+                return false;
+            }
+        }
+        auto LoadEnd = std::chrono::steady_clock::now();
+        LoadTimes[Index] = std::chrono::duration< double, std::milli >(LoadEnd - LoadStart).count() / DOptions.DSaveRuns;
+
+        Check = CSavedGame::SaveText(DContext);
+        if(Check != Text){
+            std::istringstream Expected(Text);
+            std::istringstream Actual(Check);
+            std::string ExpectedLine;
+            std::string ActualLine;
+            int Line = 1;
+
+            while(true){
+                if(!std::getline(Expected, ExpectedLine)){
+                    ExpectedLine = "<end of file>";
+                }
+                if(!std::getline(Actual, ActualLine)){
+                    ActualLine = "<end of file>";
+                }
+                if((ExpectedLine != ActualLine) || (!Expected && !Actual)){
+                    break;
+                }
+                Line++;
+            }
+            PrintError("The %s saved game does not round trip, line %d differs:\n", Formats[Index].first.c_str(), Line);
+            PrintError("  expected: %s\n", ExpectedLine.c_str());
+            PrintError("  actual:   %s\n", ActualLine.c_str());
+            Success = false;
+        }
+    }
+    printf("%-10s %10s %10s %10s\n", "format", "bytes", "save (ms)", "load (ms)");
+    for(size_t Index = 0; Index < Formats.size(); Index++){
+        printf("%-10s %10d %10.3f %10.3f\n", Formats[Index].first.c_str(), (int)Formats[Index].second.size(), SaveTimes[Index], LoadTimes[Index]);
+    }
+    printf("Round trip %s\n", Success ? "passed" : "failed");
+    return Success;
+}
@@ -84,8 +84,8 @@ bool CHostGameOptionsMode::ValidSelectedMapCallback(const std::string &str){
 
     int i = 0;
     
-    while(CAssetDecoratedMap::GetMap(i)){
-        if(DHostGameOptionsModePointer->DEditText[3] == CAssetDecoratedMap::GetMap(i++)->MapName())
+    while(i < CAssetDecoratedMap::MapCount()){
+        if(DHostGameOptionsModePointer->DEditText[3] == CAssetDecoratedMap::GetMapName(i++))
             ValidMap = true;
     }
 
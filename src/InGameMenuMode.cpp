@@ -19,6 +19,7 @@
 #include "BattleMode.h"
 #include "OptionsMenuMode.h"
 #include "ApplicationData.h"
+#include "SavedGame.h"
 #include <fstream>
 #include <iostream>
 
@@ -61,7 +62,8 @@ void CInGameMenuMode::OptionsMenuButtonCallback(std::shared_ptr< CApplicationDat
 }
 
 /**
-* A callback function for saving the game
+* A callback function for saving the game, the game is saved in the binary
+* format to SavedGame.sav
 *
 * @param[in] context A shared pointer to a CApplicationData object
 *
@@ -70,156 +72,7 @@ void CInGameMenuMode::OptionsMenuButtonCallback(std::shared_ptr< CApplicationDat
 */
 
 void CInGameMenuMode::SaveButtonCallback(std::shared_ptr< CApplicationData > context){
-    std::ofstream save("SavedGame.txt");
-
-    // save all player colors, used to recreate DGameModel
-    for(int i = 0; i < to_underlying(EPlayerColor::Max); i++){
-        save << "#Player Colors\n";
-        save << to_underlying(context->DLoadingPlayerColors[i]) << std::endl;
-
-        save << "#Player Types\n";
-        save << to_underlying(context->DLoadingPlayerTypes[i]) << std::endl;
-    }
-
-    // DGameModel
-
-    // std::shared_ptr< CAssetDecoratedMap > DActualMap;
-    context->DGameModel->Map()->SaveMap(save);
-
-    context->DGameModel->Player(context->DPlayerColor)->VisibilityMap()->SaveMap(save);
-
-    context->DGameModel->SaveGrowthMap(save);
-
-    // int DGameCycle;
-    save << "#GameCycle\n";
-    save << context->DGameModel->GameCycle() << "\n";
-
-    // get actual number of assets in map
-    save << "#AssetMap Size\n";
-    save << GAssetIDMap.size() << std::endl;
-
-    for(auto Asset : GAssetIDMap){
-        // int DAssetID;
-        save << "#Asset ID\n";
-        save << Asset.second->AssetID() << std::endl;
-
-        save << "#Color\n";
-        save << to_underlying(Asset.second->Color()) << std::endl;
-
-        // std::shared_ptr< CPlayerAssetType > DType;
-        // NOTE: when loading, use CPlayerAssetType::DRegistry to fine the right type
-        save << "#Type\n";
-        save << Asset.second->AssetType()->Name() << std::endl;
-
-        // int DCreationCycle;
-        save << "#CreationCyCle\n";
-        save << Asset.second->CreationCycle() << std::endl;
-
-        // int DHitPoints;
-        save << "#HitPoint\n";
-        save << Asset.second->HitPoints() << std::endl;
-
-        // int DGold;
-        save << "#Gold\n";
-        save << Asset.second->Gold() << std::endl;
-
-        // int DLumber;
-        save << "#Lumber\n";
-        save << Asset.second->Lumber() << std::endl;
-
-        // int DStone;
-        save << "#Stone\n";
-        save << Asset.second->Stone() << std::endl;
-
-        // int DStep;
-        save << "#Step\n";
-        save << Asset.second->Step() << std::endl;
-
-
-        // int DMoveRemainderX;
-        save << "#Move Remainder X\n";
-        save << Asset.second->MoveRemainderX() << std::endl;
-
-        // int DMoveRemainderY;
-        save << "#Move Remainder Y\n";
-        save << Asset.second->MoveRemainderY() << std::endl;
-
-        // CPixelPosition DPosition;
-        // X
-        save << "#TilePosition X\n";
-        save << Asset.second->TilePositionX() << std::endl;
-        // Y
-        save << "#TilePosition Y\n";
-        save << Asset.second->TilePositionY() << std::endl;
-
-        // EDirection DDirection;
-        save << "#Direction\n";
-        save << to_underlying(Asset.second->Direction()) << std::endl;
-
-        save << "#Capabilities size\n";
-
-        auto Capabilities = Asset.second->AssetType()->Capabilities();
-        save << Capabilities.size() << std::endl;
-
-        save << "#Capabilities\n";
-        for(int i = 0; i < Capabilities.size(); i++){
-            save << to_underlying(Capabilities[i]) << std::endl;
-        }
-
-        Asset.second->SavePeasants(save);
-    }
-
-    // get max asset count
-    save << "#AssetCount\n";
-    save << GAssetIDCount << std::endl;
-
-    //DPlayers
-    for(auto PlayerColor : context->DLoadingPlayerColors){
-        std::shared_ptr<CPlayerData> Player = context->DGameModel->Player(PlayerColor);
-
-        save << "#AI\n";
-        save << Player->IsAI() << std::endl;
-        save << "#Gold\n";
-        save << Player->Gold() << std::endl;
-        save << "#Lumber\n";
-        save << Player->Lumber() << std::endl;
-        save << "#Stone\n";
-        save << Player->Stone() << std::endl;
-
-        // std::vector< bool > DUpgrades;
-        save << "#Player Upgrades\n";
-        for(int i = 0; i < to_underlying(EAssetCapabilityType::Max); i++){
-            save << Player->HasUpgrade(static_cast<EAssetCapabilityType>(i)) << "\n";
-        }
-
-        // std::list< std::weak_ptr< CPlayerAsset > > DAssets;
-        save << "#WeakAssetCount\n";
-        save << Player->Assets().size() << std::endl;
-
-        for(auto WeakAsset : Player->Assets()){
-            auto Asset = WeakAsset.lock();
-
-            // store ID for loading
-            save << "#AssetID\n";
-            save << Asset->AssetID() << '\n';
-
-            Asset->SaveCommands(save, PlayerColor);
-        }
-    }
-
-    // unit groups
-    for(int i = SGUIKeyType::Key0; i <= SGUIKeyType::Key9; i++){
-        save << "#Unit grouping" << i << " size\n";
-        save << context->DGroupHotKeyMap[i].size() << std::endl;
-
-        if(context->DGroupHotKeyMap[i].size()){
-            for(auto Asset : context->DGroupHotKeyMap[i]){
-                save << Asset.lock()->AssetID() << std::endl;
-            }
-        }
-    }
-
-    save.close();
+    CSavedGame::Write(CSavedGame::SaveBinary(context), SAVED_GAME_FILENAME);
 }
 
 /**
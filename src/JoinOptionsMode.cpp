@@ -135,7 +135,12 @@ void CJoinOptionsMode::JoinOptionsUpdateButtonCallback(std::shared_ptr< CApplica
 			context->DGameSessionType = CApplicationData::gstMultiPlayerClient;
 			//Set map
 			context->DSelectedMapIndex = CAssetDecoratedMap::FindMapIndex(context->DMultiplayerClient->mapName);
-			*context->DSelectedMap = *CAssetDecoratedMap::GetMap(context->DSelectedMapIndex);
+			auto SelectedMap = CAssetDecoratedMap::GetMap(context->DSelectedMapIndex);
+			if(nullptr == SelectedMap) {
+			PrintError("Failed to load map %s.\n", context->DMultiplayerClient->mapName.c_str());
+			return false;
+			}
+			*context->DSelectedMap = *SelectedMap;
 			context->DPlayerColor = static_cast<EPlayerColor>(context->DMultiplayerClient->team);
 
 			context->ChangeApplicationMode(CGameSelectionMode::Instance());
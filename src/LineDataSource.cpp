@@ -44,7 +44,8 @@ CLineDataSource::CLineDataSource(std::shared_ptr< CDataSource > source){
 }
 
 /**
-* Reads the line of text until reaching a new line character
+* Reads the line of text until reaching a new line character, buffered
+* sources hand over the whole line at once
 *
 * @param[in] line std::string reference to text this function will read
 *
@@ -53,24 +54,5 @@ CLineDataSource::CLineDataSource(std::shared_ptr< CDataSource > source){
 */
 
 bool CLineDataSource::Read(std::string &line){
-    char TempChar;
-    
-    line.clear();
-    while(true){
-        if(0 < DDataSource->Read(&TempChar, 1)){
-            // Check until reach a new line character
-            if('\n' == TempChar){
-                return true;
-            }
-            // Skip carriage returns
-            else if('\r' != TempChar){
-                line += TempChar;
-            }
-        }
-        else{
-            return 0 < line.length();
-        }
-    }
-    
+    return DDataSource->ReadLine(line);
 }
-
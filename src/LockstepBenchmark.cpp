@@ -0,0 +1,402 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included
+    that were extracted from original Warcraft II by Blizzard Entertainment
+    were found freely available via internet sources and have been labeld as
+    abandonware. They have been included in this distribution for educational
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CLockstepBenchmark
+*
+* @brief Checks and measures the lockstep command frames. Every frame is
+*     encoded and decoded again in both the binary and the text form and
+*     must come back unchanged, including the edge cases of empty frames,
+*     large asset IDs and negative positions. Then a set of random frames is
+*     encoded and decoded repeatedly to report the throughput and size of
+*     each form.
+*
+*     Finally a loopback test runs several lockstep schedulers against each
+*     other in one process. Their frames are exchanged through in-memory
+*     links with a random latency of a few frames, every peer must apply the
+*     same commands in the same cycles, and the stalls are reported for no
+*     input delay and for the requested one.
+*
+*     Started with "--lockstep-benchmark", see PrintUsage for the other
+*     options.
+*
+*/
+
+#include "LockstepBenchmark.h"
+#include "Debug.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <list>
+
+#define LOCKSTEP_BENCHMARK_SEED     160
+#define LOCKSTEP_DISTINCT_FRAMES    1024
+#define LOCKSTEP_MAP_PIXELS         4096
+#define LOCKSTEP_FRAME_SECONDS      0.05
+#define LOCKSTEP_COMMAND_ODDS       4
+
+/**
+* Constructor, stores the options.
+*
+* @param[in] options The parsed benchmark options
+*
+*/
+
+CLockstepBenchmark::CLockstepBenchmark(const SOptions &options) : DRandom(LOCKSTEP_BENCHMARK_SEED){
+    DOptions = options;
+}
+
+/**
+* Parses the command line for the lockstep benchmark options. The benchmark
+* is only enabled if "--lockstep-benchmark" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the lockstep benchmark was requested
+*
+*/
+
+bool CLockstepBenchmark::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--lockstep-benchmark" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--frames" == Argument){
+            options.DFrames = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--commands" == Argument){
+            options.DCommands = std::max(0, std::atoi(Value.c_str()));
+        }
+        else if("--actors" == Argument){
+            options.DActors = std::max(0, std::atoi(Value.c_str()));
+        }
+        else if("--peers" == Argument){
+            options.DPeers = std::max(1, std::min(std::atoi(Value.c_str()), to_underlying(EPlayerColor::Max) - 1));
+        }
+        else if("--cycles" == Argument){
+            options.DCycles = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--delay" == Argument){
+            options.DDelay = std::max(0, std::min(std::atoi(Value.c_str()), MAX_LOCKSTEP_INPUT_DELAY));
+        }
+        else if("--latency" == Argument){
+            options.DLatency = std::max(0, std::atoi(Value.c_str()));
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown lockstep benchmark option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the lockstep benchmark options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CLockstepBenchmark::PrintUsage(const char *program){
+    PrintError("Usage: %s --lockstep-benchmark [options]\n", program);
+    PrintError("  --frames N        frames to encode and decode per form (default: 100000)\n");
+    PrintError("  --commands N      commands batched per frame (default: 1)\n");
+    PrintError("  --actors N        actors per command (default: 9)\n");
+    PrintError("  --peers N         peers in the loopback test (default: 2)\n");
+    PrintError("  --cycles N        game cycles in the loopback test (default: 2000)\n");
+    PrintError("  --delay N         input delay in cycles for the loopback test (default: %d)\n", DEFAULT_LOCKSTEP_INPUT_DELAY);
+    PrintError("  --latency N       maximum link latency in frames for the loopback test (default: 4)\n");
+}
+
+/**
+* Runs the round trip checks, the throughput measurements and the loopback
+* test.
+*
+* @return 0 on success, 1 if a frame did not survive a round trip or the
+*     peers of the loopback test diverged
+*
+*/
+
+int CLockstepBenchmark::Run(){
+    if(!RunRoundTrips()){
+        return 1;
+    }
+    for(int Index = 0; Index < LOCKSTEP_DISTINCT_FRAMES; Index++){
+        DFrames.push_back(RandomFrame(Index, DOptions.DCommands, DOptions.DActors));
+    }
+    RunThroughput(false);
+    RunThroughput(true);
+    if(DOptions.DDelay && !RunLoopback(0)){
+        return 1;
+    }
+    return RunLoopback(DOptions.DDelay) ? 0 : 1;
+}
+
+/**
+* Builds a frame of random commands, actor IDs are clustered like the IDs
+* of a player's units usually are.
+*
+* @param[in] cycle The game cycle of the frame
+* @param[in] commands The number of commands in the frame
+* @param[in] actors The number of actors per command
+*
+* @return The frame
+*
+*/
+
+SLockstepFrame CLockstepBenchmark::RandomFrame(int cycle, int commands, int actors){
+    SLockstepFrame Frame;
+
+    Frame.DCycle = cycle;
+    for(int CommandIndex = 0; CommandIndex < commands; CommandIndex++){
+        SLockstepCommand Command;
+        int BaseID = DRandom() % 2000;
+
+        Command.DPlayer = static_cast< EPlayerColor >(1 + DRandom() % (to_underlying(EPlayerColor::Max) - 1));
+        Command.DAction = static_cast< EAssetCapabilityType >(DRandom() % to_underlying(EAssetCapabilityType::Max));
+        for(int Actor = 0; Actor < actors; Actor++){
+            Command.DActorIDs.push_back(BaseID + DRandom() % 64);
+        }
+        Command.DTargetColor = static_cast< EPlayerColor >(DRandom() % to_underlying(EPlayerColor::Max));
+        Command.DTargetType = static_cast< EAssetType >(DRandom() % to_underlying(EAssetType::Max));
+        Command.DTargetX = DRandom() % LOCKSTEP_MAP_PIXELS;
+        Command.DTargetY = DRandom() % LOCKSTEP_MAP_PIXELS;
+        Frame.DCommands.push_back(Command);
+    }
+    return Frame;
+}
+
+/**
+* Encodes and decodes a frame and compares the result.
+*
+* @param[in] frame The frame to check
+* @param[in] text true to check the text form, false for the binary form
+*
+* @return true if the frame came back unchanged
+*
+*/
+
+bool CLockstepBenchmark::RoundTrip(const SLockstepFrame &frame, bool text){
+    SLockstepFrame Decoded;
+
+    if(!CLockstepFrame::DecodeMessage(CLockstepFrame::EncodeMessage(frame, text), Decoded)){
+        PrintError("Failed to decode %s frame for cycle %d\n", text ? "text" : "binary", frame.DCycle);
+        return false;
+    }
+    if(!CLockstepFrame::Equal(frame, Decoded)){
+        PrintError("%s frame for cycle %d changed in a round trip\n", text ? "Text" : "Binary", frame.DCycle);
+        return false;
+    }
+    return true;
+}
+
+/**
+* Checks the round trip of the edge cases and of random frames of every
+* size up to the requested one.
+*
+* @return true if all frames came back unchanged
+*
+*/
+
+bool CLockstepBenchmark::RunRoundTrips(){
+    std::vector< SLockstepFrame > Frames;
+    SLockstepFrame Frame;
+    SLockstepFrame Decoded;
+    int Failures = 0;
+
+    Frame.DCycle = 0;
+    Frames.push_back(Frame);
+    Frame = RandomFrame(0x7FFFFFFF, 1, 0);
+    Frames.push_back(Frame);
+    Frame = RandomFrame(1, 1, 4);
+    Frame.DCommands[0].DActorIDs = {0x7FFFFFFF, 0, 0x7FFFFFFF, 1};
+    Frame.DCommands[0].DTargetX = -1;
+    Frame.DCommands[0].DTargetY = -0x7FFFFFFF;
+    Frames.push_back(Frame);
+    for(int Commands = 0; Commands <= std::max(DOptions.DCommands, 8); Commands++){
+        for(int Actors = 0; Actors <= std::max(DOptions.DActors, 9); Actors++){
+            Frames.push_back(RandomFrame(Commands * 100 + Actors, Commands, Actors));
+        }
+    }
+    for(auto &Frame : Frames){
+        Failures += RoundTrip(Frame, false) ? 0 : 1;
+        Failures += RoundTrip(Frame, true) ? 0 : 1;
+    }
+    // Truncated or corrupted binary frames must be rejected, not misread
+    std::string Message = CLockstepFrame::EncodeMessage(Frames.back());
+    for(size_t Length = 1; Length < Message.size(); Length++){
+        if(CLockstepFrame::DecodeMessage(Message.substr(0, Length), Decoded) && CLockstepFrame::Equal(Frames.back(), Decoded)){
+            PrintError("Truncated frame of %d characters was accepted\n", (int)Length);
+            Failures++;
+        }
+    }
+    if(CLockstepFrame::DecodeMessage(Message + "*", Decoded)){
+        PrintError("Frame with an invalid character was accepted\n");
+        Failures++;
+    }
+    printf("Round trips: %d frames, %d failures\n", (int)Frames.size() * 2, Failures);
+    return 0 == Failures;
+}
+
+/**
+* Measures encoding and decoding of the random frames in one form.
+*
+* @param[in] text true to measure the text form, false for the binary form
+*
+* @return void
+*
+*/
+
+void CLockstepBenchmark::RunThroughput(bool text){
+    std::vector< std::string > Messages(DFrames.size());
+    SLockstepFrame Decoded;
+    size_t TotalBytes = 0;
+    int Decodes = 0;
+
+    auto EncodeStart = std::chrono::steady_clock::now();
+    for(int Index = 0; Index < DOptions.DFrames; Index++){
+        std::string &Message = Messages[Index % DFrames.size()];
+
+        Message = CLockstepFrame::EncodeMessage(DFrames[Index % DFrames.size()], text);
+        TotalBytes += Message.size();
+    }
+    auto EncodeEnd = std::chrono::steady_clock::now();
+    for(int Index = 0; Index < DOptions.DFrames; Index++){
+        Decodes += CLockstepFrame::DecodeMessage(Messages[Index % Messages.size()], Decoded) ? 1 : 0;
+    }
+    auto DecodeEnd = std::chrono::steady_clock::now();
+
+    double EncodeSeconds = std::chrono::duration< double >(EncodeEnd - EncodeStart).count();
+    double DecodeSeconds = std::chrono::duration< double >(DecodeEnd - EncodeEnd).count();
+
+    printf("%-6s %8.1f bytes/frame, encode %10.0f frames/s, decode %10.0f frames/s (%d/%d decoded)\n", text ? "text" : "binary", (double)TotalBytes / DOptions.DFrames, DOptions.DFrames / std::max(EncodeSeconds, 1e-9), DOptions.DFrames / std::max(DecodeSeconds, 1e-9), Decodes, DOptions.DFrames);
+}
+
+/**
+* Runs the peers of the loopback test until all of them simulated the
+* requested cycles. Every frame each peer may give a random command, sends
+* its due frames, receives the frames whose latency has passed and then
+* simulates a cycle if the scheduler allows it. A link delivers in order
+* like the TCP connection through the server does.
+*
+* @param[in] delay The input delay in cycles
+*
+* @return true if all peers finished and applied identical commands
+*
+*/
+
+bool CLockstepBenchmark::RunLoopback(int delay){
+    using SLinkMessage = struct LINKMESSAGE_TAG{
+        int DDeliverFrame;
+        int DPeer;
+        std::string DMessage;
+    };
+    int Peers = DOptions.DPeers;
+    int MaxFrames = DOptions.DCycles * (DOptions.DLatency + 2) + 1000;
+    std::vector< CLockstepScheduler > Schedulers(Peers, CLockstepScheduler(delay));
+    std::vector< int > Cycles(Peers, 0);
+    std::vector< size_t > Digests(Peers, 0);
+    std::vector< std::vector< int > > LastDelivery(Peers, std::vector< int >(Peers, 0));
+    std::list< SLinkMessage > Links;
+    std::vector< SLockstepCommand > Commands;
+    SLockstepFrame Frame;
+    int FrameIndex;
+
+    for(int Peer = 0; Peer < Peers; Peer++){
+        Schedulers[Peer].Reset(0);
+        for(int Other = 0; Other < Peers; Other++){
+            Schedulers[Peer].Expect(static_cast< EPlayerColor >(Other + 1), true);
+        }
+    }
+    for(FrameIndex = 0; FrameIndex < MaxFrames; FrameIndex++){
+        bool Done = true;
+
+        for(int Peer = 0; Peer < Peers; Peer++){
+            if(0 == DRandom() % LOCKSTEP_COMMAND_ODDS){
+                Schedulers[Peer].Submit(RandomFrame(0, 1, 1 + DRandom() % 4).DCommands.front());
+            }
+            while(Schedulers[Peer].Issue(Cycles[Peer], static_cast< EPlayerColor >(Peer + 1), Frame)){
+                std::string Message = CLockstepFrame::EncodeMessage(Frame);
+
+                for(int Other = 0; Other < Peers; Other++){
+                    if(Other != Peer){
+                        int Deliver = std::max(FrameIndex + (int)(DRandom() % (DOptions.DLatency + 1)), LastDelivery[Peer][Other]);
+
+                        LastDelivery[Peer][Other] = Deliver;
+                        Links.push_back({Deliver, Other, Message});
+                    }
+                }
+            }
+        }
+        for(auto Link = Links.begin(); Link != Links.end();){
+            if(Link->DDeliverFrame <= FrameIndex){
+                if(!CLockstepFrame::DecodeMessage(Link->DMessage, Frame) || !Schedulers[Link->DPeer].Receive(Frame)){
+                    PrintError("Peer %d rejected a frame\n", Link->DPeer);
+                    return false;
+                }
+                Link = Links.erase(Link);
+            }
+            else{
+                Link++;
+            }
+        }
+        for(int Peer = 0; Peer < Peers; Peer++){
+            if(Cycles[Peer] < DOptions.DCycles){
+                if(Schedulers[Peer].Advance(Cycles[Peer], FrameIndex * LOCKSTEP_FRAME_SECONDS, Commands)){
+                    Frame.DCycle = Cycles[Peer];
+                    Frame.DCommands = Commands;
+                    Digests[Peer] = Digests[Peer] * 31 + std::hash< std::string >()(CLockstepFrame::EncodeBinary(Frame));
+                    Cycles[Peer]++;
+                }
+                Done = false;
+            }
+        }
+        if(Done){
+            break;
+        }
+    }
+    printf("Loopback: %d peers, delay %d, latency 0-%d frames, %d cycles in %d frames\n", Peers, delay, DOptions.DLatency, DOptions.DCycles, FrameIndex);
+    for(int Peer = 0; Peer < Peers; Peer++){
+        printf("  peer %d: %6d cycles, %5d stalls, %6d stalled frames, %8.1f ms stalled, max %6.1f ms\n", Peer + 1, Schedulers[Peer].CyclesAdvanced(), Schedulers[Peer].StallCount(), Schedulers[Peer].StalledFrames(), Schedulers[Peer].StallTime() * 1000.0, Schedulers[Peer].MaxStall() * 1000.0);
+        if(Cycles[Peer] < DOptions.DCycles){
+            PrintError("Peer %d stopped at cycle %d\n", Peer + 1, Cycles[Peer]);
+            return false;
+        }
+        if(Digests[Peer] != Digests[0]){
+            PrintError("Peer %d applied different commands than peer 1\n", Peer + 1);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,515 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CLockstepFrame
+*
+* @brief Encodes the player commands of one game cycle for the lockstep
+*     exchange between multiplayer clients. All commands of a cycle are
+*     batched into one frame. The binary form uses varints, with actor IDs
+*     delta coded, and is sent as one URL safe base64 token prefixed with
+*     LOCKSTEP_BINARY_MARKER, since the server protocol is line based.
+*     The original "#"-commented multi line text form is still written on
+*     request and always accepted, as a readable fallback for debugging.
+*
+*/
+
+#include "LockstepFrame.h"
+#include "GameModel.h"
+#include "Debug.h"
+#include <sstream>
+
+static const char Text64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/**
+* Appends an unsigned value as a varint, seven bits per byte with the high
+* bit set on all but the last byte.
+*
+* @param[out] data The buffer to append to
+* @param[in] value The value to append
+*
+* @return void
+*
+*/
+
+void CLockstepFrame::AppendVarint(std::string &data, uint32_t value){
+    while(0x80 <= value){
+        data.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.push_back((char)value);
+}
+
+/**
+* Reads a varint.
+*
+* @param[in] data The buffer to read from
+* @param[in,out] offset The position in the buffer, advanced past the varint
+* @param[out] value The value read
+*
+* @return true if a complete varint was read
+*
+*/
+
+bool CLockstepFrame::ReadVarint(const std::string &data, size_t &offset, uint32_t &value){
+    value = 0;
+    for(int Shift = 0; Shift < 35; Shift += 7){
+        uint8_t Byte;
+
+        if(offset >= data.size()){
+            return false;
+        }
+        Byte = data[offset++];
+        value |= (uint32_t)(Byte & 0x7F) << Shift;
+        if(!(Byte & 0x80)){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+* Maps a signed value onto an unsigned one so small negative values stay
+* small as varints.
+*
+* @param[in] value The signed value
+*
+* @return The zigzag encoded value
+*
+*/
+
+uint32_t CLockstepFrame::ZigZag(int value){
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+* Reverses ZigZag.
+*
+* @param[in] value The zigzag encoded value
+*
+* @return The signed value
+*
+*/
+
+int CLockstepFrame::UnZigZag(uint32_t value){
+    return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+/**
+* Encodes bytes as URL safe base64 without padding, so a frame is a single
+* token without spaces, pipes or newlines.
+*
+* @param[in] data The bytes to encode
+*
+* @return The encoded text
+*
+*/
+
+std::string CLockstepFrame::ToText64(const std::string &data){
+    std::string Text;
+    uint32_t Bits = 0;
+    int BitCount = 0;
+
+    Text.reserve((data.size() * 4 + 2) / 3);
+    for(auto Character : data){
+        Bits = (Bits << 8) | (uint8_t)Character;
+        BitCount += 8;
+        while(6 <= BitCount){
+            BitCount -= 6;
+            Text.push_back(Text64Alphabet[(Bits >> BitCount) & 0x3F]);
+        }
+    }
+    if(BitCount){
+        Text.push_back(Text64Alphabet[(Bits << (6 - BitCount)) & 0x3F]);
+    }
+    return Text;
+}
+
+/**
+* Decodes text written by ToText64.
+*
+* @param[in] text The encoded text
+* @param[out] data The decoded bytes
+*
+* @return true if the text only held valid characters
+*
+*/
+
+bool CLockstepFrame::FromText64(const std::string &text, std::string &data){
+    uint32_t Bits = 0;
+    int BitCount = 0;
+
+    data.clear();
+    data.reserve((text.size() * 3) / 4);
+    for(auto Character : text){
+        int Value;
+
+        if(('A' <= Character) && ('Z' >= Character)){
+            Value = Character - 'A';
+        }
+        else if(('a' <= Character) && ('z' >= Character)){
+            Value = Character - 'a' + 26;
+        }
+        else if(('0' <= Character) && ('9' >= Character)){
+            Value = Character - '0' + 52;
+        }
+        else if('-' == Character){
+            Value = 62;
+        }
+        else if('_' == Character){
+            Value = 63;
+        }
+        else{
+            return false;
+        }
+        Bits = (Bits << 6) | Value;
+        BitCount += 6;
+        if(8 <= BitCount){
+            BitCount -= 8;
+            data.push_back((char)((Bits >> BitCount) & 0xFF));
+        }
+    }
+    return true;
+}
+
+/**
+* Builds the frame command for a player's command request. Actors that no
+* longer exist are left out.
+*
+* @param[in] player The player issuing the command
+* @param[in] request The command request
+*
+* @return The frame command
+*
+*/
+
+SLockstepCommand CLockstepFrame::FromRequest(EPlayerColor player, const SPlayerCommandRequest &request){
+    SLockstepCommand Command;
+
+    Command.DPlayer = player;
+    Command.DAction = request.DAction;
+    for(auto &WeakActor : request.DActors){
+        if(auto Actor = WeakActor.lock()){
+            Command.DActorIDs.push_back(Actor->AssetID());
+        }
+    }
+    Command.DTargetColor = request.DTargetColor;
+    Command.DTargetType = request.DTargetType;
+    Command.DTargetX = request.DTargetLocation.X();
+    Command.DTargetY = request.DTargetLocation.Y();
+    return Command;
+}
+
+/**
+* Fills a command request from a frame command, actor IDs are looked up in
+* the game model.
+*
+* @param[in] command The frame command
+* @param[out] request The command request
+*
+* @return void
+*
+*/
+
+void CLockstepFrame::ToRequest(const SLockstepCommand &command, SPlayerCommandRequest &request){
+    request.DAction = command.DAction;
+    request.DActors.clear();
+    for(auto AssetID : command.DActorIDs){
+        std::shared_ptr< CPlayerAsset > FoundAsset = FindAssetObj(AssetID);
+
+        if(nullptr == FoundAsset){
+            PrintDebug(DEBUG_LOW, "Lockstep actor %d not found\n", AssetID);
+        }
+        request.DActors.push_back(FoundAsset);
+    }
+    request.DTargetColor = command.DTargetColor;
+    request.DTargetType = command.DTargetType;
+    request.DTargetLocation.X(command.DTargetX);
+    request.DTargetLocation.Y(command.DTargetY);
+}
+
+/**
+* Encodes a frame in the binary form.
+*
+* @param[in] frame The frame to encode
+*
+* @return The encoded bytes
+*
+*/
+
+std::string CLockstepFrame::EncodeBinary(const SLockstepFrame &frame){
+    std::string Data;
+
+    Data.push_back((char)LOCKSTEP_FRAME_VERSION);
+    AppendVarint(Data, frame.DCycle);
+    AppendVarint(Data, frame.DCommands.size());
+    for(auto &Command : frame.DCommands){
+        int LastID = 0;
+
+        Data.push_back((char)to_underlying(Command.DPlayer));
+        AppendVarint(Data, to_underlying(Command.DAction));
+        AppendVarint(Data, Command.DActorIDs.size());
+        for(auto AssetID : Command.DActorIDs){
+            AppendVarint(Data, ZigZag(AssetID - LastID));
+            LastID = AssetID;
+        }
+        Data.push_back((char)to_underlying(Command.DTargetColor));
+        AppendVarint(Data, to_underlying(Command.DTargetType));
+        AppendVarint(Data, ZigZag(Command.DTargetX));
+        AppendVarint(Data, ZigZag(Command.DTargetY));
+    }
+    return Data;
+}
+
+/**
+* Decodes a frame in the binary form, values out of range for their enum
+* reject the frame.
+*
+* @param[in] data The encoded bytes
+* @param[out] frame The decoded frame
+*
+* @return true if the frame was valid
+*
+*/
+
+bool CLockstepFrame::DecodeBinary(const std::string &data, SLockstepFrame &frame){
+    size_t Offset = 1;
+    uint32_t Value, CommandCount;
+
+    frame.DCommands.clear();
+    if(data.empty() || (LOCKSTEP_FRAME_VERSION != (uint8_t)data[0])){
+        return false;
+    }
+    if(!ReadVarint(data, Offset, Value)){
+        return false;
+    }
+    frame.DCycle = Value;
+    if(!ReadVarint(data, Offset, CommandCount) || (CommandCount > data.size())){
+        return false;
+    }
+    frame.DCommands.resize(CommandCount);
+    for(auto &Command : frame.DCommands){
+        uint32_t ActorCount;
+        int LastID = 0;
+
+        if((Offset >= data.size()) || ((uint8_t)data[Offset] >= to_underlying(EPlayerColor::Max))){
+            return false;
+        }
+        Command.DPlayer = static_cast< EPlayerColor >((uint8_t)data[Offset++]);
+        if(!ReadVarint(data, Offset, Value) || (Value >= (uint32_t)to_underlying(EAssetCapabilityType::Max))){
+            return false;
+        }
+        Command.DAction = static_cast< EAssetCapabilityType >(Value);
+        if(!ReadVarint(data, Offset, ActorCount) || (ActorCount > data.size() - Offset)){
+            return false;
+        }
+        Command.DActorIDs.resize(ActorCount);
+        for(auto &AssetID : Command.DActorIDs){
+            if(!ReadVarint(data, Offset, Value)){
+                return false;
+            }
+            AssetID = LastID + UnZigZag(Value);
+            LastID = AssetID;
+        }
+        if((Offset >= data.size()) || ((uint8_t)data[Offset] >= to_underlying(EPlayerColor::Max))){
+            return false;
+        }
+        Command.DTargetColor = static_cast< EPlayerColor >((uint8_t)data[Offset++]);
+        if(!ReadVarint(data, Offset, Value) || (Value >= (uint32_t)to_underlying(EAssetType::Max))){
+            return false;
+        }
+        Command.DTargetType = static_cast< EAssetType >(Value);
+        if(!ReadVarint(data, Offset, Value)){
+            return false;
+        }
+        Command.DTargetX = UnZigZag(Value);
+        if(!ReadVarint(data, Offset, Value)){
+            return false;
+        }
+        Command.DTargetY = UnZigZag(Value);
+    }
+    return Offset == data.size();
+}
+
+/**
+* Encodes a frame in the original commented text form, the cycle followed
+* by one block per command.
+*
+* @param[in] frame The frame to encode
+*
+* @return The text
+*
+*/
+
+std::string CLockstepFrame::EncodeText(const SLockstepFrame &frame){
+    std::stringstream Output;
+
+    Output << "#Game Cycle\n" << frame.DCycle << "\n";
+    for(auto &Command : frame.DCommands){
+        Output << "#PlayerColor\n" << to_underlying(Command.DPlayer) << "\n";
+        Output << "#Action\n" << to_underlying(Command.DAction) << "\n";
+        Output << "#Actors Count\n" << Command.DActorIDs.size() << "\n";
+        Output << "#AssetID\n";
+        for(auto AssetID : Command.DActorIDs){
+            Output << AssetID << "\n";
+        }
+        Output << "#TargetColor\n" << to_underlying(Command.DTargetColor) << "\n";
+        Output << "#TargetType\n" << to_underlying(Command.DTargetType) << "\n";
+        Output << "#TargetLocation\n" << Command.DTargetX << "\n";
+        Output << Command.DTargetY << "\n";
+    }
+    return Output.str();
+}
+
+/**
+* Decodes the text form.
+*
+* @param[in] text The text
+* @param[out] frame The decoded frame
+*
+* @return true if the text was a complete frame
+*
+*/
+
+bool CLockstepFrame::DecodeText(const std::string &text, SLockstepFrame &frame){
+    std::vector< int > Values;
+    size_t Start = 0;
+    size_t Index = 0;
+
+    frame.DCommands.clear();
+    while(Start < text.size()){
+        size_t End = text.find('\n', Start);
+
+        if(std::string::npos == End){
+            End = text.size();
+        }
+        if((End > Start) && ('#' != text[Start])){
+            try{
+                Values.push_back(std::stoi(text.substr(Start, End - Start)));
+            }
+            catch(std::exception &E){
+                return false;
+            }
+        }
+        Start = End + 1;
+    }
+    if(Values.empty()){
+        return false;
+    }
+    frame.DCycle = Values[Index++];
+    while(Index < Values.size()){
+        SLockstepCommand Command;
+
+        if(Index + 3 > Values.size()){
+            return false;
+        }
+        if((0 > Values[Index]) || (Values[Index] >= to_underlying(EPlayerColor::Max))){
+            return false;
+        }
+        Command.DPlayer = static_cast< EPlayerColor >(Values[Index++]);
+        if((0 > Values[Index]) || (Values[Index] >= to_underlying(EAssetCapabilityType::Max))){
+            return false;
+        }
+        Command.DAction = static_cast< EAssetCapabilityType >(Values[Index++]);
+        if((0 > Values[Index]) || (Index + 1 + Values[Index] + 4 > Values.size())){
+            return false;
+        }
+        Command.DActorIDs.assign(Values.begin() + Index + 1, Values.begin() + Index + 1 + Values[Index]);
+        Index += 1 + Values[Index];
+        if((0 > Values[Index]) || (Values[Index] >= to_underlying(EPlayerColor::Max))){
+            return false;
+        }
+        Command.DTargetColor = static_cast< EPlayerColor >(Values[Index++]);
+        if((0 > Values[Index]) || (Values[Index] >= to_underlying(EAssetType::Max))){
+            return false;
+        }
+        Command.DTargetType = static_cast< EAssetType >(Values[Index++]);
+        Command.DTargetX = Values[Index++];
+        Command.DTargetY = Values[Index++];
+        frame.DCommands.push_back(Command);
+    }
+    return true;
+}
+
+/**
+* Encodes a frame as it is sent in a COMMAND message.
+*
+* @param[in] frame The frame to encode
+* @param[in] text true to send the text form instead of the binary form
+*
+* @return The message body
+*
+*/
+
+std::string CLockstepFrame::EncodeMessage(const SLockstepFrame &frame, bool text){
+    if(text){
+        return EncodeText(frame);
+    }
+    return std::string(1, LOCKSTEP_BINARY_MARKER) + ToText64(EncodeBinary(frame));
+}
+
+/**
+* Decodes the body of a COMMAND message in either form.
+*
+* @param[in] message The message body
+* @param[out] frame The decoded frame
+*
+* @return true if the message held a valid frame
+*
+*/
+
+bool CLockstepFrame::DecodeMessage(const std::string &message, SLockstepFrame &frame){
+    std::string Data;
+
+    if(message.empty()){
+        return false;
+    }
+    if(LOCKSTEP_BINARY_MARKER == message[0]){
+        size_t End = message.find_last_not_of("\r\n ");
+
+        return FromText64(message.substr(1, End), Data) && DecodeBinary(Data, frame);
+    }
+    return DecodeText(message, frame);
+}
+
+/**
+* Compares two frames.
+*
+* @param[in] first The first frame
+* @param[in] second The second frame
+*
+* @return true if both frames hold the same commands for the same cycle
+*
+*/
+
+bool CLockstepFrame::Equal(const SLockstepFrame &first, const SLockstepFrame &second){
+    if((first.DCycle != second.DCycle) || (first.DCommands.size() != second.DCommands.size())){
+        return false;
+    }
+    for(size_t Index = 0; Index < first.DCommands.size(); Index++){
+        const SLockstepCommand &First = first.DCommands[Index];
+        const SLockstepCommand &Second = second.DCommands[Index];
+
+        if((First.DPlayer != Second.DPlayer) || (First.DAction != Second.DAction) || (First.DActorIDs != Second.DActorIDs)){
+            return false;
+        }
+        if((First.DTargetColor != Second.DTargetColor) || (First.DTargetType != Second.DTargetType) || (First.DTargetX != Second.DTargetX) || (First.DTargetY != Second.DTargetY)){
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,291 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CLockstepScheduler
+*
+* @brief Schedules the lockstep commands of all players. A local command is
+*     not applied in the cycle it was given but sent for the cycle
+*     InputDelay() ticks ahead, so the commands of the other players have
+*     that long to arrive. The received commands are buffered per cycle and
+*     the simulation only advances once every expected player's frame for
+*     the current cycle is present. Until then Advance fails and the caller
+*     keeps rendering, the time spent waiting is recorded as a stall.
+*
+*     Every issued frame carries at least one command of the sending player,
+*     an empty command if nothing was given, so a frame with no action still
+*     tells the other players that the cycle is complete.
+*
+*/
+
+#include "LockstepScheduler.h"
+#include "Debug.h"
+#include <algorithm>
+
+/**
+* Constructor, sets the input delay and starts at cycle 0.
+*
+* @param[in] delay The input delay in game cycles
+*
+*/
+
+CLockstepScheduler::CLockstepScheduler(int delay){
+    DInputDelay = 0;
+    InputDelay(delay);
+    Reset(0);
+}
+
+/**
+* Sets the input delay, only takes effect for the next Reset.
+*
+* @param[in] delay The input delay in game cycles
+*
+* @return The input delay after clamping it to the valid range
+*
+*/
+
+int CLockstepScheduler::InputDelay(int delay){
+    DInputDelay = std::max(0, std::min(delay, MAX_LOCKSTEP_INPUT_DELAY));
+    return DInputDelay;
+}
+
+/**
+* Clears the buffered commands and statistics and starts the schedule at a
+* cycle. The first InputDelay() cycles after it have no commands.
+*
+* @param[in] cycle The game cycle the battle starts at
+*
+* @return void
+*
+*/
+
+void CLockstepScheduler::Reset(int cycle){
+    DStartCycle = cycle;
+    DCurrentCycle = cycle;
+    DIssuedCycle = cycle + DInputDelay - 1;
+    DExpected = 0;
+    DSlots.clear();
+    DHasPending = false;
+    DStalling = false;
+    DStallStart = 0.0;
+    DStallCount = 0;
+    DStalledFrames = 0;
+    DCyclesAdvanced = 0;
+    DStallTime = 0.0;
+    DMaxStall = 0.0;
+}
+
+/**
+* Sets whether the frames of a player are required to advance.
+*
+* @param[in] player The player color
+* @param[in] expected true if the simulation has to wait for the player
+*
+* @return void
+*
+*/
+
+void CLockstepScheduler::Expect(EPlayerColor player, bool expected){
+    if(expected){
+        DExpected |= PlayerBit(player);
+    }
+    else{
+        DExpected &= ~PlayerBit(player);
+    }
+}
+
+/**
+* Submits a local command, it is sent with the next issued frame. A newer
+* command replaces one that has not been issued yet.
+*
+* @param[in] command The local player's command
+*
+* @return void
+*
+*/
+
+void CLockstepScheduler::Submit(const SLockstepCommand &command){
+    DPending = command;
+    DHasPending = true;
+}
+
+/**
+* Issues the local frame of the next cycle that has none yet, if that cycle
+* is at most InputDelay() cycles ahead. The frame is also buffered locally.
+* Call until it returns false so no cycle is skipped.
+*
+* @param[in] cycle The current game cycle
+* @param[in] player The local player color
+* @param[out] frame The frame to send to the other players
+*
+* @return true if a frame was issued
+*
+*/
+
+bool CLockstepScheduler::Issue(int cycle, EPlayerColor player, SLockstepFrame &frame){
+    if(DIssuedCycle + 1 > cycle + DInputDelay){
+        return false;
+    }
+    DIssuedCycle++;
+    frame.DCycle = DIssuedCycle;
+    frame.DCommands.clear();
+    if(DHasPending){
+        frame.DCommands.push_back(DPending);
+        frame.DCommands.back().DPlayer = player;
+        DHasPending = false;
+    }
+    else{
+        SLockstepCommand Empty;
+
+        Empty.DPlayer = player;
+        Empty.DAction = EAssetCapabilityType::None;
+        Empty.DTargetColor = EPlayerColor::None;
+        Empty.DTargetType = EAssetType::None;
+        Empty.DTargetX = 0;
+        Empty.DTargetY = 0;
+        frame.DCommands.push_back(Empty);
+    }
+    Store(frame.DCycle, player, frame.DCommands);
+    return true;
+}
+
+/**
+* Buffers a frame received from another player. Frames for cycles that were
+* already simulated, too far ahead or repeated are dropped.
+*
+* @param[in] frame The decoded frame
+*
+* @return true if the frame was buffered
+*
+*/
+
+bool CLockstepScheduler::Receive(const SLockstepFrame &frame){
+    std::vector< SLockstepCommand > Commands;
+    bool Stored = false;
+
+    if((frame.DCycle < DCurrentCycle) || (frame.DCycle > DCurrentCycle + DInputDelay + MAX_LOCKSTEP_CYCLES_AHEAD)){
+        PrintDebug(DEBUG_LOW, "Dropped lockstep frame for cycle %d at cycle %d\n", frame.DCycle, DCurrentCycle);
+        return false;
+    }
+    for(int Index = 1; Index < to_underlying(EPlayerColor::Max); Index++){
+        Commands.clear();
+        for(auto &Command : frame.DCommands){
+            if(to_underlying(Command.DPlayer) == Index){
+                Commands.push_back(Command);
+            }
+        }
+        if(!Commands.empty()){
+            Stored |= Store(frame.DCycle, static_cast< EPlayerColor >(Index), Commands);
+        }
+    }
+    return Stored;
+}
+
+/**
+* Buffers the commands of one player for a cycle.
+*
+* @param[in] cycle The game cycle of the commands
+* @param[in] player The player that sent them
+* @param[in] commands The commands
+*
+* @return false if the player's commands for the cycle were already present
+*
+*/
+
+bool CLockstepScheduler::Store(int cycle, EPlayerColor player, const std::vector< SLockstepCommand > &commands){
+    SCycleSlot &Slot = DSlots[cycle];
+
+    if(Slot.DReceived & PlayerBit(player)){
+        return false;
+    }
+    Slot.DReceived |= PlayerBit(player);
+    Slot.DCommands.insert(Slot.DCommands.end(), commands.begin(), commands.end());
+    return true;
+}
+
+/**
+* Checks if the commands of every expected player are present for a cycle.
+*
+* @param[in] cycle The game cycle
+*
+* @return true if the cycle can be simulated
+*
+*/
+
+bool CLockstepScheduler::Ready(int cycle) const{
+    if(cycle < DStartCycle + DInputDelay){
+        return true;
+    }
+    auto Slot = DSlots.find(cycle);
+
+    return (DSlots.end() != Slot) && ((Slot->second.DReceived & DExpected) == DExpected);
+}
+
+/**
+* Advances to the next cycle if it is ready. The commands are returned
+* ordered by player so every peer applies them in the same order. If the
+* cycle is not ready the call counts as a stalled frame.
+*
+* @param[in] cycle The game cycle about to be simulated
+* @param[in] now The current time in seconds, used for the stall time
+* @param[out] commands The commands of all players for the cycle
+*
+* @return true if the cycle can be simulated, false if it has to wait
+*
+*/
+
+bool CLockstepScheduler::Advance(int cycle, double now, std::vector< SLockstepCommand > &commands){
+    commands.clear();
+    if(!Ready(cycle)){
+        if(!DStalling){
+            DStalling = true;
+            DStallStart = now;
+            DStallCount++;
+        }
+        DStalledFrames++;
+        return false;
+    }
+    if(DStalling){
+        double Duration = now - DStallStart;
+
+        DStallTime += Duration;
+        DMaxStall = std::max(DMaxStall, Duration);
+        DStalling = false;
+    }
+    auto Slot = DSlots.find(cycle);
+
+    if(DSlots.end() != Slot){
+        commands.swap(Slot->second.DCommands);
+        std::stable_sort(commands.begin(), commands.end(), [](const SLockstepCommand &first, const SLockstepCommand &second){
+            return to_underlying(first.DPlayer) < to_underlying(second.DPlayer);
+        });
+    }
+    DSlots.erase(DSlots.begin(), DSlots.upper_bound(cycle));
+    DCurrentCycle = cycle + 1;
+    DCyclesAdvanced++;
+    return true;
+}
+
+/**
+* Prints the stall statistics to the debug log.
+*
+* @return void
+*
+*/
+
+void CLockstepScheduler::PrintStatistics() const{
+    PrintDebug(DEBUG_LOW, "Lockstep: delay %d, %d cycles, %d stalls over %d frames, %.1f ms stalled (max %.1f ms)\n", DInputDelay, DCyclesAdvanced, DStallCount, DStalledFrames, DStallTime * 1000.0, DMaxStall * 1000.0);
+}
@@ -231,7 +231,7 @@ void CLogInOptionsMode::InitializeChange(std::shared_ptr< CApplicationData > con
     DEditText.push_back("");
 	// Connect via Multiplayer Server IP Address
 
-    context->DMultiplayerClient.reset(new CMultiplayerClient(context, std::string("104.236.151.124"), std::string("55107")));
+    context->DMultiplayerClient.reset(new CMultiplayerClient(context, context->DServerAddress, context->DServerPort));
 	context->DMultiplayerClient->start_client_thread();
 }
 
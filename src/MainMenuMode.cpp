@@ -54,6 +54,8 @@
 #include "MapSelectionMode.h"
 #include "ApplicationData.h"
 #include "MemoryDataSource.h"
+#include "AutoSave.h"
+#include "SavedGame.h"
 #include "FileDataContainer.h"
 #include "Tokenizer.h"
 #include <iostream>
@@ -143,7 +145,8 @@ void CMainMenuMode::OptionsButtonCallback(std::shared_ptr< CApplicationData > co
 }
 
 /**
-* When the "Load" button is pressed, loads the saved game from SavedGame.txt.
+* When the "Load" button is pressed, loads the newer of SavedGame.sav and the
+* autosave, or SavedGame.txt if there is neither.
 *
 * @param[in] context The data for the game's current state.
 *
@@ -153,14 +156,33 @@ void CMainMenuMode::OptionsButtonCallback(std::shared_ptr< CApplicationData > co
 
 void CMainMenuMode::LoadButtonCallback(std::shared_ptr< CApplicationData > context){
     std::shared_ptr< CDirectoryDataContainer > CurrDir = std::make_shared< CDirectoryDataContainer > (".");
-    std::shared_ptr< CDataSource > source = CurrDir->DataSource("SavedGame.txt");
+    std::string FileName = CSavedGame::NewestFile({SAVED_GAME_FILENAME, AUTO_SAVE_FILENAME});
+    std::shared_ptr< CDataSource > source = CurrDir->DataSource(FileName.empty() ? SAVED_GAME_TEXT_FILENAME : FileName);
+
+    if(CSavedGame::Load(context, source)){
+        context->DNextApplicationMode = CBattleMode::Instance();
+    }
+}
+
+/**
+* Loads a saved game (as written by the in game menu) into the context. Used by
+* the "Load" button and by the headless renderer.
+*
+* @param[in] context The data for the game's current state.
+* @param[in] source The saved game data.
+*
+* @return true if the saved game was loaded
+*
+*/
+
+bool CMainMenuMode::LoadSavedGame(std::shared_ptr< CApplicationData > context, std::shared_ptr< CDataSource > source){
     CCommentSkipLineDataSource LineSource(source, '#');
     std::string Value;
     std::vector< std::string > Tokens;
 
     // if save file does not exist
     if(source == nullptr){
-        return;
+        return false;
     }
 
     CApplicationData::DLoadedGame = true;
@@ -189,7 +211,7 @@ void CMainMenuMode::LoadButtonCallback(std::shared_ptr< CApplicationData > conte
     // read map, map partial bits, and map indices
     TempMap->RestoreMap(source);
 
-    // replace map, map partial bits, and map indices while keeping a backup
+    // replace map, map partial bits, and map indices until the map is reset
     CAssetDecoratedMap::ReplaceMap(TempMap, context->DSelectedMapIndex);
 
     context->DSelectedMap = CAssetDecoratedMap::DuplicateMap(context->DSelectedMapIndex, context->DLoadingPlayerColors);
@@ -376,6 +398,8 @@ void CMainMenuMode::LoadButtonCallback(std::shared_ptr< CApplicationData > conte
         LineSource.Read(Value);
         int UnitGroupSize = std::stoi(Value);
 
+        context->DGroupHotKeyMap[i].clear();
+
         for(int Index = 0; Index < UnitGroupSize; Index++){
             LineSource.Read(Value);
 
@@ -391,6 +415,24 @@ void CMainMenuMode::LoadButtonCallback(std::shared_ptr< CApplicationData > conte
     // replace visibility map
     // context->DFogRenderer->ReplaceVisibilityMap(context->DGameModel->Player(context->DPlayerColor)->VisibilityMap());
 
+    CenterViewport(context);
+
+// visibility map
+
+    return true;
+}
+
+/**
+* Centers the viewport of a loaded game on one of the player's moving units,
+* or on the first of the player's assets if none can move.
+*
+* @param[in] context The data for the game's current state.
+*
+* @return void
+*
+*/
+
+void CMainMenuMode::CenterViewport(std::shared_ptr< CApplicationData > context){
     // center viewport to a moving unit
     bool ViewportCentered = false;
     for(auto WeakAsset : context->DGameModel->Player(context->DPlayerColor)->Assets()){
@@ -413,10 +455,6 @@ void CMainMenuMode::LoadButtonCallback(std::shared_ptr< CApplicationData > conte
             }
         }
     }
-
-// visibility map
-
-    context->DNextApplicationMode = CBattleMode::Instance();
 }
 
 
@@ -142,10 +142,20 @@ void CMapSelectionMode::BackButtonCallback(std::shared_ptr< CApplicationData > c
 void CMapSelectionMode::InitializeChange(std::shared_ptr< CApplicationData > context){
     DButtonHovered = false;
     DMapOffset = 0;
+    DPreviews.clear();
 
     context->ResetPlayerColors();
-    context->DSelectedMapIndex = 0;
-    context->DSelectedMap = CAssetDecoratedMap::DuplicateMap(0,context->DLoadingPlayerColors);
+    // start on the first map that loads
+    context->DSelectedMap = nullptr;
+    for(int Index = 0; (nullptr == context->DSelectedMap) && (Index < CAssetDecoratedMap::MapCount()); Index++){
+        context->DSelectedMapIndex = Index;
+        context->DSelectedMap = CAssetDecoratedMap::DuplicateMap(Index,context->DLoadingPlayerColors);
+    }
+    if(nullptr == context->DSelectedMap){
+        PrintError("No map could be loaded.\n");
+        context->ChangeApplicationMode(CMainMenuMode::Instance());
+        return;
+    }
     context->DMapRenderer = std::make_shared< CMapRenderer >(std::make_shared< CMemoryDataSource >(context->DMapRendererConfigurationData), context->DTerrainTileset, context->DSelectedMap, context->DTreeTileset);
     context->DAssetRenderer = std::make_shared< CAssetRenderer >(context->DAssetRecolorMap, context->DAssetTilesets, context->DMarkerTileset, context->DCorpseTileset, context->DFireTilesets, context->DBuildingDeathTileset, context->DArrowTileset, nullptr, context->DSelectedMap);
     context->DMiniMapRenderer = std::make_shared< CMiniMapRenderer >(context->DMapRenderer, context->DAssetRenderer, nullptr, nullptr, context->DDoubleBufferSurface->Format() );
@@ -176,10 +186,12 @@ void CMapSelectionMode::Input(std::shared_ptr< CApplicationData > context){
             DMapOffset++;
         }
         else if(to_underlying(CListViewRenderer::EListViewObject::None) != ItemSelected){
-            if(context->DSelectedMapIndex != ItemSelected){
+            auto SelectedMap = CAssetDecoratedMap::GetMap(ItemSelected);
+
+            if((context->DSelectedMapIndex != ItemSelected) && (nullptr != SelectedMap)){
                 context->DSelectedMapIndex = ItemSelected;
 
-                *context->DSelectedMap = *CAssetDecoratedMap::GetMap(context->DSelectedMapIndex);
+                *context->DSelectedMap = *SelectedMap;
             }
         }
         else{
@@ -256,8 +268,8 @@ void CMapSelectionMode::Render(std::shared_ptr< CApplicationData > context){
     context->DMapSelectListViewSurface->Draw(context->DWorkingBufferSurface, 0, 0, ListViewWidth, ListViewHeight, context->DMapSelectListViewXOffset, context->DMapSelectListViewYOffset);
 
     std::vector< std::string > MapNames;
-    while(CAssetDecoratedMap::GetMap(MapNames.size())){
-        MapNames.push_back(CAssetDecoratedMap::GetMap(MapNames.size())->MapName());
+    while(MapNames.size() < CAssetDecoratedMap::MapCount()){
+        MapNames.push_back(CAssetDecoratedMap::GetMapName(MapNames.size()));
     }
 
 
@@ -265,9 +277,18 @@ void CMapSelectionMode::Render(std::shared_ptr< CApplicationData > context){
     context->DWorkingBufferSurface->Draw(context->DMapSelectListViewSurface, context->DMapSelectListViewXOffset, context->DMapSelectListViewYOffset, ListViewWidth, ListViewHeight, 0, 0);
     context->DInnerBevel->DrawBevel(context->DWorkingBufferSurface, context->DMapSelectListViewXOffset, context->DMapSelectListViewYOffset, ListViewWidth, ListViewHeight);
 
-    context->DMiniMapRenderer->DrawMiniMap(context->DMiniMapSurface);
+    // A map's preview is only drawn the first time the map is shown, afterwards it is copied
+    if(DPreviews.size() <= context->DSelectedMapIndex){
+        DPreviews.resize(context->DSelectedMapIndex + 1);
+    }
+    auto &Preview = DPreviews[context->DSelectedMapIndex];
+    if((nullptr == Preview)||(Preview->Width() != MiniMapWidth)||(Preview->Height() != MiniMapHeight)){
+        context->DMiniMapRenderer->DrawMiniMap(context->DMiniMapSurface);
+        Preview = CGraphicFactory::CreateSurface(MiniMapWidth, MiniMapHeight, context->DMiniMapSurface->Format());
+        Preview->Draw(context->DMiniMapSurface, 0, 0, -1, -1, 0, 0);
+    }
     MiniMapLeft = context->DMapSelectListViewXOffset + ListViewWidth + context->DInnerBevel->Width() * 4;
-    context->DWorkingBufferSurface->Draw(context->DMiniMapSurface, MiniMapLeft, context->DMapSelectListViewYOffset, -1, -1, 0, 0);
+    context->DWorkingBufferSurface->Draw(Preview, MiniMapLeft, context->DMapSelectListViewYOffset, -1, -1, 0, 0);
     context->DInnerBevel->DrawBevel(context->DWorkingBufferSurface, MiniMapLeft, context->DMapSelectListViewYOffset, MiniMapWidth, MiniMapHeight);
 
     TextTop = context->DMapSelectListViewYOffset + MiniMapHeight + context->DInnerBevel->Width() * 2;
@@ -0,0 +1,211 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CMemoryAccounting
+*
+* @brief Keeps count of the memory each subsystem of the game holds: the
+*     loaded maps, the visibility maps, the assets and their commands, the
+*     pending game events, the Lua states and the tilesets. Each subsystem
+*     reports what it allocates and frees, either object by object through
+*     the pools or as a whole through a CMemoryAccount when a map or tileset
+*     changes size.
+*     The counters are atomic so they can be updated from the loader
+*     threads.
+*
+*     Report formats the live, peak and pooled bytes of each subsystem along
+*     with the allocations per second since the previous report.
+*
+*/
+
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cstdio>
+
+CMemoryAccounting::SCounters CMemoryAccounting::DCounters[static_cast< int >(EMemorySubsystem::Max)];
+std::chrono::steady_clock::time_point CMemoryAccounting::DReportTime = std::chrono::steady_clock::now();
+
+/**
+* Gets the name of a subsystem for the report
+*
+* @param[in] subsystem The subsystem
+*
+* @return The name
+*
+*/
+
+const char *CMemoryAccounting::Name(EMemorySubsystem subsystem){
+    switch(subsystem){
+        case EMemorySubsystem::Maps:        return "maps";
+        case EMemorySubsystem::Visibility:  return "visibility";
+        case EMemorySubsystem::Assets:      return "assets";
+        case EMemorySubsystem::Events:      return "events";
+        case EMemorySubsystem::Lua:         return "lua";
+        case EMemorySubsystem::Tilesets:    return "tilesets";
+        default:                            return "unknown";
+    }
+}
+
+/**
+* Counts allocations
+*
+* @param[in] subsystem The subsystem that allocated
+* @param[in] bytes The total size of the allocations
+* @param[in] count The number of allocations
+*
+* @return void
+*
+*/
+
+void CMemoryAccounting::Allocate(EMemorySubsystem subsystem, size_t bytes, size_t count){
+    SCounters &Counters = DCounters[static_cast< int >(subsystem)];
+    int64_t LiveBytes = Counters.DLiveBytes += bytes;
+    int64_t PeakBytes = Counters.DPeakBytes;
+
+    Counters.DAllocations += count;
+    Counters.DAllocatedBytes += bytes;
+    while((PeakBytes < LiveBytes) && !Counters.DPeakBytes.compare_exchange_weak(PeakBytes, LiveBytes)){
+    }
+}
+
+/**
+* Counts a free
+*
+* @param[in] subsystem The subsystem that freed
+* @param[in] bytes The size of the allocation that was freed
+*
+* @return void
+*
+*/
+
+void CMemoryAccounting::Free(EMemorySubsystem subsystem, size_t bytes){
+    DCounters[static_cast< int >(subsystem)].DLiveBytes -= bytes;
+}
+
+/**
+* Counts memory a pool of the subsystem has reserved, pools never release
+* their chunks
+*
+* @param[in] subsystem The subsystem of the pool
+* @param[in] bytes The size of the new chunk
+*
+* @return void
+*
+*/
+
+void CMemoryAccounting::Reserve(EMemorySubsystem subsystem, size_t bytes){
+    DCounters[static_cast< int >(subsystem)].DReservedBytes += bytes;
+}
+
+/**
+* Formats the counters of every subsystem, one line each after a header
+* line. The rates are since the previous report, or since start up for the
+* first.
+*
+* @return The lines of the report
+*
+*/
+
+std::vector< std::string > CMemoryAccounting::Report(){
+    std::vector< std::string > Lines;
+    auto Now = std::chrono::steady_clock::now();
+    double Seconds = std::max(std::chrono::duration< double >(Now - DReportTime).count(), 1e-6);
+    int64_t TotalLiveBytes = 0;
+    char Buffer[128];
+
+    DReportTime = Now;
+    snprintf(Buffer, sizeof(Buffer), "%-10s %10s %10s %10s %10s %10s", "memory", "live KiB", "peak KiB", "pool KiB", "allocs/s", "KiB/s");
+    Lines.push_back(Buffer);
+    for(int Index = 0; Index < static_cast< int >(EMemorySubsystem::Max); Index++){
+        SCounters &Counters = DCounters[Index];
+        uint64_t Allocations = Counters.DAllocations;
+        uint64_t AllocatedBytes = Counters.DAllocatedBytes;
+        int64_t LiveBytes = Counters.DLiveBytes;
+
+        snprintf(Buffer, sizeof(Buffer), "%-10s %10lld %10lld %10llu %10.0f %10.1f", Name(static_cast< EMemorySubsystem >(Index)), (long long)(LiveBytes / 1024), (long long)(Counters.DPeakBytes / 1024), (unsigned long long)(Counters.DReservedBytes / 1024), (Allocations - Counters.DReportedAllocations) / Seconds, (AllocatedBytes - Counters.DReportedBytes) / 1024.0 / Seconds);
+        Lines.push_back(Buffer);
+        Counters.DReportedAllocations = Allocations;
+        Counters.DReportedBytes = AllocatedBytes;
+        TotalLiveBytes += LiveBytes;
+    }
+    snprintf(Buffer, sizeof(Buffer), "%-10s %10lld", "total", (long long)(TotalLiveBytes / 1024));
+    Lines.push_back(Buffer);
+    return Lines;
+}
+
+/**
+* @class CMemoryAccount
+*
+* @brief The bytes a map or tileset counts against its subsystem. The count
+*     is released when the account is destroyed. A copy starts empty and
+*     its owner resizes it, an assignment takes over the count of the
+*     account assigned, as the owner now holds a copy of that memory.
+*
+*/
+
+/**
+* Constructor, nothing is counted yet
+*
+* @param[in] subsystem The subsystem the bytes are counted against
+*
+*/
+
+CMemoryAccount::CMemoryAccount(EMemorySubsystem subsystem){
+    DSubsystem = subsystem;
+    DBytes = 0;
+}
+
+/**
+* Copy constructor, same subsystem with nothing counted
+*
+* @param[in] account The account copied
+*
+*/
+
+CMemoryAccount::CMemoryAccount(const CMemoryAccount &account){
+    DSubsystem = account.DSubsystem;
+    DBytes = 0;
+}
+
+/**
+* Destructor, releases the bytes counted
+*
+*/
+
+CMemoryAccount::~CMemoryAccount(){
+    CMemoryAccounting::Free(DSubsystem, DBytes);
+}
+
+/**
+* Changes the bytes counted, growing counts as an allocation of the
+* difference
+*
+* @param[in] bytes The new size
+*
+* @return void
+*
+*/
+
+void CMemoryAccount::Resize(size_t bytes){
+    if(bytes > DBytes){
+        CMemoryAccounting::Allocate(DSubsystem, bytes - DBytes);
+    }
+    else if(bytes < DBytes){
+        CMemoryAccounting::Free(DSubsystem, DBytes - bytes);
+    }
+    DBytes = bytes;
+}
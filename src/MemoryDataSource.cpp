@@ -31,6 +31,7 @@
 */
 
 #include "MemoryDataSource.h"
+#include <algorithm>
 #include <cstring>
 
 /**
@@ -69,3 +70,31 @@ int CMemoryDataSource::Read(void *data, int length){
     return length;
 }
 
+/**
+* Reads the next line straight out of the data, the new line is consumed but
+* not stored and carriage returns are dropped
+*
+* @param[out] line The line read
+*
+* @return true if a line was read
+*
+*/
+
+bool CMemoryDataSource::ReadLine(std::string &line){
+    size_t Available = DOffset < (int)DData.size() ? DData.size() - DOffset : 0;
+
+    line.clear();
+    if(!Available){
+        return false;
+    }
+    const char *Start = DData.data() + DOffset;
+    const char *NewLine = static_cast< const char * >(memchr(Start, '\n', Available));
+    size_t Length = NewLine ? NewLine - Start : Available;
+
+    line.assign(Start, Length);
+    DOffset += NewLine ? Length + 1 : Length;
+    if(std::string::npos != line.find('\r')){
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+    }
+    return (nullptr != NewLine) || line.length();
+}
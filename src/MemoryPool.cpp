@@ -0,0 +1,116 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CMemoryPool
+*
+* @brief Hands out blocks of one size from chunks of
+*     MEMORY_POOL_CHUNK_BLOCKS blocks. Freed blocks go on a free list and are
+*     handed out again before a new chunk is allocated, chunks are kept until
+*     the pool is destroyed. Every block handed out is counted against the
+*     subsystem of the pool in CMemoryAccounting.
+*
+*     The game objects that are created and destroyed all through a game,
+*     the assets, the markers and the activated capabilities, come from
+*     pools through CPoolAllocator and MakePooled, which allocate the object
+*     and its shared pointer control block as one block.
+*
+*/
+
+#include "MemoryPool.h"
+#include <algorithm>
+
+/**
+* Constructor, the first chunk is allocated on first use
+*
+* @param[in] blocksize The size of the blocks
+* @param[in] subsystem The subsystem the blocks are counted against
+*
+*/
+
+CMemoryPool::CMemoryPool(size_t blocksize, EMemorySubsystem subsystem){
+    size_t Alignment = alignof(std::max_align_t);
+
+    DSubsystem = subsystem;
+    DBlockSize = (std::max(blocksize, sizeof(void *)) + Alignment - 1) / Alignment * Alignment;
+    DFreeBlocks = nullptr;
+    DLiveBlocks = 0;
+}
+
+/**
+* Destructor, releases the chunks, every block must have been freed
+*
+*/
+
+CMemoryPool::~CMemoryPool(){
+    for(auto Chunk : DChunks){
+        ::operator delete(Chunk);
+    }
+}
+
+/**
+* Takes a block off the free list, allocating a new chunk if it is empty
+*
+* @return The block
+*
+*/
+
+void *CMemoryPool::Allocate(){
+    void *Block;
+
+    {
+        std::lock_guard< std::mutex > Lock(DMutex);
+
+        if(nullptr == DFreeBlocks){
+            char *Chunk = static_cast< char * >(::operator new(DBlockSize * MEMORY_POOL_CHUNK_BLOCKS));
+
+            for(int Index = MEMORY_POOL_CHUNK_BLOCKS - 1; 0 <= Index; Index--){
+                void *NewBlock = Chunk + Index * DBlockSize;
+
+                *static_cast< void ** >(NewBlock) = DFreeBlocks;
+                DFreeBlocks = NewBlock;
+            }
+            DChunks.push_back(Chunk);
+            CMemoryAccounting::Reserve(DSubsystem, DBlockSize * MEMORY_POOL_CHUNK_BLOCKS);
+        }
+        Block = DFreeBlocks;
+        DFreeBlocks = *static_cast< void ** >(Block);
+        DLiveBlocks++;
+    }
+    CMemoryAccounting::Allocate(DSubsystem, DBlockSize);
+    return Block;
+}
+
+/**
+* Puts a block back on the free list
+*
+* @param[in] block The block, from Allocate of this pool
+*
+* @return void
+*
+*/
+
+void CMemoryPool::Free(void *block){
+    {
+        std::lock_guard< std::mutex > Lock(DMutex);
+
+        *static_cast< void ** >(block) = DFreeBlocks;
+        DFreeBlocks = block;
+        DLiveBlocks--;
+    }
+    CMemoryAccounting::Free(DSubsystem, DBlockSize);
+}
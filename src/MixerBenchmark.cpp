@@ -0,0 +1,430 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included
+    that were extracted from original Warcraft II by Blizzard Entertainment
+    were found freely available via internet sources and have been labeld as
+    abandonware. They have been included in this distribution for educational
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CMixerBenchmark
+*
+* @brief Measures the cost of the sound mixer without an audio device. The
+*     sound library is loaded into an offline CSoundLibraryMixer, a script of
+*     clip and tone bursts is played, and every buffer is rendered by calling
+*     the mixer directly in a loop. The time each buffer takes is reported
+*     against the real time budget of the buffer, and the output can be
+*     written as a WAV file to check the mix by ear or by diffing.
+*
+*     Started with "--mixer-benchmark", see PrintUsage for the other options.
+*
+*/
+
+#include "MixerBenchmark.h"
+#include "ApplicationPath.h"
+#include "AssetArchive.h"
+#include "CommentSkipLineDataSource.h"
+#include "FileDataContainer.h"
+#include "FileDataSink.h"
+#include "Tokenizer.h"
+#include "Debug.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+
+#define DEFAULT_BURST_INTERVAL_MS   500
+#define DEFAULT_BURST_CLIPS         24
+#define DEFAULT_TONE_INTERVAL_MS    1000
+#define DEFAULT_BURST_TONES         4
+#define DEFAULT_STORM_CLIPS         96
+
+/**
+* Loading callback for the sound library, nothing to show while loading.
+*
+* @param[in] calldata Unused
+*
+* @return void
+*
+*/
+
+static void MixerBenchmarkLoadingCallback(TSoundLibraryLoadingCalldata calldata){
+
+}
+
+/**
+* Constructor, stores the options.
+*
+* @param[in] options The parsed benchmark options
+*
+*/
+
+CMixerBenchmark::CMixerBenchmark(const SOptions &options){
+    DOptions = options;
+    DClipRotation = 0;
+}
+
+/**
+* Parses the command line for the mixer benchmark options. The benchmark is
+* only enabled if "--mixer-benchmark" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the mixer benchmark was requested
+*
+*/
+
+bool CMixerBenchmark::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--mixer-benchmark" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--data" == Argument){
+            options.DDataPath = Value;
+        }
+        else if("--script" == Argument){
+            options.DScriptPath = Value;
+        }
+        else if("--wav" == Argument){
+            options.DWavePath = Value;
+        }
+        else if("--timings" == Argument){
+            options.DTimingsPath = Value;
+        }
+        else if("--song" == Argument){
+            options.DSongName = Value;
+        }
+        else if("--seconds" == Argument){
+            options.DSeconds = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--voices" == Argument){
+            options.DVoiceLimit = std::max(1, std::atoi(Value.c_str()));
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown mixer benchmark option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the mixer benchmark options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CMixerBenchmark::PrintUsage(const char *program){
+    PrintError("Usage: %s --mixer-benchmark [options]\n", program);
+    PrintError("  --data DIR        data directory (default: data next to the executable)\n");
+    PrintError("  --seconds N       seconds of audio to render (default: 30)\n");
+    PrintError("  --script FILE     events to play, one \"MS clip NAME [COUNT]\", \"MS tone HZ [COUNT]\",\n");
+    PrintError("                    \"MS song NAME\" or \"MS stop\" per line (default: clip and tone bursts)\n");
+    PrintError("  --sound-cache DIR decoded clip cache, created on first use (default: no cache)\n");
+    PrintError("  --song NAME       play a song under the script (default: no music)\n");
+    PrintError("  --voices N        clip voice limit (default: the mixer default)\n");
+    PrintError("  --wav FILE        write the rendered output as a 16 bit stereo WAV file\n");
+    PrintError("  --timings FILE    write per buffer timings as CSV\n");
+}
+
+/**
+* Loads the sound library into an offline mixer, plays the script while
+* rendering buffer after buffer, then reports the timings.
+*
+* @return 0 on success, 1 on failure
+*
+*/
+
+int CMixerBenchmark::Run(){
+    std::string DataPath = DOptions.DDataPath;
+    std::vector< float > Buffer;
+    size_t NextEvent = 0;
+    int FramesPerBuffer = CSoundLibraryMixer::FramesPerBuffer();
+    int TotalBuffers;
+
+    if(DataPath.empty()){
+        DataPath = GetApplicationPath().Containing().ToString() + "/data";
+    }
+    std::shared_ptr< CDataContainer > DataContainer = CAssetArchiveDataContainer::OpenDataDirectory(DataPath);
+    std::shared_ptr< CDataSource > LibrarySource = DataContainer->DataSource("./snd/SoundClips.dat");
+
+    if(nullptr == LibrarySource){
+        PrintError("Failed to find snd/SoundClips.dat in %s.\n", DataPath.c_str());
+        return 1;
+    }
+    DMixer = std::make_shared< CSoundLibraryMixer >(false, true);
+    if(!DOptions.DCachePath.empty()){
+        mkdir(DOptions.DCachePath.c_str(), S_IRWXU);
+        DMixer->PCMCache(std::make_shared< CDirectoryDataContainer >(DOptions.DCachePath));
+    }
+
+    auto LoadStart = std::chrono::steady_clock::now();
+    if(!DMixer->LoadLibrary(LibrarySource, MixerBenchmarkLoadingCallback, nullptr)){
+        PrintError("Failed to load sound library.\n");
+        return 1;
+    }
+    auto LoadEnd = std::chrono::steady_clock::now();
+    printf("Loaded %d clips in %.1f ms\n", DMixer->ClipCount(), std::chrono::duration< double, std::milli >(LoadEnd - LoadStart).count());
+
+    DMixer->StopSong();
+    if(!DOptions.DSongName.empty()){
+        DMixer->PlaySong(DMixer->FindSong(DOptions.DSongName), 0.5);
+    }
+    if(DOptions.DVoiceLimit){
+        DMixer->MaxClipVoices(DOptions.DVoiceLimit);
+    }
+    if(!LoadScript()){
+        return 1;
+    }
+    DMixer->CaptureOffline(!DOptions.DWavePath.empty());
+
+    TotalBuffers = ((long long)DOptions.DSeconds * DMixer->SampleRate()) / FramesPerBuffer;
+    Buffer.resize(FramesPerBuffer * 2);
+    DTimings.reserve(TotalBuffers);
+    for(int Index = 0; Index < TotalBuffers; Index++){
+        double Now = (Index * (double)FramesPerBuffer * 1000.0) / DMixer->SampleRate();
+        SBufferTiming Timing;
+
+        while((NextEvent < DScript.size()) && (DScript[NextEvent].DTime <= Now)){
+            TriggerEvent(DScript[NextEvent++]);
+        }
+        DMixer->SyncOffline(FramesPerBuffer);
+
+        auto MixStart = std::chrono::steady_clock::now();
+        DMixer->RenderOffline(Buffer.data(), FramesPerBuffer);
+        auto MixEnd = std::chrono::steady_clock::now();
+
+        Timing.DMicroseconds = std::chrono::duration< double, std::micro >(MixEnd - MixStart).count();
+        Timing.DClipVoices = DMixer->ActiveClipVoices();
+        Timing.DToneVoices = DMixer->ActiveToneVoices();
+        DTimings.push_back(Timing);
+    }
+    if(!DOptions.DWavePath.empty()){
+        if(!DMixer->WriteCapture(std::make_shared< CFileDataSink >(DOptions.DWavePath))){
+            PrintError("Failed to write %s.\n", DOptions.DWavePath.c_str());
+            return 1;
+        }
+    }
+    WriteTimings();
+    PrintSummary();
+    return 0;
+}
+
+/**
+* Loads the event script if one was given, otherwise builds the default one.
+*
+* @return true if the script was loaded
+*
+*/
+
+bool CMixerBenchmark::LoadScript(){
+    if(DOptions.DScriptPath.empty()){
+        DefaultScript();
+        return true;
+    }
+    std::shared_ptr< CDirectoryDataContainer > CurrDir = std::make_shared< CDirectoryDataContainer > (".");
+    std::shared_ptr< CDataSource > Source = CurrDir->DataSource(DOptions.DScriptPath);
+    std::string TempString;
+    std::vector< std::string > Tokens;
+
+    if(nullptr == Source){
+        PrintError("Failed to open mixer script %s.\n", DOptions.DScriptPath.c_str());
+        return false;
+    }
+    CCommentSkipLineDataSource LineSource(Source, '#');
+    while(LineSource.Read(TempString)){
+        SScriptEvent Event;
+
+        CTokenizer::Tokenize(Tokens, TempString);
+        if(2 > Tokens.size()){
+            continue;
+        }
+        try{
+            Event.DTime = std::stod(Tokens[0]);
+            Event.DFrequency = 0.0;
+            Event.DCount = 1;
+            if("clip" == Tokens[1]){
+                Event.DType = EEventType::Clip;
+                Event.DName = 2 < Tokens.size() ? Tokens[2] : "";
+                Event.DCount = 3 < Tokens.size() ? std::stoi(Tokens[3]) : 1;
+            }
+            else if("tone" == Tokens[1]){
+                Event.DType = EEventType::Tone;
+                Event.DFrequency = 2 < Tokens.size() ? std::stof(Tokens[2]) : 440.0;
+                Event.DCount = 3 < Tokens.size() ? std::stoi(Tokens[3]) : 1;
+            }
+            else if("song" == Tokens[1]){
+                Event.DType = EEventType::Song;
+                Event.DName = 2 < Tokens.size() ? Tokens[2] : "";
+            }
+            else if("stop" == Tokens[1]){
+                Event.DType = EEventType::Stop;
+            }
+            else{
+                PrintError("Unknown mixer script event %s.\n", Tokens[1].c_str());
+                return false;
+            }
+        }
+        catch(std::exception &E){
+            PrintError("Invalid mixer script line \"%s\": %s\n", TempString.c_str(), E.what());
+            return false;
+        }
+        DScript.push_back(Event);
+    }
+    std::stable_sort(DScript.begin(), DScript.end(), [](const SScriptEvent &first, const SScriptEvent &second){
+        return first.DTime < second.DTime;
+    });
+    return true;
+}
+
+/**
+* Builds the default script, regular bursts of clips cycling through the
+* library, a few tones every second, and one storm in the middle that plays
+* more clips than there are voices so voice stealing is measured too.
+*
+* @return void
+*
+*/
+
+void CMixerBenchmark::DefaultScript(){
+    double Duration = DOptions.DSeconds * 1000.0;
+
+    for(double Time = 0.0; Time < Duration; Time += DEFAULT_BURST_INTERVAL_MS){
+        SScriptEvent Event;
+
+        Event.DTime = Time;
+        Event.DType = EEventType::Clip;
+        Event.DFrequency = 0.0;
+        Event.DCount = DEFAULT_BURST_CLIPS;
+        DScript.push_back(Event);
+        if(0.0 == std::fmod(Time, DEFAULT_TONE_INTERVAL_MS)){
+            Event.DType = EEventType::Tone;
+            Event.DFrequency = 220.0 + std::fmod(Time / 10.0, 660.0);
+            Event.DCount = DEFAULT_BURST_TONES;
+            DScript.push_back(Event);
+        }
+        if((Time < Duration / 2) && (Time + DEFAULT_BURST_INTERVAL_MS >= Duration / 2)){
+            Event.DType = EEventType::Clip;
+            Event.DFrequency = 0.0;
+            Event.DCount = DEFAULT_STORM_CLIPS;
+            DScript.push_back(Event);
+        }
+    }
+}
+
+/**
+* Plays one script event. Clip events without a name cycle through the whole
+* library with varying priority and bias.
+*
+* @param[in] event The event to play
+*
+* @return void
+*
+*/
+
+void CMixerBenchmark::TriggerEvent(const SScriptEvent &event){
+    switch(event.DType){
+        case EEventType::Clip:  for(int Index = 0; Index < event.DCount; Index++){
+                                    int ClipIndex = event.DName.empty() ? (DClipRotation++ % std::max(1, DMixer->ClipCount())) : DMixer->FindClip(event.DName);
+                                    ESoundPriority Priority = (ESoundPriority)(Index % ((int)ESoundPriority::Interface + 1));
+                                    float RightBias = ((Index % 9) - 4) / 4.0;
+
+                                    DMixer->PlayClip(ClipIndex, 0.5, RightBias, Priority, Index);
+                                }
+                                break;
+        case EEventType::Tone:  for(int Index = 0; Index < event.DCount; Index++){
+                                    float Frequency = event.DFrequency * (Index + 1);
+
+                                    DMixer->PlayTone(Frequency, -Frequency / 2.0, 0.3, -0.3, ((Index % 3) - 1) / 2.0, 0.0);
+                                }
+                                break;
+        case EEventType::Song:  DMixer->PlaySong(DMixer->FindSong(event.DName), 0.5);
+                                break;
+        case EEventType::Stop:  DMixer->StopSong();
+                                break;
+        default:                break;
+    }
+}
+
+/**
+* Writes the per buffer timings as CSV if a timings file was requested.
+*
+* @return void
+*
+*/
+
+void CMixerBenchmark::WriteTimings() const{
+    if(DOptions.DTimingsPath.empty()){
+        return;
+    }
+    std::ofstream Output(DOptions.DTimingsPath);
+
+    Output<<"buffer,mix_us,clip_voices,tone_voices"<<std::endl;
+    for(size_t Index = 0; Index < DTimings.size(); Index++){
+        const SBufferTiming &Timing = DTimings[Index];
+
+        Output<<Index<<","<<Timing.DMicroseconds<<","<<Timing.DClipVoices<<","<<Timing.DToneVoices<<std::endl;
+    }
+}
+
+/**
+* Prints the mean, median, 99th percentile and worst buffer time against the
+* time budget of a buffer, and the most voices that were mixed at once.
+*
+* @return void
+*
+*/
+
+void CMixerBenchmark::PrintSummary() const{
+    std::vector< double > Sorted;
+    double Total = 0.0;
+    double Budget = (CSoundLibraryMixer::FramesPerBuffer() * 1000000.0) / DMixer->SampleRate();
+    int PeakClips = 0, PeakTones = 0;
+
+    if(DTimings.empty()){
+        return;
+    }
+    for(auto &Timing : DTimings){
+        Sorted.push_back(Timing.DMicroseconds);
+        Total += Timing.DMicroseconds;
+        PeakClips = std::max(PeakClips, Timing.DClipVoices);
+        PeakTones = std::max(PeakTones, Timing.DToneVoices);
+    }
+    std::sort(Sorted.begin(), Sorted.end());
+    printf("%d buffers of %d frames at %dHz, budget %.1f us per buffer\n", (int)DTimings.size(), CSoundLibraryMixer::FramesPerBuffer(), DMixer->SampleRate(), Budget);
+    printf("%-10s %10s %10s %10s %10s\n", "(us)", "mean", "p50", "p99", "max");
+    printf("%-10s %10.1f %10.1f %10.1f %10.1f\n", "mix", Total / Sorted.size(), Sorted[Sorted.size() / 2], Sorted[(Sorted.size() * 99) / 100], Sorted.back());
+    printf("Worst callback used %.1f%% of its budget\n", (Sorted.back() * 100.0) / Budget);
+    printf("Peak voices: %d clips, %d tones\n", PeakClips, PeakTones);
+    if(!DOptions.DWavePath.empty()){
+        printf("Wrote %d frames to %s\n", DMixer->CapturedFrames(), DOptions.DWavePath.c_str());
+    }
+}
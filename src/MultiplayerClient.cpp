@@ -2,6 +2,8 @@
 #include <deque>
 #include <iostream>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <fstream>
 #include "Command.hpp"
 #include <boost/asio.hpp>
@@ -56,6 +58,8 @@ void Handler::handle(std::string command, std::string expected, std::deque<std::
 CMultiplayerClient::CMultiplayerClient(std::shared_ptr<CApplicationData> context, std::string hostname, std::string port)
 	:io_service_(),
 	socket_(io_service_),
+	retry_timer_(io_service_),
+	closed_(false),
 	handler()
 {
 	
@@ -90,33 +94,31 @@ void CMultiplayerClient::CMultiplayerClient::send_message(std::string message) {
 bool CMultiplayerClient::login( std::function<void(bool)> function, std::string username, std::string password) {
 	std::string login = std::string("LOGIN ") + username + " " + password;
 
-	bool result;
+	std::string msg;
 	send_message(login);
-	;
-	while(inqueue.empty()){std::this_thread::sleep_for(std::chrono::milliseconds(50));}
-	auto msg = inqueue.front();
+	if(!wait_message(msg)) return false;
 	auto code = msg.substr(0,msg.find(" "));
-	inqueue.pop_front();
 	if(code.compare("WELCOM") == 0){
 		handler.handle(function, true);
+		return true;
 	}
 	else if(code.compare("BADATH") == 0)
 		handler.handle(function, false);
-
+	return false;
 }
 
 bool CMultiplayerClient::joinGame(std::function<void(bool)> function, int ID, std::string password) {
 	std::string joinRequest = std::string("JGAME ") + std::to_string(ID) + " " + password;
+	std::string msg;
 	send_message(joinRequest);
-	while(inqueue.empty()){std::this_thread::sleep_for(std::chrono::milliseconds(50));}
-	auto msg = inqueue.front();
+	if(!wait_message(msg)) return false;
 	auto code = msg.substr(0,msg.find(" "));
-	inqueue.pop_front();
-	if(code.compare("INGAME") == 0)
+	if(code.compare("INGAME") == 0){
 		handler.handle(function, true);
-	else if(code.compare("NOJOIN") == 0)
-		return false;
+		return true;
+	}
 	//TODO add appropriate Error handline for NOEXIS, BADPAS, and FULL	
+	return false;
 }
 
 bool CMultiplayerClient::hostGame(std::function<void(bool)> function, std::string map, int numPlayers, std::string password, int isPrivate, std::string name) {
@@ -127,33 +129,35 @@ bool CMultiplayerClient::hostGame(std::function<void(bool)> function, std::strin
 	hostRequest.add(std::to_string(isPrivate));
 	hostRequest.add(name);
 	// std::cout << hostRequest.toString() << std::endl;
+	std::string msg;
 	send_message(hostRequest.toString());
-	while(inqueue.empty()){std::this_thread::sleep_for(std::chrono::milliseconds(50));}
-	auto msg = inqueue.front();
+	if(!wait_message(msg)) return false;
 	auto code = msg.substr(0,msg.find(" "));
-	inqueue.pop_front();
-	if(code.compare("INHOST") == 0)
+	if(code.compare("INHOST") == 0){
 		handler.handle(function, true);
+		return true;
+	}
 	else if(code.compare("NOHOST") == 0)
 		handler.handle(function, false);
+	return false;
 }
 
 
 std::vector<std::string> CMultiplayerClient::getInfo() {
 	std::string infoRequest = "MYINFO";
+	std::string msg;
 	send_message(infoRequest);
-	while(inqueue.empty()){std::this_thread::sleep_for(std::chrono::milliseconds(50));}
-	auto msg = inqueue.front();
+	if(!wait_message(msg)) return std::vector<std::string>();
 
 	Command cmd(msg,true);
 	std::vector<std::string> info = cmd.split(msg);
 
 	auto code = msg.substr(0,msg.find(" "));
-	inqueue.pop_front();
 
 	if(code.compare("YRINFO") == 0) {
 		return info;
 	}
+	return std::vector<std::string>();
 }
 
 void CMultiplayerClient::logout(std::function<void(bool)> function) {
@@ -164,17 +168,25 @@ void CMultiplayerClient::logout(std::function<void(bool)> function) {
 
 std::string CMultiplayerClient::getCommand() {
 	//TODO add parsing and handlind based on Linux Version Protocol
-	if(inqueue.empty()) return std::string("");
-	// std::cout << inqueue.size();
-	auto commandStr = inqueue.front();
-	auto code = commandStr.substr(0,7);
-	if(code.compare("COMMAND") != 0) return std::string("");
-	Command command(commandStr,true);
-	auto outstr = command.arg();
-	while(command.next()){
-		outstr += command.arg();	
+	auto front = inqueue.Front();
+	if(!front) return std::string("");
+	if(front->compare(0,7,"COMMAND") != 0) return std::string("");
+	std::string outstr;
+	// the view parses the queued line in place, only escaped text frames
+	// need the copying Command parser
+	if(view_.parse(*front) && !view_.needsUnescape()){
+		for(std::size_t i = 0; i < view_.numArgs(); i++){
+			view_.arg(i).appendTo(outstr);
+		}
 	}
-	inqueue.pop_front();
+	else{
+		Command command(*front,true);
+		outstr = command.arg();
+		while(command.next()){
+			outstr += command.arg();	
+		}
+	}
+	inqueue.Pop();
 
 	return outstr;
 }
@@ -192,29 +204,32 @@ void CMultiplayerClient::sendCommand(std::string input){
 	send_message(command.toString());
 }
 
+void CMultiplayerClient::sendCommandFrame(const std::string &frame){
+	send_message(std::string("COMMAND ") + frame);
+}
+
 std::string CMultiplayerClient::getMap() {
 	//TODO add parsing and handlind based on Linux Version Protocol
-	if(inqueue.empty()) return std::string("");
-	auto commandStr = inqueue.front();
+	auto front = inqueue.Front();
+	if(!front) return std::string("");
+	auto commandStr = *front;
 	Command command(commandStr,true);
 	auto outstr = command.arg();
-	if(inqueue.empty()) return outstr;
 
 	while(command.next()){
 		outstr += command.arg();	
 	}
-	inqueue.pop_front();
+	inqueue.Pop();
 	// std::cout << "'" << outstr << "'";
 	return outstr;
 }
 
 void CMultiplayerClient::getGameInfo(){
 	auto listGames = std::string("LGAMES");
+	std::string msg;
 	send_message(listGames);
-	while(inqueue.empty()){std::this_thread::sleep_for(std::chrono::milliseconds(50));}
-	auto msg = inqueue.front();
+	if(!wait_message(msg)) return;
 	auto code = msg.substr(0,6);
-	inqueue.pop_front();
 	std::string tmp;
 	Command command(msg, true);
 	//std::cout << "# rows = " << command.rows() << std::endl;
@@ -231,22 +246,25 @@ void CMultiplayerClient::getGameInfo(){
 }
 
 void CMultiplayerClient::getJoinedPlayerInfo(){
-	if(inqueue.empty()) return;
-	auto msg = inqueue.front();
-	auto code = msg.substr(0,msg.find(" "));
-	if(code.compare("PLYINF") == 0){
-		inqueue.pop_front();
-		Command command(msg, true);
-		players.emplace_back(command.arg());
+	auto front = inqueue.Front();
+	if(!front) return;
+	if(CommandView::verb(*front).equals("PLYINF")){
+		if(view_.parse(*front) && !view_.needsUnescape()){
+			if(view_.numArgs()) players.emplace_back(view_.arg(0).str());
+		}
+		else{
+			Command command(*front, true);
+			players.emplace_back(command.arg());
+		}
+		inqueue.Pop();
 	} 
 }
 
 void CMultiplayerClient::getPlayerInfo(){
 	auto listPlayers = std::string("GETINF");
+	std::string msg;
 	send_message(listPlayers);
-	while(inqueue.empty()){std::this_thread::sleep_for(std::chrono::milliseconds(50));}
-	auto msg = inqueue.front();
-	inqueue.pop_front();
+	if(!wait_message(msg)) return;
 	std::string tmp;
 	Command command(msg, true);
 	auto code = msg.substr(0,5);
@@ -316,11 +334,10 @@ void CMultiplayerClient::sendQuit(){
 }
 
 void CMultiplayerClient::getQuit() {
-	if(inqueue.empty()) return;
-	auto quit = inqueue.front();
-	auto code = quit.substr(0,quit.find(" "));
-	if(code.compare("LEAVE") == 0){
-		inqueue.pop_front();
+	auto front = inqueue.Front();
+	if(!front) return;
+	if(CommandView::verb(*front).equals("LEAVE")){
+		inqueue.Pop();
 		getPlayerInfo();
 //		std::cout << quit << "---pop front\n" ;
 //		Command command(quit, true);
@@ -332,21 +349,20 @@ void CMultiplayerClient::getQuit() {
 }
 
 void CMultiplayerClient::getChat(std::list<std::string> &messages,int &start){
-	if(inqueue.empty()) return;
-	auto chat = inqueue.front();
-	auto code = chat.substr(0,chat.find(" "));;
-	if(code.compare("CHAT") == 0){
-		inqueue.pop_front();
-
-		messages.push_back(chat.substr(chat.find(" ")));
+	auto front = inqueue.Front();
+	if(!front) return;
+	auto code = CommandView::verb(*front);
+	if(code.equals("CHAT")){
+		messages.push_back(front->substr(code.size));
+		inqueue.Pop();
 	} 
 
-	else if(code.compare("ISRDY") == 0 || code.compare("UNRDY") == 0) {
-		inqueue.pop_front();
+	else if(code.equals("ISRDY") || code.equals("UNRDY")) {
+		inqueue.Pop();
 	}
 
-	else if(code.compare("GSTART") == 0){
-		inqueue.pop_front();
+	else if(code.equals("GSTART")){
+		inqueue.Pop();
 		start = 1;
 	}
 
@@ -354,8 +370,82 @@ void CMultiplayerClient::getChat(std::list<std::string> &messages,int &start){
 
 void CMultiplayerClient::CMultiplayerClient::close()
 {
-	io_service_.post([this]() { socket_.close(); });
+	io_service_.post([this]() { retry_timer_.cancel(); socket_.close(); });
 	service_thread.join();
+	mark_closed();
+}
+
+/*
+ * Waits for the next line from the server. The io_service thread notifies
+ * as soon as it queues a line, so there is no polling delay.
+ *
+ * @param[out] msg The line that was received
+ *
+ * @return false if the connection closed before a line arrived
+ *
+ */
+
+bool CMultiplayerClient::wait_message(std::string &msg)
+{
+	std::unique_lock<std::mutex> lock(inmutex);
+	incondition.wait(lock, [this](){ return !inqueue.Empty() || closed_; });
+	return inqueue.Pop(msg);
+}
+
+/*
+ * Wakes the game thread if it is waiting for a line. The mutex is taken so
+ * the notification can not slip in between the waiter checking the queue
+ * and going to sleep.
+ */
+
+void CMultiplayerClient::notify_waiting()
+{
+	{
+		std::lock_guard<std::mutex> lock(inmutex);
+	}
+	incondition.notify_all();
+}
+
+/*
+ * Marks the connection as closed and wakes any waiting request.
+ */
+
+void CMultiplayerClient::mark_closed()
+{
+	closed_ = true;
+	notify_waiting();
+}
+
+/*
+ * Hands the line at the start of inbuf to the game thread. It is copied
+ * straight into its queue slot, the slot strings keep their capacity so
+ * this does not allocate once they have grown. If the queue is full the
+ * game thread has fallen behind, so reading from the socket pauses and
+ * the line stays in inbuf until it is retried shortly.
+ *
+ * @param[in] length The length of the line including the newline
+ *
+ */
+
+void CMultiplayerClient::deliver(std::size_t length)
+{
+	std::string *slot = inqueue.BeginPush();
+	if(!slot){
+		retry_timer_.expires_from_now(boost::posix_time::milliseconds(MESSAGE_RETRY_INTERVAL));
+		retry_timer_.async_wait([this, length](boost::system::error_code ec)
+				{
+				if (!ec)
+				{
+				deliver(length);
+				}
+				});
+		return;
+	}
+	slot->assign(boost::asio::buffer_cast<const char*>(inbuf.data()), length - 1);
+	inqueue.EndPush();
+	inbuf.consume(length);
+	notify_waiting();
+	do_read();
 }
 
 void CMultiplayerClient::do_connect(tcp::resolver::iterator endpoint_iterator)
@@ -370,37 +460,39 @@ void CMultiplayerClient::do_connect(tcp::resolver::iterator endpoint_iterator)
 
 			do_read();
 			}
+			else
+			{
+			mark_closed();
+			}
 			});
 }
 
 void CMultiplayerClient::do_read()
 {
 	boost::asio::async_read_until(socket_,inbuf,'\n',
-			[this](boost::system::error_code ec, std::size_t /*length*/)
+			[this](boost::system::error_code ec, std::size_t length)
 			{
 			if (!ec)
 			{
-			do_read_line();
+			do_read_line(length);
 			}
 			else
 			{
+			if (ec != boost::asio::error::operation_aborted)
 			std::cout << "ERROR " << ec << std::endl ;
 			socket_.close();
+			mark_closed();
 			}
 			});
 }
 
 //reads body of sent message, pushes to queue of actions to handle
-void CMultiplayerClient::do_read_line()
+void CMultiplayerClient::do_read_line(std::size_t length)
 {
 	//if(history.size() == HISTORY_SIZE ) history.pop_back();
-	std::string line;
-	std::istream in(&inbuf);
-	std::getline(in, line);
 	//history.push_front(line);
-	inqueue.push_front(std::string(line));
 	// std::cout << line << std::endl;
-	do_read();
+	deliver(length);
 }
 
 void CMultiplayerClient::CMultiplayerClient::write(const std::string msg)
@@ -418,7 +510,8 @@ void CMultiplayerClient::CMultiplayerClient::write(const std::string msg)
 }
 
 void CMultiplayerClient::do_write(){
-	std::string msg = outqueue.back();
+	// the front stays in outqueue until written, so the buffer stays valid
+	const std::string &msg = outqueue.front();
 	boost::asio::async_write(socket_,boost::asio::buffer(msg),
 			[this](boost::system::error_code ec, std::size_t /*length*/)
 			{
@@ -433,6 +526,7 @@ void CMultiplayerClient::do_write(){
 			else
 			{
 			socket_.close();
+			mark_closed();
 			}
 			});
 }
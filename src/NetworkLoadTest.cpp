@@ -0,0 +1,525 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CNetworkLoadTest
+*
+* @brief Runs a CGameServer on the loopback interface and a number of
+*     simulated players against it, each a real CMultiplayerClient on its
+*     own thread. The players log in, host or join a game in groups of
+*     --players, get ready and start, then play a scripted lockstep match:
+*     every tick each player may give a random command, sends its frames
+*     through the lockstep scheduler, sends chat lines at the given rate and
+*     takes everything it received off the client's queue.
+*
+*     Reported are the server's message throughput, the latency of commands
+*     and chat lines from the sender's call to the receiver taking them off
+*     its queue, the depth of the client queues and of the server's output
+*     queues, and the lockstep stalls. Players of a match join one after the
+*     other, CMultiplayerClient can not tell a join notice from the reply it
+*     is waiting for.
+*
+*     Started with "--network-load-test", see PrintUsage for the other
+*     options.
+*
+*/
+
+#include "NetworkLoadTest.h"
+#include "MultiplayerClient.hpp"
+#include "Debug.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <random>
+#include <thread>
+
+#define NETWORK_LOAD_COMMAND_ODDS   4
+#define NETWORK_LOAD_MAP_PIXELS     4096
+
+/**
+* Constructor, stores the options.
+*
+* @param[in] options The parsed load test options
+*
+*/
+
+CNetworkLoadTest::CNetworkLoadTest(const SOptions &options){
+    DOptions = options;
+    DPort = 0;
+    DFailures = 0;
+    DStalls = 0;
+    DStalledFrames = 0;
+    DMaxStall = 0.0;
+    DPeakClientQueue = 0;
+    DClientQueueTotal = 0.0;
+    DClientQueueSamples = 0;
+}
+
+/**
+* Parses the command line for the load test options. The load test is only
+* enabled if "--network-load-test" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the load test was requested
+*
+*/
+
+bool CNetworkLoadTest::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--network-load-test" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--clients" == Argument){
+            options.DClients = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--players" == Argument){
+            options.DPlayers = std::max(1, std::min(std::atoi(Value.c_str()), to_underlying(EPlayerColor::Max) - 1));
+        }
+        else if("--cycles" == Argument){
+            options.DCycles = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--tick" == Argument){
+            options.DTick = std::max(0, std::atoi(Value.c_str()));
+        }
+        else if("--delay" == Argument){
+            options.DDelay = std::max(0, std::min(std::atoi(Value.c_str()), MAX_LOCKSTEP_INPUT_DELAY));
+        }
+        else if("--chat" == Argument){
+            options.DChatPercent = std::max(0, std::min(std::atoi(Value.c_str()), 100));
+        }
+        else if("--timeout" == Argument){
+            options.DTimeout = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--record" == Argument){
+            options.DRecordPath = Value;
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown network load test option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the load test options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CNetworkLoadTest::PrintUsage(const char *program){
+    PrintError("Usage: %s --network-load-test [options]\n", program);
+    PrintError("  --clients N       simulated players (default: 8)\n");
+    PrintError("  --players N       players per match (default: 2)\n");
+    PrintError("  --cycles N        game cycles per match (default: 500)\n");
+    PrintError("  --tick MS         milliseconds per tick, 0 runs as fast as possible (default: 10)\n");
+    PrintError("  --delay N         lockstep input delay in cycles (default: %d)\n", DEFAULT_LOCKSTEP_INPUT_DELAY);
+    PrintError("  --chat PERCENT    chance to send a chat line each tick (default: 5)\n");
+    PrintError("  --timeout S       seconds to wait for the other players (default: 30)\n");
+    PrintError("  --record FILE     write every line the server sends to FILE\n");
+}
+
+/**
+* Returns a monotonic time in seconds.
+*
+* @return The time
+*
+*/
+
+double CNetworkLoadTest::Now(){
+    return std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+* Builds the key a frame's send time is stored under.
+*
+* @param[in] player The sending player's color
+* @param[in] cycle The frame's cycle
+*
+* @return The key
+*
+*/
+
+int64_t CNetworkLoadTest::SendKey(int player, int cycle){
+    return ((int64_t)cycle << 8) | player;
+}
+
+/**
+* Waits until a condition on a match holds, one of its players failed or
+* the timeout passed.
+*
+* @param[in] match The match, its mutex must not be held
+* @param[in] condition Checked with the match's mutex held
+*
+* @return true if the condition holds
+*
+*/
+
+bool CNetworkLoadTest::WaitFor(SMatch &match, std::function< bool() > condition){
+    std::unique_lock< std::mutex > Lock(match.DMutex);
+
+    return match.DCondition.wait_for(Lock, std::chrono::seconds(DOptions.DTimeout), [&match, &condition](){ return match.DFailed || condition(); }) && !match.DFailed;
+}
+
+/**
+* Looks up when a frame or chat line was sent.
+*
+* @param[in] match The match it was sent in
+* @param[in] key The frame or chat key
+* @param[in] chat true for a chat line, false for a frame
+*
+* @return The seconds since it was sent, negative if it is unknown
+*
+*/
+
+double CNetworkLoadTest::Latency(SMatch &match, int64_t key, bool chat){
+    std::lock_guard< std::mutex > Lock(match.DMutex);
+    auto &Times = chat ? match.DChatTimes : match.DSendTimes;
+    auto Sent = Times.find(key);
+
+    return Times.end() == Sent ? -1.0 : Now() - Sent->second;
+}
+
+/**
+* Plays one simulated player from login to the end of its match.
+*
+* @param[in] matchIndex The match the player belongs to
+* @param[in] slot The player's position in the match, 0 hosts
+*
+* @return true if the player finished the match
+*
+*/
+
+bool CNetworkLoadTest::RunClient(int matchIndex, int slot){
+    SMatch &Match = *DMatches[matchIndex];
+    std::string Name = "load" + std::to_string(matchIndex) + "_" + std::to_string(slot);
+    std::string GameName = "match" + std::to_string(matchIndex);
+    std::mt19937 Random(matchIndex * 64 + slot);
+    auto Ignore = [](bool){};
+    CMultiplayerClient Client(nullptr, "127.0.0.1", std::to_string(DPort));
+    std::vector< double > CommandLatencies;
+    std::vector< double > ChatLatencies;
+    std::vector< SLockstepCommand > Commands;
+    std::list< std::string > Chats;
+    CLockstepScheduler Scheduler(DOptions.DDelay);
+    SLockstepFrame Frame;
+    size_t PeakQueue = 0;
+    double QueueTotal = 0.0;
+    int QueueSamples = 0;
+    int Cycle = 0;
+    int ChatSequence = 0;
+    EPlayerColor Color = EPlayerColor::None;
+
+    Client.start_client_thread();
+    auto Play = [&]() -> bool{
+        int Start = 0;
+
+        if(!Client.login(Ignore, Name, "load")){
+            PrintError("%s could not log in\n", Name.c_str());
+            return false;
+        }
+        if(0 == slot){
+            if(!Client.hostGame(Ignore, "loadtest", DOptions.DPlayers, "", 0, GameName)){
+                PrintError("%s could not host %s\n", Name.c_str(), GameName.c_str());
+                return false;
+            }
+            Client.getPlayerInfo();
+        }
+        else{
+            int GameID = -1;
+
+            if(!WaitFor(Match, [&Match, slot](){ return Match.DJoined == slot; })){
+                return false;
+            }
+            Client.getGameInfo();
+            for(auto &Game : Client.games){
+                size_t Separator = Game.find(". ");
+
+                if((std::string::npos != Separator) && (Game.substr(Separator + 2) == GameName)){
+                    GameID = std::atoi(Game.c_str());
+                }
+            }
+            if((0 > GameID) || !Client.joinGame(Ignore, GameID, "")){
+                PrintError("%s could not join %s\n", Name.c_str(), GameName.c_str());
+                return false;
+            }
+            Client.getPlayerInfo();
+        }
+        Color = static_cast< EPlayerColor >(Client.team);
+        {
+            std::lock_guard< std::mutex > Lock(Match.DMutex);
+
+            Match.DJoined++;
+        }
+        Match.DCondition.notify_all();
+        if(!WaitFor(Match, [this, &Match](){ return Match.DJoined == DOptions.DPlayers; })){
+            return false;
+        }
+        Client.sendReady("1");
+        {
+            std::lock_guard< std::mutex > Lock(Match.DMutex);
+
+            Match.DReady++;
+        }
+        Match.DCondition.notify_all();
+        if((0 == slot) && WaitFor(Match, [this, &Match](){ return Match.DReady == DOptions.DPlayers; })){
+            Client.sendStart();
+        }
+        double Deadline = Now() + DOptions.DTimeout;
+
+        while(!Start){
+            Client.getJoinedPlayerInfo();
+            Client.getChat(Chats, Start);
+            if(Now() > Deadline || Client.isClosed()){
+                PrintError("%s did not see the game start\n", Name.c_str());
+                return false;
+            }
+            if(!Start){
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        Scheduler.Reset(0);
+        for(int Player = 1; Player <= DOptions.DPlayers; Player++){
+            Scheduler.Expect(static_cast< EPlayerColor >(Player), true);
+        }
+        auto NextTick = std::chrono::steady_clock::now();
+
+        Deadline = Now() + DOptions.DTimeout + DOptions.DCycles * DOptions.DTick / 1000.0;
+        while(Cycle < DOptions.DCycles){
+            if(0 == Random() % NETWORK_LOAD_COMMAND_ODDS){
+                SLockstepCommand Command;
+
+                Command.DPlayer = Color;
+                Command.DAction = static_cast< EAssetCapabilityType >(1 + Random() % (to_underlying(EAssetCapabilityType::Max) - 1));
+                for(int Actor = 1 + Random() % 9; Actor; Actor--){
+                    Command.DActorIDs.push_back(Random() % 2000);
+                }
+                Command.DTargetColor = EPlayerColor::None;
+                Command.DTargetType = EAssetType::None;
+                Command.DTargetX = Random() % NETWORK_LOAD_MAP_PIXELS;
+                Command.DTargetY = Random() % NETWORK_LOAD_MAP_PIXELS;
+                Scheduler.Submit(Command);
+            }
+            while(Scheduler.Issue(Cycle, Color, Frame)){
+                {
+                    std::lock_guard< std::mutex > Lock(Match.DMutex);
+
+                    Match.DSendTimes[SendKey(to_underlying(Color), Frame.DCycle)] = Now();
+                }
+                Client.sendCommandFrame(CLockstepFrame::EncodeMessage(Frame));
+            }
+            if((int)(Random() % 100) < DOptions.DChatPercent){
+                int64_t Key = ((int64_t)ChatSequence++ << 8) | slot;
+                {
+                    std::lock_guard< std::mutex > Lock(Match.DMutex);
+
+                    Match.DChatTimes[Key] = Now();
+                }
+                Client.sendChat("load " + std::to_string(Key));
+            }
+
+            size_t Depth = Client.queuedMessages();
+
+            PeakQueue = std::max(PeakQueue, Depth);
+            QueueTotal += Depth;
+            QueueSamples++;
+            for(;;){
+                std::string Message;
+
+                Chats.clear();
+                Client.getJoinedPlayerInfo();
+                Client.getChat(Chats, Start);
+                for(auto &Chat : Chats){
+                    size_t Separator = Chat.rfind(' ');
+                    double Seconds = std::string::npos == Separator ? -1.0 : Latency(Match, std::atoll(Chat.c_str() + Separator + 1), true);
+
+                    if(0.0 <= Seconds){
+                        ChatLatencies.push_back(Seconds);
+                    }
+                }
+                Message = Client.getCommand();
+                if(!Message.empty()){
+                    if(CLockstepFrame::DecodeMessage(Message, Frame) && !Frame.DCommands.empty()){
+                        double Seconds = Latency(Match, SendKey(to_underlying(Frame.DCommands.front().DPlayer), Frame.DCycle), false);
+
+                        if(0.0 <= Seconds){
+                            CommandLatencies.push_back(Seconds);
+                        }
+                        Scheduler.Receive(Frame);
+                    }
+                    else{
+                        PrintError("%s received an invalid frame\n", Name.c_str());
+                    }
+                }
+                if(Chats.empty() && Message.empty()){
+                    break;
+                }
+            }
+            bool Advanced = Scheduler.Advance(Cycle, Now(), Commands);
+
+            if(Advanced){
+                Cycle++;
+            }
+            if(Client.isClosed() || (Now() > Deadline)){
+                PrintError("%s stopped at cycle %d\n", Name.c_str(), Cycle);
+                return false;
+            }
+            if(DOptions.DTick){
+                NextTick += std::chrono::milliseconds(DOptions.DTick);
+                std::this_thread::sleep_until(NextTick);
+            }
+            else if(!Advanced){
+                std::this_thread::yield();
+            }
+        }
+        {
+            std::lock_guard< std::mutex > Lock(Match.DMutex);
+
+            Match.DFinished++;
+        }
+        Match.DCondition.notify_all();
+        // The others may still need to take this player's last frames
+        return WaitFor(Match, [this, &Match](){ return Match.DFinished == DOptions.DPlayers; });
+    };
+    bool Success = Play();
+
+    if(!Success){
+        {
+            std::lock_guard< std::mutex > Lock(Match.DMutex);
+
+            Match.DFailed = true;
+        }
+        Match.DCondition.notify_all();
+    }
+    Client.sendQuit();
+    Client.close();
+
+    std::lock_guard< std::mutex > Lock(DResultMutex);
+
+    DCommandLatencies.insert(DCommandLatencies.end(), CommandLatencies.begin(), CommandLatencies.end());
+    DChatLatencies.insert(DChatLatencies.end(), ChatLatencies.begin(), ChatLatencies.end());
+    DStalls += Scheduler.StallCount();
+    DStalledFrames += Scheduler.StalledFrames();
+    DMaxStall = std::max(DMaxStall, Scheduler.MaxStall());
+    DPeakClientQueue = std::max(DPeakClientQueue, PeakQueue);
+    DClientQueueTotal += QueueTotal;
+    DClientQueueSamples += QueueSamples;
+    return Success;
+}
+
+/**
+* Prints the percentiles of a set of latencies.
+*
+* @param[in] name The name of the latencies
+* @param[in] latencies The latencies in seconds, sorted by the call
+*
+* @return void
+*
+*/
+
+void CNetworkLoadTest::PrintLatencies(const char *name, std::vector< double > &latencies){
+    if(latencies.empty()){
+        printf("  %-8s latency: no samples\n", name);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto Percentile = [&latencies](double fraction){
+        return latencies[std::min(latencies.size() - 1, (size_t)(fraction * latencies.size()))] * 1000.0;
+    };
+
+    printf("  %-8s latency: p50 %7.2f ms, p90 %7.2f ms, p99 %7.2f ms, max %7.2f ms (%d samples)\n", name, Percentile(0.5), Percentile(0.9), Percentile(0.99), latencies.back() * 1000.0, (int)latencies.size());
+}
+
+/**
+* Starts the server and the simulated players, waits for all matches to
+* end and prints the report.
+*
+* @return 0 if every player finished its match, 1 otherwise
+*
+*/
+
+int CNetworkLoadTest::Run(){
+    int Matches = std::max(1, DOptions.DClients / DOptions.DPlayers);
+    int Clients = Matches * DOptions.DPlayers;
+    std::vector< std::thread > Threads;
+
+    try{
+        CGameServer Server("127.0.0.1", 0);
+
+        DPort = Server.Port();
+        if(!DOptions.DRecordPath.empty() && !Server.Record(DOptions.DRecordPath)){
+            PrintError("Could not open %s\n", DOptions.DRecordPath.c_str());
+            return 1;
+        }
+        Server.Start();
+        for(int Index = 0; Index < Matches; Index++){
+            DMatches.emplace_back(new SMatch);
+        }
+
+        double StartTime = Now();
+
+        for(int Index = 0; Index < Clients; Index++){
+            Threads.emplace_back([this, Index](){
+                if(!RunClient(Index / DOptions.DPlayers, Index % DOptions.DPlayers)){
+                    std::lock_guard< std::mutex > Lock(DResultMutex);
+
+                    DFailures++;
+                }
+            });
+        }
+        for(auto &Thread : Threads){
+            Thread.join();
+        }
+
+        double Elapsed = std::max(Now() - StartTime, 1e-9);
+        CGameServer::SStatistics Statistics = Server.Statistics();
+
+        Server.Stop();
+        printf("Network load: %d clients in %d matches of %d, %d cycles at %d ms ticks, delay %d\n", Clients, Matches, DOptions.DPlayers, DOptions.DCycles, DOptions.DTick, DOptions.DDelay);
+        printf("  elapsed %.2f s, %d connections\n", Elapsed, (int)Statistics.DConnections);
+        printf("  server   messages: %llu in (%.0f/s), %llu out (%.0f/s), %.1f KB in, %.1f KB out\n", (unsigned long long)Statistics.DMessagesIn, Statistics.DMessagesIn / Elapsed, (unsigned long long)Statistics.DMessagesOut, Statistics.DMessagesOut / Elapsed, Statistics.DBytesIn / 1024.0, Statistics.DBytesOut / 1024.0);
+        PrintLatencies("command", DCommandLatencies);
+        PrintLatencies("chat", DChatLatencies);
+        printf("  queues: server output peak %d, client input mean %.2f peak %d\n", (int)Statistics.DPeakQueueDepth, DClientQueueSamples ? DClientQueueTotal / DClientQueueSamples : 0.0, (int)DPeakClientQueue);
+        printf("  lockstep: %d stalls over %d frames, max stall %.1f ms\n", DStalls, DStalledFrames, DMaxStall * 1000.0);
+        printf("  failures: %d\n", DFailures);
+    }
+    catch(std::exception &Exception){
+        PrintError("Could not run the game server: %s\n", Exception.what());
+        return 1;
+    }
+    return DFailures ? 1 : 0;
+}
@@ -0,0 +1,240 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CParseBenchmark
+*
+* @brief Measures how long reading the resource descriptors takes. Every
+*     .dat and .map file under res, img, upg, map and snd is read through a
+*     CCommentSkipLineDataSource and each line tokenized, the way the
+*     loaders do, once with buffering turned off, which reads a byte per
+*     read call like the data sources used to, and once with block buffered
+*     reads. Both passes must produce the same lines and tokens.
+*
+*     Started with "--parse-benchmark", see PrintUsage for the other
+*     options.
+*
+*/
+
+#include "ParseBenchmark.h"
+#include "ApplicationPath.h"
+#include "BufferedDataSource.h"
+#include "CommentSkipLineDataSource.h"
+#include "FileDataContainer.h"
+#include "Tokenizer.h"
+#include "Debug.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#define PARSE_BENCHMARK_FNV_OFFSET  14695981039346656037ULL
+#define PARSE_BENCHMARK_FNV_PRIME   1099511628211ULL
+
+/**
+* Constructor, stores the options.
+*
+* @param[in] options The parsed benchmark options
+*
+*/
+
+CParseBenchmark::CParseBenchmark(const SOptions &options){
+    DOptions = options;
+    if(0 >= DOptions.DBlockSize){
+        DOptions.DBlockSize = DEFAULT_DATA_SOURCE_BLOCK_SIZE;
+    }
+}
+
+/**
+* Parses the command line for the parse benchmark options. The benchmark is
+* only enabled if "--parse-benchmark" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the parse benchmark was requested
+*
+*/
+
+bool CParseBenchmark::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--parse-benchmark" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--data" == Argument){
+            options.DDataPath = Value;
+        }
+        else if("--passes" == Argument){
+            options.DPasses = std::max(1, std::atoi(Value.c_str()));
+        }
+        else if("--block" == Argument){
+            options.DBlockSize = std::max(1, std::atoi(Value.c_str()));
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown parse benchmark option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the parse benchmark options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CParseBenchmark::PrintUsage(const char *program){
+    PrintError("Usage: %s --parse-benchmark [options]\n", program);
+    PrintError("  --data DIR        data directory (default: data next to the executable)\n");
+    PrintError("  --passes N        passes over all descriptors per measurement (default: 20)\n");
+    PrintError("  --block N         block size of the buffered reads (default: %d)\n", DEFAULT_DATA_SOURCE_BLOCK_SIZE);
+}
+
+/**
+* Adds the descriptors in a directory of the data container to the list of
+* files, missing directories are skipped.
+*
+* @param[in] directory The directory relative to the data directory
+*
+* @return void
+*
+*/
+
+void CParseBenchmark::FindDescriptors(const std::string &directory){
+    std::shared_ptr< CDataContainer > Container = DDataContainer->DataContainer(directory);
+    std::vector< std::string > Names;
+
+    if(nullptr == Container){
+        return;
+    }
+    for(auto Iterator = Container->First(); (nullptr != Iterator) && Iterator->IsValid(); Iterator->Next()){
+        std::string Name = Iterator->Name();
+        size_t Dot = Name.rfind('.');
+
+        if(!Iterator->IsContainer() && (std::string::npos != Dot)){
+            std::string Extension = Name.substr(Dot);
+
+            if((".dat" == Extension) || (".map" == Extension)){
+                Names.push_back(directory + "/" + Name);
+            }
+        }
+    }
+    std::sort(Names.begin(), Names.end());
+    DFiles.insert(DFiles.end(), Names.begin(), Names.end());
+}
+
+/**
+* Reads and tokenizes every descriptor once.
+*
+* @param[in] blocksize The block size of the data sources, 0 for unbuffered
+*
+* @return The time taken, the counts and a checksum of the tokens
+*
+*/
+
+CParseBenchmark::SPassResult CParseBenchmark::ParseAll(size_t blocksize){
+    SPassResult Result;
+    std::string Line;
+    std::vector< std::string > Tokens;
+
+    Result.DChecksum = PARSE_BENCHMARK_FNV_OFFSET;
+    auto Start = std::chrono::steady_clock::now();
+    for(auto &FileName : DFiles){
+        std::shared_ptr< CBufferedDataSource > Source = std::dynamic_pointer_cast< CBufferedDataSource >(DDataContainer->DataSource(FileName));
+
+        if(nullptr == Source){
+            continue;
+        }
+        Source->BlockSize(blocksize);
+
+        CCommentSkipLineDataSource LineSource(Source, '#');
+
+        while(LineSource.Read(Line)){
+            CTokenizer::Tokenize(Tokens, Line);
+            Result.DLines++;
+            Result.DTokens += Tokens.size();
+            for(auto &Token : Tokens){
+                for(char Character : Token){
+                    Result.DChecksum = (Result.DChecksum ^ (uint8_t)Character) * PARSE_BENCHMARK_FNV_PRIME;
+                }
+                Result.DChecksum = (Result.DChecksum ^ 0xFF) * PARSE_BENCHMARK_FNV_PRIME;
+            }
+        }
+        Result.DBlockReads += Source->BlockReads();
+    }
+    Result.DSeconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - Start).count();
+    return Result;
+}
+
+/**
+* Finds the descriptors, checks that both ways of reading agree and times
+* them.
+*
+* @return 0 on success, 1 if no descriptors were found or the results differ
+*
+*/
+
+int CParseBenchmark::Run(){
+    std::string DataPath = DOptions.DDataPath;
+    SPassResult Unbuffered, Buffered;
+    double UnbufferedSeconds = 0.0, BufferedSeconds = 0.0;
+
+    if(DataPath.empty()){
+        DataPath = GetApplicationPath().Containing().ToString() + "/data";
+    }
+    DDataContainer = std::make_shared< CDirectoryDataContainer >(DataPath);
+    for(auto Directory : {"res", "img", "upg", "map", "snd"}){
+        FindDescriptors(Directory);
+    }
+    if(DFiles.empty()){
+        PrintError("Failed to find any descriptors in %s.\n", DataPath.c_str());
+        return 1;
+    }
+
+    Unbuffered = ParseAll(0);
+    Buffered = ParseAll(DOptions.DBlockSize);
+    printf("Descriptors: %d files, %d lines, %d tokens\n", (int)DFiles.size(), (int)Buffered.DLines, (int)Buffered.DTokens);
+    if((Unbuffered.DLines != Buffered.DLines) || (Unbuffered.DTokens != Buffered.DTokens) || (Unbuffered.DChecksum != Buffered.DChecksum)){
+        PrintError("Buffered reads differ from unbuffered reads.\n");
+        return 1;
+    }
+
+    // Alternate the two so neither one gets all of the warm cache
+    for(int Pass = 0; Pass < DOptions.DPasses; Pass++){
+        UnbufferedSeconds += ParseAll(0).DSeconds;
+        BufferedSeconds += ParseAll(DOptions.DBlockSize).DSeconds;
+    }
+    printf("unbuffered %8.3f ms/pass, %8d reads/pass\n", UnbufferedSeconds * 1000.0 / DOptions.DPasses, (int)Unbuffered.DBlockReads);
+    printf("buffered   %8.3f ms/pass, %8d reads/pass, %d byte blocks\n", BufferedSeconds * 1000.0 / DOptions.DPasses, (int)Buffered.DBlockReads, DOptions.DBlockSize);
+    printf("speedup    %8.2fx\n", UnbufferedSeconds / std::max(BufferedSeconds, 1e-12));
+    return 0;
+}
@@ -184,7 +184,10 @@ void CPlayerAIColorSelectMode::Calculate(std::shared_ptr< CApplicationData > con
         }
         context->DLoadingPlayerColors[to_underlying(DPlayerColorRequestingChange)] = DPlayerColorChangeRequest;
                                     
-        *context->DSelectedMap = *CAssetDecoratedMap::DuplicateMap(context->DSelectedMapIndex,context->DLoadingPlayerColors);
+        auto RecoloredMap = CAssetDecoratedMap::DuplicateMap(context->DSelectedMapIndex,context->DLoadingPlayerColors);
+        if(nullptr != RecoloredMap){
+            *context->DSelectedMap = *RecoloredMap;
+        }
     }
     if(EPlayerColor::None != DPlayerColorRequesTypeChange){
         if(CApplicationData::gstSinglePlayer == context->DGameSessionType){
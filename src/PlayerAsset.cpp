@@ -22,6 +22,7 @@
 #include "CommentSkipLineDataSource.h"
 #include "Debug.h"
 #include "GameModel.h"
+#include "MemoryPool.h"
 #include <algorithm>
 #include <Tokenizer.h>
 
@@ -664,6 +665,41 @@ CPlayerAssetType::~CPlayerAssetType(){
 
 }
 
+/**
+* Update the stats from another asset type, used to bring a player's copy of
+*     a type up to date after its .dat file was loaded again. The name, color
+*     and the upgrades the player researched are kept.
+*
+* @param[in] asset shared_ptr to CPlayerAssetType
+*
+* @return Nothing
+*
+*/
+
+void CPlayerAssetType::UpdateStats(std::shared_ptr< CPlayerAssetType > asset){
+    if(nullptr != asset){
+        DType = asset->DType;
+        DCapabilities = asset->DCapabilities;
+        DAssetRequirements = asset->DAssetRequirements;
+        DHitPoints = asset->DHitPoints;
+        DArmor = asset->DArmor;
+        DSight = asset->DSight;
+        DConstructionSight = asset->DConstructionSight;
+        DSize = asset->DSize;
+        DSpeed = asset->DSpeed;
+        DGoldCost = asset->DGoldCost;
+        DLumberCost = asset->DLumberCost;
+        DStoneCost = asset->DStoneCost;
+        DFoodConsumption = asset->DFoodConsumption;
+        DBuildTime = asset->DBuildTime;
+        DAttackSteps = asset->DAttackSteps;
+        DReloadSteps = asset->DReloadSteps;
+        DBasicDamage = asset->DBasicDamage;
+        DPiercingDamage = asset->DPiercingDamage;
+        DRange = asset->DRange;
+    }
+}
+
 /**
 * Do upgrade on Armor over range current capability and new DAssetUpgrades
 *
@@ -887,8 +923,25 @@ bool CPlayerAssetType::LoadTypes(std::shared_ptr< CDataContainer > container){
 */
 
 bool CPlayerAssetType::Load(std::shared_ptr< CDataSource > source){
+    std::string Name;
+
+    return Load(source, Name);
+}
+
+/**
+* Load a type like Load(source) and also return its name, so that a type
+*     loaded again can be found in the players' registries
+*
+* @param[in] source a shared_ptr to CDataSource
+* @param[out] name the name of the type in the file
+*
+* @return True if load was completed
+*
+*/
+
+bool CPlayerAssetType::Load(std::shared_ptr< CDataSource > source, std::string &name){
     CCommentSkipLineDataSource LineSource(source, '#');
-    std::string Name, TempString;
+    std::string TempString;
     std::shared_ptr< CPlayerAssetType > PlayerAssetType;
     EAssetType AssetType;
     int CapabilityCount, AssetRequirementCount;
@@ -898,24 +951,24 @@ bool CPlayerAssetType::Load(std::shared_ptr< CDataSource > source){
     	PrintDebug(DEBUG_LOW, "Failed nullptr == source\n");
         return false;
     }
-    if(!LineSource.Read(Name)){
+    if(!LineSource.Read(name)){
         PrintError("Failed to get resource type name.\n");
         return false;
     }
-    AssetType = NameToType(Name);
-    if((EAssetType::None == AssetType) && (Name != DTypeStrings[to_underlying(EAssetType::None)])){
-        PrintError("Unknown resource type %s.\n", Name.c_str());
+    AssetType = NameToType(name);
+    if((EAssetType::None == AssetType) && (name != DTypeStrings[to_underlying(EAssetType::None)])){
+        PrintError("Unknown resource type %s.\n", name.c_str());
         return false;
     }
-    auto Iterator = DRegistry.find(Name);
+    auto Iterator = DRegistry.find(name);
     if(DRegistry.end() != Iterator){
         PlayerAssetType = Iterator->second;
     }
     else{
         PlayerAssetType = std::make_shared< CPlayerAssetType >();
         PlayerAssetType->DThis = PlayerAssetType;
-        PlayerAssetType->DName = Name;
-        DRegistry[Name] = PlayerAssetType;
+        PlayerAssetType->DName = name;
+        DRegistry[name] = PlayerAssetType;
     }
     int flag = 0;
     PlayerAssetType->DType = AssetType;
@@ -1041,6 +1094,7 @@ bool CPlayerAssetType::Load(std::shared_ptr< CDataSource > source){
         }
         flag++;
         AssetRequirementCount = std::stoi(TempString);
+        PlayerAssetType->DAssetRequirements.clear();
         for(int Index = 0; Index < AssetRequirementCount; Index++){
             if(!LineSource.Read(TempString)){
                 PrintError("Failed to read asset requirement %d.\n", Index);
@@ -1129,7 +1183,7 @@ std::shared_ptr< std::unordered_map< std::string, std::shared_ptr< CPlayerAssetT
 
 std::shared_ptr< CPlayerAsset > CPlayerAssetType::Construct(){
     if(auto ThisShared = DThis.lock()){
-        return std::shared_ptr< CPlayerAsset >(new CPlayerAsset(ThisShared));
+        return MakePooled< CPlayerAsset, EMemorySubsystem::Assets >(ThisShared);
     }
     return nullptr;
 }
@@ -1529,6 +1583,39 @@ void CPlayerAsset::SaveCommands(std::ofstream& save, EPlayerColor PlayerColor) c
     }
 }
 
+/**
+* Saves player commands as records for the binary saved game
+*
+* @param[out] save The command records, one per command
+* @param[in] PlayerColor Color of player
+*
+* @return void
+*
+*/
+
+void CPlayerAsset::SaveCommands(std::vector< SSavedAssetCommand > &save, EPlayerColor PlayerColor) const{
+    save.clear();
+    save.reserve(DCommands.size());
+
+    for(auto Command : DCommands){
+        SSavedAssetCommand Saved;
+
+        Saved.DPlayerColor = to_underlying(PlayerColor);
+        Saved.DAction = Command.DAction;
+        Saved.DCapability = Command.DCapability;
+        if(Command.DAssetTarget){
+            Saved.DHasTarget = true;
+            Saved.DTargetID = Command.DAssetTarget->AssetID();
+            Saved.DTargetX = Command.DAssetTarget->PositionX();
+            Saved.DTargetY = Command.DAssetTarget->PositionY();
+        }
+        if(Command.DActivatedCapability){
+            Command.DActivatedCapability->Save(Saved.DActivatedCapability);
+        }
+        save.push_back(Saved);
+    }
+}
+
 /**
 * Load player commands from data source file
 *
@@ -1541,173 +1628,156 @@ void CPlayerAsset::SaveCommands(std::ofstream& save, EPlayerColor PlayerColor) c
 
 void CPlayerAsset::LoadCommands(std::shared_ptr< CDataSource > source, std::array< std::shared_ptr< CPlayerData >, to_underlying(EPlayerColor::Max)> Players){
     CCommentSkipLineDataSource LineSource(source, '#');
-    std::string Value, Type;
-    bool PushToggle = true;
+    std::vector< SSavedAssetCommand > Commands;
+    std::string Value;
 
-    // if an asset already has some commands, it must be processed by another asset already,
-    // may just skip the following commands to avoid repetitions.
-    if(DCommands.size())
-        PushToggle = false;
+    auto ReadInt = [&](){
+        LineSource.Read(Value);
+        return std::stoi(Value);
+    };
+    // asset ids and player colors are written as NULL when there is none
+    auto ReadID = [&](){
+        LineSource.Read(Value);
+        return Value == "NULL" ? -1 : std::stoi(Value);
+    };
+    auto ReadName = [&](){
+        LineSource.Read(Value);
+        return Value == "NULL" ? std::string() : Value;
+    };
 
-    // save << "#CommandCount\n";
-    // save << DCommands.size() << std::endl;
-    LineSource.Read(Value);
-    // std::cout << "CommandCount: " << Value << std::endl;
-    int CommandCount = std::stoi(Value);
+    int CommandCount = ReadInt();
 
     for(int i = 0; i < CommandCount; i++){
-        SAssetCommand Command;
+        SSavedAssetCommand Command;
+        auto &Capability = Command.DActivatedCapability;
 
-        // Player color
-        LineSource.Read(Value);
-        int PlayerColor = std::stoi(Value);
+        Command.DPlayerColor = ReadInt();
+        Command.DAction = static_cast<EAssetAction>(ReadInt());
+        Command.DCapability = static_cast<EAssetCapabilityType>(ReadInt());
 
-        // EAssetAction DAction;
+        // std::shared_ptr< CPlayerAsset > DAssetTarget;
         LineSource.Read(Value);
-        // std::cout << "Action: " << Value << std::endl;
+        if(Value != "NULL"){
+            Command.DHasTarget = true;
+            if(Command.DAction == EAssetAction::Walk || Command.DAction == EAssetAction::HarvestLumber
+                || Command.DAction == EAssetAction::QuarryStone){
+                std::vector<std::string> Tokens;
 
-        Command.DAction = static_cast<EAssetAction>(std::stoi(Value));
+                CTokenizer::Tokenize(Tokens, Value);
+                Command.DTargetX = std::stoi(Tokens[0]);
+                Command.DTargetY = std::stoi(Tokens[1]);
+            }
+            else
+                Command.DTargetID = std::stoi(Value);
+        }
 
-        // EAssetCapabilityType DCapability;
-        LineSource.Read(Value);
-        // std::cout << "Capability: " << Value << std::endl;
+        LineSource.Read(Capability.DType);
+        if(Capability.DType == "BASIC" || Capability.DType == "UNITUPGRADE" || Capability.DType == "BUILD"
+            || Capability.DType == "TRAIN" || Capability.DType == "BUILDINGUPGRADE"){
+            Capability.DActor = ReadID();
+            Capability.DPlayerColor = ReadID();
+            Capability.DTarget = ReadID();
+
+            if(Capability.DType == "BUILDINGUPGRADE")
+                Capability.DOriginalType = ReadName();
+            if(Capability.DType == "UNITUPGRADE" || Capability.DType == "BUILDINGUPGRADE")
+                Capability.DUpgradingType = ReadName();
+            if(Capability.DType == "UNITUPGRADE")
+                Capability.DUpgradeName = ReadName();
+
+            if(Capability.DType != "BASIC"){
+                Capability.DCurrentStep = ReadInt();
+                Capability.DTotalSteps = ReadInt();
+                Capability.DLumber = ReadInt();
+                Capability.DGold = ReadInt();
+                Capability.DStone = ReadInt();
+            }
+        }
+        Commands.push_back(Command);
+    }
+    LoadCommands(Commands, Players);
+}
 
-        Command.DCapability = static_cast<EAssetCapabilityType>(std::stoi(Value));
+/**
+* Restores player commands from their saved records, shared by the text and
+* binary saved games
+*
+* @param[in] commands The command records as saved by SaveCommands
+* @param[in] Players CPlayerData array stored all player data
+*
+* @return void
+*
+*/
 
-        // std::shared_ptr< CPlayerAsset > DAssetTarget;
-        LineSource.Read(Value);
-        // std::cout << "Target: " << Value << std::endl;
+void CPlayerAsset::LoadCommands(const std::vector< SSavedAssetCommand > &commands, std::array< std::shared_ptr< CPlayerData >, to_underlying(EPlayerColor::Max)> Players){
+    bool PushToggle = true;
 
-        if(Value == "NULL")
+    // if an asset already has some commands, it must be processed by another asset already,
+    // may just skip the following commands to avoid repetitions.
+    if(DCommands.size())
+        PushToggle = false;
+
+    auto FindPlayer = [&](int color) -> std::shared_ptr< CPlayerData >{
+        if((0 > color) || (to_underlying(EPlayerColor::Max) <= color))
+            return nullptr;
+        return Players[color];
+    };
+    auto FindAsset = [](int assetid) -> std::shared_ptr< CPlayerAsset >{
+        return 0 <= assetid ? FindAssetObj(assetid) : nullptr;
+    };
+    auto FindType = [](std::shared_ptr< CPlayerData > playerdata, const std::string &name) -> std::shared_ptr< CPlayerAssetType >{
+        auto Types = playerdata->AssetTypes();
+        auto Found = Types->find(name);
+
+        return Found == Types->end() ? nullptr : Found->second;
+    };
+
+    for(auto &Saved : commands){
+        auto &Saving = Saved.DActivatedCapability;
+        SAssetCommand Command;
+
+        Command.DAction = Saved.DAction;
+        Command.DCapability = Saved.DCapability;
+
+        // std::shared_ptr< CPlayerAsset > DAssetTarget;
+        if(!Saved.DHasTarget)
             Command.DAssetTarget = nullptr;
         else if(Command.DAction == EAssetAction::Walk || Command.DAction == EAssetAction::HarvestLumber
                 || Command.DAction == EAssetAction::QuarryStone){
-            std::vector<std::string> Tokens;
+            auto Player = FindPlayer(Saved.DPlayerColor);
 
-            CTokenizer::Tokenize(Tokens, Value);
-
-            Command.DAssetTarget = Players[PlayerColor]->CreateMarker(CPixelPosition(std::stoi(Tokens[0]), std::stoi(Tokens[1])), false);
+            Command.DAssetTarget = Player ? Player->CreateMarker(CPixelPosition(Saved.DTargetX, Saved.DTargetY), false) : nullptr;
         }
         else
-            Command.DAssetTarget = FindAssetObj(std::stoi(Value));
+            Command.DAssetTarget = FindAsset(Saved.DTargetID);
 
-        LineSource.Read(Type);
-        // std::cout << "ActivatedCapability: " << Value << std::endl;
+        auto Actor = FindAsset(Saving.DActor);
+        auto PlayerData = FindPlayer(Saving.DPlayerColor);
+        auto Target = FindAsset(Saving.DTarget);
+        auto PlayerCapability = CPlayerCapability::FindCapability(Command.DCapability);
 
-        if(Type == "NULL"){
+        if(Saving.DType == "NULL"){
             Command.DActivatedCapability = nullptr;
 
             if(PushToggle)
                 DCommands.push_back(Command);
         }
-
-        else if(Type == "BASIC"){
-            // Actor
-            LineSource.Read(Value);
-            // std::cout << "Actor: " << Value << std::endl;
-
-            auto Actor = FindAssetObj(std::stoi(Value));
-
-            // Player Data
-            LineSource.Read(Value);
-            // std::cout << "Player: " << Value << std::endl;
-
-            auto PlayerData = Players[std::stoi(Value)];
-
-            // Target
-            LineSource.Read(Value);
-            // std::cout << "Target: " << Value << std::endl;
-
-            auto Target = FindAssetObj(std::stoi(Value));
-
-            auto PlayerCapability = CPlayerCapability::FindCapability(Command.DCapability);
-            // std::cout << "Capability: " << CPlayerCapability::TypeToName(Command.DCapability) << std::endl;
-
+        else if(!Actor || !PlayerData || !PlayerCapability){
+            PrintError("Saved %s command could not be restored.\n", Saving.DType.c_str());
+        }
+        else if(Saving.DType == "BASIC"){
             PlayerCapability->ApplyCapability(Actor, PlayerData, Target);
         }
-        else if(Type == "UNITUPGRADE"){
-            // Actor
-            LineSource.Read(Value);
-            // std::cout << "Actor: " << Value << std::endl;
-
-            auto Actor = FindAssetObj(std::stoi(Value));
-
-            // Player Data
-            LineSource.Read(Value);
-            // std::cout << "PlayerData: " << Value << std::endl;
-
-            auto PlayerData = Players[std::stoi(Value)];
-
-            // Target
-            LineSource.Read(Value);
-            // std::cout << "Target: " << Value << std::endl;
-
-            std::shared_ptr<CPlayerAsset> Target;
-
-            if(Value == "NULL")
-                Target = nullptr;
-            else
-                Target = FindAssetObj(std::stoi(Value));
-
-            // std::shared_ptr< CPlayerAssetType > DUpgradingType;
-            std::shared_ptr< CPlayerAssetType > UpgradingType;
-
-            LineSource.Read(Value);
-            if(Value == "NULL")
-                UpgradingType = nullptr;
-            else
-                UpgradingType = PlayerData->AssetTypes()->find(Value)->second;
-
-            // std::cout << "UpgradingType: " << Value << std::endl;
-
-
-            // std::string DUpgradeName;
-            LineSource.Read(Value);
-            // std::cout << "UpgradeName: " << Value << std::endl;
-
-            auto Name = Value;
-
-            // int DCurrentStep;
-            LineSource.Read(Value);
-            // std::cout << "CurrentStep: " << Value << std::endl;
-
-            int CurrentStep = std::stoi(Value);
-
-            // int DTotalSteps;
-            LineSource.Read(Value);
-            // std::cout << "TotalSteps: " << Value << std::endl;
-
-            int TotalSteps = std::stoi(Value);
-
-            // int DLumber;
-            LineSource.Read(Value);
-            // std::cout << "Lumber: " << Value << std::endl;
-
-            int Lumber = std::stoi(Value);
-            PlayerData->IncrementLumber(Lumber);
-
-            // int DGold;
-            LineSource.Read(Value);
-            // std::cout << "Gold: " << Value << std::endl;
-
-            int Gold = std::stoi(Value);
-            PlayerData->IncrementGold(Gold);
-
-            // int DStone;
-            LineSource.Read(Value);
-            // std::cout << "Stone: " << Value << std::endl;
-
-            int Stone = std::stoi(Value);
-            PlayerData->IncrementStone(Stone);
-
-            auto PlayerCapability = CPlayerCapability::FindCapability(Command.DCapability);
-            // std::cout << "Capability: " << CPlayerCapability::TypeToName(Command.DCapability) << std::endl;
+        else if(Saving.DType == "UNITUPGRADE"){
+            PlayerData->IncrementLumber(Saving.DLumber);
+            PlayerData->IncrementGold(Saving.DGold);
+            PlayerData->IncrementStone(Saving.DStone);
 
             // Since this is a building in progress, need to remove it from the actual map
             // conserving the maximum asset id count
             int Temp = GAssetIDCount;
 
-            if(Actor->Type() == EAssetType::Barracks){
+            if(Actor->Type() == EAssetType::Barracks && Target){
 
                 // removing the same asset from the actual map
                 PlayerData->DeleteAsset(Target);
@@ -1727,66 +1797,15 @@ void CPlayerAsset::LoadCommands(std::shared_ptr< CDataSource > source, std::arra
             }
 
             // set current step
-            DCommands.back().DActivatedCapability->Step(CurrentStep);
+            DCommands.back().DActivatedCapability->Step(Saving.DCurrentStep);
 
             // reset
             GAssetIDCount = Temp;
-
         }
-        else if(Type == "BUILD" || Type == "TRAIN"){
-            // Actor
-            LineSource.Read(Value);
-            // std::cout << "Actor: " << Value << std::endl;
-
-            auto Actor = FindAssetObj(std::stoi(Value));
-
-            // Player Data
-            LineSource.Read(Value);
-            // std::cout << "Player: " << Value << std::endl;
-
-            auto PlayerData = Players[std::stoi(Value)];
-
-            // Target
-            LineSource.Read(Value);
-            // std::cout << "Target: " << Value << std::endl;
-
-            auto Target = FindAssetObj(std::stoi(Value));
-
-            // int DCurrentStep;
-            LineSource.Read(Value);
-            // std::cout << "CurrentStep: " << Value << std::endl;
-
-            int CurrentStep = std::stoi(Value);
-
-            // int DTotalSteps;
-            LineSource.Read(Value);
-            // std::cout << "TotalSteps: " << Value << std::endl;
-
-            int TotalSteps = std::stoi(Value);
-
-            // int DLumber;
-            LineSource.Read(Value);
-            // std::cout << "Lumber: " << Value << std::endl;
-
-            int Lumber = std::stoi(Value);
-            PlayerData->IncrementLumber(Lumber);
-
-            // int DGold;
-            LineSource.Read(Value);
-            // std::cout << "Gold: " << Value << std::endl;
-
-            int Gold = std::stoi(Value);
-            PlayerData->IncrementGold(Gold);
-
-            // int DStone;
-            LineSource.Read(Value);
-            // std::cout << "Stone: " << Value << std::endl;
-
-            int Stone = std::stoi(Value);
-            PlayerData->IncrementStone(Stone);
-
-            auto PlayerCapability = CPlayerCapability::FindCapability(Command.DCapability);
-            // std::cout << "Capability: " << CPlayerCapability::TypeToName(Command.DCapability) << std::endl;
+        else if((Saving.DType == "BUILD" || Saving.DType == "TRAIN") && Target){
+            PlayerData->IncrementLumber(Saving.DLumber);
+            PlayerData->IncrementGold(Saving.DGold);
+            PlayerData->IncrementStone(Saving.DStone);
 
             // Since this is a building in progress, need to remove it from the actual map
             // conserving the maximum asset id count
@@ -1797,7 +1816,6 @@ void CPlayerAsset::LoadCommands(std::shared_ptr< CDataSource > source, std::arra
 
             // replacing the maximum asset id count, so the newly created asset will have the same id
             GAssetIDCount = Target->AssetID();
-            // }
 
             // apply capability will create a new instance of the asset
             PlayerCapability->ApplyCapability(Actor, PlayerData, Target);
@@ -1809,83 +1827,22 @@ void CPlayerAsset::LoadCommands(std::shared_ptr< CDataSource > source, std::arra
             NewTarget->CreationCycle(Target->CreationCycle());
 
             // set current step
-            DCommands.back().DActivatedCapability->Step(CurrentStep);
+            DCommands.back().DActivatedCapability->Step(Saving.DCurrentStep);
 
             // reset
             GAssetIDCount = Temp;
         }
-        else if(Type == "BUILDINGUPGRADE"){
-            // Actor
-            LineSource.Read(Value);
-            // std::cout << "Actor: " << Value << std::endl;
-
-            auto Actor = FindAssetObj(std::stoi(Value));
-
-            // Player Data
-            LineSource.Read(Value);
-            // std::cout << "PlayerData: " << Value << std::endl;
+        else if(Saving.DType == "BUILDINGUPGRADE"){
+            auto OriginalType = FindType(PlayerData, Saving.DOriginalType);
+            auto UpgradeType = FindType(PlayerData, Saving.DUpgradingType);
 
-            auto PlayerData = Players[std::stoi(Value)];
-
-            // Target
-            LineSource.Read(Value);
-            // std::cout << "Target: " << Value << std::endl;
-
-            std::shared_ptr<CPlayerAsset> Target;
-
-            if(Value == "NULL")
-                Target = nullptr;
-            else
-                Target = FindAssetObj(std::stoi(Value));
-
-            // std::shared_ptr< CPlayerAssetType > DOriginalType;
-            LineSource.Read(Value);
-            // std::cout << "OrgType: " << Value << std::endl;
-
-            auto OriginalType = PlayerData->AssetTypes()->find(Value)->second;
-
-
-            // std::shared_ptr< CPlayerAssetType > DUpgradingType;
-            LineSource.Read(Value);
-            // std::cout << "UpgraddType: " << Value << std::endl;
-
-            auto UpgradeType = PlayerData->AssetTypes()->find(Value)->second;
-
-            // int DCurrentStep;
-            LineSource.Read(Value);
-            // std::cout << "CurrentStep: " << Value << std::endl;
-
-            int CurrentStep = std::stoi(Value);
-
-            // int DTotalSteps;
-            LineSource.Read(Value);
-            // std::cout << "TotalSteps: " << Value << std::endl;
-
-            int TotalSteps = std::stoi(Value);
-
-            // int DLumber;
-            LineSource.Read(Value);
-            // std::cout << "Lumber: " << Value << std::endl;
-
-            int Lumber = std::stoi(Value);
-            PlayerData->IncrementLumber(Lumber);
-
-            // int DGold;
-            LineSource.Read(Value);
-            // std::cout << "Gold: " << Value << std::endl;
-
-            int Gold = std::stoi(Value);
-            PlayerData->IncrementGold(Gold);
-
-            // int DStone;
-            LineSource.Read(Value);
-            // std::cout << "Stone: " << Value << std::endl;
-
-            int Stone = std::stoi(Value);
-            PlayerData->IncrementStone(Stone);
-
-            auto PlayerCapability = CPlayerCapability::FindCapability(Command.DCapability);
-            // std::cout << "Capability: " << CPlayerCapability::TypeToName(Command.DCapability) << std::endl;
+            if(!OriginalType || !UpgradeType){
+                PrintError("Saved upgrade from %s to %s could not be restored.\n", Saving.DOriginalType.c_str(), Saving.DUpgradingType.c_str());
+                continue;
+            }
+            PlayerData->IncrementLumber(Saving.DLumber);
+            PlayerData->IncrementGold(Saving.DGold);
+            PlayerData->IncrementStone(Saving.DStone);
 
             // change asset type to its original type
             Actor->ChangeType(OriginalType);
@@ -1896,7 +1853,7 @@ void CPlayerAsset::LoadCommands(std::shared_ptr< CDataSource > source, std::arra
             SAssetCommand AssetCommand = Actor->CurrentCommand();
             AssetCommand.DAction = EAssetAction::Construct;
             Actor->ChangeType(UpgradeType);
-            AssetCommand.DActivatedCapability->Step(CurrentStep);
+            AssetCommand.DActivatedCapability->Step(Saving.DCurrentStep);
             Actor->PopCommand();
             Actor->PushCommand(AssetCommand);
         }
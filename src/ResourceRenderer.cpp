@@ -90,7 +90,8 @@ CResourceRenderer::~CResourceRenderer(){
 }
 
 /**
-* A member function that draws player's resources such as gold and lumbers
+* A member function that draws player's resources such as gold and lumbers,
+* the panel is only rerendered when one of the displayed values changes
 *
 * @param[in] surface The shared pointer to a CGraphicSurface object
 *
@@ -99,9 +100,6 @@ CResourceRenderer::~CResourceRenderer(){
 */
 
 void CResourceRenderer::DrawResources(std::shared_ptr< CGraphicSurface > surface){
-    int Width, Height;
-    int TextYOffset, ImageYOffset;
-    int WidthSeparation, XOffset;
     int DeltaGold = DPlayer->Gold() - DLastGoldDisplay;
     int DeltaLumber = DPlayer->Lumber() - DLastLumberDisplay;
     int DeltaStone = DPlayer->Stone() - DLastStoneDisplay;
@@ -127,6 +125,29 @@ void CResourceRenderer::DrawResources(std::shared_ptr< CGraphicSurface > surface
     else{
         DLastStoneDisplay += DeltaStone;
     }
+    
+    std::vector< int > Key = {DLastGoldDisplay, DLastLumberDisplay, DLastStoneDisplay, DPlayer->FoodConsumption(), DPlayer->FoodProduction()};
+    if(DPanel.Update(surface->Width(), surface->Height(), Key)){
+        DrawPanel(DPanel.Surface());
+    }
+    DPanel.Draw(surface, 0, 0);
+}
+
+/**
+* A member function that renders the resource icons and counts into the
+* retained panel, only called when a displayed value has changed
+*
+* @param[in] surface The shared pointer to the panel surface
+*
+* @return void
+*
+*/
+
+void CResourceRenderer::DrawPanel(std::shared_ptr< CGraphicSurface > surface){
+    int Width, Height;
+    int TextYOffset, ImageYOffset;
+    int WidthSeparation, XOffset;
+    
     Width = surface->Width();
     Height = surface->Height();
     TextYOffset = Height/2 - DTextHeight/2;
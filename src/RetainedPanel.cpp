@@ -0,0 +1,109 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+*
+* @class CRetainedPanel
+*
+* @brief Keeps the rendered contents of a UI panel in a transparent surface
+*        between frames. The owner describes everything the panel depends on
+*        as a key; the panel only has to be redrawn when the key changes,
+*        otherwise drawing it is a single surface copy.
+*
+*/
+
+#include "RetainedPanel.h"
+#include "GraphicFactory.h"
+
+unsigned int CRetainedPanel::DCurrentGeneration = 0;
+
+/**
+* A CRetainedPanel object constructor, the panel starts out invalid
+*
+*/
+
+CRetainedPanel::CRetainedPanel(){
+    DValid = false;
+    DGeneration = DCurrentGeneration;
+}
+
+/**
+* Checks the panel against its current inputs. If the size or key differ from
+* the last rendered contents the surface is cleared and the key is stored, the
+* caller must then render the panel into Surface().
+*
+* @param[in] width The width of the panel
+* @param[in] height The height of the panel
+* @param[in] key The values the panel contents depend on
+*
+* @return true if the panel must be redrawn
+*
+*/
+
+bool CRetainedPanel::Update(int width, int height, const std::vector< int > &key){
+    if(DValid && (DGeneration == DCurrentGeneration) && (DSurface->Width() == width) && (DSurface->Height() == height) && (DKey == key)){
+        return false;
+    }
+    if(!DSurface || (DSurface->Width() != width) || (DSurface->Height() != height)){
+        DSurface = CGraphicFactory::CreateSurface(width, height, CGraphicSurface::ESurfaceFormat::ARGB32);
+    }
+    DSurface->Clear();
+    DKey = key;
+    DValid = true;
+    DGeneration = DCurrentGeneration;
+    return true;
+}
+
+/**
+* Forces the next Update to request a redraw
+*
+* @return void
+*
+*/
+
+void CRetainedPanel::Invalidate(){
+    DValid = false;
+}
+
+/**
+* Forces the next Update of every panel to request a redraw, used when the
+* tilesets or fonts they were drawn with have been reloaded
+*
+* @return void
+*
+*/
+
+void CRetainedPanel::InvalidateAll(){
+    DCurrentGeneration++;
+}
+
+/**
+* Draws the retained contents onto a surface
+*
+* @param[in] surface The surface to draw the panel onto
+* @param[in] xpos The x position of the panel on the surface
+* @param[in] ypos The y position of the panel on the surface
+*
+* @return void
+*
+*/
+
+void CRetainedPanel::Draw(std::shared_ptr< CGraphicSurface > surface, int xpos, int ypos){
+    if(DValid){
+        surface->Draw(DSurface, xpos, ypos, -1, -1, 0, 0);
+    }
+}
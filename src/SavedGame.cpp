@@ -0,0 +1,1156 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CSavedGame
+*
+* @brief Writes and reads saved games. The text format is the one the in
+*     game menu has always written, one commented value per line. The binary
+*     format holds the same state in chunks, each a four character tag, its
+*     length and its payload, after a magic number and a version:
+*
+*         GAME    player colors and types, game cycle, asset id count
+*         TERR    map name, size and the terrain partials run length encoded
+*         VISI    the local player's visibility map run length encoded
+*         GROW    the growth map
+*         ASET    one record per asset, keyed by its asset id
+*         PLYR    player resources, upgrades and the commands of their assets
+*         GRUP    the unit groups as asset ids
+*         RAND    the state of the game's random number generator
+*
+*     Numbers are varints, signed ones zigzag encoded. Readers skip chunks
+*     they do not know, so chunks can be added without a new version. The
+*     visibility map and the queued commands are encoded field by field, the
+*     commands from the records CPlayerAsset::SaveCommands fills in.
+*
+*/
+
+#include "SavedGame.h"
+#include "ApplicationData.h"
+#include "AssetDecoratedMap.h"
+#include "FileDataSink.h"
+#include "GameModel.h"
+#include "MainMenuMode.h"
+#include "MemoryDataSource.h"
+#include "PlayerAsset.h"
+#include "VisibilityMap.h"
+#include "Debug.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SAVED_GAME_TAG_SIZE         4
+
+typedef struct{
+    int DAssetID;
+    uint64_t DColor;
+    std::string DTypeName;
+    int DCreationCycle;
+    int DHitPoints;
+    int DGold;
+    int DLumber;
+    int DStone;
+    int DStep;
+    int DMoveRemainderX;
+    int DMoveRemainderY;
+    int DTilePositionX;
+    int DTilePositionY;
+    uint64_t DDirection;
+    std::vector< EAssetCapabilityType > DCapabilities;
+    std::vector< int > DPeasants;
+} SSavedGameAsset;
+
+typedef struct{
+    bool DIsAI;
+    int DGold;
+    int DLumber;
+    int DStone;
+    std::vector< std::string > DUpgrades;
+    std::vector< std::pair< int, std::vector< SSavedAssetCommand > > > DCommands;
+} SSavedGamePlayer;
+
+/**
+* Reads the values written by the SavedGameAppend functions out of a chunk,
+* once a read runs past the end of the chunk every later read returns 0 and
+* Valid() is false.
+*
+*/
+
+class CSavedGameReader{
+    protected:
+        const std::string &DData;
+        size_t DOffset;
+        size_t DEnd;
+        bool DValid;
+
+    public:
+        CSavedGameReader(const std::string &data, size_t offset, size_t length) : DData(data){
+            DOffset = offset;
+            DEnd = std::min(data.size(), offset + length);
+            DValid = offset <= DEnd;
+        };
+
+        bool Valid() const{
+            return DValid;
+        };
+        size_t Offset() const{
+            return DOffset;
+        };
+
+        uint64_t Varint();
+        int Int();
+        std::string String();
+        bool Runs(std::vector< uint8_t > &values, size_t count);
+};
+
+/**
+* Reads an unsigned varint.
+*
+* @return The value, 0 if the chunk is too short
+*
+*/
+
+uint64_t CSavedGameReader::Varint(){
+    uint64_t Value = 0;
+
+    for(int Shift = 0; DValid && (64 > Shift); Shift += 7){
+        if(DOffset >= DEnd){
+            break;
+        }
+        uint8_t Byte = DData[DOffset++];
+
+        Value |= (uint64_t)(Byte & 0x7F) << Shift;
+        if(!(Byte & 0x80)){
+            return Value;
+        }
+    }
+    DValid = false;
+    return 0;
+}
+
+/**
+* Reads a zigzag encoded signed varint.
+*
+* @return The value, 0 if the chunk is too short
+*
+*/
+
+int CSavedGameReader::Int(){
+    uint64_t Value = Varint();
+
+    return (int)(int64_t)((Value >> 1) ^ (~(Value & 1) + 1));
+}
+
+/**
+* Reads a length prefixed string.
+*
+* @return The string, empty if the chunk is too short
+*
+*/
+
+std::string CSavedGameReader::String(){
+    uint64_t Length = Varint();
+
+    if(!DValid || (Length > DEnd - DOffset)){
+        DValid = false;
+        return "";
+    }
+    DOffset += Length;
+    return DData.substr(DOffset - Length, Length);
+}
+
+/**
+* Reads run length encoded bytes.
+*
+* @param[out] values The decoded bytes
+* @param[in] count The number of bytes that were encoded
+*
+* @return true if exactly count bytes were decoded
+*
+*/
+
+bool CSavedGameReader::Runs(std::vector< uint8_t > &values, size_t count){
+    values.clear();
+    values.reserve(count);
+    while(DValid && (values.size() < count)){
+        uint64_t Length = Varint();
+
+        if(!Length || (Length > count - values.size()) || (DOffset >= DEnd)){
+            DValid = false;
+            break;
+        }
+        values.insert(values.end(), Length, (uint8_t)DData[DOffset++]);
+    }
+    return DValid;
+}
+
+/**
+* Appends an unsigned varint, seven bits per byte with the high bit set on all
+* but the last byte.
+*
+* @param[in,out] data The data to append to
+* @param[in] value The value to append
+*
+* @return void
+*
+*/
+
+static void SavedGameAppendVarint(std::string &data, uint64_t value){
+    while(0x80 <= value){
+        data += (char)(0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+    data += (char)value;
+}
+
+/**
+* Appends a signed value zigzag encoded, so small negative values stay short.
+*
+* @param[in,out] data The data to append to
+* @param[in] value The value to append
+*
+* @return void
+*
+*/
+
+static void SavedGameAppendInt(std::string &data, int value){
+    SavedGameAppendVarint(data, ((uint64_t)(int64_t)value << 1) ^ (uint64_t)((int64_t)value >> 63));
+}
+
+/**
+* Appends a length prefixed string.
+*
+* @param[in,out] data The data to append to
+* @param[in] value The string to append
+*
+* @return void
+*
+*/
+
+static void SavedGameAppendString(std::string &data, const std::string &value){
+    SavedGameAppendVarint(data, value.length());
+    data += value;
+}
+
+/**
+* Appends bytes run length encoded as pairs of run length and byte.
+*
+* @param[in,out] data The data to append to
+* @param[in] values The bytes to append
+*
+* @return void
+*
+*/
+
+static void SavedGameAppendRuns(std::string &data, const std::vector< uint8_t > &values){
+    for(size_t Index = 0; Index < values.size(); ){
+        size_t End = Index + 1;
+
+        while((End < values.size()) && (values[End] == values[Index])){
+            End++;
+        }
+        SavedGameAppendVarint(data, End - Index);
+        data += (char)values[Index];
+        Index = End;
+    }
+}
+
+/**
+* Appends a chunk.
+*
+* @param[in,out] data The saved game to append to
+* @param[in] tag The four character tag of the chunk
+* @param[in] payload The contents of the chunk
+*
+* @return void
+*
+*/
+
+static void SavedGameAppendChunk(std::string &data, const char *tag, const std::string &payload){
+    data.append(tag, SAVED_GAME_TAG_SIZE);
+    SavedGameAppendVarint(data, payload.length());
+    data += payload;
+}
+
+/**
+* Runs one of the text serializers into a string, they all write to an
+* std::ofstream so its stream buffer is swapped for a string buffer.
+*
+* @param[in] save The serializer to run
+*
+* @return The text written
+*
+*/
+
+static std::string SavedGameCaptureText(const std::function< void(std::ofstream &) > &save){
+    std::stringbuf Buffer;
+    std::ofstream Stream;
+
+    static_cast< std::ostream & >(Stream).rdbuf(&Buffer);
+    save(Stream);
+    Stream.flush();
+    return Buffer.str();
+}
+
+/**
+* Wraps a string in a data source for the text loaders.
+*
+* @param[in] text The text to read
+*
+* @return The data source
+*
+*/
+
+static std::shared_ptr< CDataSource > SavedGameTextSource(const std::string &text){
+    return std::make_shared< CMemoryDataSource >(std::vector< char >(text.begin(), text.end()));
+}
+
+/**
+* Writes the game as text, the format loaded by CMainMenuMode::LoadSavedGame.
+*
+* @param[in] context The game to save
+* @param[out] save The stream to write to
+*
+* @return void
+*
+*/
+
+void CSavedGame::SaveText(std::shared_ptr< CApplicationData > context, std::ofstream &save){
+    // save all player colors, used to recreate DGameModel
+    for(int i = 0; i < to_underlying(EPlayerColor::Max); i++){
+        save << "#Player Colors\n";
+        save << to_underlying(context->DLoadingPlayerColors[i]) << std::endl;
+
+        save << "#Player Types\n";
+        save << to_underlying(context->DLoadingPlayerTypes[i]) << std::endl;
+    }
+
+    // DGameModel
+
+    // std::shared_ptr< CAssetDecoratedMap > DActualMap;
+    context->DGameModel->Map()->SaveMap(save);
+
+    context->DGameModel->Player(context->DPlayerColor)->VisibilityMap()->SaveMap(save);
+
+    context->DGameModel->SaveGrowthMap(save);
+
+    // int DGameCycle;
+    save << "#GameCycle\n";
+    save << context->DGameModel->GameCycle() << "\n";
+
+    // get actual number of assets in map
+    save << "#AssetMap Size\n";
+    save << GAssetIDMap.size() << std::endl;
+
+    for(auto Asset : GAssetIDMap){
+        // int DAssetID;
+        save << "#Asset ID\n";
+        save << Asset.second->AssetID() << std::endl;
+
+        save << "#Color\n";
+        save << to_underlying(Asset.second->Color()) << std::endl;
+
+        // std::shared_ptr< CPlayerAssetType > DType;
+        // NOTE: when loading, use CPlayerAssetType::DRegistry to fine the right type
+        save << "#Type\n";
+        save << Asset.second->AssetType()->Name() << std::endl;
+
+        // int DCreationCycle;
+        save << "#CreationCyCle\n";
+        save << Asset.second->CreationCycle() << std::endl;
+
+        // int DHitPoints;
+        save << "#HitPoint\n";
+        save << Asset.second->HitPoints() << std::endl;
+
+        // int DGold;
+        save << "#Gold\n";
+        save << Asset.second->Gold() << std::endl;
+
+        // int DLumber;
+        save << "#Lumber\n";
+        save << Asset.second->Lumber() << std::endl;
+
+        // int DStone;
+        save << "#Stone\n";
+        save << Asset.second->Stone() << std::endl;
+
+        // int DStep;
+        save << "#Step\n";
+        save << Asset.second->Step() << std::endl;
+
+
+        // int DMoveRemainderX;
+        save << "#Move Remainder X\n";
+        save << Asset.second->MoveRemainderX() << std::endl;
+
+        // int DMoveRemainderY;
+        save << "#Move Remainder Y\n";
+        save << Asset.second->MoveRemainderY() << std::endl;
+
+        // CPixelPosition DPosition;
+        // X
+        save << "#TilePosition X\n";
+        save << Asset.second->TilePositionX() << std::endl;
+        // Y
+        save << "#TilePosition Y\n";
+        save << Asset.second->TilePositionY() << std::endl;
+
+        // EDirection DDirection;
+        save << "#Direction\n";
+        save << to_underlying(Asset.second->Direction()) << std::endl;
+
+        save << "#Capabilities size\n";
+
+        auto Capabilities = Asset.second->AssetType()->Capabilities();
+        save << Capabilities.size() << std::endl;
+
+        save << "#Capabilities\n";
+        for(int i = 0; i < Capabilities.size(); i++){
+            save << to_underlying(Capabilities[i]) << std::endl;
+        }
+
+        Asset.second->SavePeasants(save);
+    }
+
+    // get max asset count
+    save << "#AssetCount\n";
+    save << GAssetIDCount << std::endl;
+
+    //DPlayers
+    for(auto PlayerColor : context->DLoadingPlayerColors){
+        std::shared_ptr<CPlayerData> Player = context->DGameModel->Player(PlayerColor);
+
+        save << "#AI\n";
+        save << Player->IsAI() << std::endl;
+        save << "#Gold\n";
+        save << Player->Gold() << std::endl;
+        save << "#Lumber\n";
+        save << Player->Lumber() << std::endl;
+        save << "#Stone\n";
+        save << Player->Stone() << std::endl;
+
+        // std::vector< bool > DUpgrades;
+        save << "#Player Upgrades\n";
+        for(int i = 0; i < to_underlying(EAssetCapabilityType::Max); i++){
+            save << Player->HasUpgrade(static_cast<EAssetCapabilityType>(i)) << "\n";
+        }
+
+        // std::list< std::weak_ptr< CPlayerAsset > > DAssets;
+        save << "#WeakAssetCount\n";
+        save << Player->Assets().size() << std::endl;
+
+        for(auto WeakAsset : Player->Assets()){
+            auto Asset = WeakAsset.lock();
+
+            // store ID for loading
+            save << "#AssetID\n";
+            save << Asset->AssetID() << '\n';
+
+            Asset->SaveCommands(save, PlayerColor);
+        }
+    }
+
+    // unit groups
+    for(int i = SGUIKeyType::Key0; i <= SGUIKeyType::Key9; i++){
+        save << "#Unit grouping" << i << " size\n";
+        save << context->DGroupHotKeyMap[i].size() << std::endl;
+
+        if(context->DGroupHotKeyMap[i].size()){
+            for(auto Asset : context->DGroupHotKeyMap[i]){
+                save << Asset.lock()->AssetID() << std::endl;
+            }
+        }
+    }
+
+}
+
+/**
+* Writes the game as text into a string.
+*
+* @param[in] context The game to save
+*
+* @return The saved game as text
+*
+*/
+
+std::string CSavedGame::SaveText(std::shared_ptr< CApplicationData > context){
+    return SavedGameCaptureText([&](std::ofstream &save){
+        SaveText(context, save);
+    });
+}
+
+/**
+* Gives the saved game access to the tiles of a visibility map, so the VISI
+* chunk is encoded from and decoded into the tiles directly.
+*
+*/
+
+class CSavedGameVisibilityMap : public CVisibilityMap{
+    public:
+        CSavedGameVisibilityMap(const CVisibilityMap &map) : CVisibilityMap(map){};
+        CSavedGameVisibilityMap(int width, int height, int maxvisibility) : CVisibilityMap(width, height, maxvisibility){};
+
+        std::string Save() const;
+        static std::shared_ptr< CSavedGameVisibilityMap > Load(CSavedGameReader &reader, int mapwidth, int mapheight);
+};
+
+/**
+* Encodes the visibility map for the VISI chunk, the tiles run length encoded.
+*
+* @return The chunk payload
+*
+*/
+
+std::string CSavedGameVisibilityMap::Save() const{
+    std::vector< uint8_t > Cells;
+    std::string Chunk;
+    size_t Width = DMap.empty() ? 0 : DMap[0].size();
+
+    SavedGameAppendInt(Chunk, DMaxVisibility);
+    SavedGameAppendVarint(Chunk, DMap.size());
+    SavedGameAppendVarint(Chunk, Width);
+    Cells.reserve(DMap.size() * Width);
+    for(auto &Row : DMap){
+        for(auto Cell : Row){
+            Cells.push_back(to_underlying(Cell));
+        }
+    }
+    SavedGameAppendRuns(Chunk, Cells);
+    SavedGameAppendInt(Chunk, DUnseenTiles);
+    return Chunk;
+}
+
+/**
+* Decodes the VISI chunk.
+*
+* @param[in] reader The reader of the chunk
+* @param[in] mapwidth The width of the map the visibility is for
+* @param[in] mapheight The height of the map the visibility is for
+*
+* @return The visibility map, nullptr if the chunk is corrupt or does not fit
+*     the map
+*
+*/
+
+std::shared_ptr< CSavedGameVisibilityMap > CSavedGameVisibilityMap::Load(CSavedGameReader &reader, int mapwidth, int mapheight){
+    std::vector< uint8_t > Cells;
+    int MaxVisibility = reader.Int();
+    size_t Height = reader.Varint();
+    size_t Width = reader.Varint();
+
+    if(!reader.Valid() || (0 > MaxVisibility) || (Height != (size_t)mapheight + 2 * MaxVisibility) || (Width != (size_t)mapwidth + 2 * MaxVisibility) || !reader.Runs(Cells, Height * Width)){
+        return nullptr;
+    }
+    auto Map = std::make_shared< CSavedGameVisibilityMap >(mapwidth, mapheight, MaxVisibility);
+
+    for(size_t Row = 0; Row < Height; Row++){
+        for(size_t Column = 0; Column < Width; Column++){
+            Map->DMap[Row][Column] = static_cast< ETileVisibility >(Cells[Row * Width + Column]);
+        }
+    }
+    Map->DUnseenTiles = reader.Int();
+    return reader.Valid() ? Map : nullptr;
+}
+
+/**
+* Appends a queued command and its activated capability field by field.
+*
+* @param[in,out] data The data to append to
+* @param[in] command The command as saved by CPlayerAsset::SaveCommands
+*
+* @return void
+*
+*/
+
+static void SavedGameAppendCommand(std::string &data, const SSavedAssetCommand &command){
+    auto &Capability = command.DActivatedCapability;
+
+    SavedGameAppendInt(data, command.DPlayerColor);
+    SavedGameAppendVarint(data, to_underlying(command.DAction));
+    SavedGameAppendVarint(data, to_underlying(command.DCapability));
+    SavedGameAppendVarint(data, command.DHasTarget);
+    SavedGameAppendInt(data, command.DTargetID);
+    SavedGameAppendInt(data, command.DTargetX);
+    SavedGameAppendInt(data, command.DTargetY);
+    SavedGameAppendString(data, Capability.DType);
+    SavedGameAppendInt(data, Capability.DActor);
+    SavedGameAppendInt(data, Capability.DPlayerColor);
+    SavedGameAppendInt(data, Capability.DTarget);
+    SavedGameAppendString(data, Capability.DOriginalType);
+    SavedGameAppendString(data, Capability.DUpgradingType);
+    SavedGameAppendString(data, Capability.DUpgradeName);
+    SavedGameAppendInt(data, Capability.DCurrentStep);
+    SavedGameAppendInt(data, Capability.DTotalSteps);
+    SavedGameAppendInt(data, Capability.DLumber);
+    SavedGameAppendInt(data, Capability.DGold);
+    SavedGameAppendInt(data, Capability.DStone);
+}
+
+/**
+* Reads a command written by SavedGameAppendCommand.
+*
+* @param[in] reader The reader of the chunk
+* @param[out] command The command
+*
+* @return true if the command was read and its action and capability are known
+*
+*/
+
+static bool SavedGameReadCommand(CSavedGameReader &reader, SSavedAssetCommand &command){
+    auto &Capability = command.DActivatedCapability;
+    uint64_t Action, CapabilityType;
+
+    command.DPlayerColor = reader.Int();
+    Action = reader.Varint();
+    CapabilityType = reader.Varint();
+    command.DAction = static_cast< EAssetAction >(Action);
+    command.DCapability = static_cast< EAssetCapabilityType >(CapabilityType);
+    command.DHasTarget = reader.Varint();
+    command.DTargetID = reader.Int();
+    command.DTargetX = reader.Int();
+    command.DTargetY = reader.Int();
+    Capability.DType = reader.String();
+    Capability.DActor = reader.Int();
+    Capability.DPlayerColor = reader.Int();
+    Capability.DTarget = reader.Int();
+    Capability.DOriginalType = reader.String();
+    Capability.DUpgradingType = reader.String();
+    Capability.DUpgradeName = reader.String();
+    Capability.DCurrentStep = reader.Int();
+    Capability.DTotalSteps = reader.Int();
+    Capability.DLumber = reader.Int();
+    Capability.DGold = reader.Int();
+    Capability.DStone = reader.Int();
+    return reader.Valid() && ((uint64_t)to_underlying(EAssetAction::Shelter) >= Action) && ((uint64_t)to_underlying(EAssetCapabilityType::Max) > CapabilityType);
+}
+
+/**
+* Encodes the game in the binary format.
+*
+* @param[in] context The game to save
+*
+* @return The saved game
+*
+*/
+
+std::string CSavedGame::SaveBinary(std::shared_ptr< CApplicationData > context){
+    std::string Data(SAVED_GAME_MAGIC, SAVED_GAME_MAGIC_SIZE);
+    std::string Chunk;
+    std::vector< SSavedAssetCommand > Commands;
+    auto Map = context->DGameModel->Map();
+
+    SavedGameAppendVarint(Data, SAVED_GAME_VERSION);
+
+    SavedGameAppendVarint(Chunk, to_underlying(EPlayerColor::Max));
+    for(int Index = 0; Index < to_underlying(EPlayerColor::Max); Index++){
+        SavedGameAppendVarint(Chunk, to_underlying(context->DLoadingPlayerColors[Index]));
+        SavedGameAppendVarint(Chunk, to_underlying(context->DLoadingPlayerTypes[Index]));
+    }
+    SavedGameAppendInt(Chunk, context->DGameModel->GameCycle());
+    SavedGameAppendInt(Chunk, GAssetIDCount);
+    SavedGameAppendChunk(Data, "GAME", Chunk);
+
+    Chunk.clear();
+    SavedGameAppendString(Chunk, Map->MapName());
+    SavedGameAppendVarint(Chunk, Map->Width());
+    SavedGameAppendVarint(Chunk, Map->Height());
+    SavedGameAppendRuns(Chunk, Map->TerrainPartials());
+    SavedGameAppendChunk(Data, "TERR", Chunk);
+
+    SavedGameAppendChunk(Data, "VISI", CSavedGameVisibilityMap(*context->DGameModel->Player(context->DPlayerColor)->VisibilityMap()).Save());
+
+    Chunk.clear();
+    SavedGameAppendVarint(Chunk, context->DGameModel->GrowthMap().size());
+    for(auto &Growth : context->DGameModel->GrowthMap()){
+        SavedGameAppendInt(Chunk, Growth.first.first);
+        SavedGameAppendInt(Chunk, Growth.first.second);
+        SavedGameAppendInt(Chunk, Growth.second);
+    }
+    SavedGameAppendChunk(Data, "GROW", Chunk);
+
+    Chunk.clear();
+    SavedGameAppendVarint(Chunk, GAssetIDMap.size());
+    for(auto &AssetID : GAssetIDMap){
+        auto Asset = AssetID.second;
+        auto Capabilities = Asset->AssetType()->Capabilities();
+
+        SavedGameAppendInt(Chunk, Asset->AssetID());
+        SavedGameAppendVarint(Chunk, to_underlying(Asset->Color()));
+        SavedGameAppendString(Chunk, Asset->AssetType()->Name());
+        SavedGameAppendInt(Chunk, Asset->CreationCycle());
+        SavedGameAppendInt(Chunk, Asset->HitPoints());
+        SavedGameAppendInt(Chunk, Asset->Gold());
+        SavedGameAppendInt(Chunk, Asset->Lumber());
+        SavedGameAppendInt(Chunk, Asset->Stone());
+        SavedGameAppendInt(Chunk, Asset->Step());
+        SavedGameAppendInt(Chunk, Asset->MoveRemainderX());
+        SavedGameAppendInt(Chunk, Asset->MoveRemainderY());
+        SavedGameAppendInt(Chunk, Asset->TilePositionX());
+        SavedGameAppendInt(Chunk, Asset->TilePositionY());
+        SavedGameAppendVarint(Chunk, to_underlying(Asset->Direction()));
+        SavedGameAppendVarint(Chunk, Capabilities.size());
+        for(auto Capability : Capabilities){
+            SavedGameAppendVarint(Chunk, to_underlying(Capability));
+        }
+        SavedGameAppendVarint(Chunk, Asset->Peasants().size());
+        for(auto Peasant : Asset->Peasants()){
+            SavedGameAppendInt(Chunk, Peasant);
+        }
+    }
+    SavedGameAppendChunk(Data, "ASET", Chunk);
+
+    Chunk.clear();
+    SavedGameAppendVarint(Chunk, context->DLoadingPlayerColors.size());
+    for(auto PlayerColor : context->DLoadingPlayerColors){
+        std::shared_ptr< CPlayerData > Player = context->DGameModel->Player(PlayerColor);
+
+        SavedGameAppendVarint(Chunk, Player->IsAI());
+        SavedGameAppendInt(Chunk, Player->Gold());
+        SavedGameAppendInt(Chunk, Player->Lumber());
+        SavedGameAppendInt(Chunk, Player->Stone());
+        SavedGameAppendVarint(Chunk, to_underlying(EAssetCapabilityType::Max));
+        for(int Index = 0; Index < to_underlying(EAssetCapabilityType::Max); Index++){
+            SavedGameAppendVarint(Chunk, Player->HasUpgrade(static_cast< EAssetCapabilityType >(Index)));
+        }
+        SavedGameAppendVarint(Chunk, Player->Assets().size());
+        for(auto WeakAsset : Player->Assets()){
+            auto Asset = WeakAsset.lock();
+
+            SavedGameAppendInt(Chunk, Asset->AssetID());
+            Asset->SaveCommands(Commands, PlayerColor);
+            SavedGameAppendVarint(Chunk, Commands.size());
+            for(auto &Command : Commands){
+                SavedGameAppendCommand(Chunk, Command);
+            }
+        }
+    }
+    SavedGameAppendChunk(Data, "PLYR", Chunk);
+
+    Chunk.clear();
+    SavedGameAppendVarint(Chunk, SGUIKeyType::Key9 - SGUIKeyType::Key0 + 1);
+    for(int Index = SGUIKeyType::Key0; Index <= SGUIKeyType::Key9; Index++){
+        auto &Group = context->DGroupHotKeyMap[Index];
+
+        SavedGameAppendVarint(Chunk, Group.size());
+        for(auto &WeakAsset : Group){
+            SavedGameAppendInt(Chunk, WeakAsset.lock()->AssetID());
+        }
+    }
+    SavedGameAppendChunk(Data, "GRUP", Chunk);
+
+    Chunk.clear();
+    SavedGameAppendVarint(Chunk, context->DGameModel->RandomState());
+    SavedGameAppendChunk(Data, "RAND", Chunk);
+    return Data;
+}
+
+/**
+* Writes a saved game to a file. The file is written under a temporary name
+* and renamed, so a failed save never leaves a truncated saved game behind.
+*
+* @param[in] data The saved game
+* @param[in] filename The file to write
+* @param[in] sync Whether to sync the file to disk before renaming it
+*
+* @return true if the file was written
+*
+*/
+
+bool CSavedGame::Write(const std::string &data, const std::string &filename, bool sync){
+    std::string TempName = filename + ".tmp";
+    bool Success = true;
+
+    unlink(TempName.c_str());
+    {
+        CFileDataSink Sink(TempName);
+        size_t Written = 0;
+
+        while(Success && (Written < data.size())){
+            int Length = Sink.Write(data.data() + Written, data.size() - Written);
+
+            Success = 0 < Length;
+            Written += Success ? Length : 0;
+        }
+        if(Success && sync){
+            Success = Sink.Sync();
+        }
+    }
+    if(!Success || (0 != rename(TempName.c_str(), filename.c_str()))){
+        PrintError("Failed to write saved game %s.\n", filename.c_str());
+        unlink(TempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+* Picks the most recently written of several saved games, so the load button
+* finds an autosave that is newer than the last manual save.
+*
+* @param[in] filenames The saved games to choose from
+*
+* @return The newest file that exists, empty if none does
+*
+*/
+
+std::string CSavedGame::NewestFile(const std::vector< std::string > &filenames){
+    std::string Newest;
+    time_t NewestTime = 0;
+
+    for(auto &FileName : filenames){
+        struct stat FileStat;
+
+        if((0 == stat(FileName.c_str(), &FileStat)) && (Newest.empty() || (FileStat.st_mtime > NewestTime))){
+            Newest = FileName;
+            NewestTime = FileStat.st_mtime;
+        }
+    }
+    return Newest;
+}
+
+/**
+* Checks if a saved game is in the binary format.
+*
+* @param[in] data The saved game
+*
+* @return true if it starts with the binary magic number
+*
+*/
+
+bool CSavedGame::IsBinary(const std::string &data){
+    return (SAVED_GAME_MAGIC_SIZE <= data.size()) && (0 == memcmp(data.data(), SAVED_GAME_MAGIC, SAVED_GAME_MAGIC_SIZE));
+}
+
+/**
+* Loads a saved game in either format.
+*
+* @param[in] context The game to load into
+* @param[in] source The saved game
+*
+* @return true if the saved game was loaded
+*
+*/
+
+bool CSavedGame::Load(std::shared_ptr< CApplicationData > context, std::shared_ptr< CDataSource > source){
+    std::string Data;
+    char Buffer[4096];
+    int Length;
+
+    if(nullptr == source){
+        return false;
+    }
+    while(0 < (Length = source->Read(Buffer, sizeof(Buffer)))){
+        Data.append(Buffer, Length);
+    }
+    if(IsBinary(Data)){
+        return LoadBinary(context, Data);
+    }
+    return CMainMenuMode::LoadSavedGame(context, SavedGameTextSource(Data));
+}
+
+/**
+* Loads a saved game in the binary format. The steps are the same as the
+* text loader in CMainMenuMode::LoadSavedGame so both restore the same game.
+* Every chunk is decoded and checked before anything is changed, so a corrupt
+* saved game leaves the running game as it was.
+*
+* @param[in] context The game to load into
+* @param[in] data The saved game
+*
+* @return true if the saved game was loaded
+*
+*/
+
+bool CSavedGame::LoadBinary(std::shared_ptr< CApplicationData > context, const std::string &data){
+    std::map< std::string, std::pair< size_t, size_t > > Chunks;
+    std::array< EPlayerColor, to_underlying(EPlayerColor::Max)> Colors;
+    std::array< CApplicationData::EPlayerType, to_underlying(EPlayerColor::Max)> Types;
+    std::vector< uint8_t > Partials;
+    std::string MapName;
+    int GameCycle, AssetIDCount, MapIndex;
+
+    if(!IsBinary(data)){
+        return false;
+    }
+    CSavedGameReader Header(data, SAVED_GAME_MAGIC_SIZE, data.size());
+    uint64_t Version = Header.Varint();
+    if(!Header.Valid() || !Version || (SAVED_GAME_VERSION < Version)){
+        PrintError("Saved game version %d is not supported.\n", (int)Version);
+        return false;
+    }
+    for(size_t Offset = Header.Offset(); Offset < data.size(); ){
+        if(Offset + SAVED_GAME_TAG_SIZE > data.size()){
+            PrintError("Saved game is truncated.\n");
+            return false;
+        }
+        CSavedGameReader ChunkHeader(data, Offset + SAVED_GAME_TAG_SIZE, data.size());
+        uint64_t Size = ChunkHeader.Varint();
+
+        if(!ChunkHeader.Valid() || (Size > data.size() - ChunkHeader.Offset())){
+            PrintError("Saved game is truncated.\n");
+            return false;
+        }
+        Chunks[data.substr(Offset, SAVED_GAME_TAG_SIZE)] = std::make_pair(ChunkHeader.Offset(), (size_t)Size);
+        Offset = ChunkHeader.Offset() + Size;
+    }
+    for(auto Tag : {"GAME", "TERR", "VISI", "GROW", "ASET", "PLYR", "GRUP"}){
+        if(Chunks.end() == Chunks.find(Tag)){
+            PrintError("Saved game is missing its %s chunk.\n", Tag);
+            return false;
+        }
+    }
+    auto ChunkReader = [&](const char *tag){
+        return CSavedGameReader(data, Chunks[tag].first, Chunks[tag].second);
+    };
+
+    CSavedGameReader Game = ChunkReader("GAME");
+    if(to_underlying(EPlayerColor::Max) != Game.Varint()){
+        PrintError("Saved game has a different number of players.\n");
+        return false;
+    }
+    for(int Index = 0; Index < to_underlying(EPlayerColor::Max); Index++){
+        uint64_t Color = Game.Varint();
+        uint64_t Type = Game.Varint();
+
+        if((to_underlying(EPlayerColor::Max) <= Color) || (CApplicationData::ptAIHard < Type)){
+            PrintError("Saved game has an invalid player.\n");
+            return false;
+        }
+        Colors[Index] = static_cast< EPlayerColor >(Color);
+        Types[Index] = static_cast< CApplicationData::EPlayerType >(Type);
+    }
+    GameCycle = Game.Int();
+    AssetIDCount = Game.Int();
+
+    CSavedGameReader Terrain = ChunkReader("TERR");
+    MapName = Terrain.String();
+    int Width = Terrain.Varint();
+    int Height = Terrain.Varint();
+    MapIndex = CAssetDecoratedMap::FindMapIndex(MapName);
+    auto OriginalMap = CAssetDecoratedMap::GetMap(MapIndex);
+    if(nullptr == OriginalMap){
+        PrintError("Saved game map %s was not found.\n", MapName.c_str());
+        return false;
+    }
+    auto TempMap = std::make_shared< CAssetDecoratedMap >(*OriginalMap);
+    if((Width != TempMap->Width()) || (Height != TempMap->Height()) || !Terrain.Runs(Partials, (Width + 1) * (Height + 1)) || !Game.Valid()){
+        PrintError("Saved game map %s is corrupt.\n", MapName.c_str());
+        return false;
+    }
+    CSavedGameReader VisibilityReader = ChunkReader("VISI");
+    auto Visibility = CSavedGameVisibilityMap::Load(VisibilityReader, Width, Height);
+    if(nullptr == Visibility){
+        PrintError("Saved game visibility is corrupt.\n");
+        return false;
+    }
+
+    CSavedGameReader Growth = ChunkReader("GROW");
+    std::map< std::pair< int, int >, int > GrowthMap;
+    for(uint64_t Count = Growth.Varint(); Growth.Valid() && Count; Count--){
+        int Column = Growth.Int();
+        int Row = Growth.Int();
+
+        GrowthMap[std::make_pair(Column, Row)] = Growth.Int();
+    }
+
+    CSavedGameReader Assets = ChunkReader("ASET");
+    std::vector< SSavedGameAsset > SavedAssets;
+    for(uint64_t Count = Assets.Varint(); Assets.Valid() && Count; Count--){
+        SSavedGameAsset Asset;
+
+        Asset.DAssetID = Assets.Int();
+        Asset.DColor = Assets.Varint();
+        Asset.DTypeName = Assets.String();
+        Asset.DCreationCycle = Assets.Int();
+        Asset.DHitPoints = Assets.Int();
+        Asset.DGold = Assets.Int();
+        Asset.DLumber = Assets.Int();
+        Asset.DStone = Assets.Int();
+        Asset.DStep = Assets.Int();
+        Asset.DMoveRemainderX = Assets.Int();
+        Asset.DMoveRemainderY = Assets.Int();
+        Asset.DTilePositionX = Assets.Int();
+        Asset.DTilePositionY = Assets.Int();
+        Asset.DDirection = Assets.Varint();
+        for(uint64_t Capabilities = Assets.Varint(); Assets.Valid() && Capabilities; Capabilities--){
+            uint64_t Capability = Assets.Varint();
+
+            if((uint64_t)to_underlying(EAssetCapabilityType::Max) > Capability){
+                Asset.DCapabilities.push_back(static_cast< EAssetCapabilityType >(Capability));
+            }
+        }
+        for(uint64_t Peasants = Assets.Varint(); Assets.Valid() && Peasants; Peasants--){
+            Asset.DPeasants.push_back(Assets.Int());
+        }
+        if(Assets.Valid() && (((uint64_t)to_underlying(EPlayerColor::Max) <= Asset.DColor) || ((uint64_t)to_underlying(EDirection::Max) <= Asset.DDirection) || (nullptr == CPlayerAssetType::FindDefaultFromName(Asset.DTypeName)))){
+            PrintError("Saved game asset of type %s could not be created.\n", Asset.DTypeName.c_str());
+            return false;
+        }
+        SavedAssets.push_back(Asset);
+    }
+
+    CSavedGameReader Players = ChunkReader("PLYR");
+    std::vector< SSavedGamePlayer > SavedPlayers;
+    uint64_t PlayerCount = Players.Varint();
+    for(size_t Index = 0; Players.Valid() && (Index < PlayerCount) && (Index < context->DLoadingPlayerColors.size()); Index++){
+        SSavedGamePlayer Player;
+
+        Player.DIsAI = Players.Varint();
+        Player.DGold = Players.Int();
+        Player.DLumber = Players.Int();
+        Player.DStone = Players.Int();
+        uint64_t UpgradeCount = Players.Varint();
+        for(uint64_t Upgrade = 0; Players.Valid() && (Upgrade < UpgradeCount); Upgrade++){
+            if(Players.Varint() && (Upgrade < to_underlying(EAssetCapabilityType::Max))){
+                auto PlayerUpgrade = CPlayerUpgrade::FindUpgradeFromType(static_cast< EAssetCapabilityType >(Upgrade));
+
+                if(nullptr == PlayerUpgrade){
+                    PrintError("Saved game upgrade %d is unknown.\n", (int)Upgrade);
+                    return false;
+                }
+                Player.DUpgrades.push_back(PlayerUpgrade->Name());
+            }
+        }
+        for(uint64_t Count = Players.Varint(); Players.Valid() && Count; Count--){
+            std::pair< int, std::vector< SSavedAssetCommand > > AssetCommands;
+
+            AssetCommands.first = Players.Int();
+            for(uint64_t Commands = Players.Varint(); Players.Valid() && Commands; Commands--){
+                SSavedAssetCommand Command;
+
+                if(!SavedGameReadCommand(Players, Command)){
+                    PrintError("Saved game command is corrupt.\n");
+                    return false;
+                }
+                AssetCommands.second.push_back(Command);
+            }
+            Player.DCommands.push_back(AssetCommands);
+        }
+        SavedPlayers.push_back(Player);
+    }
+
+    CSavedGameReader Groups = ChunkReader("GRUP");
+    std::vector< std::vector< int > > SavedGroups;
+    uint64_t GroupCount = Groups.Varint();
+    for(uint64_t Group = 0; Groups.Valid() && (Group < GroupCount) && (Group <= (uint64_t)(SGUIKeyType::Key9 - SGUIKeyType::Key0)); Group++){
+        SavedGroups.push_back(std::vector< int >());
+        for(uint64_t Count = Groups.Varint(); Groups.Valid() && Count; Count--){
+            SavedGroups.back().push_back(Groups.Int());
+        }
+    }
+    if(!Assets.Valid() || !Players.Valid() || !Groups.Valid() || !Growth.Valid()){
+        PrintError("Saved game is corrupt.\n");
+        return false;
+    }
+    bool HasRandomState = false;
+    uint64_t RandomState = 0;
+    if(Chunks.end() != Chunks.find("RAND")){
+        CSavedGameReader Random = ChunkReader("RAND");
+
+        RandomState = Random.Varint();
+        HasRandomState = Random.Valid();
+    }
+
+    // everything decoded, only now is the running game replaced
+    CApplicationData::DLoadedGame = true;
+    context->DGameSessionType = CApplicationData::gstSinglePlayer;
+    context->DLoadingPlayerColors = Colors;
+    context->DLoadingPlayerTypes = Types;
+    context->DPlayerColor = context->DLoadingPlayerColors[1];
+    context->DSelectedMapIndex = MapIndex;
+
+    TempMap->TerrainPartials(Partials);
+    CAssetDecoratedMap::ReplaceMap(TempMap, context->DSelectedMapIndex);
+    context->DSelectedMap = CAssetDecoratedMap::DuplicateMap(context->DSelectedMapIndex, context->DLoadingPlayerColors);
+    context->LoadGameMap(context->DSelectedMapIndex, nullptr);
+    *context->DGameModel->Player(context->DPlayerColor)->VisibilityMap() = *Visibility;
+    context->DSoundLibraryMixer->PlaySong(context->DSoundLibraryMixer->FindSong("game1"), context->DMusicVolume);
+
+    context->DGameModel->GrowthMap(GrowthMap);
+    context->DGameModel->GameCycle(GameCycle);
+
+    for(auto &Saved : SavedAssets){
+        GAssetIDCount = Saved.DAssetID;
+        auto Asset = context->DGameModel->Player(static_cast< EPlayerColor >(Saved.DColor))->CreateAsset(Saved.DTypeName);
+
+        Asset->CreationCycle(Saved.DCreationCycle);
+        Asset->HitPoints(Saved.DHitPoints);
+        Asset->Gold(Saved.DGold);
+        Asset->Lumber(Saved.DLumber);
+        Asset->Stone(Saved.DStone);
+        Asset->Step(Saved.DStep);
+        Asset->MoveRemainderX(Saved.DMoveRemainderX);
+        Asset->MoveRemainderY(Saved.DMoveRemainderY);
+        Asset->TilePositionX(Saved.DTilePositionX);
+        Asset->TilePositionY(Saved.DTilePositionY);
+        Asset->Direction(static_cast< EDirection >(Saved.DDirection));
+        for(int Index = 0; Index < to_underlying(EAssetCapabilityType::Max); Index++){
+            Asset->AssetType()->RemoveCapability(static_cast< EAssetCapabilityType >(Index));
+        }
+        for(auto Capability : Saved.DCapabilities){
+            Asset->AssetType()->AddCapability(Capability);
+        }
+        for(auto Peasant : Saved.DPeasants){
+            Asset->PushPeasant(Peasant);
+            Asset->TakeSpace();
+        }
+    }
+    GAssetIDCount = AssetIDCount;
+
+    for(size_t Index = 0; Index < SavedPlayers.size(); Index++){
+        std::shared_ptr< CPlayerData > Player = context->DGameModel->Player(context->DLoadingPlayerColors[Index]);
+        auto &Saved = SavedPlayers[Index];
+
+        Player->IsAI(Saved.DIsAI);
+        Player->IncrementGold(Saved.DGold - Player->Gold());
+        Player->IncrementLumber(Saved.DLumber - Player->Lumber());
+        Player->IncrementStone(Saved.DStone - Player->Stone());
+        Player->GameCycle(context->DGameModel->GameCycle());
+        for(auto &Upgrade : Saved.DUpgrades){
+            Player->AddUpgrade(Upgrade);
+        }
+        for(auto &AssetCommands : Saved.DCommands){
+            auto Asset = FindAssetObj(AssetCommands.first);
+
+            if(Asset && AssetCommands.second.size()){
+                Asset->LoadCommands(AssetCommands.second, context->DGameModel->Players());
+            }
+        }
+    }
+
+    for(size_t Group = 0; Group < SavedGroups.size(); Group++){
+        auto &HotKeyGroup = context->DGroupHotKeyMap[SGUIKeyType::Key0 + Group];
+
+        HotKeyGroup.clear();
+        for(auto AssetID : SavedGroups[Group]){
+            auto Asset = FindAssetObj(AssetID);
+
+            if(Asset){
+                HotKeyGroup.push_back(Asset);
+            }
+        }
+    }
+    if(HasRandomState){
+        context->DGameModel->RandomState(RandomState);
+    }
+    CMainMenuMode::CenterViewport(context);
+    return true;
+}
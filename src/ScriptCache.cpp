@@ -0,0 +1,328 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CScriptCache
+*
+* @brief Keeps the compiled Lua chunk of each AI and event script. The AI
+*     and event handlers create a new Lua state for every call, so without
+*     the cache each call read and compiled the script again. Load compiles
+*     a script the first time it is used and afterwards loads the compiled
+*     chunk from memory. Scripts pulled in with require go through the same
+*     cache once InstallSearcher has been called on the state. Reload
+*     recompiles a single script after it changed on disk. The states made
+*     by NewState count their memory against Lua in CMemoryAccounting.
+*
+*/
+
+#include "ScriptCache.h"
+#include "Path.h"
+#include "MemoryAccounting.h"
+#include "Debug.h"
+#include <cstdlib>
+
+extern "C" {
+    #include "lua.h"
+    #include "lauxlib.h"
+    #include "lualib.h"
+}
+
+std::unordered_map< std::string, std::string > CScriptCache::DChunks;
+int CScriptCache::DCompileCount = 0;
+
+/**
+* Lua writer that appends the dumped chunk to a string
+*
+* @param[in] L The Lua state being dumped
+* @param[in] data The next piece of the chunk
+* @param[in] size The size of the piece
+* @param[in] chunk The string the chunk is appended to
+*
+* @return 0 to continue the dump
+*
+*/
+
+static int ScriptCacheWriter(lua_State */*L*/, const void *data, size_t size, void *chunk){
+    static_cast< std::string * >(chunk)->append(static_cast< const char * >(data), size);
+    return 0;
+}
+
+/**
+* Lua allocator that counts the memory of the state, Lua passes the type of
+* the object instead of the old size when block is nullptr. Only a new block
+* counts as an allocation, resizing a block changes the live bytes by the
+* difference.
+*
+* @param[in] userdata Not used
+* @param[in] block The block to resize or free, or nullptr
+* @param[in] oldsize The size of the block
+* @param[in] newsize The size wanted, 0 to free
+*
+* @return The resized block, or nullptr if freed or out of memory
+*
+*/
+
+static void *ScriptCacheAllocate(void */*userdata*/, void *block, size_t oldsize, size_t newsize){
+    void *NewBlock;
+
+    if(nullptr == block){
+        oldsize = 0;
+    }
+    if(0 == newsize){
+        free(block);
+        CMemoryAccounting::Free(EMemorySubsystem::Lua, oldsize);
+        return nullptr;
+    }
+    NewBlock = realloc(block, newsize);
+    if(nullptr == NewBlock){
+        return nullptr;
+    }
+    if(nullptr == block){
+        CMemoryAccounting::Allocate(EMemorySubsystem::Lua, newsize);
+    }
+    else if(newsize > oldsize){
+        CMemoryAccounting::Allocate(EMemorySubsystem::Lua, newsize - oldsize, 0);
+    }
+    else{
+        CMemoryAccounting::Free(EMemorySubsystem::Lua, oldsize - newsize);
+    }
+    return NewBlock;
+}
+
+/**
+* Lua panic function, prints the error of an unprotected call the same as
+* the default state does before Lua aborts
+*
+* @param[in] L The Lua state
+*
+* @return 0
+*
+*/
+
+static int ScriptCachePanic(lua_State *L){
+    PrintError("PANIC: unprotected error in call to Lua API (%s)\n", lua_tostring(L, -1));
+    return 0;
+}
+
+/**
+* Gets the cache key of a script, so that the different spellings of the
+* same path in the maps and in require calls find the same chunk
+*
+* @param[in] filename The path of the script
+*
+* @return The simplified absolute path of the script
+*
+*/
+
+std::string CScriptCache::Key(const std::string &filename){
+    return CPath::CurrentPath().Simplify(CPath(filename)).ToString();
+}
+
+/**
+* Creates a Lua state whose memory is counted, used in place of
+* luaL_newstate
+*
+* @return The new state, or nullptr if out of memory
+*
+*/
+
+lua_State *CScriptCache::NewState(){
+    lua_State *L = lua_newstate(ScriptCacheAllocate, nullptr);
+
+    if(nullptr != L){
+        lua_atpanic(L, ScriptCachePanic);
+    }
+    return L;
+}
+
+/**
+* Compiles a script and dumps the compiled chunk. The compiled function, or
+* the error message if it fails, is left on the stack.
+*
+* @param[in] L The Lua state to compile in
+* @param[in] filename The path of the script
+* @param[out] chunk The compiled chunk
+*
+* @return LUA_OK or the error of luaL_loadfile
+*
+*/
+
+int CScriptCache::Compile(lua_State *L, const std::string &filename, std::string &chunk){
+    int Status = luaL_loadfile(L, filename.c_str());
+
+    if(LUA_OK == Status){
+        chunk.clear();
+        lua_dump(L, ScriptCacheWriter, &chunk);
+        DCompileCount++;
+    }
+    return Status;
+}
+
+/**
+* Loads a script onto the stack of a Lua state like luaL_loadfile, from the
+* cache if it has been compiled before
+*
+* @param[in] L The Lua state to load into
+* @param[in] filename The path of the script
+*
+* @return LUA_OK or the error of the load
+*
+*/
+
+int CScriptCache::Load(lua_State *L, const std::string &filename){
+    std::string Name = Key(filename);
+    auto Search = DChunks.find(Name);
+    std::string Chunk;
+    int Status;
+
+    if(Search != DChunks.end()){
+        return luaL_loadbuffer(L, Search->second.data(), Search->second.size(), ("@" + filename).c_str());
+    }
+    Status = Compile(L, filename, Chunk);
+    if(LUA_OK == Status){
+        PrintDebug(DEBUG_LOW, "Compiled script %s, %d bytes\n", Name.c_str(), (int)Chunk.size());
+        DChunks[Name].swap(Chunk);
+    }
+    return Status;
+}
+
+/**
+* Loads and runs a script like luaL_dofile, from the cache if it has been
+* compiled before
+*
+* @param[in] L The Lua state to run the script in
+* @param[in] filename The path of the script
+*
+* @return LUA_OK or the error of the load or the call
+*
+*/
+
+int CScriptCache::DoFile(lua_State *L, const std::string &filename){
+    int Status = Load(L, filename);
+
+    if(LUA_OK == Status){
+        Status = lua_pcall(L, 0, LUA_MULTRET, 0);
+    }
+    return Status;
+}
+
+/**
+* Package searcher that resolves a module on package.path and loads it
+* through the cache
+*
+* @param[in] L The Lua state, the module name is the first argument
+*
+* @return 2, the loader and the file name, or 1 with a message if the module
+*     is not a file on package.path
+*
+*/
+
+int CScriptCache::Searcher(lua_State *L){
+    bool Failed = false;
+
+    // The strings go out of scope before lua_error jumps out of the function
+    {
+        std::string ModuleName = luaL_checkstring(L, 1);
+        std::string FileName;
+
+        lua_getglobal(L, "package");
+        lua_getfield(L, -1, "searchpath");
+        lua_pushstring(L, ModuleName.c_str());
+        lua_getfield(L, -3, "path");
+        lua_call(L, 2, 1);
+        if(!lua_isstring(L, -1)){
+            lua_pushfstring(L, "\n\tno cached script for '%s'", ModuleName.c_str());
+            return 1;
+        }
+        FileName = lua_tostring(L, -1);
+        if(LUA_OK != Load(L, FileName)){
+            lua_pushfstring(L, "error loading module '%s' from file '%s':\n\t%s", ModuleName.c_str(), FileName.c_str(), lua_tostring(L, -1));
+            Failed = true;
+        }
+        else{
+            lua_pushstring(L, FileName.c_str());
+        }
+    }
+    if(Failed){
+        return lua_error(L);
+    }
+    return 2;
+}
+
+/**
+* Puts the cache in front of the file searcher of package.searchers, so that
+* require loads scripts through the cache. Must be called after the package
+* library has been opened.
+*
+* @param[in] L The Lua state
+*
+* @return void
+*
+*/
+
+void CScriptCache::InstallSearcher(lua_State *L){
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchers");
+    if(lua_istable(L, -1)){
+        // Searcher 1 is package.preload, the cache goes right after it
+        for(int Index = luaL_len(L, -1); Index >= 2; Index--){
+            lua_rawgeti(L, -1, Index);
+            lua_rawseti(L, -2, Index + 1);
+        }
+        lua_pushcfunction(L, Searcher);
+        lua_rawseti(L, -2, 2);
+    }
+    lua_pop(L, 2);
+}
+
+/**
+* Recompiles a script that changed on disk. If it no longer compiles the
+* error is printed and the previous chunk stays in use.
+*
+* @param[in] filename The path of the script
+*
+* @return true if the script compiled
+*
+*/
+
+bool CScriptCache::Reload(const std::string &filename){
+    lua_State *L = NewState();
+    std::string Name = Key(filename);
+    std::string Chunk;
+    bool Success = LUA_OK == Compile(L, filename, Chunk);
+
+    if(Success){
+        PrintDebug(DEBUG_LOW, "Recompiled script %s, %d bytes\n", Name.c_str(), (int)Chunk.size());
+        DChunks[Name].swap(Chunk);
+    }
+    else{
+        PrintError("Failed to compile %s: %s\n", Name.c_str(), lua_tostring(L, -1));
+    }
+    lua_close(L);
+    return Success;
+}
+
+/**
+* Drops all compiled chunks
+*
+* @return void
+*
+*/
+
+void CScriptCache::Clear(){
+    DChunks.clear();
+}
@@ -36,7 +36,50 @@
 #include <vector>
 #include <sndfile.h>
 #include <mpg123.h>
+#include <algorithm>
 #include <cstring>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#define SOUND_READ_CHUNK_SIZE   4096
+#define PCM_CACHE_MAGIC         0x4D435053
+#define PCM_CACHE_VERSION       1
+
+typedef struct{
+    uint32_t DMagic;
+    uint32_t DVersion;
+    int64_t DModified;
+    int32_t DSampleRate;
+    int32_t DTotalFrames;
+} SPCMCacheHeader, *SPCMCacheHeaderRef;
+
+/**
+* Reads exactly length bytes from a data source, data sources may return
+* fewer bytes than requested per read
+*
+* @param[in] source The data source to read from
+* @param[out] data The buffer to read into
+* @param[in] length The number of bytes to read
+*
+* @return True if all bytes were read
+*
+*/
+
+static bool ReadFully(std::shared_ptr< CDataSource > source, void *data, size_t length){
+    uint8_t *Buffer = (uint8_t *)data;
+
+    while(length){
+        int Length = source->Read(Buffer, std::min(length, (size_t)INT32_MAX));
+
+        if(0 >= Length){
+            return false;
+        }
+        Buffer += Length;
+        length -= Length;
+    }
+    return true;
+}
 
 /**
 *
@@ -71,11 +114,12 @@ class CSFVirtualIODataSource{
 */
 
 CSFVirtualIODataSource::CSFVirtualIODataSource(std::shared_ptr< CDataSource > source){
-    uint8_t TempByte;
+    uint8_t TempBuffer[SOUND_READ_CHUNK_SIZE];
+    int Length;
     
-    // Read and push each valid byte into DData vector
-    while(0 < source->Read(&TempByte, 1)){
-        DData.push_back(TempByte);
+    // Read and append blocks of valid bytes into DData vector
+    while(0 < (Length = source->Read(TempBuffer, sizeof(TempBuffer)))){
+        DData.insert(DData.end(), TempBuffer, TempBuffer + Length);
     }
     DOffset = 0;
 }
@@ -286,15 +330,16 @@ CSoundClip &CSoundClip::operator=(const CSoundClip &clip){
 bool CSoundClip::Load(std::shared_ptr< CDataSource > source, bool ismp3){
     if(ismp3){
         std::vector< unsigned char > DataBuffer;
-        uint8_t TempByte;
+        uint8_t TempBuffer[SOUND_READ_CHUNK_SIZE];
+        int Length;
         mpg123_handle *MPG123Handle;
         int ReturnValue;
         bool ReturnStatus = false;
 
         LibraryReference();
 
-        while(0 < source->Read(&TempByte, 1)){
-            DataBuffer.push_back(TempByte);
+        while(0 < (Length = source->Read(TempBuffer, sizeof(TempBuffer)))){
+            DataBuffer.insert(DataBuffer.end(), TempBuffer, TempBuffer + Length);
         }
 
         MPG123Handle = mpg123_new(NULL, &ReturnValue);
@@ -382,10 +427,14 @@ bool CSoundClip::Load(std::shared_ptr< CDataSource > source, bool ismp3){
             DTotalFrames = SoundFileInfo.frames;
             DSampleRate = SoundFileInfo.samplerate;
             DData.resize(SoundFileInfo.frames * 2);
-            for(int Frame = 0; Frame < DTotalFrames; Frame++){
-                sf_readf_float(SoundFilePtr, DData.data() + Frame * 2, 1);
-                DData[Frame * 2 + 1] = DData[Frame * 2];
+            // Read all frames into the first half, then spread them out from
+            // the back so no frame is overwritten before it is duplicated
+            DTotalFrames = sf_readf_float(SoundFilePtr, DData.data(), DTotalFrames);
+            for(int Frame = DTotalFrames - 1; Frame >= 0; Frame--){
+                DData[Frame * 2 + 1] = DData[Frame];
+                DData[Frame * 2] = DData[Frame];
             }
+            DData.resize(DTotalFrames * 2);
         }
         else if(2 == SoundFileInfo.channels){
             DChannels = 2;
@@ -404,6 +453,68 @@ bool CSoundClip::Load(std::shared_ptr< CDataSource > source, bool ismp3){
     return true;
 }
 
+/**
+* Load previously decoded samples from the PCM cache, the cache is only used
+* if it was stored for a source with the same modification time
+*
+* @param[in] source a pointer to the cached CDataSource
+* @param[in] modified the modification time of the original sound file
+*
+* @return True if the cache was valid and loaded
+*
+*/
+
+bool CSoundClip::LoadCache(std::shared_ptr< CDataSource > source, time_t modified){
+    SPCMCacheHeader Header;
+
+    if(nullptr == source){
+        return false;
+    }
+    if(!ReadFully(source, &Header, sizeof(Header))){
+        return false;
+    }
+    if((PCM_CACHE_MAGIC != Header.DMagic)||(PCM_CACHE_VERSION != Header.DVersion)||(modified != Header.DModified)||(0 > Header.DTotalFrames)){
+        return false;
+    }
+    DData.resize(Header.DTotalFrames * 2);
+    if(!ReadFully(source, DData.data(), DData.size() * sizeof(float))){
+        DData.clear();
+        return false;
+    }
+    DChannels = 2;
+    DSampleRate = Header.DSampleRate;
+    DTotalFrames = Header.DTotalFrames;
+    return true;
+}
+
+/**
+* Store the decoded samples in the PCM cache
+*
+* @param[in] sink a pointer to the CDataSink to write the cache to
+* @param[in] modified the modification time of the original sound file
+*
+* @return True if the cache was written
+*
+*/
+
+bool CSoundClip::StoreCache(std::shared_ptr< CDataSink > sink, time_t modified) const{
+    SPCMCacheHeader Header;
+    int Length = DData.size() * sizeof(float);
+
+    if(nullptr == sink){
+        return false;
+    }
+    Header.DMagic = PCM_CACHE_MAGIC;
+    Header.DVersion = PCM_CACHE_VERSION;
+    Header.DModified = modified;
+    Header.DSampleRate = DSampleRate;
+    Header.DTotalFrames = DTotalFrames;
+    if(sizeof(Header) != sink->Write(&Header, sizeof(Header))){
+        return false;
+    }
+    return Length == sink->Write(DData.data(), Length);
+}
+
 /**
 * memcpy data into a pointer
 * 
@@ -447,8 +558,8 @@ void CSoundClip::CopyStereoClip(float *data, int offset, int frames){
 */
 
 void CSoundClip::MixStereoClip(float *data, int offset, int frames, float volume, float rightbias, bool loop){
-    const float *DataPointer = DData.data() + (offset * 2);
-    int FramesToMix = frames;
+    float LeftGain = volume * (1.0 - rightbias);
+    float RightGain = volume * (1.0 + rightbias);
 
     if(!DTotalFrames){
         return;
@@ -456,27 +567,59 @@ void CSoundClip::MixStereoClip(float *data, int offset, int frames, float volume
 
     if(loop){
         offset = offset % DTotalFrames;
-        DataPointer = DData.data() + (offset * 2);
-         for(int Frame = 0; Frame < FramesToMix; Frame++){
-            *data++ += volume * (1.0 - rightbias) * *DataPointer++;
-            *data++ += volume * (1.0 + rightbias) * *DataPointer++;
-            offset = (offset + 1) % DTotalFrames;
-            if(!offset){
-               DataPointer = DData.data();
-            }
+        while(frames){
+            int FramesToMix = std::min(frames, DTotalFrames - offset);
+
+            MixStereoBlock(data, DData.data() + (offset * 2), FramesToMix, LeftGain, RightGain);
+            data += FramesToMix * 2;
+            frames -= FramesToMix;
+            offset = 0;
         }
     }
     else{
-        DataPointer = DData.data() + (offset * 2);
+        int FramesToMix = frames;
+
         if(offset + frames > DTotalFrames){
             FramesToMix = DTotalFrames - offset;
             if(0 > FramesToMix){
                 FramesToMix = 0;
             }
         }
-        for(int Frame = 0; Frame < FramesToMix; Frame++){
-            *data++ += volume * (1.0 - rightbias) * *DataPointer++;
-            *data++ += volume * (1.0 + rightbias) * *DataPointer++;
-        }
+        MixStereoBlock(data, DData.data() + (offset * 2), FramesToMix, LeftGain, RightGain);
+    }
+}
+
+/**
+* Mixes a block of interleaved stereo frames into data, scaling the left and
+* right channels by their gains. Two frames are mixed per step with SSE when
+* available.
+*
+* @param[out] data a float pointer to the interleaved stereo output to mix into
+* @param[in] source a float pointer to the interleaved stereo input
+* @param[in] frames the number of frames to mix
+* @param[in] leftgain the gain of the left channel
+* @param[in] rightgain the gain of the right channel
+*
+* @return void
+*
+*/
+
+void CSoundClip::MixStereoBlock(float *data, const float *source, int frames, float leftgain, float rightgain){
+    int Frame = 0;
+
+#ifdef __SSE__
+    __m128 Gains = _mm_setr_ps(leftgain, rightgain, leftgain, rightgain);
+
+    for(; Frame + 2 <= frames; Frame += 2){
+        __m128 Mixed = _mm_add_ps(_mm_loadu_ps(data), _mm_mul_ps(Gains, _mm_loadu_ps(source)));
+
+        _mm_storeu_ps(data, Mixed);
+        data += 4;
+        source += 4;
+    }
+#endif
+    for(; Frame < frames; Frame++){
+        *data++ += leftgain * *source++;
+        *data++ += rightgain * *source++;
     }
 }
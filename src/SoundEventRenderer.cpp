@@ -33,6 +33,7 @@
 
 #include "SoundEventRenderer.h"
 #include <unordered_map>
+#include <cmath>
 
 /**
 * A CSoundEventRenderer object constructor, maps sound clips to events
@@ -305,6 +306,24 @@ float CSoundEventRenderer::RightBias(const SRectangle &viewportrect, const CPosi
     return ((float)(position.X() - CenterX)) / (RightX - CenterX);
 }
 
+/**
+* Distance function, the distance in pixels from the center of the viewport
+* to the position, used to decide which sounds to drop when too many play
+*
+* @param[in] viewportrect The reference of a SRectangle struct
+* @param[in] position The reference of a CPosition object
+*
+* @return A floting point number
+*
+*/
+
+float CSoundEventRenderer::Distance(const SRectangle &viewportrect, const CPosition &position){
+    float DeltaX = position.X() - (viewportrect.DXPosition + viewportrect.DWidth / 2);
+    float DeltaY = position.Y() - (viewportrect.DYPosition + viewportrect.DHeight / 2);
+
+    return std::sqrt(DeltaX * DeltaX + DeltaY * DeltaY);
+}
+
 /**
 * Checks if the mouse is pointing at the viewport
 *
@@ -363,7 +382,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                         if(DConstructIndices.size()){
                             int RandomClip = MainRandomNumber % DConstructIndices.size();
 
-                            DSoundMixer->PlayClip(DConstructIndices[RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                            DSoundMixer->PlayClip(DConstructIndices[RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Voice, Distance(viewportrect, Event.DAsset->Position()));
                         }
                     }
                     else if(DSelectionIndices[to_underlying(Event.DAsset->Type())].size()){
@@ -375,7 +394,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                             else{
                                 RandomClip = DDelayedSelectionIndices[to_underlying(Event.DAsset->Type())];
                             }
-                            DSoundMixer->PlayClip(DSelectionIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                            DSoundMixer->PlayClip(DSelectionIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Voice, Distance(viewportrect, Event.DAsset->Position()));
                             Selections[to_underlying(Event.DAsset->Type())]++;
                         }
                         else if(0 == (DRandomNumberGenerator.Random() & 0x3)){
@@ -398,7 +417,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                             else{
                                 RandomClip = DDelayedAcknowledgeIndices[to_underlying(Event.DAsset->Type())];
                             }
-                            DSoundMixer->PlayClip(DAcknowledgeIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                            DSoundMixer->PlayClip(DAcknowledgeIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Voice, Distance(viewportrect, Event.DAsset->Position()));
                             Acknowledges[to_underlying(Event.DAsset->Type())]++;
                         }
                         else if(0 == (DRandomNumberGenerator.Random() & 0x3)){
@@ -414,7 +433,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DWorkCompleteIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DWorkCompleteIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DWorkCompleteIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DWorkCompleteIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Voice, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -425,7 +444,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DReadyIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DReadyIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DReadyIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DReadyIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Voice, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -436,7 +455,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DDeathIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DDeathIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DDeathIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DDeathIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Combat, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -447,7 +466,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DAttackedIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DAttackedIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DAttackedIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DAttackedIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Voice, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -458,7 +477,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DMissleFireIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DMissleFireIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DMissleFireIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DMissleFireIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Combat, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -472,7 +491,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                         if(DMissleHitIndices[to_underlying(CreationCommand.DAssetTarget->Type())].size()){
                             int RandomClip = DRandomNumberGenerator.Random() % DMissleHitIndices[to_underlying(CreationCommand.DAssetTarget->Type())].size();
 
-                            DSoundMixer->PlayClip(DMissleHitIndices[to_underlying(CreationCommand.DAssetTarget->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                            DSoundMixer->PlayClip(DMissleHitIndices[to_underlying(CreationCommand.DAssetTarget->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Combat, Distance(viewportrect, Event.DAsset->Position()));
                         }
                     }
                 }
@@ -484,7 +503,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DHarvestIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DHarvestIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DHarvestIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DHarvestIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Ambient, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -495,7 +514,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DQuarryIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DQuarryIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DQuarryIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DQuarryIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Ambient, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -506,7 +525,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
                     if(DMeleeHitIndices[to_underlying(Event.DAsset->Type())].size()){
                         int RandomClip = DRandomNumberGenerator.Random() % DMeleeHitIndices[to_underlying(Event.DAsset->Type())].size();
 
-                        DSoundMixer->PlayClip(DMeleeHitIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                        DSoundMixer->PlayClip(DMeleeHitIndices[to_underlying(Event.DAsset->Type())][RandomClip], DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Combat, Distance(viewportrect, Event.DAsset->Position()));
                     }
                 }
             }
@@ -514,7 +533,7 @@ void CSoundEventRenderer::RenderEvents(const SRectangle &viewportrect){
         else if(EEventType::PlaceAction == Event.DType){
             if(Event.DAsset){
                 if(0 <= DPlaceIndex){
-                    DSoundMixer->PlayClip(DPlaceIndex, DVolume, RightBias(viewportrect, Event.DAsset->Position()));
+                    DSoundMixer->PlayClip(DPlaceIndex, DVolume, RightBias(viewportrect, Event.DAsset->Position()), ESoundPriority::Interface, Distance(viewportrect, Event.DAsset->Position()));
                 }
             }
 
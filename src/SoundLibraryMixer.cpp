@@ -34,12 +34,23 @@
 #include "SoundLibraryMixer.h"
 #include "CommentSkipLineDataSource.h"
 #include "Debug.h"
+#include "StartupTrace.h"
 #include <fstream>
 #include <math.h>
 #include <unistd.h>
 #include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cctype>
 
 #define FRAMES_PER_BUFFER       512
+#define MAX_CLIP_VOICES         128
+#define MAX_TONE_VOICES         32
+#define DEFAULT_CLIP_VOICES     32
+#define MAX_SOUND_LOADER_THREADS 8
 #ifndef M_PI
 #define M_PI                    3.14159265358979323846
 #endif
@@ -61,26 +72,42 @@
 bool no_audio;
 
 /**
-* A CSoundLibraryMixer object constructor, initialize internal values and pushes in free clips
+* A CSoundLibraryMixer object constructor, initialize internal values, pushes in free clips
+* and allocates the fixed voice arrays used by the audio callback
 *
 * @param[in] NO_AUDIOMIX boolean variable to indicate if there is audio mixer
+* @param[in] offline True to render through RenderOffline instead of an audio device
 *
 */
 
-CSoundLibraryMixer::CSoundLibraryMixer(bool NO_AUDIOMIX){
+CSoundLibraryMixer::CSoundLibraryMixer(bool NO_AUDIOMIX, bool offline){
     no_audio = NO_AUDIOMIX;
+    DOffline = offline;
+    DCapturing = false;
+    DStream = nullptr;
+    DPortAudioInitialized = false;
+    DActiveClipVoices = 0;
+    DActiveToneVoices = 0;
+    DClipVoiceLimit = DEFAULT_CLIP_VOICES;
+    DRequestedClipVoiceLimit = DEFAULT_CLIP_VOICES;
+    DMusicStatus.DIndex = -1;
+    DPlayingMusicStream = nullptr;
+    DMusicCommandsSent = 0;
+    DMusicCommandsApplied = 0;
     
     if(no_audio)
         return;
     
-    DStream = nullptr;
-    DNextClipID = 0;
+    DNextClipID = MAX_CLIP_VOICES;
     DNextToneID = 0;
-    DPortAudioInitialized = paNoError == Pa_Initialize();
-    //pthread_mutex_init(&DMutex, nullptr);
-    for(int Index = 0; Index < 128; Index++){
+    DPortAudioInitialized = !DOffline && (paNoError == Pa_Initialize());
+    DClipVoices.resize(MAX_CLIP_VOICES);
+    DToneVoices.resize(MAX_TONE_VOICES);
+    for(int Index = 0; Index < MAX_CLIP_VOICES; Index++){
         DFreeClipIDs.push_back(Index);   
     }
+    DUnreportedClipIDs.reserve(MAX_CLIP_VOICES + MIXER_COMMAND_QUEUE_SIZE);
+    DUnreportedToneIDs.reserve(MAX_TONE_VOICES + MIXER_COMMAND_QUEUE_SIZE);
 }
 
 /**
@@ -100,7 +127,6 @@ CSoundLibraryMixer::~CSoundLibraryMixer(){
     if(DPortAudioInitialized){
         Pa_Terminate();
     }
-    //pthread_mutex_destroy(&DMutex);
 }
 
 /**
@@ -181,9 +207,313 @@ int CSoundLibraryMixer::TimestepCallback(const void *in, void *out, unsigned lon
     return Mixer->Timestep(out, frames, timeinfo, status);
 }
 
+/**
+* Sends a command from the game thread to the audio callback
+*
+* @param[in] command The command to be queued
+*
+* @return True if the command was queued, false if the queue is full
+*
+*/
+
+bool CSoundLibraryMixer::SendCommand(const SMixerCommand &command){
+    if(!DCommandQueue.Push(command)){
+        PrintDebug(DEBUG_LOW, "Mixer command queue full, dropping command %d\n", (int)command.DType);
+        return false;
+    }
+    return true;
+}
+
+/**
+* Sends a song command, the stream that was playing is kept alive until the
+* audio callback has applied the command since it may still be mixing it
+*
+* @param[in] command The PlaySong or StopSong command to be queued
+* @param[in] stream The stream that plays once the command is applied
+*
+* @return True if the command was queued
+*
+*/
+
+bool CSoundLibraryMixer::SendMusicCommand(SMixerCommand &command, std::shared_ptr< CSoundStream > stream){
+    command.DStream = stream.get();
+    if(!SendCommand(command)){
+        return false;
+    }
+    DMusicCommandsSent++;
+    if(nullptr != DMusicStream){
+        DRetiredMusicStreams.push_back(std::make_pair(DMusicCommandsSent, DMusicStream));
+    }
+    DMusicStream = stream;
+    return true;
+}
+
+/**
+* Returns the identifications of clips and tones the audio callback has
+* finished with to the free lists, and closes retired music streams the
+* audio callback no longer reads from, only called from the game thread
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::CollectCompleted(){
+    int Identification;
+    int MusicCommandsApplied = DMusicCommandsApplied.load(std::memory_order_acquire);
+    
+    while(DCompletedClipQueue.Pop(Identification)){
+        DFreeClipIDs.push_back(Identification);
+    }
+    while(DCompletedToneQueue.Pop(Identification)){
+        DFreeToneIDs.push_back(Identification);
+    }
+    while(!DRetiredMusicStreams.empty() && (DRetiredMusicStreams.front().first <= MusicCommandsApplied)){
+        DRetiredMusicStreams.pop_front();
+    }
+}
+
+/**
+* Reports a clip the audio callback has finished with to the game thread. If
+* the completion queue is full the identification is held back until
+* ReportCompleted finds room, so it is never lost from the free list.
+*
+* @param[in] identification The identification of the finished clip
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::CompleteClip(int identification){
+    if(!DUnreportedClipIDs.empty() || !DCompletedClipQueue.Push(identification)){
+        DUnreportedClipIDs.push_back(identification);
+    }
+}
+
+/**
+* Reports a tone the audio callback has finished with to the game thread,
+* held back like CompleteClip when the completion queue is full.
+*
+* @param[in] identification The identification of the finished tone
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::CompleteTone(int identification){
+    if(!DUnreportedToneIDs.empty() || !DCompletedToneQueue.Push(identification)){
+        DUnreportedToneIDs.push_back(identification);
+    }
+}
+
+/**
+* Pushes the held back completions once the game thread has made room in the
+* completion queues, only called from the audio callback. The held back
+* arrays are reserved up front so the callback does not allocate.
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::ReportCompleted(){
+    while(!DUnreportedClipIDs.empty() && DCompletedClipQueue.Push(DUnreportedClipIDs.back())){
+        DUnreportedClipIDs.pop_back();
+    }
+    while(!DUnreportedToneIDs.empty() && DCompletedToneQueue.Push(DUnreportedToneIDs.back())){
+        DUnreportedToneIDs.pop_back();
+    }
+}
+
+/**
+* Applies the queued commands to the voice arrays, only called from the
+* audio callback. Clips and tones that do not fit in the voice arrays are
+* reported as completed immediately.
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::ProcessCommands(){
+    SMixerCommand Command;
+    
+    while(DCommandQueue.Pop(Command)){
+        switch(Command.DType){
+            case EMixerCommandType::PlayClip:   StartClipVoice(Command.DClip);
+                                                break;
+            case EMixerCommandType::PlayTone:   if(DActiveToneVoices < DToneVoices.size()){
+                                                    DToneVoices[DActiveToneVoices++] = Command.DTone;
+                                                }
+                                                else{
+                                                    CompleteTone(Command.DTone.DIdentification);
+                                                }
+                                                break;
+            case EMixerCommandType::StopTone:   for(int Voice = 0; Voice < DActiveToneVoices; Voice++){
+                                                    if(DToneVoices[Voice].DIdentification == Command.DTone.DIdentification){
+                                                        CompleteTone(DToneVoices[Voice].DIdentification);
+                                                        DToneVoices[Voice] = DToneVoices[--DActiveToneVoices];
+                                                        break;
+                                                    }
+                                                }
+                                                break;
+            case EMixerCommandType::PlaySong:   DMusicStatus = Command.DClip;
+                                                DPlayingMusicStream = Command.DStream;
+                                                DMusicCommandsApplied.fetch_add(1, std::memory_order_release);
+                                                break;
+            case EMixerCommandType::StopSong:   DMusicStatus.DIndex = -1;
+                                                DPlayingMusicStream = nullptr;
+                                                DMusicCommandsApplied.fetch_add(1, std::memory_order_release);
+                                                break;
+            case EMixerCommandType::SongVolume: DMusicStatus.DVolume = Command.DClip.DVolume;
+                                                break;
+            case EMixerCommandType::VoiceLimit: DClipVoiceLimit = Command.DClip.DIndex;
+                                                while(DActiveClipVoices > DClipVoiceLimit){
+                                                    int Weakest = 0;
+
+                                                    for(int Voice = 1; Voice < DActiveClipVoices; Voice++){
+                                                        if(WeakerVoice(DClipVoices[Voice], DClipVoices[Weakest])){
+                                                            Weakest = Voice;
+                                                        }
+                                                    }
+                                                    CompleteClip(DClipVoices[Weakest].DIdentification);
+                                                    DClipVoices[Weakest] = DClipVoices[--DActiveClipVoices];
+                                                }
+                                                break;
+            default:                            break;
+        }
+    }
+}
+
+/**
+* Orders clip voices for stealing, a voice is weaker if it has a lower
+* priority, is further away at the same priority, or has played longer at
+* the same priority and distance
+*
+* @param[in] first The voice to check
+* @param[in] second The voice to compare against
+*
+* @return True if first should be stolen before second
+*
+*/
+
+bool CSoundLibraryMixer::WeakerVoice(const SClipStatus &first, const SClipStatus &second){
+    if(first.DPriority != second.DPriority){
+        return first.DPriority < second.DPriority;
+    }
+    if(first.DDistance != second.DDistance){
+        return first.DDistance > second.DDistance;
+    }
+    return first.DOffset > second.DOffset;
+}
+
+/**
+* Starts a clip on a free voice, only called from the audio callback. When
+* the voice limit is reached the weakest playing voice is stolen if the new
+* clip is not weaker than it, otherwise the new clip is dropped. Stolen and
+* dropped clips are reported as completed.
+*
+* @param[in] clip The clip to start
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::StartClipVoice(const SClipStatus &clip){
+    int Weakest = 0;
+
+    if(DActiveClipVoices < DClipVoiceLimit){
+        DClipVoices[DActiveClipVoices++] = clip;
+        return;
+    }
+    if(!DActiveClipVoices){
+        CompleteClip(clip.DIdentification);
+        return;
+    }
+    for(int Voice = 1; Voice < DActiveClipVoices; Voice++){
+        if(WeakerVoice(DClipVoices[Voice], DClipVoices[Weakest])){
+            Weakest = Voice;
+        }
+    }
+    if(WeakerVoice(clip, DClipVoices[Weakest])){
+        CompleteClip(clip.DIdentification);
+        return;
+    }
+    CompleteClip(DClipVoices[Weakest].DIdentification);
+    DClipVoices[Weakest] = clip;
+}
+
+/**
+* Mixes a tone into data. The frames are generated in runs that end where the
+* volume, frequency or bias can next cross a limit, so the inner loop only
+* steps the table and the decays and does not test the limits per sample.
+*
+* @param[in] tone The tone to mix, advanced by the frames mixed
+* @param[out] data A float pointer to the interleaved stereo output
+* @param[in] frames The number of frames to mix
+*
+* @return True if the tone is still playing after the frames
+*
+*/
+
+bool CSoundLibraryMixer::MixTone(SToneStatus &tone, float *data, int frames){
+    const float *SineTable = DSineWave.data();
+
+    while(frames){
+        int Run = frames;
+
+        if(0.0 > tone.DVolumeDecay){
+            Run = std::min(Run, (int)(tone.DVolume / -tone.DVolumeDecay) + 1);
+        }
+        if(0.0 > tone.DFrequencyDecay){
+            Run = std::min(Run, (int)((tone.DCurrentFrequency - 20.0) / -tone.DFrequencyDecay) + 1);
+        }
+        if(0.0 < tone.DRightShift){
+            Run = std::min(Run, (int)((1.0 - tone.DRightBias) / tone.DRightShift) + 1);
+        }
+        else if(0.0 > tone.DRightShift){
+            Run = std::min(Run, (int)((tone.DRightBias + 1.0) / -tone.DRightShift) + 1);
+        }
+        Run = std::max(Run, 1);
+        frames -= Run;
+        for(int Frame = 0; Frame < Run; Frame++){
+            int SineIndex = tone.DCurrentStep + 0.5;
+            float Sample;
+
+            if(DSampleRate <= SineIndex){
+                SineIndex = 0;
+            }
+            Sample = tone.DVolume * SineTable[SineIndex];
+            *data++ += (1.0 - tone.DRightBias) * Sample;
+            *data++ += (1.0 + tone.DRightBias) * Sample;
+            tone.DCurrentStep += tone.DCurrentFrequency;
+            tone.DCurrentFrequency += tone.DFrequencyDecay;
+            tone.DVolume += tone.DVolumeDecay;
+            tone.DRightBias += tone.DRightShift;
+            if(DSampleRate <= tone.DCurrentStep){
+                tone.DCurrentStep -= DSampleRate;
+            }
+        }
+        if(0.0 > tone.DVolume){
+            return false;
+        }
+        if(20.0 > tone.DCurrentFrequency){
+            return false;
+        }
+        if(-1.0 > tone.DRightBias){
+            tone.DRightBias = -1.0;
+            tone.DRightShift = 0.0;
+        }
+        if(1.0 < tone.DRightBias){
+            tone.DRightBias = -1.0;
+            tone.DRightShift = 0.0;                
+        }
+    }
+    return true;
+}
+
 /**
 * Advances sound clip and tone to the next frame
-* Put a clip or a tone to the free list if done playing
+* Report a clip or a tone as completed if done playing. This runs in the
+* PortAudio callback, it never locks or allocates; the game thread talks to it
+* only through the command and completion queues.
 *
 * @param[in] out A void pointer, an array that holds all the frames
 * @param[in] timeinfo A constant pointer to a PaStreamCallbackTimeInfo object
@@ -199,79 +529,38 @@ int CSoundLibraryMixer::Timestep(void *out, unsigned long frames, const PaStream
     float *DataPtr = (float *)out;
     
     memset(DataPtr, 0, sizeof(float) * frames * 2);
-    //pthread_mutex_lock(&DMutex);
-    DMutex.lock();
-    for(std::list< SClipStatus >::iterator ClipIterator = DClipsInProgress.begin(); ClipIterator != DClipsInProgress.end(); ){
-        bool Advance = true;
+    ReportCompleted();
+    ProcessCommands();
+    for(int Voice = 0; Voice < DActiveClipVoices; ){
+        SClipStatus &Clip = DClipVoices[Voice];
         
-        DSoundClips[ClipIterator->DIndex].MixStereoClip(DataPtr, ClipIterator->DOffset, frames, ClipIterator->DVolume, ClipIterator->DRightBias);
+        DSoundClips[Clip.DIndex].MixStereoClip(DataPtr, Clip.DOffset, frames, Clip.DVolume, Clip.DRightBias);
         
-        ClipIterator->DOffset += frames;
-        if(ClipIterator->DOffset >= DSoundClips[ClipIterator->DIndex].TotalFrames()){
-            DFreeClipIDs.push_back(ClipIterator->DIdentification);   
-            ClipIterator = DClipsInProgress.erase(ClipIterator);
-            Advance = false;
+        Clip.DOffset += frames;
+        if(Clip.DOffset >= DSoundClips[Clip.DIndex].TotalFrames()){
+            CompleteClip(Clip.DIdentification);
+            Clip = DClipVoices[--DActiveClipVoices];
         }
-        if(Advance){
-            ClipIterator++;   
+        else{
+            Voice++;
         }
     }
-    if(0 <= DMusicStatus.DIndex){
-        DMusicClips[DMusicStatus.DIndex].MixStereoClip(DataPtr, DMusicStatus.DOffset, frames, DMusicStatus.DVolume, DMusicStatus.DRightBias, true);
-        
-        DMusicStatus.DOffset = (DMusicStatus.DOffset + frames) % DMusicClips[DMusicStatus.DIndex].TotalFrames();
+    if((0 <= DMusicStatus.DIndex) && (nullptr != DPlayingMusicStream)){
+        DMusicStatus.DOffset += DPlayingMusicStream->MixStereoStream(DataPtr, frames, DMusicStatus.DVolume, DMusicStatus.DRightBias);
     }
     
-    for(std::list< SToneStatus >::iterator ToneIterator = DTonesInProgress.begin(); ToneIterator != DTonesInProgress.end(); ){
-        bool Advance = true;
-        float *CurOutPtr = DataPtr;
+    for(int Voice = 0; Voice < DActiveToneVoices; ){
+        SToneStatus &Tone = DToneVoices[Voice];
         
-        for(int Frame = 0; Frame < frames; Frame++){
-            int SineIndex = ToneIterator->DCurrentStep;
-            
-            if(0.5 <= (ToneIterator->DCurrentStep - SineIndex)){
-                SineIndex++;
-                if(DSampleRate <= SineIndex){
-                    SineIndex = 0;   
-                }
-            }
-            *CurOutPtr++ += ToneIterator->DVolume * (1.0 - ToneIterator->DRightBias) * DSineWave[SineIndex];
-            *CurOutPtr++ += ToneIterator->DVolume * (1.0 + ToneIterator->DRightBias) * DSineWave[SineIndex];
-            ToneIterator->DCurrentStep += ToneIterator->DCurrentFrequency;
-            ToneIterator->DCurrentFrequency += ToneIterator->DFrequencyDecay;
-            ToneIterator->DVolume += ToneIterator->DVolumeDecay;
-            ToneIterator->DRightBias += ToneIterator->DRightShift;
-            if(DSampleRate <= ToneIterator->DCurrentStep){
-                ToneIterator->DCurrentStep -= DSampleRate;
-            }
-            if(0.0 > ToneIterator->DVolume){
-                Advance = false;
-                break;
-            }
-            if(20.0 > ToneIterator->DCurrentFrequency){
-                Advance = false;
-                break;
-            }
-            if(-1.0 > ToneIterator->DRightBias){
-                ToneIterator->DRightBias = -1.0;
-                ToneIterator->DRightShift = 0.0;
-            }
-            if(1.0 < ToneIterator->DRightBias){
-                ToneIterator->DRightBias = -1.0;
-                ToneIterator->DRightShift = 0.0;                
-            }
-        }        
-        if(Advance){
-            ToneIterator++;    
+        if(MixTone(Tone, DataPtr, frames)){
+            Voice++;    
         }
         else{
-            DFreeToneIDs.push_back(ToneIterator->DIdentification);   
-            ToneIterator = DTonesInProgress.erase(ToneIterator);
+            CompleteTone(Tone.DIdentification);
+            Tone = DToneVoices[--DActiveToneVoices];
         }
     }
     
-    //pthread_mutex_unlock(&DMutex);    
-    DMutex.unlock();
     frames *= 2;
     for(int Frame = 0; Frame < frames; Frame++){
         if(-1.0 > *DataPtr){
@@ -286,6 +575,152 @@ int CSoundLibraryMixer::Timestep(void *out, unsigned long frames, const PaStream
     return paContinue;
 }
 
+/**
+* Opens and starts the default PortAudio output stream that pulls Timestep
+*
+* @return True if the stream is running
+*
+*/
+
+bool CSoundLibraryMixer::OpenDevice(){
+    if(!DPortAudioInitialized){
+        PaError PortAudioResult;
+        PrintDebug(DEBUG_LOW, "Port Audio not initialized, try to reinitialize.\n");
+        PortAudioResult = Pa_Initialize();    
+        DPortAudioInitialized = paNoError == PortAudioResult;
+        if(DPortAudioInitialized){
+            PrintDebug(DEBUG_LOW, "Port Audio initialized.\n");
+        }
+        else{
+            PrintDebug(DEBUG_LOW, "Port Audio failed to initialize with code %d.\n", PortAudioResult);
+        }
+    }
+    PrintDebug(DEBUG_LOW, "Opening stream at %dHz with %d frames per buffer\n",DSampleRate, FRAMES_PER_BUFFER);
+    if(paNoError != Pa_OpenDefaultStream(&DStream, 0, 2, paFloat32, DSampleRate, FRAMES_PER_BUFFER, TimestepCallback, this)){
+        PrintError("Failed to open default sound stream\n");
+        return false;
+    }
+    PrintDebug(DEBUG_LOW, "Default sound stream opened.\n");
+    if(paNoError != Pa_StartStream(DStream)){
+        PrintError("Failed to start default sound stream\n");
+        return false;
+    }
+    PrintDebug(DEBUG_LOW, "Sound stream started.\n");
+    return true;
+}
+
+/**
+* Loads a clip, from the PCM cache if there is one and it is up to date,
+* otherwise by decoding the sound file and then storing it in the cache.
+* Called from the loader threads, each clip is only touched by one thread.
+*
+* @param[in] index The index of the clip to load
+* @param[in] path The path of the sound file in the sound data container
+*
+* @return True if the clip was loaded
+*
+*/
+
+bool CSoundLibraryMixer::LoadClip(int index, const std::string &path){
+    CStartupTrace Trace("Clip " + path);
+    std::shared_ptr< CDataSource > Source = DSoundDataContainer->DataSource(path);
+    std::string CacheName;
+    time_t Modified;
+    
+    if(nullptr == Source){
+        return false;
+    }
+    Modified = Source->ModificationTime();
+    if((nullptr != DPCMCache) && Modified){
+        for(auto Character : path){
+            CacheName += isalnum(Character) ? Character : '_';
+        }
+        CacheName += ".pcm";
+        if(DSoundClips[index].LoadCache(DPCMCache->DataSource(CacheName), Modified)){
+            return true;
+        }
+    }
+    if(!DSoundClips[index].Load(Source)){
+        return false;
+    }
+    if(!CacheName.empty() && !DSoundClips[index].StoreCache(DPCMCache->DataSink(CacheName), Modified)){
+        PrintDebug(DEBUG_LOW, "Failed to cache sound clip %s\n", path.c_str());
+    }
+    return true;
+}
+
+/**
+* Decodes all clips on a pool of loader threads, one per core up to
+* MAX_SOUND_LOADER_THREADS but at least one. The loading callback is
+* still called once per clip, but from the calling thread since it draws
+* the loading screen.
+*
+* @param[in] paths The paths of the sound files, one per clip
+* @param[in] callback The sound library loading callback function
+* @param[in] calldata The sound library loading calldata for the callback function
+*
+* @return True if every clip was loaded
+*
+*/
+
+bool CSoundLibraryMixer::LoadClips(const std::vector< std::string > &paths, TSoundLibraryLoadingCallback callback, TSoundLibraryLoadingCalldata calldata){
+    std::vector< std::thread > Loaders;
+    std::mutex ProgressMutex;
+    std::condition_variable ProgressCondition;
+    std::atomic< int > NextClip(0);
+    std::atomic< int > FailedClip(-1);
+    int TotalClips = paths.size();
+    int CompletedClips = 0;
+    int ReportedClips = 0;
+    int LoaderCount = std::min((int)std::thread::hardware_concurrency(), MAX_SOUND_LOADER_THREADS);
+    
+    LoaderCount = std::max(1, std::min(LoaderCount, TotalClips));
+    
+    DSoundClips.resize(TotalClips);
+    for(int Loader = 0; Loader < LoaderCount; Loader++){
+        Loaders.push_back(std::thread([&](){
+            int Index;
+            
+            while((0 > FailedClip.load()) && ((Index = NextClip++) < TotalClips)){
+                bool Loaded = LoadClip(Index, paths[Index]);
+                std::lock_guard< std::mutex > Lock(ProgressMutex);
+                
+                if(Loaded){
+                    CompletedClips++;
+                }
+                else if(0 > FailedClip.load()){
+                    FailedClip = Index;
+                }
+                ProgressCondition.notify_one();
+            }
+        }));
+    }
+    {
+        std::unique_lock< std::mutex > Lock(ProgressMutex);
+        
+        while((ReportedClips < TotalClips) && (0 > FailedClip.load())){
+            int NewClips;
+            
+            ProgressCondition.wait(Lock, [&]{ return (CompletedClips > ReportedClips) || (0 <= FailedClip.load()); });
+            NewClips = CompletedClips - ReportedClips;
+            ReportedClips = CompletedClips;
+            Lock.unlock();
+            while(NewClips--){
+                callback(calldata);
+            }
+            Lock.lock();
+        }
+    }
+    for(auto &Loader : Loaders){
+        Loader.join();
+    }
+    if(0 <= FailedClip.load()){
+        PrintError("Failed to load sound clip %d.\n", FailedClip.load());
+        return false;
+    }
+    return true;
+}
+
 /**
 * Loads the sound library data source file and initialize internal variables
 *
@@ -304,8 +739,10 @@ bool CSoundLibraryMixer::LoadLibrary(std::shared_ptr< CDataSource > source, TSou
     int TotalClips, TotalSongs;
     bool ReturnStatus = false;
     std::string TempString;
+    std::vector< std::string > ClipPaths;
     std::shared_ptr< CDataSource >  SFInput;
     std::ofstream SFOutput;
+    CStartupTrace Step("SoundIndex");
     
     DSoundDataContainer = source->Container();
     
@@ -339,7 +776,6 @@ bool CSoundLibraryMixer::LoadLibrary(std::shared_ptr< CDataSource > source, TSou
     }
 
     DMusicFilenames.resize(TotalSongs);
-    DMusicClips.resize(TotalSongs);
     for(int Index = 0; Index < TotalSongs; Index++){
         auto TempData = std::make_shared< std::vector< char > > ();
         
@@ -357,29 +793,13 @@ bool CSoundLibraryMixer::LoadLibrary(std::shared_ptr< CDataSource > source, TSou
     }
     DMusicStatus.DIndex = -1;
     
-    if(!DPortAudioInitialized){
-        PaError PortAudioResult;
-        PrintDebug(DEBUG_LOW, "Port Audio not initialized, try to reinitialize.\n");
-        PortAudioResult = Pa_Initialize();    
-        DPortAudioInitialized = paNoError == PortAudioResult;
-        if(DPortAudioInitialized){
-            PrintDebug(DEBUG_LOW, "Port Audio initialized.\n");
-        }
-        else{
-            PrintDebug(DEBUG_LOW, "Port Audio failed to initialize with code %d.\n", PortAudioResult);
-        }
-    }
-    PrintDebug(DEBUG_LOW, "Opening stream at %dHz with %d frames per buffer\n",DSampleRate, FRAMES_PER_BUFFER);
-    if(paNoError != Pa_OpenDefaultStream(&DStream, 0, 2, paFloat32, DSampleRate, FRAMES_PER_BUFFER, TimestepCallback, this)){
-        PrintError("Failed to open default sound stream\n");
-        goto LoadLibraryExit;
+    Step.Next("SoundDevice");
+    if(DOffline){
+        PrintDebug(DEBUG_LOW, "Rendering offline at %dHz with %d frames per buffer\n", DSampleRate, FRAMES_PER_BUFFER);
     }
-    PrintDebug(DEBUG_LOW, "Default sound stream opened.\n");
-    if(paNoError != Pa_StartStream(DStream)){
-        PrintError("Failed to start default sound stream\n");
+    else if(!OpenDevice()){
         goto LoadLibraryExit;
     }
-    PrintDebug(DEBUG_LOW, "Sound stream started.\n");
     
     PlaySong(0, 0.5);
         
@@ -396,22 +816,21 @@ bool CSoundLibraryMixer::LoadLibrary(std::shared_ptr< CDataSource > source, TSou
         goto LoadLibraryExit;
     }
 
-    DSoundClips.resize(TotalClips);
+    Step.Next("SoundClips");
+    ClipPaths.resize(TotalClips);
     for(int Index = 0; Index < TotalClips; Index++){
         if(!LineSource.Read(TempString)){
             PrintError("Failed to read clip name %d.\n", Index);
             goto LoadLibraryExit;
         }
         DMapping[TempString] = Index;
-        if(!LineSource.Read(TempString)){
+        if(!LineSource.Read(ClipPaths[Index])){
             PrintError("Failed to read clip path %d.\n", Index);
             goto LoadLibraryExit;
         }
-        if(!DSoundClips[Index].Load(DSoundDataContainer->DataSource(TempString))){
-            PrintError("Failed to load sound clip %d.\n", Index);
-            goto LoadLibraryExit;    
-        }
-        callback(calldata);
+    }
+    if(!LoadClips(ClipPaths, callback, calldata)){
+        goto LoadLibraryExit;
     }
 
     for(int Index = 1; Index < TotalClips; Index++){
@@ -431,22 +850,164 @@ LoadLibraryExit:
     return ReturnStatus;
 }
 
+/**
+* Returns the number of frames the mixer renders per buffer
+*
+* @return The frames per buffer
+*
+*/
+
+int CSoundLibraryMixer::FramesPerBuffer(){
+    return FRAMES_PER_BUFFER;
+}
+
+/**
+* Waits until the playing song has decoded enough frames for the next
+* offline buffer, so offline output does not depend on how fast the
+* decoder thread happens to run. Does nothing when using an audio device.
+*
+* @param[in] frames The number of frames about to be rendered
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::SyncOffline(int frames){
+    if(!DOffline || (nullptr == DMusicStream)){
+        return;
+    }
+    while((DMusicStream->BufferedFrames() < frames) && !DMusicStream->Finished()){
+        std::this_thread::yield();
+    }
+}
+
+/**
+* Renders the next buffer without an audio device by calling Timestep
+* directly, the output is appended to the capture if capturing
+*
+* @param[out] data The stereo buffer to render into
+* @param[in] frames The number of frames to render
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::RenderOffline(float *data, int frames){
+    if(!DOffline){
+        return;
+    }
+    Timestep(data, frames, nullptr, 0);
+    if(DCapturing){
+        DCapture.insert(DCapture.end(), data, data + frames * 2);
+    }
+}
+
+/**
+* Starts or stops capturing the offline output, starting discards any
+* previous capture
+*
+* @param[in] capture True to start capturing
+*
+* @return void
+*
+*/
+
+void CSoundLibraryMixer::CaptureOffline(bool capture){
+    if(capture && !DCapturing){
+        DCapture.clear();
+    }
+    DCapturing = capture;
+}
+
+/**
+* Writes the captured offline output as a 16 bit stereo WAV file
+*
+* @param[in] sink The data sink to write the WAV file to
+*
+* @return True if the whole file was written
+*
+*/
+
+bool CSoundLibraryMixer::WriteCapture(std::shared_ptr< CDataSink > sink) const{
+    std::vector< uint8_t > Buffer;
+    uint32_t DataBytes = DCapture.size() * sizeof(int16_t);
+    auto AppendTag = [&Buffer](const char *tag){
+        Buffer.insert(Buffer.end(), tag, tag + 4);
+    };
+    auto Append16 = [&Buffer](uint16_t value){
+        Buffer.push_back(value & 0xFF);
+        Buffer.push_back((value >> 8) & 0xFF);
+    };
+    auto Append32 = [&Buffer](uint32_t value){
+        for(int Byte = 0; Byte < 4; Byte++){
+            Buffer.push_back((value >> (Byte * 8)) & 0xFF);
+        }
+    };
+    
+    if(nullptr == sink){
+        return false;
+    }
+    Buffer.reserve(44 + DataBytes);
+    AppendTag("RIFF");
+    Append32(36 + DataBytes);
+    AppendTag("WAVE");
+    AppendTag("fmt ");
+    Append32(16);
+    Append16(1);
+    Append16(2);
+    Append32(DSampleRate);
+    Append32(DSampleRate * 2 * sizeof(int16_t));
+    Append16(2 * sizeof(int16_t));
+    Append16(16);
+    AppendTag("data");
+    Append32(DataBytes);
+    for(float Sample : DCapture){
+        Append16((uint16_t)(int16_t)lroundf(std::max(-1.0f, std::min(1.0f, Sample)) * 32767.0f));
+    }
+    return (int)Buffer.size() == sink->Write(Buffer.data(), Buffer.size());
+}
+
+/**
+* Sets the maximum number of clips mixed at once, when more clips are played
+* the weakest voices are stolen
+*
+* @param[in] limit The number of clip voices, limited to the size of the voice array
+*
+* @return The new voice limit
+*
+*/
+
+int CSoundLibraryMixer::MaxClipVoices(int limit){
+    SMixerCommand TempCommand;
+    
+    DRequestedClipVoiceLimit = std::max(1, std::min(limit, MAX_CLIP_VOICES));
+    if(no_audio) 
+        return DRequestedClipVoiceLimit;
+    TempCommand.DType = EMixerCommandType::VoiceLimit;
+    TempCommand.DClip.DIndex = DRequestedClipVoiceLimit;
+    SendCommand(TempCommand);
+    return DRequestedClipVoiceLimit;
+}
+
 /**
 * Plays a clip specified by its index and sound volume by pushing the clip
-* into the DClipsInProgress list
+* to the audio callback through the command queue
 *
 * @param[in] index Index of the clip to be played
 * @param[in] volume The sound volume that the clip is to be played
 * @prarm[in] rightbias The rightbias value of the clip
+* @param[in] priority The priority of the clip when voices must be stolen
+* @param[in] distance The distance of the clip from the listener, further clips are stolen first
 *
 * @return The identification of the clip played
 *
 */
 
-int CSoundLibraryMixer::PlayClip(int index, float volume, float rightbias){
+int CSoundLibraryMixer::PlayClip(int index, float volume, float rightbias, ESoundPriority priority, float distance){
     if(no_audio) 
         return 0;
     SClipStatus TempClipStatus;
+    SMixerCommand TempCommand;
     
     if((0 > index)||(DSoundClips.size() <= index)){
         PrintError("Invalid Clip %d!!!!!\n",index);
@@ -456,9 +1017,9 @@ int CSoundLibraryMixer::PlayClip(int index, float volume, float rightbias){
     TempClipStatus.DOffset = 0;
     TempClipStatus.DVolume = volume;
     TempClipStatus.DRightBias = rightbias;
-    
-    //pthread_mutex_lock(&DMutex);
-    DMutex.lock();
+    TempClipStatus.DPriority = priority;
+    TempClipStatus.DDistance = distance;
+    CollectCompleted();
     if(DFreeClipIDs.size()){
         TempClipStatus.DIdentification = DFreeClipIDs.front();
         DFreeClipIDs.pop_front();
@@ -466,15 +1027,18 @@ int CSoundLibraryMixer::PlayClip(int index, float volume, float rightbias){
     else{
         TempClipStatus.DIdentification = DNextClipID++;    
     }
-    DClipsInProgress.push_back(TempClipStatus);
-    //pthread_mutex_unlock(&DMutex);  
-    DMutex.unlock();
+    TempCommand.DType = EMixerCommandType::PlayClip;
+    TempCommand.DClip = TempClipStatus;
+    if(!SendCommand(TempCommand)){
+        DFreeClipIDs.push_back(TempClipStatus.DIdentification);
+        return -1;
+    }
     return TempClipStatus.DIdentification;
 }
 
 /**
 * Plays a tone specified by frequency, sound volume, frequency decay and other values
-* by pushing the tone into the DTonesInProgress list
+* by sending the tone to the audio callback through the command queue
 *
 * @param[in] freq The current frequency of the tone
 * @param[in] freqdecay The frequency decay value of the tone
@@ -491,7 +1055,7 @@ int CSoundLibraryMixer::PlayTone(float freq, float freqdecay, float volume, floa
     if(no_audio) 
         return 0;
     SToneStatus TempToneStatus;
-    
+    SMixerCommand TempCommand;
 
     TempToneStatus.DCurrentFrequency = freq;
     TempToneStatus.DCurrentStep = 0;
@@ -501,8 +1065,7 @@ int CSoundLibraryMixer::PlayTone(float freq, float freqdecay, float volume, floa
     TempToneStatus.DRightBias = rightbias;
     TempToneStatus.DRightShift = rightshift / DSampleRate;
     
-    //pthread_mutex_lock(&DMutex);
-    DMutex.lock();
+    CollectCompleted();
     if(DFreeToneIDs.size()){
         TempToneStatus.DIdentification = DFreeToneIDs.front();
         DFreeToneIDs.pop_front();
@@ -510,14 +1073,17 @@ int CSoundLibraryMixer::PlayTone(float freq, float freqdecay, float volume, floa
     else{
         TempToneStatus.DIdentification = DNextToneID++;    
     }
-    DTonesInProgress.push_back(TempToneStatus);
-    //pthread_mutex_unlock(&DMutex);  
-    DMutex.unlock();
+    TempCommand.DType = EMixerCommandType::PlayTone;
+    TempCommand.DTone = TempToneStatus;
+    if(!SendCommand(TempCommand)){
+        DFreeToneIDs.push_back(TempToneStatus.DIdentification);
+        return -1;
+    }
     return TempToneStatus.DIdentification;
 }
 
 /**
-* Stops a tone by removing the tone from the DToneInProgress list
+* Stops a tone by asking the audio callback to remove it from its voices
 *
 * @param[in] id The identification of the tone to be stopped
 *
@@ -528,21 +1094,11 @@ int CSoundLibraryMixer::PlayTone(float freq, float freqdecay, float volume, floa
 void CSoundLibraryMixer::StopTone(int id){
     if(no_audio) 
         return;
-    std::list< SToneStatus >::iterator ToneIterator;
+    SMixerCommand TempCommand;
     
-    //pthread_mutex_lock(&DMutex);
-    DMutex.lock();
-    ToneIterator = DTonesInProgress.begin();
-    while(ToneIterator != DTonesInProgress.end()){
-        if(ToneIterator->DIdentification == id){
-            DTonesInProgress.erase(ToneIterator);
-            DFreeToneIDs.push_back(id);
-            break;
-        }
-        ToneIterator++;
-    }
-    //pthread_mutex_unlock(&DMutex);  
-    DMutex.unlock();
+    TempCommand.DType = EMixerCommandType::StopTone;
+    TempCommand.DTone.DIdentification = id;
+    SendCommand(TempCommand);
 }
 
 /**
@@ -559,8 +1115,7 @@ bool CSoundLibraryMixer::ClipCompleted(int id){
     std::list< int >::iterator ClipIDIterator;
     bool FoundID = false;
     
-    //pthread_mutex_lock(&DMutex);
-    DMutex.lock();
+    CollectCompleted();
     ClipIDIterator = DFreeClipIDs.begin();
     while(ClipIDIterator != DFreeClipIDs.end()){
         if(*ClipIDIterator == id){
@@ -569,8 +1124,6 @@ bool CSoundLibraryMixer::ClipCompleted(int id){
         }
         ClipIDIterator++;
     }
-    //pthread_mutex_unlock(&DMutex); 
-    DMutex.unlock();
     return FoundID;
 }
 
@@ -587,19 +1140,28 @@ bool CSoundLibraryMixer::ClipCompleted(int id){
 void CSoundLibraryMixer::PlaySong(int index, float volume){
     if(no_audio)
         return;
-    if((0 > index)||(index >= DMusicClips.size())){
+    SMixerCommand TempCommand;
+    std::shared_ptr< CSoundStream > Stream;
+    
+    if((0 > index)||(index >= DMusicFilenames.size())){
         return;   
     }
-    if(!DMusicClips[index].TotalFrames()){
-        if(!DMusicClips[index].Load(DSoundDataContainer->DataSource(DMusicFilenames[index]), true)){
-            PrintError("Failed to load song clip %d.\n", index);
-            return;
-        }
+    CollectCompleted();
+    Stream = std::make_shared< CSoundStream >();
+    if(!Stream->Open(DSoundDataContainer, DMusicFilenames[index], true)){
+        PrintError("Failed to open song clip %d.\n", index);
+        return;
+    }
+    if(Stream->SampleRate() != DSampleRate){
+        PrintDebug(DEBUG_LOW, "Song %d sample rate %dHz differs from mixer %dHz\n", index, Stream->SampleRate(), DSampleRate);
     }
-    DMusicStatus.DOffset = 0;
-    DMusicStatus.DIndex = index;
-    DMusicStatus.DVolume = volume;
-    DMusicStatus.DRightBias = 0.0;
+    TempCommand.DType = EMixerCommandType::PlaySong;
+    TempCommand.DClip.DIdentification = -1;
+    TempCommand.DClip.DOffset = 0;
+    TempCommand.DClip.DIndex = index;
+    TempCommand.DClip.DVolume = volume;
+    TempCommand.DClip.DRightBias = 0.0;
+    SendMusicCommand(TempCommand, Stream);
 }
 
 /**
@@ -612,7 +1174,11 @@ void CSoundLibraryMixer::PlaySong(int index, float volume){
 void CSoundLibraryMixer::StopSong(){
     if(no_audio) 
         return;
-    DMusicStatus.DIndex = -1;
+    SMixerCommand TempCommand;
+    
+    CollectCompleted();
+    TempCommand.DType = EMixerCommandType::StopSong;
+    SendMusicCommand(TempCommand, nullptr);
 }
 
 /**
@@ -627,6 +1193,10 @@ void CSoundLibraryMixer::StopSong(){
 void CSoundLibraryMixer::SongVolume(float volume){
     if(no_audio) 
         return;
-    DMusicStatus.DVolume = volume;
+    SMixerCommand TempCommand;
+    
+    TempCommand.DType = EMixerCommandType::SongVolume;
+    TempCommand.DClip.DVolume = volume;
+    SendCommand(TempCommand);
 }
 
@@ -0,0 +1,335 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included
+    that were extracted from original Warcraft II by Blizzard Entertainment
+    were found freely available via internet sources and have been labeld as
+    abandonware. They have been included in this distribution for educational
+    purposes only and this copyright notice does not attempt to claim any
+    ownership of this material.
+*/
+
+/**
+*
+* @class CSoundStream
+*
+* @brief Plays a long mp3 (the music) without decoding it into memory up
+*        front. A background thread feeds the file to mpg123 in chunks and
+*        decodes into a fixed stereo ring buffer; the audio callback only
+*        copies out of the ring, so it never waits on the decoder.
+*
+*/
+
+#include "SoundStream.h"
+#include "SoundClip.h"
+#include "Debug.h"
+#include <mpg123.h>
+#include <algorithm>
+#include <chrono>
+
+#define STREAM_PREFILL_DIVISOR          4
+#define STREAM_MIN_DECODE_FRAMES        1024
+#define STREAM_DECODER_SLEEP_MS         10
+
+/**
+* A CSoundStream object constructor, allocates the ring buffer
+*
+* @param[in] bufferframes The number of stereo frames the ring buffer holds
+*
+*/
+
+CSoundStream::CSoundStream(int bufferframes) : DReadIndex(0), DWriteIndex(0), DRunning(false), DFinished(false), DUnderruns(0){
+    DDecoder = nullptr;
+    DFramesSinceOpen = 0;
+    DSourceChannels = 2;
+    DSampleRate = 0;
+    DLoop = true;
+    DRing.resize(bufferframes * 2);
+    DReadBuffer.resize(STREAM_READ_CHUNK_SIZE);
+    DDecodeBuffer.resize(STREAM_MIN_DECODE_FRAMES * 2);
+}
+
+/**
+* A CSoundStream object destructor, stops the decoder thread
+*
+*/
+
+CSoundStream::~CSoundStream(){
+    Close();
+}
+
+/**
+* Opens a new data source for the file and a fresh mpg123 feed decoder
+*
+* @return True if the decoder is ready to be fed
+*
+*/
+
+bool CSoundStream::OpenDecoder(){
+    int ReturnValue;
+
+    DSource = DContainer->DataSource(DFilename);
+    if(nullptr == DSource){
+        return false;
+    }
+    DDecoder = mpg123_new(NULL, &ReturnValue);
+    if(nullptr == DDecoder){
+        return false;
+    }
+    if((MPG123_OK != mpg123_param(DDecoder, MPG123_REMOVE_FLAGS, MPG123_IGNORE_INFOFRAME, 0.0))||(MPG123_OK != mpg123_param(DDecoder, MPG123_ADD_FLAGS, MPG123_FORCE_FLOAT, 0.0))||(MPG123_OK != mpg123_open_feed(DDecoder))){
+        mpg123_delete(DDecoder);
+        DDecoder = nullptr;
+        return false;
+    }
+    DFramesSinceOpen = 0;
+    return true;
+}
+
+/**
+* Closes the mpg123 decoder and releases the data source
+*
+* @return void
+*
+*/
+
+void CSoundStream::CloseDecoder(){
+    if(nullptr != DDecoder){
+        mpg123_close(DDecoder);
+        mpg123_delete(DDecoder);
+        DDecoder = nullptr;
+    }
+    DSource = nullptr;
+}
+
+/**
+* Reads the next chunk of the file and hands it to the decoder
+*
+* @return True if more data was fed, false at the end of the file
+*
+*/
+
+bool CSoundStream::FeedDecoder(){
+    int Length = DSource->Read(DReadBuffer.data(), DReadBuffer.size());
+
+    if(0 >= Length){
+        return false;
+    }
+    return MPG123_OK == mpg123_feed(DDecoder, DReadBuffer.data(), Length);
+}
+
+/**
+* Decodes up to the requested number of frames as interleaved stereo, mono
+* songs are duplicated to both channels. At the end of the file the song
+* is restarted if looping, otherwise the stream is marked as finished.
+*
+* @param[out] data The stereo buffer to decode into
+* @param[in] frames The maximum number of frames to decode
+*
+* @return The number of frames decoded
+*
+*/
+
+int CSoundStream::DecodeFrames(float *data, int frames){
+    int Decoded = 0;
+
+    while((Decoded < frames) && !DFinished.load()){
+        size_t BytesRead = 0;
+        size_t Samples = std::min(DDecodeBuffer.size(), (size_t)(frames - Decoded) * DSourceChannels);
+        int ReturnValue = mpg123_read(DDecoder, (unsigned char *)DDecodeBuffer.data(), Samples * sizeof(float), &BytesRead);
+        int FramesRead = BytesRead / sizeof(float) / DSourceChannels;
+
+        if(1 == DSourceChannels){
+            for(int Index = 0; Index < FramesRead; Index++){
+                data[Decoded * 2] = DDecodeBuffer[Index];
+                data[Decoded * 2 + 1] = DDecodeBuffer[Index];
+                Decoded++;
+            }
+        }
+        else{
+            std::copy(DDecodeBuffer.begin(), DDecodeBuffer.begin() + FramesRead * 2, data + Decoded * 2);
+            Decoded += FramesRead;
+        }
+        DFramesSinceOpen += FramesRead;
+
+        if(MPG123_NEW_FORMAT == ReturnValue){
+            long Rate;
+            int Channels, Encoding;
+
+            if((MPG123_OK != mpg123_getformat(DDecoder, &Rate, &Channels, &Encoding))||(sizeof(float) != mpg123_encsize(Encoding))||(1 > Channels)||(2 < Channels)){
+                PrintDebug(DEBUG_LOW, "Unsupported format in song %s\n", DFilename.c_str());
+                DFinished = true;
+                break;
+            }
+            DSampleRate = Rate;
+            DSourceChannels = Channels;
+        }
+        else if((MPG123_NEED_MORE == ReturnValue)||(MPG123_DONE == ReturnValue)){
+            if((MPG123_NEED_MORE == ReturnValue) && FeedDecoder()){
+                continue;
+            }
+            // An empty pass means the file has nothing to play, don't spin reopening it
+            if(!DLoop || !DFramesSinceOpen){
+                DFinished = true;
+                break;
+            }
+            CloseDecoder();
+            if(!OpenDecoder()){
+                DFinished = true;
+            }
+        }
+        else if(MPG123_OK != ReturnValue){
+            PrintDebug(DEBUG_LOW, "Failed to decode song %s\n", DFilename.c_str());
+            DFinished = true;
+        }
+    }
+    return Decoded;
+}
+
+/**
+* Decodes into the free part of the ring buffer, only called from one
+* thread at a time (the caller of Open, then the decoder thread)
+*
+* @param[in] frames The maximum number of frames to decode
+*
+* @return The number of frames added to the ring buffer
+*
+*/
+
+int CSoundStream::FillRing(int frames){
+    int Filled = 0;
+
+    while(Filled < frames){
+        size_t Read = DReadIndex.load(std::memory_order_acquire);
+        size_t Write = DWriteIndex.load(std::memory_order_relaxed);
+        size_t Position = Write % DRing.size();
+        int Free = (DRing.size() - (Write - Read)) / 2;
+        int Contiguous = (DRing.size() - Position) / 2;
+        int FramesToDecode = std::min(std::min(frames - Filled, Free), Contiguous);
+        int Decoded;
+
+        if(0 >= FramesToDecode){
+            break;
+        }
+        Decoded = DecodeFrames(DRing.data() + Position, FramesToDecode);
+        DWriteIndex.store(Write + Decoded * 2, std::memory_order_release);
+        Filled += Decoded;
+        if(Decoded < FramesToDecode){
+            break;
+        }
+    }
+    return Filled;
+}
+
+/**
+* The decoder thread, keeps the ring buffer topped up until closed
+*
+* @return void
+*
+*/
+
+void CSoundStream::DecodeThread(){
+    while(DRunning.load()){
+        int Free = (DRing.size() - (DWriteIndex.load() - DReadIndex.load())) / 2;
+
+        if(DFinished.load() || (STREAM_MIN_DECODE_FRAMES > Free)){
+            std::unique_lock< std::mutex > Lock(DWakeMutex);
+
+            DWakeCondition.wait_for(Lock, std::chrono::milliseconds(STREAM_DECODER_SLEEP_MS), [this]{ return !DRunning.load(); });
+            continue;
+        }
+        FillRing(Free);
+    }
+}
+
+/**
+* Opens a song and starts decoding it, the start of the song is decoded
+* before returning so it can be played without an initial underrun
+*
+* @param[in] container The data container holding the song
+* @param[in] filename The name of the song in the container
+* @param[in] loop True if the song restarts at the end
+*
+* @return True if the song could be opened
+*
+*/
+
+bool CSoundStream::Open(std::shared_ptr< CDataContainer > container, const std::string &filename, bool loop){
+    Close();
+    CSoundClip::LibraryReference();
+
+    DContainer = container;
+    DFilename = filename;
+    DLoop = loop;
+    DReadIndex = 0;
+    DWriteIndex = 0;
+    DFinished = false;
+    DUnderruns = 0;
+    if((nullptr == DContainer) || !OpenDecoder()){
+        CloseDecoder();
+        return false;
+    }
+    if(!FillRing(DRing.size() / 2 / STREAM_PREFILL_DIVISOR) || !DSampleRate){
+        CloseDecoder();
+        return false;
+    }
+    DRunning = true;
+    DThread = std::thread(&CSoundStream::DecodeThread, this);
+    return true;
+}
+
+/**
+* Stops the decoder thread and closes the song, must not be called while
+* the audio callback may still be reading from the stream
+*
+* @return void
+*
+*/
+
+void CSoundStream::Close(){
+    if(DThread.joinable()){
+        {
+            std::lock_guard< std::mutex > Lock(DWakeMutex);
+            DRunning = false;
+        }
+        DWakeCondition.notify_all();
+        DThread.join();
+    }
+    DRunning = false;
+    CloseDecoder();
+}
+
+/**
+* Mixes the next frames of the song into the output, only called from the
+* audio callback. If the decoder has fallen behind the missing frames are
+* left silent and counted as an underrun.
+*
+* @param[out] data The stereo buffer to mix into
+* @param[in] frames The number of frames requested
+* @param[in] volume The volume of the song
+* @param[in] rightbias The bias towards the right channel
+*
+* @return The number of frames mixed
+*
+*/
+
+int CSoundStream::MixStereoStream(float *data, int frames, float volume, float rightbias){
+    size_t Read = DReadIndex.load(std::memory_order_relaxed);
+    size_t Write = DWriteIndex.load(std::memory_order_acquire);
+    size_t Position = Read % DRing.size();
+    int Available = std::min((int)((Write - Read) / 2), frames);
+    int FirstFrames = std::min(Available, (int)((DRing.size() - Position) / 2));
+
+    if((Available < frames) && !DFinished.load(std::memory_order_relaxed)){
+        DUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    CSoundClip::MixStereoBlock(data, DRing.data() + Position, FirstFrames, volume * (1.0 - rightbias), volume * (1.0 + rightbias));
+    CSoundClip::MixStereoBlock(data + FirstFrames * 2, DRing.data(), Available - FirstFrames, volume * (1.0 - rightbias), volume * (1.0 + rightbias));
+    DReadIndex.store(Read + Available * 2, std::memory_order_release);
+    return Available;
+}
@@ -0,0 +1,217 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+/**
+* @class CStartupBenchmark
+*
+* @brief Times loading the game without a window. The whole of
+*     CApplicationData::LoadGameData is loaded once, as the game does on
+*     start up, then the tilesets are loaded again and again through
+*     CAssetLoader, alternating between loading everything on the calling
+*     thread and decoding on the loader threads, so the two can be compared
+*     on the same warm file cache. The sound library is loaded too, rendering
+*     offline. With "--runs 0" the game data is loaded once and the benchmark
+*     quits, which with "--startup-trace FILE" traces a cold start up.
+*
+*     Started with "--startup-benchmark", see PrintUsage for the other
+*     options.
+*
+*/
+
+#include "StartupBenchmark.h"
+#include "ApplicationPath.h"
+#include "AssetArchive.h"
+#include "AssetLoader.h"
+#include "StartupTrace.h"
+#include "Debug.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+* Constructor, stores the context to load into and the options.
+*
+* @param[in] context The application data that will be loaded
+* @param[in] options The parsed benchmark options
+*
+*/
+
+CStartupBenchmark::CStartupBenchmark(std::shared_ptr< CApplicationData > context, const SOptions &options){
+    DContext = context;
+    DOptions = options;
+}
+
+/**
+* Parses the command line for the startup benchmark options. The benchmark
+* is only enabled if "--startup-benchmark" is present.
+*
+* @param[in] argc Number of command line arguments
+* @param[in] argv The command line arguments
+* @param[out] options The parsed options
+*
+* @return true if the startup benchmark was requested
+*
+*/
+
+bool CStartupBenchmark::ParseArguments(int argc, char *argv[], SOptions &options){
+    for(int Index = 1; Index < argc; Index++){
+        std::string Argument = argv[Index];
+        std::string Value = Index + 1 < argc ? argv[Index + 1] : "";
+        bool HasValue = true;
+
+        if("--startup-benchmark" == Argument){
+            options.DEnabled = true;
+            HasValue = false;
+        }
+        else if("--data" == Argument){
+            options.DDataPath = Value;
+        }
+        else if("--runs" == Argument){
+            options.DRuns = std::max(0, std::atoi(Value.c_str()));
+        }
+        else{
+            HasValue = false;
+            if(options.DEnabled){
+                PrintError("Unknown startup benchmark option %s\n", Argument.c_str());
+                PrintUsage(argv[0]);
+            }
+        }
+        if(HasValue){
+            Index++;
+        }
+    }
+    return options.DEnabled;
+}
+
+/**
+* Prints the startup benchmark options.
+*
+* @param[in] program The name of the executable
+*
+* @return void
+*
+*/
+
+void CStartupBenchmark::PrintUsage(const char *program){
+    PrintError("Usage: %s --startup-benchmark [options]\n", program);
+    PrintError("  --data DIR          data directory (default: data next to the executable)\n");
+    PrintError("  --runs N            tileset loads of each kind to time, 0 to only load once (default: 5)\n");
+    PrintError("  --loader-threads N  tileset loader threads (default: one per core up to %d)\n", MAX_ASSET_LOADER_THREADS);
+    PrintError("  --startup-trace FILE  write a trace of the load to FILE and print a summary\n");
+}
+
+/**
+* Loads all of the tilesets once.
+*
+* @param[in] threads The number of loader threads, 0 for none
+* @param[out] waittime Seconds the calling thread waited for the workers
+*
+* @return Seconds taken
+*
+*/
+
+double CStartupBenchmark::LoadAssets(int threads, double &waittime){
+    CAssetLoader AssetLoader(DContext, DDataContainer, DImageDirectory);
+
+    DContext->DLoaderThreads = threads;
+    auto Start = std::chrono::steady_clock::now();
+    AssetLoader.LoadAllAssets();
+    auto End = std::chrono::steady_clock::now();
+    waittime = AssetLoader.WaitTime();
+    return std::chrono::duration< double >(End - Start).count();
+}
+
+/**
+* Prints the best and median of a set of timings.
+*
+* @param[in] name The name of the measurement
+* @param[in] times The timings in seconds, sorted in place
+* @param[in] waittime Total seconds spent waiting for the workers
+*
+* @return void
+*
+*/
+
+void CStartupBenchmark::PrintTimes(const char *name, std::vector< double > &times, double waittime){
+    std::sort(times.begin(), times.end());
+    printf("%-20s best %8.1f ms, median %8.1f ms, waiting %6.1f ms/run\n", name, times.front() * 1000.0, times[times.size() / 2] * 1000.0, waittime * 1000.0 / times.size());
+}
+
+/**
+* Loads the game data once, then times the tileset loads unless no runs
+* were asked for.
+*
+* @return 0 on success, 1 if the game data could not be loaded
+*
+*/
+
+int CStartupBenchmark::Run(){
+    std::string DataPath = DOptions.DDataPath;
+    int Threads = CAssetLoader::ThreadCount(DOptions.DThreads);
+    std::vector< double > SerialTimes, PooledTimes;
+    double SerialWait = 0.0, PooledWait = 0.0;
+
+    if(DataPath.empty()){
+        DataPath = GetApplicationPath().Containing().ToString() + "/data";
+    }
+    DDataContainer = CAssetArchiveDataContainer::OpenDataDirectory(DataPath);
+    DImageDirectory = DDataContainer->DataContainer("img");
+    if(!DImageDirectory){
+        PrintError("Failed to find img directory in %s.\n", DataPath.c_str());
+        return 1;
+    }
+    DContext->DHeadless = true;
+    DContext->DHeadlessSound = true;
+    DContext->DLoaderThreads = Threads;
+    DContext->DTotalLoadingSteps = 128;
+    DContext->DCurrentLoadingStep = 0;
+    DContext->DDoubleBufferSurface = CGraphicFactory::CreateSurface(DContext->DHeadlessWidth, DContext->DHeadlessHeight, CGraphicSurface::ESurfaceFormat::ARGB32);
+    DContext->DWorkingBufferSurface = CGraphicFactory::CreateSurface(DContext->DHeadlessWidth, DContext->DHeadlessHeight, CGraphicSurface::ESurfaceFormat::ARGB32);
+
+    auto LoadStart = std::chrono::steady_clock::now();
+    if(!DContext->LoadGameData(DDataContainer, DImageDirectory)){
+        PrintError("Failed to load game data.\n");
+        return 1;
+    }
+    auto LoadEnd = std::chrono::steady_clock::now();
+    CStartupTrace::Stop();
+    printf("Game data loaded in %.1f ms with %d loader threads, %d of %d splash steps\n", std::chrono::duration< double, std::milli >(LoadEnd - LoadStart).count(), Threads, DContext->DCurrentLoadingStep, DContext->DTotalLoadingSteps);
+    if(0 == DOptions.DRuns){
+        return 0;
+    }
+
+    for(int Run = 0; Run < DOptions.DRuns; Run++){
+        double WaitTime;
+
+        SerialTimes.push_back(LoadAssets(0, WaitTime));
+        SerialWait += WaitTime;
+        if(Threads){
+            PooledTimes.push_back(LoadAssets(Threads, WaitTime));
+            PooledWait += WaitTime;
+        }
+    }
+    PrintTimes("tilesets, 0 threads", SerialTimes, SerialWait);
+    if(Threads){
+        char Name[32];
+
+        snprintf(Name, sizeof(Name), "tilesets, %d threads", Threads);
+        PrintTimes(Name, PooledTimes, PooledWait);
+        printf("speedup %.2fx\n", SerialTimes.front() / std::max(PooledTimes.front(), 1e-12));
+    }
+    DContext->DLoaderThreads = Threads;
+    return 0;
+}
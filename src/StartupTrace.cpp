@@ -0,0 +1,347 @@
+/*
+    Copyright (c) 2015, Christopher Nitta
+    All rights reserved.
+
+    All source material (source code, images, sounds, etc.) have been provided to
+    University of California, Davis students of course ECS 160 for educational
+    purposes. It may not be distributed beyond those enrolled in the course without
+    prior permission from the copyright holder.
+
+    All sound files, sound fonts, midi files, and images that have been included 
+    that were extracted from original Warcraft II by Blizzard Entertainment 
+    were found freely available via internet sources and have been labeld as 
+    abandonware. They have been included in this distribution for educational 
+    purposes only and this copyright notice does not attempt to claim any 
+    ownership of this material.
+*/
+
+/**
+* @class CStartupTrace
+*
+* @brief Records how long each loading step takes, with the bytes and files
+*     it read. A step is timed by a CStartupTrace object that lives on the
+*     stack, from construction until End is called or it goes out of scope,
+*     and steps nest within each other on the same thread. The data sources
+*     count every file they open and every byte they read on the thread
+*     doing the reading, so steps on the loader threads get their own
+*     counts. Nothing is recorded unless the game was started with
+*     "--startup-trace FILE", and Stop ends the recording once start up is
+*     done, so steps run later, like maps loaded on first use, stay out.
+*
+*     At exit Finish writes the steps to FILE in the Chrome trace event
+*     format, which chrome://tracing and Perfetto can show, and prints a
+*     summary of the main thread, which is the critical path of start up,
+*     and of the time each other thread was busy.
+*
+*/
+
+#include "StartupTrace.h"
+#include "Debug.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+std::atomic< bool > CStartupTrace::DEnabled(false);
+std::atomic< bool > CStartupTrace::DRecording(false);
+std::string CStartupTrace::DFileName;
+std::chrono::steady_clock::time_point CStartupTrace::DStartTime;
+std::mutex CStartupTrace::DMutex;
+std::vector< CStartupTrace::SEvent > CStartupTrace::DEvents;
+
+static thread_local uint64_t StartupTraceBytes = 0;
+static thread_local int StartupTraceFiles = 0;
+static thread_local int StartupTraceDepth = 0;
+static thread_local int StartupTraceThread = 0;
+static std::atomic< int > StartupTraceThreadCount(0);
+
+/**
+* Starts timing a step on the calling thread
+*
+* @param[in] name The name of the step
+*
+*/
+
+CStartupTrace::CStartupTrace(const std::string &name){
+    DRunning = false;
+    DStartBytes = 0;
+    DStartFiles = 0;
+    DDepth = 0;
+    Next(name);
+}
+
+/**
+* Destructor, ends the step if End was not called
+*
+*/
+
+CStartupTrace::~CStartupTrace(){
+    End();
+}
+
+/**
+* Ends the step and records it, must be called on the thread that started
+* it. Later calls do nothing.
+*
+* @return void
+*
+*/
+
+void CStartupTrace::End(){
+    SEvent Event;
+
+    if(!DRunning){
+        return;
+    }
+    DRunning = false;
+    Event.DName = DName;
+    Event.DThread = ThreadIndex();
+    Event.DDepth = DDepth;
+    Event.DStart = Milliseconds(DStart);
+    Event.DDuration = Milliseconds(std::chrono::steady_clock::now()) - Event.DStart;
+    Event.DBytes = StartupTraceBytes - DStartBytes;
+    Event.DFiles = StartupTraceFiles - DStartFiles;
+    StartupTraceDepth--;
+
+    std::lock_guard< std::mutex > Lock(DMutex);
+    DEvents.push_back(Event);
+}
+
+/**
+* Ends the current step and starts timing the next one at the same depth,
+* for a sequence of steps in one function
+*
+* @param[in] name The name of the next step
+*
+* @return void
+*
+*/
+
+void CStartupTrace::Next(const std::string &name){
+    End();
+    DRunning = DRecording;
+    if(DRunning){
+        DName = name;
+        DDepth = StartupTraceDepth++;
+        DStartBytes = StartupTraceBytes;
+        DStartFiles = StartupTraceFiles;
+        DStart = std::chrono::steady_clock::now();
+    }
+}
+
+/**
+* Gets the number of the calling thread in the trace, the thread that
+* enabled the trace is 1
+*
+* @return The thread number
+*
+*/
+
+int CStartupTrace::ThreadIndex(){
+    if(0 == StartupTraceThread){
+        StartupTraceThread = ++StartupTraceThreadCount;
+    }
+    return StartupTraceThread;
+}
+
+/**
+* Converts a time to milliseconds since the trace was enabled
+*
+* @param[in] time The time to convert
+*
+* @return The milliseconds since the start of the trace
+*
+*/
+
+double CStartupTrace::Milliseconds(std::chrono::steady_clock::time_point time){
+    return std::chrono::duration< double, std::milli >(time - DStartTime).count();
+}
+
+/**
+* Escapes a string for a JSON string literal
+*
+* @param[in] str The string to escape
+*
+* @return The escaped string
+*
+*/
+
+std::string CStartupTrace::Escape(const std::string &str){
+    std::string Escaped;
+
+    for(auto Character : str){
+        if(('"' == Character) || ('\\' == Character)){
+            Escaped += '\\';
+            Escaped += Character;
+        }
+        else if(0x20 > (unsigned char)Character){
+            char Buffer[8];
+
+            snprintf(Buffer, sizeof(Buffer), "\\u%04x", (unsigned char)Character);
+            Escaped += Buffer;
+        }
+        else{
+            Escaped += Character;
+        }
+    }
+    return Escaped;
+}
+
+/**
+* Starts recording, the start of the trace is now and the calling thread
+* is the main thread
+*
+* @param[in] filename The file the trace is written to by Finish
+*
+* @return void
+*
+*/
+
+void CStartupTrace::Enable(const std::string &filename){
+    DFileName = filename;
+    DStartTime = std::chrono::steady_clock::now();
+    DEvents.clear();
+    ThreadIndex();
+    DEnabled = true;
+    DRecording = true;
+}
+
+/**
+* Stops recording at the end of start up, steps that are still running are
+* recorded when they end. The trace is still written by Finish.
+*
+* @return void
+*
+*/
+
+void CStartupTrace::Stop(){
+    DRecording = false;
+}
+
+/**
+* Counts a file opened by the calling thread
+*
+* @return void
+*
+*/
+
+void CStartupTrace::CountFile(){
+    StartupTraceFiles++;
+}
+
+/**
+* Counts bytes read by the calling thread
+*
+* @param[in] bytes The number of bytes read
+*
+* @return void
+*
+*/
+
+void CStartupTrace::CountBytes(size_t bytes){
+    StartupTraceBytes += bytes;
+}
+
+/**
+* Writes the recorded steps in the Chrome trace event format, as complete
+* events in microseconds with the bytes and files as arguments
+*
+* @param[in] filename The file to write
+*
+* @return true if the file was written
+*
+*/
+
+bool CStartupTrace::Write(const std::string &filename){
+    std::lock_guard< std::mutex > Lock(DMutex);
+    FILE *File = fopen(filename.c_str(), "w");
+    int ThreadCount = StartupTraceThreadCount;
+
+    if(nullptr == File){
+        return false;
+    }
+    fprintf(File, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for(int Index = 1; Index <= ThreadCount; Index++){
+        fprintf(File, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}},\n", Index, 1 == Index ? "main" : "loader", Index);
+    }
+    for(size_t Index = 0; Index < DEvents.size(); Index++){
+        auto &Event = DEvents[Index];
+
+        fprintf(File, "{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"bytes\":%llu,\"files\":%d}}%s\n", Escape(Event.DName).c_str(), Event.DThread, Event.DStart * 1000.0, Event.DDuration * 1000.0, (unsigned long long)Event.DBytes, Event.DFiles, Index + 1 < DEvents.size() ? "," : "");
+    }
+    fprintf(File, "]}\n");
+    return 0 == fclose(File);
+}
+
+/**
+* Prints every step of the main thread with its start, duration, share of
+* the whole start up, bytes and files, indented by nesting, followed by the
+* busy time of each other thread
+*
+* @return void
+*
+*/
+
+void CStartupTrace::PrintSummary(){
+    std::vector< SEvent > Events;
+    std::vector< SThreadSummary > Threads;
+    double TotalTime = 0.0;
+    uint64_t TotalBytes = 0;
+    int TotalFiles = 0;
+
+    {
+        std::lock_guard< std::mutex > Lock(DMutex);
+
+        Events = DEvents;
+    }
+    std::stable_sort(Events.begin(), Events.end(), [](const SEvent &first, const SEvent &second){
+        return first.DThread != second.DThread ? first.DThread < second.DThread : first.DStart < second.DStart;
+    });
+    for(auto &Event : Events){
+        TotalTime = std::max(TotalTime, Event.DStart + Event.DDuration);
+        if((int)Threads.size() < Event.DThread){
+            Threads.resize(Event.DThread);
+        }
+        if(0 == Event.DDepth){
+            SThreadSummary &Thread = Threads[Event.DThread - 1];
+
+            Thread.DSteps++;
+            Thread.DBusy += Event.DDuration;
+            Thread.DBytes += Event.DBytes;
+            Thread.DFiles += Event.DFiles;
+            TotalBytes += Event.DBytes;
+            TotalFiles += Event.DFiles;
+        }
+    }
+    printf("Start up took %.1f ms, read %llu KiB in %d files on %d threads\n", TotalTime, (unsigned long long)(TotalBytes / 1024), TotalFiles, (int)Threads.size());
+    printf("%9s %9s %6s %9s %6s  %s\n", "start ms", "ms", "%", "KiB", "files", "step");
+    for(auto &Event : Events){
+        if(1 == Event.DThread){
+            printf("%9.1f %9.1f %5.1f%% %9llu %6d  %*s%s\n", Event.DStart, Event.DDuration, 0.0 < TotalTime ? Event.DDuration * 100.0 / TotalTime : 0.0, (unsigned long long)(Event.DBytes / 1024), Event.DFiles, Event.DDepth * 2, "", Event.DName.c_str());
+        }
+    }
+    for(size_t Index = 1; Index < Threads.size(); Index++){
+        printf("thread %d: %d steps, busy %.1f ms, %llu KiB in %d files\n", (int)Index + 1, Threads[Index].DSteps, Threads[Index].DBusy, (unsigned long long)(Threads[Index].DBytes / 1024), Threads[Index].DFiles);
+    }
+}
+
+/**
+* Writes the trace and prints the summary, called once at exit. Later steps
+* are not recorded.
+*
+* @return void
+*
+*/
+
+void CStartupTrace::Finish(){
+    if(!DEnabled.exchange(false)){
+        return;
+    }
+    DRecording = false;
+    if(Write(DFileName)){
+        printf("Start up trace written to %s\n", DFileName.c_str());
+    }
+    else{
+        PrintError("Failed to write start up trace %s.\n", DFileName.c_str());
+    }
+    PrintSummary();
+}
@@ -37,6 +37,7 @@
 
 #include "GameModel.h"
 #include "Debug.h"
+#include "MemoryPool.h"
 
 class CPlayerCapabilityTrainNormal : public CPlayerCapability{
     protected:
@@ -62,6 +63,7 @@ class CPlayerCapabilityTrainNormal : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step);
         };
         std::string DUnitName;
@@ -196,7 +198,7 @@ bool CPlayerCapabilityTrainNormal::ApplyCapability(std::shared_ptr< CPlayerAsset
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = NewAsset;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, NewAsset, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, NewAsset, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
         actor->PushCommand(NewCommand);
         actor->ResetStep();
     }
@@ -275,6 +277,27 @@ void CPlayerCapabilityTrainNormal::CActivatedCapability::Save(std::ofstream& sav
     save << DStone << std::endl;
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityTrainNormal::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "TRAIN";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+    save.DCurrentStep = DCurrentStep;
+    save.DTotalSteps = DTotalSteps;
+    save.DLumber = DLumber;
+    save.DGold = DGold;
+    save.DStone = DStone;
+}
+
 void CPlayerCapabilityTrainNormal::CActivatedCapability::Step(int step){
     DCurrentStep = step;
 }
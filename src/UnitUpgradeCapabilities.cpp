@@ -37,6 +37,7 @@
 
 #include "GameModel.h"
 #include "Debug.h"
+#include "MemoryPool.h"
 
 class CPlayerCapabilityUnitUpgrade : public CPlayerCapability{
     protected:
@@ -64,6 +65,7 @@ class CPlayerCapabilityUnitUpgrade : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step);
         };
         std::string DUpgradeName;
@@ -195,7 +197,7 @@ bool CPlayerCapabilityUnitUpgrade::ApplyCapability(std::shared_ptr< CPlayerAsset
         NewCommand.DAction = EAssetAction::Capability;
         NewCommand.DCapability = AssetCapabilityType();
         NewCommand.DAssetTarget = target;
-        NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target, actor->AssetType(), DUpgradeName, Upgrade->LumberCost(), Upgrade->GoldCost(), Upgrade->StoneCost(), CPlayerAsset::UpdateFrequency() * Upgrade->ResearchTime());
+        NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target, actor->AssetType(), DUpgradeName, Upgrade->LumberCost(), Upgrade->GoldCost(), Upgrade->StoneCost(), CPlayerAsset::UpdateFrequency() * Upgrade->ResearchTime());
         actor->PushCommand(NewCommand);
 
         return true;
@@ -287,6 +289,29 @@ void CPlayerCapabilityUnitUpgrade::CActivatedCapability::Save(std::ofstream& sav
     save << DStone << std::endl;
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityUnitUpgrade::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "UNITUPGRADE";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+    save.DUpgradingType = DUpgradingType->Name();
+    save.DUpgradeName = DUpgradeName;
+    save.DCurrentStep = DCurrentStep;
+    save.DTotalSteps = DTotalSteps;
+    save.DLumber = DLumber;
+    save.DGold = DGold;
+    save.DStone = DStone;
+}
+
 void CPlayerCapabilityUnitUpgrade::CActivatedCapability::Step(int step){
     DCurrentStep = step;
 }
@@ -389,6 +414,7 @@ class CPlayerCapabilityBuildRanger : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step);
         };
         std::string DUnitName;
@@ -544,7 +570,7 @@ bool CPlayerCapabilityBuildRanger::ApplyCapability(std::shared_ptr< CPlayerAsset
             NewCommand.DAction = EAssetAction::Capability;
             NewCommand.DCapability = AssetCapabilityType();
             NewCommand.DAssetTarget = target;
-            NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target, actor->AssetType(), DUnitName, Upgrade->LumberCost(), Upgrade->GoldCost(), Upgrade->StoneCost(), CPlayerAsset::UpdateFrequency() * Upgrade->ResearchTime());
+            NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target, actor->AssetType(), DUnitName, Upgrade->LumberCost(), Upgrade->GoldCost(), Upgrade->StoneCost(), CPlayerAsset::UpdateFrequency() * Upgrade->ResearchTime());
             actor->PushCommand(NewCommand);
 
             return true;
@@ -565,7 +591,7 @@ bool CPlayerCapabilityBuildRanger::ApplyCapability(std::shared_ptr< CPlayerAsset
             NewCommand.DAction = EAssetAction::Capability;
             NewCommand.DCapability = AssetCapabilityType();
             NewCommand.DAssetTarget = NewAsset;
-            NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, NewAsset, actor->AssetType(), DUnitName, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
+            NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, NewAsset, actor->AssetType(), DUnitName, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
             actor->PushCommand(NewCommand);
         }
     }
@@ -667,6 +693,29 @@ void CPlayerCapabilityBuildRanger::CActivatedCapability::Save(std::ofstream& sav
     save << DStone << std::endl;
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityBuildRanger::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "UNITUPGRADE";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+    save.DUpgradingType = DUpgradingType ? DUpgradingType->Name() : "";
+    save.DUpgradeName = DUnitName;
+    save.DCurrentStep = DCurrentStep;
+    save.DTotalSteps = DTotalSteps;
+    save.DLumber = DLumber;
+    save.DGold = DGold;
+    save.DStone = DStone;
+}
+
 void CPlayerCapabilityBuildRanger::CActivatedCapability::Step(int step){
     DCurrentStep = step;
 }
@@ -846,6 +895,7 @@ class CPlayerCapabilityBuildKnight : public CPlayerCapability{
                 bool IncrementStep();
                 void Cancel();
                 void Save(std::ofstream& save);
+                void Save(SSavedCapability &save);
                 void Step(int step);
         };
         std::string DUnitName;
@@ -994,7 +1044,7 @@ bool CPlayerCapabilityBuildKnight::ApplyCapability(std::shared_ptr< CPlayerAsset
             NewCommand.DAction = EAssetAction::Capability;
             NewCommand.DCapability = AssetCapabilityType();
             NewCommand.DAssetTarget = target;
-            NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, target, actor->AssetType(), DUnitName, Upgrade->LumberCost(), Upgrade->GoldCost(), Upgrade->StoneCost(), CPlayerAsset::UpdateFrequency() * Upgrade->ResearchTime());
+            NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, target, actor->AssetType(), DUnitName, Upgrade->LumberCost(), Upgrade->GoldCost(), Upgrade->StoneCost(), CPlayerAsset::UpdateFrequency() * Upgrade->ResearchTime());
             actor->PushCommand(NewCommand);
             return true;
         }
@@ -1014,7 +1064,7 @@ bool CPlayerCapabilityBuildKnight::ApplyCapability(std::shared_ptr< CPlayerAsset
             NewCommand.DAction = EAssetAction::Capability;
             NewCommand.DCapability = AssetCapabilityType();
             NewCommand.DAssetTarget = NewAsset;
-            NewCommand.DActivatedCapability = std::make_shared< CActivatedCapability >(actor, playerdata, NewAsset, actor->AssetType(), DUnitName, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
+            NewCommand.DActivatedCapability = MakePooled< CActivatedCapability, EMemorySubsystem::Assets >(actor, playerdata, NewAsset, actor->AssetType(), DUnitName, AssetType->LumberCost(), AssetType->GoldCost(), AssetType->StoneCost(), CPlayerAsset::UpdateFrequency() * AssetType->BuildTime());
             actor->PushCommand(NewCommand);
         }
     }
@@ -1118,6 +1168,29 @@ void CPlayerCapabilityBuildKnight::CActivatedCapability::Save(std::ofstream& sav
     save << DStone << std::endl;
 }
 
+/**
+* Saves activated capability to a record for the binary saved game
+*
+* @param[out] save The record to fill in
+*
+* @return void
+*
+*/
+
+void CPlayerCapabilityBuildKnight::CActivatedCapability::Save(SSavedCapability &save){
+    save.DType = "UNITUPGRADE";
+    save.DActor = DActor->AssetID();
+    save.DPlayerColor = DPlayerData ? to_underlying(DPlayerData->Color()) : -1;
+    save.DTarget = DTarget ? DTarget->AssetID() : -1;
+    save.DUpgradingType = DUpgradingType ? DUpgradingType->Name() : "";
+    save.DUpgradeName = DUnitName;
+    save.DCurrentStep = DCurrentStep;
+    save.DTotalSteps = DTotalSteps;
+    save.DLumber = DLumber;
+    save.DGold = DGold;
+    save.DStone = DStone;
+}
+
 void CPlayerCapabilityBuildKnight::CActivatedCapability::Step(int step){
     DCurrentStep = step;
 }
@@ -16,6 +16,7 @@
 */
 #include "VisibilityMap.h"
 #include "CommentSkipLineDataSource.h"
+#include "MemoryAccounting.h"
 #include <string>
 
 /**
@@ -34,6 +35,19 @@
 *
 */
 
+/**
+* Gets the size of the tiles of a visibility map for the memory accounting
+*
+* @param[in] map The tiles of the map
+*
+* @return The size in bytes
+*
+*/
+
+static size_t VisibilityMapBytes(const std::vector< std::vector< CVisibilityMap::ETileVisibility > > &map){
+    return map.size() * (map.empty() ? 0 : map[0].size()) * sizeof(CVisibilityMap::ETileVisibility);
+}
+
 /**
 * Constructor, builds visibility map based on input width and height
 * Begins with all tiles unseen
@@ -55,6 +69,7 @@ CVisibilityMap::CVisibilityMap(int width, int height, int maxvisibility){
     }
     DTotalMapTiles = width * height;
     DUnseenTiles = DTotalMapTiles;
+    CMemoryAccounting::Allocate(EMemorySubsystem::Visibility, VisibilityMapBytes(DMap));
 }
 
 /**
@@ -69,6 +84,7 @@ CVisibilityMap::CVisibilityMap(const CVisibilityMap &map){
     DMap = map.DMap;
     DTotalMapTiles = map.DTotalMapTiles;
     DUnseenTiles = map.DUnseenTiles;
+    CMemoryAccounting::Allocate(EMemorySubsystem::Visibility, VisibilityMapBytes(DMap));
 }
 
 /**
@@ -77,7 +93,7 @@ CVisibilityMap::CVisibilityMap(const CVisibilityMap &map){
 */
 
 CVisibilityMap::~CVisibilityMap(){
-
+    CMemoryAccounting::Free(EMemorySubsystem::Visibility, VisibilityMapBytes(DMap));
 }
 
 /**
@@ -91,6 +107,8 @@ CVisibilityMap::~CVisibilityMap(){
 
 CVisibilityMap &CVisibilityMap::operator=(const CVisibilityMap &map){
     if(this != &map){
+        CMemoryAccounting::Free(EMemorySubsystem::Visibility, VisibilityMapBytes(DMap));
+        CMemoryAccounting::Allocate(EMemorySubsystem::Visibility, VisibilityMapBytes(map.DMap));
         DMaxVisibility = map.DMaxVisibility;
         DMap = map.DMap;
         DTotalMapTiles = map.DTotalMapTiles;
@@ -29,6 +29,7 @@
 */
 
 #include "ApplicationData.h"
+#include "StartupTrace.h"
 #include "Debug.h"
 
 #ifndef DEBUG_LEVEL
@@ -54,6 +55,7 @@ int main(int argc, char *argv[]){
     AppInstance = CApplicationData::Instance("edu.ucdavis.cs.ecs160.game");
     
     ReturnValue = AppInstance->Run(argc, argv);
+    CStartupTrace::Finish();
     PrintDebug(DEBUG_HIGH,"Run Returned\n");
     return ReturnValue;
 }